@@ -13,6 +13,15 @@ namespace Event {
 class DeferredDeletable {
 public:
   virtual ~DeferredDeletable() = default;
+
+  /**
+   * Called by the dispatcher when the object's deferred deletion comes due, in place of deleting
+   * it. Hot objects can override this to destroy themselves and return their storage to a free
+   * list, @see Event::ObjectPool. If this returns true the dispatcher releases the object without
+   * deleting it and must not touch it again.
+   * @return bool true if the object has disposed of itself, false to have the dispatcher delete it.
+   */
+  virtual bool recycle() { return false; }
 };
 
 using DeferredDeletablePtr = std::unique_ptr<DeferredDeletable>;
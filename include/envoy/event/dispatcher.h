@@ -1,5 +1,6 @@
 #pragma once
 
+#include <chrono>
 #include <cstdint>
 #include <functional>
 #include <memory>
@@ -30,8 +31,13 @@ namespace Event {
  * All dispatcher stats. @see stats_macros.h
  */
 #define ALL_DISPATCHER_STATS(HISTOGRAM)                                                            \
+  HISTOGRAM(deferred_delete_duration_us, Microseconds)                                             \
+  HISTOGRAM(deferred_delete_size, Unspecified)                                                     \
   HISTOGRAM(loop_duration_us, Microseconds)                                                        \
-  HISTOGRAM(poll_delay_us, Microseconds)
+  HISTOGRAM(poll_delay_us, Microseconds)                                                           \
+  HISTOGRAM(poll_duration_us, Microseconds)                                                        \
+  HISTOGRAM(post_queue_depth, Unspecified)                                                         \
+  HISTOGRAM(ready_events, Unspecified)
 
 /**
  * Struct definition for all dispatcher stats. @see stats_macros.h
@@ -40,6 +46,17 @@ struct DispatcherStats {
   ALL_DISPATCHER_STATS(GENERATE_HISTOGRAM_STRUCT)
 };
 
+/**
+ * Cumulative time an event loop has spent waiting for events and processing them. @see
+ * Dispatcher::loopTimes().
+ */
+struct DispatcherLoopTimes {
+  // Time spent blocked polling for events.
+  std::chrono::microseconds poll_time_{};
+  // Time spent processing events between polls.
+  std::chrono::microseconds busy_time_{};
+};
+
 /**
  * Callback invoked when a dispatcher post() runs.
  */
@@ -163,6 +180,17 @@ public:
    */
   virtual Event::TimerPtr createTimer(TimerCb cb) PURE;
 
+  /**
+   * Allocates a coarse grained timer. Coarse timers share a timing wheel owned by the dispatcher,
+   * so arming and disarming one is O(1) and does not touch the event loop's timer heap. Timeouts
+   * are rounded up to the wheel's 1ms tick, so a coarse timer fires up to 1ms later than requested
+   * (plus any delay of the event loop itself), and never earlier. They are meant for timeouts which
+   * are re-armed often and rarely fire, such as per-stream idle timeouts. @see Timer for docs on
+   * how to use the timer.
+   * @param cb supplies the callback to invoke when the timer fires.
+   */
+  virtual Event::TimerPtr createCoarseTimer(TimerCb cb) PURE;
+
   /**
    * Submits an item for deferred delete. @see DeferredDeletable.
    */
@@ -238,6 +266,15 @@ public:
    * Updates approximate monotonic time to current value.
    */
   virtual void updateApproximateMonotonicTime() PURE;
+
+  /**
+   * Returns how long the event loop has spent polling for events and processing them since its
+   * instrumentation was enabled. Instrumentation is enabled by initializeStats() or by the first
+   * call to this method, which then returns zero times, so dispatchers which are never asked pay
+   * nothing for it. Must be called from the dispatcher's thread.
+   * @return DispatcherLoopTimes the cumulative loop times.
+   */
+  virtual DispatcherLoopTimes loopTimes() PURE;
 };
 
 using DispatcherPtr = std::unique_ptr<Dispatcher>;
@@ -347,6 +347,21 @@ struct Http1Settings {
 
   // How header keys should be formatted when serializing HTTP/1.1 headers.
   HeaderKeyFormat header_key_format_{HeaderKeyFormat::Default};
+
+  enum class ParserBackend {
+    // Parse requests byte by byte with http_parser.
+    HttpParser,
+    // Locate the request line and header fields of requests which arrive in a single read with
+    // vectorized delimiter scanning, leaving message framing and bodies to http_parser.
+    HeadScanner,
+  };
+
+  // The parser used for requests received by a server connection.
+  ParserBackend parser_backend_{ParserBackend::HttpParser};
+
+  // The maximum number of requests outstanding at once on an upstream connection. Values greater
+  // than 1 allow requests to be pipelined.
+  uint32_t max_pipeline_depth_{1};
 };
 
 /**
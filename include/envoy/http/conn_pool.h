@@ -114,6 +114,22 @@ public:
   virtual Cancellable* newStream(Http::ResponseDecoder& response_decoder,
                                  Callbacks& callbacks) PURE;
 
+  /**
+   * Create a new stream on the pool for a request which may be pipelined, i.e. written to a
+   * connection behind other requests which have not been answered yet. This must only be used for
+   * idempotent requests whose headers are encoded with end_stream set, as the stream is reset with
+   * StreamResetReason::RemoteRefusedStreamReset if the connection closes before the request is
+   * answered. Pools which do not pipeline requests create the stream as newStream() does.
+   * @param response_decoder supplies the decoder events to fire when the response is
+   *                         available.
+   * @param cb supplies the callbacks to invoke when the connection is ready or has failed.
+   * @return Cancellable* as for newStream().
+   */
+  virtual Cancellable* newPipelinableStream(Http::ResponseDecoder& response_decoder,
+                                            Callbacks& callbacks) {
+    return newStream(response_decoder, callbacks);
+  }
+
   /**
    * @return Upstream::HostDescriptionConstSharedPtr the host for which connections are pooled.
    */
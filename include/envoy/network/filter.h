@@ -3,6 +3,7 @@
 #include <memory>
 
 #include "envoy/buffer/buffer.h"
+#include "envoy/network/drain_decision.h"
 #include "envoy/network/listen_socket.h"
 #include "envoy/network/transport_socket.h"
 #include "envoy/upstream/host_description.h"
@@ -353,7 +354,13 @@ using FilterChainSharedPtr = std::shared_ptr<FilterChain>;
  */
 class DrainableFilterChain : public FilterChain {
 public:
-  virtual void startDraining() PURE;
+  /**
+   * Start draining the connections of the filter chain, independently of the other filter chains
+   * of the listener.
+   * @param drain_decision supplies the decision of whether to close a connection of the filter
+   *        chain. It must outlive the filter chain.
+   */
+  virtual void startDraining(const DrainDecision& drain_decision) PURE;
 };
 
 /**
@@ -227,9 +227,11 @@ public:
 class FilterChainFactoryContext : public virtual FactoryContext {
 public:
   /**
-   * Set the flag that all attached filter chains will be destroyed.
+   * Start draining the connections of the attached filter chains, which will be destroyed.
+   * @param drain_decision supplies the decision of whether to close a connection of the attached
+   *        filter chains. It must outlive the context.
    */
-  virtual void startDraining() PURE;
+  virtual void startDraining(const Network::DrainDecision& drain_decision) PURE;
 };
 
 using FilterChainFactoryContextPtr = std::unique_ptr<FilterChainFactoryContext>;
@@ -5,6 +5,7 @@
 
 #include "envoy/common/pure.h"
 #include "envoy/event/dispatcher.h"
+#include "envoy/ssl/session_ticket_key_storage.h"
 #include "envoy/stats/allocator.h"
 #include "envoy/stats/store.h"
 #include "envoy/thread/thread.h"
@@ -94,6 +95,12 @@ public:
    * @return Thread::BasicLockable& a lock for access logs.
    */
   virtual Thread::BasicLockable& accessLogLock() PURE;
+
+  /**
+   * @return Ssl::SessionTicketKeyStorage* storage for rotated TLS session ticket keys which is
+   *         shared with the parent and child processes, or nullptr if there is none.
+   */
+  virtual Ssl::SessionTicketKeyStorage* sessionTicketKeyStorage() PURE;
 };
 
 } // namespace Server
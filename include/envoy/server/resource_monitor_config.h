@@ -6,6 +6,7 @@
 #include "envoy/event/dispatcher.h"
 #include "envoy/protobuf/message_validator.h"
 #include "envoy/server/resource_monitor.h"
+#include "envoy/thread_local/thread_local.h"
 
 #include "common/protobuf/protobuf.h"
 
@@ -33,6 +34,12 @@ public:
    *         messages.
    */
   virtual ProtobufMessage::ValidationVisitor& messageValidationVisitor() PURE;
+
+  /**
+   * @return ThreadLocal::SlotAllocator& the thread local storage, which monitors can use to sample
+   *         state owned by the worker threads.
+   */
+  virtual ThreadLocal::SlotAllocator& threadLocal() PURE;
 };
 
 /**
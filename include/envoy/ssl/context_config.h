@@ -61,6 +61,24 @@ public:
    */
   virtual unsigned maxProtocolVersion() const PURE;
 
+  /**
+   * @return true if record encryption should be handed over to the kernel after the handshake,
+   *         where the kernel and the negotiated parameters allow it.
+   */
+  virtual bool kernelTlsOffload() const PURE;
+
+  /**
+   * @return the maximum plaintext size of the records written at the start of a connection, or 0
+   *         if all records are written at the maximum size.
+   */
+  virtual uint32_t initialRecordSize() const PURE;
+
+  /**
+   * @return the number of plaintext bytes written with initialRecordSize() records before a
+   *         connection switches to maximum size records.
+   */
+  virtual uint32_t initialRecordBytes() const PURE;
+
   /**
    * @return true if the ContextConfig is able to provide secrets to create SSL context,
    * and false if dynamic secrets are expected but are not downloaded from SDS server yet.
@@ -112,6 +130,13 @@ public:
     std::array<uint8_t, 256 / 8> aes_key_; // AES256 key size, in bytes
   };
 
+  struct SessionTicketKeyRotation {
+    // How long a key encrypts new session tickets before a new key is generated.
+    std::chrono::milliseconds rotation_interval_;
+    // Number of most recent keys which are accepted to decrypt session tickets.
+    uint32_t decryption_keys_;
+  };
+
   /**
    * @return True if client certificate is required, false otherwise.
    */
@@ -134,6 +159,18 @@ public:
    * @return True if stateless TLS session resumption is disabled, false otherwise.
    */
   virtual bool disableStatelessSessionResumption() const PURE;
+
+  /**
+   * @return the rotation settings if session tickets are encrypted with automatically rotated keys,
+   *         or nullopt otherwise.
+   */
+  virtual const absl::optional<SessionTicketKeyRotation>& sessionTicketKeyRotation() const PURE;
+
+  /**
+   * @return True if sessions are stored in the session cache shared by all server contexts, false
+   *         if each context keeps its own cache.
+   */
+  virtual bool sharedSessionCache() const PURE;
 };
 
 using ServerContextConfigPtr = std::unique_ptr<ServerContextConfig>;
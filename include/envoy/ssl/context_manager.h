@@ -7,6 +7,7 @@
 #include "envoy/ssl/context.h"
 #include "envoy/ssl/context_config.h"
 #include "envoy/ssl/private_key/private_key.h"
+#include "envoy/ssl/session_ticket_key_storage.h"
 #include "envoy/stats/scope.h"
 
 namespace Envoy {
@@ -54,7 +55,15 @@ using ContextManagerPtr = std::unique_ptr<ContextManager>;
 class ContextManagerFactory : public Config::UntypedFactory {
 public:
   ~ContextManagerFactory() override = default;
-  virtual ContextManagerPtr createContextManager(TimeSource& time_source) PURE;
+  /**
+   * @param time_source supplies the time source of the server.
+   * @param session_ticket_key_storage supplies storage for rotated session ticket keys which is
+   *        shared with other Envoy processes, or nullptr if the keys are local to this process.
+   * @return ContextManagerPtr a new context manager.
+   */
+  virtual ContextManagerPtr
+  createContextManager(TimeSource& time_source,
+                       SessionTicketKeyStorage* session_ticket_key_storage) PURE;
 
   // There could be only one factory thus the name is static.
   std::string name() const override { return "ssl_context_manager"; }
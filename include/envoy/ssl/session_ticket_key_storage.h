@@ -0,0 +1,60 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+#include "envoy/common/pure.h"
+#include "envoy/thread/thread.h"
+
+namespace Envoy {
+namespace Ssl {
+
+/**
+ * Automatically rotated TLS session ticket keys. This structure is plain old data so that it can be
+ * laid directly into memory shared with other processes, e.g. the hot restart shared memory
+ * segment, which lets a new Envoy process resume sessions whose tickets were issued by its parent.
+ */
+struct RotatedSessionTicketKeys {
+  enum { MaxKeys = 8 };
+
+  struct Key {
+    uint8_t name_[16];     // 16 == SSL_TICKET_KEY_NAME_LEN
+    uint8_t hmac_key_[32]; // 32 == SHA256_DIGEST_LENGTH
+    uint8_t aes_key_[32];  // AES256 key size, in bytes
+    // Creation time of the key, in milliseconds since the epoch of the system clock.
+    int64_t created_at_;
+  };
+
+  // Number of valid keys in keys_.
+  uint32_t num_keys_;
+  // Keys ordered from the newest, which encrypts new tickets, to the oldest.
+  Key keys_[MaxKeys];
+};
+
+/**
+ * Storage for rotated session ticket keys which may be shared with other processes.
+ */
+class SessionTicketKeyStorage {
+public:
+  virtual ~SessionTicketKeyStorage() = default;
+
+  /**
+   * @return Thread::BasicLockable& the lock which must be held while accessing keys().
+   */
+  virtual Thread::BasicLockable& lock() PURE;
+
+  /**
+   * @return RotatedSessionTicketKeys& the keys. All zero until keys are first generated.
+   */
+  virtual RotatedSessionTicketKeys& keys() PURE;
+
+  /**
+   * @return std::atomic<uint64_t>& a counter which is incremented, while holding lock(), whenever
+   *         keys() is changed. It may be read without the lock to find out whether a copy of the
+   *         keys is still current.
+   */
+  virtual std::atomic<uint64_t>& generation() PURE;
+};
+
+} // namespace Ssl
+} // namespace Envoy
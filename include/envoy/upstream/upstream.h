@@ -558,6 +558,9 @@ public:
   COUNTER(upstream_cx_none_healthy)                                                                \
   COUNTER(upstream_cx_overflow)                                                                    \
   COUNTER(upstream_cx_pool_overflow)                                                               \
+  COUNTER(upstream_cx_preconnect_total)                                                            \
+  COUNTER(upstream_cx_preconnect_unused)                                                           \
+  COUNTER(upstream_cx_preconnect_used)                                                             \
   COUNTER(upstream_cx_protocol_error)                                                              \
   COUNTER(upstream_cx_rx_bytes_total)                                                              \
   COUNTER(upstream_cx_total)                                                                       \
@@ -570,11 +573,14 @@ public:
   COUNTER(upstream_internal_redirect_succeeded_total)                                              \
   COUNTER(upstream_rq_cancelled)                                                                   \
   COUNTER(upstream_rq_completed)                                                                   \
+  COUNTER(upstream_rq_cross_worker)                                                                \
   COUNTER(upstream_rq_maintenance_mode)                                                            \
   COUNTER(upstream_rq_pending_failure_eject)                                                       \
   COUNTER(upstream_rq_pending_overflow)                                                            \
   COUNTER(upstream_rq_pending_total)                                                               \
   COUNTER(upstream_rq_per_try_timeout)                                                             \
+  COUNTER(upstream_rq_pipeline_refused)                                                            \
+  COUNTER(upstream_rq_pipelined)                                                                   \
   COUNTER(upstream_rq_retry)                                                                       \
   COUNTER(upstream_rq_retry_limit_exceeded)                                                        \
   COUNTER(upstream_rq_retry_overflow)                                                              \
@@ -596,7 +602,8 @@ public:
   GAUGE(upstream_rq_pending_active, Accumulate)                                                    \
   GAUGE(version, NeverImport)                                                                      \
   HISTOGRAM(upstream_cx_connect_ms, Milliseconds)                                                  \
-  HISTOGRAM(upstream_cx_length_ms, Milliseconds)
+  HISTOGRAM(upstream_cx_length_ms, Milliseconds)                                                   \
+  HISTOGRAM(upstream_rq_pipeline_depth, Unspecified)
 
 /**
  * All cluster load report stats. These are only use for EDS load reporting and not sent to the
@@ -710,6 +717,26 @@ public:
    */
   virtual uint32_t perConnectionBufferLimitBytes() const PURE;
 
+  /**
+   * @return how many streams should be anticipated per each current stream on an upstream
+   *         connection pool. A ratio greater than 1.0 causes connection pools to establish spare
+   *         connections ahead of demand. @see Cluster.PreconnectPolicy.
+   */
+  virtual float perUpstreamPreconnectRatio() const PURE;
+
+  /**
+   * @return the number of workers which own HTTP/2 connections to each upstream host, or 0 if
+   *         HTTP/2 connection pools are not shared across workers.
+   *         @see Cluster.SharedHttp2ConnectionPool.
+   */
+  virtual uint32_t sharedHttp2PoolOwnerWorkers() const PURE;
+
+  /**
+   * @return whether hosts of this cluster use the compact host representation, in which per-host
+   *         stats are allocated on first use. @see Cluster.compact_host_representation.
+   */
+  virtual bool compactHostRepresentation() const PURE;
+
   /**
    * @return uint64_t features supported by the cluster. @see Features.
    */
@@ -513,6 +513,14 @@ void OwnedImpl::appendSliceForTest(absl::string_view data) {
   appendSliceForTest(data.data(), data.size());
 }
 
+uint64_t OwnedImpl::capacity() const {
+  uint64_t capacity = 0;
+  for (const auto& slice : slices_) {
+    capacity += slice->capacity();
+  }
+  return capacity;
+}
+
 std::vector<OwnedSlice::SliceRepresentation> OwnedImpl::describeSlicesForTest() const {
   std::vector<OwnedSlice::SliceRepresentation> slices;
   for (const auto& slice : slices_) {
@@ -67,6 +67,11 @@ public:
     }
   }
 
+  /**
+   * @return the total number of bytes in the slice, including drained and reservable space.
+   */
+  uint64_t capacity() const { return capacity_; }
+
   /**
    * @return the number of bytes available to be reserve()d.
    * @note Read-only implementations of Slice should return zero from this method.
@@ -547,6 +552,12 @@ public:
    */
   void appendSliceForTest(absl::string_view data);
 
+  /**
+   * @return the number of bytes of memory held by the slices of the buffer. This is at least its
+   *         length, as it includes space which has been drained or is still reservable.
+   */
+  uint64_t capacity() const;
+
   /**
    * Describe the in-memory representation of the slices in the buffer. For use
    * in tests that want to make assertions about the specific arrangement of
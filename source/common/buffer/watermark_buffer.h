@@ -24,6 +24,7 @@ public:
   void add(const void* data, uint64_t size) override;
   void add(absl::string_view data) override;
   void add(const Instance& data) override;
+  void addBufferFragment(BufferFragment& fragment) override;
   void prepend(absl::string_view data) override;
   void prepend(Instance& data) override;
   void commit(RawSlice* iovecs, uint64_t num_iovecs) override;
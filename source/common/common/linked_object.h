@@ -8,11 +8,12 @@
 namespace Envoy {
 /**
  * Mixin class that allows an object contained in a unique pointer to be easily linked and unlinked
- * from lists.
+ * from lists. Allocator supplies the allocator of the lists, for objects which are linked and
+ * unlinked at a high rate.
  */
-template <class T> class LinkedObject {
+template <class T, class Allocator = std::allocator<std::unique_ptr<T>>> class LinkedObject {
 public:
-  using ListType = std::list<std::unique_ptr<T>>;
+  using ListType = std::list<std::unique_ptr<T>, Allocator>;
 
   /**
    * @return the list iterator for the object.
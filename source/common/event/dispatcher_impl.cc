@@ -11,7 +11,6 @@
 #include "envoy/network/listener.h"
 
 #include "common/buffer/buffer_impl.h"
-#include "common/common/lock_guard.h"
 #include "common/common/thread.h"
 #include "common/event/file_event_impl.h"
 #include "common/event/libevent_scheduler.h"
@@ -32,6 +31,14 @@
 namespace Envoy {
 namespace Event {
 
+namespace {
+
+// Coarse timers fire at most one tick late. The wheel only wakes up for its earliest occupied
+// slot, so a fine tick does not cost extra wakeups.
+constexpr std::chrono::milliseconds CoarseTimerGranularity{1};
+
+} // namespace
+
 DispatcherImpl::DispatcherImpl(const std::string& name, Api::Api& api,
                                Event::TimeSystem& time_system)
     : DispatcherImpl(name, std::make_unique<Buffer::WatermarkBufferFactory>(), api, time_system) {}
@@ -91,16 +98,36 @@ void DispatcherImpl::clearDeferredDeleteList() {
   }
 
   deferred_deleting_ = true;
+  const MonotonicTime start_time =
+      stats_ != nullptr ? timeSource().monotonicTime() : MonotonicTime();
 
   // Calling clear() on the vector does not specify which order destructors run in. We want to
   // destroy in FIFO order so just do it manually. This required 2 passes over the vector which is
-  // not optimal but can be cleaned up later if needed.
+  // not optimal but can be cleaned up later if needed. Objects which recycle themselves have
+  // already been destroyed, so their pointers are released rather than deleted.
+  uint64_t num_recycled = 0;
   for (size_t i = 0; i < num_to_delete; i++) {
-    (*to_delete)[i].reset();
+    DeferredDeletablePtr& object = (*to_delete)[i];
+    if (object != nullptr && object->recycle()) {
+      object.release();
+      num_recycled++;
+    } else {
+      object.reset();
+    }
   }
 
   to_delete->clear();
   deferred_deleting_ = false;
+
+  ENVOY_LOG(trace, "cleared deferred deletion list (size={}, recycled={})", num_to_delete,
+            num_recycled);
+  if (stats_ != nullptr) {
+    stats_->deferred_delete_size_.recordValue(num_to_delete);
+    stats_->deferred_delete_duration_us_.recordValue(
+        std::chrono::duration_cast<std::chrono::microseconds>(timeSource().monotonicTime() -
+                                                              start_time)
+            .count());
+  }
 }
 
 Network::ConnectionPtr
@@ -159,6 +186,14 @@ TimerPtr DispatcherImpl::createTimer(TimerCb cb) {
   return createTimerInternal(cb);
 }
 
+TimerPtr DispatcherImpl::createCoarseTimer(TimerCb cb) {
+  ASSERT(isThreadSafe());
+  if (coarse_timer_wheel_ == nullptr) {
+    coarse_timer_wheel_ = std::make_unique<TimingWheel>(*this, CoarseTimerGranularity);
+  }
+  return coarse_timer_wheel_->createTimer(std::move(cb));
+}
+
 TimerPtr DispatcherImpl::createTimerInternal(TimerCb cb) {
   return scheduler_->createTimer(cb, *this);
 }
@@ -180,14 +215,7 @@ SignalEventPtr DispatcherImpl::listenForSignal(int signal_num, SignalCb cb) {
 }
 
 void DispatcherImpl::post(std::function<void()> callback) {
-  bool do_post;
-  {
-    Thread::LockGuard lock(post_lock_);
-    do_post = post_callbacks_.empty();
-    post_callbacks_.push_back(callback);
-  }
-
-  if (do_post) {
+  if (post_queue_.push(std::move(callback))) {
     post_timer_->enableTimer(std::chrono::milliseconds(0));
   }
 }
@@ -213,24 +241,15 @@ void DispatcherImpl::updateApproximateMonotonicTimeInternal() {
   approximate_monotonic_time_ = api_.timeSource().monotonicTime();
 }
 
+DispatcherLoopTimes DispatcherImpl::loopTimes() {
+  ASSERT(isThreadSafe());
+  return base_scheduler_.loopTimes();
+}
+
 void DispatcherImpl::runPostCallbacks() {
-  while (true) {
-    // It is important that this declaration is inside the body of the loop so that the callback is
-    // destructed while post_lock_ is not held. If callback is declared outside the loop and reused
-    // for each iteration, the previous iteration's callback is destructed when callback is
-    // re-assigned, which happens while holding the lock. This can lead to a deadlock (via
-    // recursive mutex acquisition) if destroying the callback runs a destructor, which through some
-    // callstack calls post() on this dispatcher.
-    std::function<void()> callback;
-    {
-      Thread::LockGuard lock(post_lock_);
-      if (post_callbacks_.empty()) {
-        return;
-      }
-      callback = post_callbacks_.front();
-      post_callbacks_.pop_front();
-    }
-    callback();
+  const uint64_t run = post_queue_.runCallbacks();
+  if (stats_ != nullptr) {
+    stats_->post_queue_depth_.recordValue(run);
   }
 }
 
@@ -9,8 +9,10 @@ namespace Envoy {
 namespace Event {
 
 namespace {
+uint64_t timevalToMicros(const timeval& tv) { return tv.tv_sec * 1000000 + tv.tv_usec; }
+
 void recordTimeval(Stats::Histogram& histogram, const timeval& tv) {
-  histogram.recordValue(tv.tv_sec * 1000000 + tv.tv_usec);
+  histogram.recordValue(timevalToMicros(tv));
 }
 } // namespace
 
@@ -59,6 +61,19 @@ void LibeventScheduler::registerOnPrepareCallback(OnPrepareCallback&& callback)
 
 void LibeventScheduler::initializeStats(DispatcherStats* stats) {
   stats_ = stats;
+  enableInstrumentation();
+}
+
+DispatcherLoopTimes LibeventScheduler::loopTimes() {
+  enableInstrumentation();
+  return loop_times_;
+}
+
+void LibeventScheduler::enableInstrumentation() {
+  if (instrumented_) {
+    return;
+  }
+  instrumented_ = true;
   // These are thread safe.
   evwatch_prepare_new(libevent_.get(), &onPrepareForStats, this);
   evwatch_check_new(libevent_.get(), &onCheckForStats, this);
@@ -83,11 +98,14 @@ void LibeventScheduler::onPrepareForStats(evwatch*, const evwatch_prepare_cb_inf
   evutil_gettimeofday(&self->prepare_time_, nullptr);
 
   // If we have a check time available from a previous iteration of the event loop (that is, all but
-  // the first), compute the loop_duration stat.
+  // the first), the time since then was spent processing events. Compute the loop_duration stat.
   if (self->check_time_.tv_sec != 0) {
     timeval delta;
     evutil_timersub(&self->prepare_time_, &self->check_time_, &delta);
-    recordTimeval(self->stats_->loop_duration_us_, delta);
+    self->loop_times_.busy_time_ += std::chrono::microseconds(timevalToMicros(delta));
+    if (self->stats_ != nullptr) {
+      recordTimeval(self->stats_->loop_duration_us_, delta);
+    }
   }
 }
 
@@ -99,9 +117,21 @@ void LibeventScheduler::onCheckForStats(evwatch*, const evwatch_check_cb_info*,
   // from above to compute the actual polling duration, and store it for the next iteration of the
   // event loop to compute the loop duration.
   evutil_gettimeofday(&self->check_time_, nullptr);
+  timeval delta;
+  evutil_timersub(&self->check_time_, &self->prepare_time_, &delta);
+  self->loop_times_.poll_time_ += std::chrono::microseconds(timevalToMicros(delta));
+  if (self->stats_ == nullptr) {
+    return;
+  }
+
+  recordTimeval(self->stats_->poll_duration_us_, delta);
+  // Events which became ready in this poll. Expired timers are activated after this point and are
+  // not included.
+  self->stats_->ready_events_.recordValue(
+      event_base_get_num_events(self->libevent_.get(), EVENT_BASE_COUNT_ACTIVE));
+
   if (self->timeout_set_) {
-    timeval delta, delay;
-    evutil_timersub(&self->check_time_, &self->prepare_time_, &delta);
+    timeval delay;
     evutil_timersub(&delta, &self->timeout_, &delay);
 
     // Delay can be negative, meaning polling completed early. This happens in normal operation,
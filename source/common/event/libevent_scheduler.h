@@ -54,17 +54,28 @@ public:
 
   /**
    * Start writing stats once thread-local storage is ready to receive them (see
-   * ThreadLocalStoreImpl::initializeThreading).
+   * ThreadLocalStoreImpl::initializeThreading). This also enables loop time tracking.
    */
   void initializeStats(DispatcherStats* stats);
 
+  /**
+   * @return the cumulative time spent polling and processing events. The first call enables loop
+   *         time tracking if initializeStats() has not already done so. @see
+   *         Dispatcher::loopTimes().
+   */
+  DispatcherLoopTimes loopTimes();
+
 private:
+  void enableInstrumentation();
+
   static void onPrepareForCallback(evwatch*, const evwatch_prepare_cb_info* info, void* arg);
   static void onPrepareForStats(evwatch*, const evwatch_prepare_cb_info* info, void* arg);
   static void onCheckForStats(evwatch*, const evwatch_check_cb_info*, void* arg);
 
   Libevent::BasePtr libevent_;
-  DispatcherStats* stats_{}; // stats owned by the containing DispatcherImpl
+  DispatcherStats* stats_{}; // stats owned by the containing DispatcherImpl, if enabled
+  bool instrumented_{};      // whether the prepare and check watchers have been installed
+  DispatcherLoopTimes loop_times_; // cumulative poll and processing times
   bool timeout_set_{};       // whether there is a poll timeout in the current event loop iteration
   timeval timeout_{};        // the poll timeout for the current event loop iteration, if available
   timeval prepare_time_{};   // timestamp immediately before polling
@@ -0,0 +1,175 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <utility>
+#include <vector>
+
+#include "common/common/non_copyable.h"
+
+namespace Envoy {
+namespace Event {
+
+/**
+ * A free list of storage for objects of type T. It lets hot objects which are destroyed through
+ * the dispatcher's deferred delete list keep their memory for the next object of the same type
+ * instead of handing it back to the allocator: the object's DeferredDeletable::recycle() override
+ * calls recycle() on the pool, and new objects are built with create().
+ *
+ * The storage is plain operator new memory of sizeof(T), so objects created by the pool may also
+ * be deleted normally, and any object of exactly type T may be recycled. Pools are not
+ * thread-safe; they are meant to be declared static thread_local so that each worker keeps its own
+ * free list.
+ */
+template <class T> class ObjectPool : NonCopyable {
+public:
+  static constexpr uint32_t DefaultMaxFreeObjects = 1024;
+
+  /**
+   * @param max_free_objects supplies the maximum number of free objects to retain. Objects
+   *        recycled beyond that are not accepted and get deleted as usual.
+   */
+  explicit ObjectPool(uint32_t max_free_objects = DefaultMaxFreeObjects)
+      : max_free_objects_(max_free_objects) {
+    static_assert(alignof(T) <= alignof(std::max_align_t), "over-aligned types are not supported");
+  }
+
+  ~ObjectPool() {
+    for (void* storage : free_) {
+      ::operator delete(storage);
+    }
+  }
+
+  /**
+   * Construct an object, reusing the storage of a recycled one if there is any.
+   * @param args supplies the constructor arguments.
+   * @return std::unique_ptr<T> the new object.
+   */
+  template <class... Args> std::unique_ptr<T> create(Args&&... args) {
+    if (free_.empty()) {
+      return std::make_unique<T>(std::forward<Args>(args)...);
+    }
+    // Take the storage off the free list before constructing the object, whose constructor may
+    // create or recycle other objects of the pool, and put it back if the constructor throws.
+    void* storage = free_.back();
+    free_.pop_back();
+    T* object;
+    try {
+      object = new (storage) T(std::forward<Args>(args)...);
+    } catch (...) {
+      free_.push_back(storage);
+      throw;
+    }
+    reused_++;
+    return std::unique_ptr<T>(object);
+  }
+
+  /**
+   * Destroy an object and keep its storage for reuse. Typically called from the object's own
+   * DeferredDeletable::recycle(), in which case the object must not be touched after this returns
+   * true.
+   * @param object supplies the object, whose dynamic type must be exactly T.
+   * @return bool true if the object was destroyed, false if the pool is full and the caller
+   *         remains responsible for deleting the object.
+   */
+  bool recycle(T* object) {
+    if (free_.size() >= max_free_objects_) {
+      return false;
+    }
+    // The storage only becomes free once the destructor has returned, as the destructor may create
+    // or recycle other objects of the pool. These may also fill the pool, in which case the storage
+    // is released.
+    object->~T();
+    deallocate(object);
+    return true;
+  }
+
+  /**
+   * Allocate storage for one object, reusing the storage of a recycled one if there is any. This
+   * lets a class keep its storage in a pool through class-specific operator new and delete.
+   * @return void* uninitialized storage of sizeof(T), to be released with deallocate() or operator
+   *         delete.
+   */
+  void* allocate() {
+    if (free_.empty()) {
+      return ::operator new(sizeof(T));
+    }
+    void* storage = free_.back();
+    free_.pop_back();
+    reused_++;
+    return storage;
+  }
+
+  /**
+   * Release storage obtained from allocate() or from recycling, keeping it for reuse unless the
+   * pool is full.
+   * @param storage supplies the storage, which must not hold a live object.
+   */
+  void deallocate(void* storage) {
+    if (free_.size() < max_free_objects_) {
+      free_.push_back(storage);
+    } else {
+      ::operator delete(storage);
+    }
+  }
+
+  /**
+   * @return the number of free objects currently retained.
+   */
+  size_t freeObjects() const { return free_.size(); }
+
+  /**
+   * @return the number of objects constructed in recycled storage.
+   */
+  uint64_t reused() const { return reused_; }
+
+private:
+  const uint32_t max_free_objects_;
+  std::vector<void*> free_;
+  uint64_t reused_{};
+};
+
+/**
+ * An allocator for node based standard containers whose single element allocations, such as the
+ * nodes of a std::list, come from a per-thread ObjectPool of the node type. Larger allocations go
+ * to operator new. Since pooled storage is plain operator new memory, containers may be destroyed
+ * on a different thread than the one which filled them.
+ */
+template <class T> class ObjectPoolAllocator {
+public:
+  using value_type = T;
+
+  ObjectPoolAllocator() = default;
+  template <class U> ObjectPoolAllocator(const ObjectPoolAllocator<U>&) {}
+
+  T* allocate(size_t n) {
+    if (n != 1) {
+      return static_cast<T*>(::operator new(n * sizeof(T)));
+    }
+    return static_cast<T*>(pool().allocate());
+  }
+
+  void deallocate(T* storage, size_t n) {
+    if (n != 1) {
+      ::operator delete(storage);
+      return;
+    }
+    pool().deallocate(storage);
+  }
+
+  /**
+   * @return the calling thread's pool of single element storage.
+   */
+  static ObjectPool<T>& pool() {
+    static thread_local ObjectPool<T> pool;
+    return pool;
+  }
+
+  template <class U> bool operator==(const ObjectPoolAllocator<U>&) const { return true; }
+  template <class U> bool operator!=(const ObjectPoolAllocator<U>&) const { return false; }
+};
+
+} // namespace Event
+} // namespace Envoy
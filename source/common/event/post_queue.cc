@@ -0,0 +1,124 @@
+#include "common/event/post_queue.h"
+
+#include "common/common/assert.h"
+#include "common/common/lock_guard.h"
+
+namespace Envoy {
+namespace Event {
+
+PostQueue::PostQueue(uint32_t capacity) : mask_(capacity - 1), cells_(new Cell[capacity]) {
+  RELEASE_ASSERT(capacity != 0 && (capacity & (capacity - 1)) == 0,
+                 "post queue capacity must be a power of two");
+  for (uint64_t i = 0; i < capacity; i++) {
+    cells_[i].sequence_.store(i, std::memory_order_relaxed);
+  }
+}
+
+PostQueue::~PostQueue() = default;
+
+bool PostQueue::push(PostCb callback) {
+  if (overflowed_.load(std::memory_order_acquire) || !tryPushRing(callback)) {
+    Thread::LockGuard lock(overflow_lock_);
+    overflowed_.store(true, std::memory_order_release);
+    overflow_.push_back(std::move(callback));
+    overflows_.fetch_add(1, std::memory_order_relaxed);
+  }
+  // The exchange pairs with the one in runCallbacks(): either the consumer sees this callback, or
+  // this push sees that no wakeup is pending and requests one.
+  return !wakeup_pending_.exchange(true);
+}
+
+bool PostQueue::tryPushRing(PostCb& callback) {
+  uint64_t pos = enqueue_pos_.load(std::memory_order_relaxed);
+  Cell* cell;
+  while (true) {
+    cell = &cells_[pos & mask_];
+    const uint64_t sequence = cell->sequence_.load(std::memory_order_acquire);
+    const int64_t diff = static_cast<int64_t>(sequence) - static_cast<int64_t>(pos);
+    if (diff == 0) {
+      // The cell is free; claim it by advancing the enqueue position.
+      if (enqueue_pos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+        break;
+      }
+    } else if (diff < 0) {
+      // The cell still holds a callback from the previous lap, so the ring is full.
+      return false;
+    } else {
+      pos = enqueue_pos_.load(std::memory_order_relaxed);
+    }
+  }
+  cell->callback_ = std::move(callback);
+  cell->sequence_.store(pos + 1, std::memory_order_release);
+  return true;
+}
+
+bool PostQueue::tryPopRing(PostCb& callback) {
+  Cell& cell = cells_[dequeue_pos_ & mask_];
+  if (cell.sequence_.load(std::memory_order_acquire) != dequeue_pos_ + 1) {
+    return false;
+  }
+  callback = std::move(cell.callback_);
+  cell.callback_ = nullptr;
+  cell.sequence_.store(dequeue_pos_ + mask_ + 1, std::memory_order_release);
+  dequeue_pos_++;
+  return true;
+}
+
+uint64_t PostQueue::drainRing() {
+  uint64_t run = 0;
+  while (true) {
+    // Declared in the loop so that each callback is destroyed right after it runs.
+    PostCb callback;
+    if (!tryPopRing(callback)) {
+      return run;
+    }
+    callback();
+    run++;
+  }
+}
+
+uint64_t PostQueue::runCallbacks() {
+  wakeup_pending_.exchange(false);
+  uint64_t run = 0;
+  while (true) {
+    run += drainRing();
+    // If a push has claimed the next cell and not filled it yet, stop here: the callbacks in the
+    // overflow list must not run ahead of it, and that push will request a wakeup.
+    if (ringBusy() || !overflowed_.load(std::memory_order_acquire)) {
+      return run;
+    }
+
+    std::list<PostCb> overflow;
+    {
+      Thread::LockGuard lock(overflow_lock_);
+      overflow.swap(overflow_);
+      if (overflow.empty()) {
+        // Everything which overflowed has run, so pushes may use the ring again.
+        overflowed_.store(false, std::memory_order_release);
+        return run;
+      }
+    }
+
+    // Callbacks pushed to the ring before the swap may have been posted ahead of the overflowed
+    // ones by the same thread, so they run first. Pushes made since the overflow list filled up go
+    // to the overflow list, which keeps each thread's callbacks in order.
+    run += drainRing();
+    if (ringBusy()) {
+      Thread::LockGuard lock(overflow_lock_);
+      overflow_.splice(overflow_.begin(), overflow);
+      return run;
+    }
+
+    while (!overflow.empty()) {
+      // Callbacks are destroyed without overflow_lock_ held, since destroying a callback may post
+      // to this queue.
+      PostCb callback = std::move(overflow.front());
+      overflow.pop_front();
+      callback();
+      run++;
+    }
+  }
+}
+
+} // namespace Event
+} // namespace Envoy
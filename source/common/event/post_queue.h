@@ -0,0 +1,85 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <list>
+#include <memory>
+
+#include "envoy/event/dispatcher.h"
+
+#include "common/common/non_copyable.h"
+#include "common/common/thread.h"
+
+namespace Envoy {
+namespace Event {
+
+/**
+ * The queue of callbacks posted to a dispatcher. Any thread may push, and only the dispatcher
+ * thread runs the callbacks.
+ *
+ * Callbacks are moved into a fixed ring of preallocated cells using the bounded queue design of
+ * Dmitry Vyukov, so a push takes no lock and allocates nothing beyond what the std::function itself
+ * needs. Pushes which find the ring full go to a mutex protected overflow list instead, and all
+ * pushes keep going there until the consumer has drained it so that each producer's callbacks run
+ * in the order they were posted.
+ *
+ * Wakeups are batched: a push only asks for the consumer to be woken up if no wakeup is already
+ * pending, so a burst of posts results in a single wakeup.
+ */
+class PostQueue : NonCopyable {
+public:
+  static constexpr uint32_t DefaultCapacity = 1024;
+
+  /**
+   * @param capacity supplies the number of cells in the ring, which must be a power of two.
+   */
+  explicit PostQueue(uint32_t capacity = DefaultCapacity);
+  ~PostQueue();
+
+  /**
+   * Add a callback to the queue. May be called from any thread.
+   * @param callback supplies the callback.
+   * @return bool true if the caller must wake the consumer up, which is the case for the first push
+   *         after the consumer started running callbacks.
+   */
+  bool push(PostCb callback);
+
+  /**
+   * Run queued callbacks until the queue is empty, including any callbacks they push. Must only be
+   * called from the consumer thread. If a concurrent push has claimed a cell but not yet filled it,
+   * the remaining callbacks are left for the wakeup that push is about to request.
+   * @return uint64_t the number of callbacks run.
+   */
+  uint64_t runCallbacks();
+
+  /**
+   * @return uint64_t the number of callbacks which did not fit in the ring.
+   */
+  uint64_t overflows() const { return overflows_.load(std::memory_order_relaxed); }
+
+private:
+  struct Cell {
+    std::atomic<uint64_t> sequence_;
+    PostCb callback_;
+  };
+
+  bool tryPushRing(PostCb& callback);
+  bool tryPopRing(PostCb& callback);
+  uint64_t drainRing();
+  // True if a push has claimed a cell which the consumer has not popped yet.
+  bool ringBusy() const { return enqueue_pos_.load(std::memory_order_acquire) != dequeue_pos_; }
+
+  const uint64_t mask_;
+  std::unique_ptr<Cell[]> cells_;
+  std::atomic<uint64_t> enqueue_pos_{0};
+  std::atomic<bool> wakeup_pending_{false};
+  std::atomic<bool> overflowed_{false};
+  // Only accessed by the consumer.
+  uint64_t dequeue_pos_{0};
+  std::atomic<uint64_t> overflows_{0};
+  Thread::MutexBasicLockable overflow_lock_;
+  std::list<PostCb> overflow_ ABSL_GUARDED_BY(overflow_lock_);
+};
+
+} // namespace Event
+} // namespace Envoy
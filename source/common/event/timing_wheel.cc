@@ -0,0 +1,233 @@
+#include "common/event/timing_wheel.h"
+
+#include <algorithm>
+
+#include "common/common/assert.h"
+#include "common/common/scope_tracker.h"
+
+namespace Envoy {
+namespace Event {
+namespace {
+
+// Caps timeouts well within the range of MonotonicTime, so that deadlines cannot overflow.
+constexpr std::chrono::hours MaxTimeout{24 * 365 * 100};
+
+} // namespace
+
+TimingWheel::TimingWheel(Dispatcher& dispatcher, std::chrono::milliseconds granularity)
+    : dispatcher_(dispatcher), granularity_(std::max(granularity, std::chrono::milliseconds(1))),
+      start_(dispatcher.timeSource().monotonicTime()),
+      tick_timer_(dispatcher.createTimer([this]() -> void { onTick(); })) {}
+
+TimingWheel::~TimingWheel() { ASSERT(armed_timers_ == 0); }
+
+TimerPtr TimingWheel::createTimer(TimerCb cb) {
+  ASSERT(cb);
+  return std::make_unique<WheelTimer>(*this, std::move(cb));
+}
+
+uint64_t TimingWheel::currentTick() const {
+  return (dispatcher_.timeSource().monotonicTime() - start_) / granularity_;
+}
+
+TimingWheel::WheelTimer& TimingWheel::Slot::front() {
+  ASSERT(!empty());
+  return static_cast<WheelTimer&>(*head_.next_);
+}
+
+void TimingWheel::Slot::pushBack(WheelTimer& timer) {
+  ListNode& node = timer;
+  node.prev_ = head_.prev_;
+  node.next_ = &head_;
+  head_.prev_->next_ = &node;
+  head_.prev_ = &node;
+}
+
+void TimingWheel::Slot::takeAll(Slot& other) {
+  if (other.empty()) {
+    return;
+  }
+  ListNode* first = other.head_.next_;
+  ListNode* last = other.head_.prev_;
+  first->prev_ = head_.prev_;
+  head_.prev_->next_ = first;
+  last->next_ = &head_;
+  head_.prev_ = last;
+  other.head_.prev_ = other.head_.next_ = &other.head_;
+}
+
+void TimingWheel::Slot::remove(WheelTimer& timer) {
+  ListNode& node = timer;
+  node.prev_->next_ = node.next_;
+  node.next_->prev_ = node.prev_;
+  node.prev_ = node.next_ = nullptr;
+}
+
+void TimingWheel::schedule(WheelTimer& timer, std::chrono::milliseconds ms) {
+  const MonotonicTime::duration elapsed = dispatcher_.timeSource().monotonicTime() - start_;
+  if (timer.enabled()) {
+    unlink(timer);
+  } else {
+    armed_timers_++;
+  }
+
+  // Slots are placed relative to last_tick_. When no slot comes due before now, which is the case
+  // unless the event loop is running late, catch up so that the timer lands in the right slot.
+  const uint64_t now = elapsed / granularity_;
+  if (now < next_wakeup_tick_) {
+    last_tick_ = std::max(last_tick_, now);
+  }
+
+  // Fire on the first tick at or after the deadline, so that a timer never fires early. Waiting
+  // for at least a nanosecond means that the due tick is always after the current one.
+  const MonotonicTime::duration timeout = std::max<MonotonicTime::duration>(
+      std::min<MonotonicTime::duration>(ms, MaxTimeout), std::chrono::nanoseconds(1));
+  timer.due_tick_ = (elapsed + timeout + granularity_ - std::chrono::nanoseconds(1)) / granularity_;
+
+  const uint64_t slot_tick = insert(timer);
+  if (slot_tick < next_wakeup_tick_) {
+    next_wakeup_tick_ = slot_tick;
+    enableTickTimer();
+  }
+}
+
+void TimingWheel::unschedule(WheelTimer& timer) {
+  ASSERT(timer.enabled());
+  unlink(timer);
+  ASSERT(armed_timers_ > 0);
+  if (--armed_timers_ == 0) {
+    tick_timer_->disableTimer();
+    next_wakeup_tick_ = std::numeric_limits<uint64_t>::max();
+  }
+}
+
+uint64_t TimingWheel::insert(WheelTimer& timer) {
+  ASSERT(timer.due_tick_ > last_tick_);
+  // The highest bit in which the due tick differs from last_tick_ picks the level. The timer's
+  // slot on that level is later than last_tick_'s, and both share the same slot on the levels
+  // above.
+  const uint32_t level = (63 - __builtin_clzll(timer.due_tick_ ^ last_tick_)) / LevelBits;
+  const uint32_t shift = level * LevelBits;
+  const uint32_t slot = (timer.due_tick_ >> shift) & (SlotsPerLevel - 1);
+  timer.slot_index_ = level * SlotsPerLevel + slot;
+  slots_[timer.slot_index_].pushBack(timer);
+  occupied_[level] |= uint64_t(1) << slot;
+  return (timer.due_tick_ >> shift) << shift;
+}
+
+void TimingWheel::unlink(WheelTimer& timer) {
+  Slot::remove(timer);
+  // The timer may have been moved to expiring_, in which case its slot has already been emptied
+  // or reused. Either way the bit is accurate once the slot is empty.
+  if (slots_[timer.slot_index_].empty()) {
+    occupied_[timer.slot_index_ / SlotsPerLevel] &=
+        ~(uint64_t(1) << (timer.slot_index_ % SlotsPerLevel));
+  }
+}
+
+void TimingWheel::onTick() {
+  const uint64_t now = currentTick();
+  ASSERT(expiring_.empty());
+  collectDueSlots(now);
+  next_wakeup_tick_ = std::numeric_limits<uint64_t>::max();
+
+  while (!expiring_.empty()) {
+    WheelTimer& timer = expiring_.front();
+    if (timer.due_tick_ > now) {
+      // The timer's slot on a higher level came due; move it down to a lower level.
+      Slot::remove(timer);
+      insert(timer);
+      continue;
+    }
+
+    // Disarm before running the callback, which may re-arm this timer or disable others.
+    unschedule(timer);
+    const ScopeTrackedObject* object = timer.object_;
+    timer.object_ = nullptr;
+    if (object == nullptr) {
+      timer.cb_();
+    } else {
+      ScopeTrackerScopeState scope(object, dispatcher_);
+      timer.cb_();
+    }
+  }
+
+  if (armed_timers_ > 0) {
+    next_wakeup_tick_ = firstOccupiedTick();
+    enableTickTimer();
+  }
+}
+
+void TimingWheel::collectDueSlots(uint64_t now) {
+  for (uint32_t level = 0; level < Levels; level++) {
+    const uint32_t shift = level * LevelBits;
+    const uint64_t from = last_tick_ >> shift;
+    const uint64_t to = now >> shift;
+    if (from == to) {
+      // No slot boundary of this level was crossed, so none of the levels above was either.
+      break;
+    }
+
+    uint64_t due = occupied_[level];
+    if (to - from < SlotsPerLevel) {
+      // The slots after from's up to and including to's, wrapping around the level.
+      const uint64_t span = (uint64_t(1) << (to - from)) - 1;
+      const uint32_t first = (from + 1) % SlotsPerLevel;
+      due &= first == 0 ? span : (span << first) | (span >> (SlotsPerLevel - first));
+    }
+    occupied_[level] &= ~due;
+    while (due != 0) {
+      expiring_.takeAll(slots_[level * SlotsPerLevel + __builtin_ctzll(due)]);
+      due &= due - 1;
+    }
+  }
+  last_tick_ = now;
+}
+
+uint64_t TimingWheel::firstOccupiedTick() const {
+  uint64_t first = std::numeric_limits<uint64_t>::max();
+  for (uint32_t level = 0; level < Levels; level++) {
+    if (occupied_[level] == 0) {
+      continue;
+    }
+    // Occupied slots share last_tick_'s slot on the level above, so the lowest one is the first.
+    const uint32_t shift = level * LevelBits;
+    const uint32_t above = shift + LevelBits;
+    const uint64_t base = above >= 64 ? 0 : (last_tick_ >> above) << above;
+    first = std::min(first, base | (uint64_t(__builtin_ctzll(occupied_[level])) << shift));
+  }
+  return first;
+}
+
+void TimingWheel::enableTickTimer() {
+  // Round up, so that the wheel does not wake up before the slot comes due.
+  const MonotonicTime wakeup = start_ + granularity_ * next_wakeup_tick_;
+  const MonotonicTime::duration until_wakeup = wakeup - dispatcher_.timeSource().monotonicTime();
+  tick_timer_->enableTimer(std::max(std::chrono::duration_cast<std::chrono::milliseconds>(
+                                        until_wakeup + std::chrono::milliseconds(1) -
+                                        std::chrono::nanoseconds(1)),
+                                    std::chrono::milliseconds(0)));
+}
+
+void TimingWheel::WheelTimer::disableTimer() {
+  if (enabled()) {
+    wheel_.unschedule(*this);
+  }
+}
+
+void TimingWheel::WheelTimer::enableTimer(const std::chrono::milliseconds& ms,
+                                          const ScopeTrackedObject* object) {
+  object_ = object;
+  wheel_.schedule(*this, ms);
+}
+
+void TimingWheel::WheelTimer::enableHRTimer(const std::chrono::microseconds& us,
+                                            const ScopeTrackedObject* object) {
+  // Round up, so that the timer never fires early.
+  enableTimer(std::chrono::duration_cast<std::chrono::milliseconds>(
+                  us + std::chrono::milliseconds(1) - std::chrono::microseconds(1)),
+              object);
+}
+
+} // namespace Event
+} // namespace Envoy
@@ -0,0 +1,145 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <limits>
+
+#include "envoy/common/time.h"
+#include "envoy/event/dispatcher.h"
+#include "envoy/event/timer.h"
+
+namespace Envoy {
+namespace Event {
+
+/**
+ * A hierarchical timing wheel for large numbers of timers which are re-armed often and rarely
+ * fire. All timers created by the wheel share a single dispatcher timer, so arming, re-arming and
+ * disarming a timer is O(1), never allocates and usually does not touch libevent.
+ *
+ * Time is divided into ticks of one granularity. The wheel has several levels of 64 slots, and
+ * each slot of a level spans 64 slots of the level below, so that the first level holds the next
+ * 64 ticks and the levels above hold longer timeouts. A timer is placed on the lowest level which
+ * can hold its deadline, and moves down a level each time the slot it is in comes due, until it
+ * fires. The dispatcher timer is only armed for the earliest occupied slot, so an armed wheel does
+ * not wake up the event loop on every tick.
+ *
+ * Timers fire on the first tick at or after their deadline, so a timer may fire up to one
+ * granularity later than requested, and timers which expire in the same tick fire in no particular
+ * order. Timers must not outlive the wheel that created them.
+ */
+class TimingWheel {
+public:
+  /**
+   * @param dispatcher supplies the dispatcher which drives the wheel.
+   * @param granularity supplies the length of a tick, which bounds how late a timer may fire.
+   */
+  TimingWheel(Dispatcher& dispatcher, std::chrono::milliseconds granularity);
+  ~TimingWheel();
+
+  /**
+   * Creates a timer managed by this wheel.
+   * @param cb supplies the callback to invoke when the timer fires.
+   */
+  TimerPtr createTimer(TimerCb cb);
+
+  /**
+   * @return the number of currently armed timers.
+   */
+  uint64_t armedTimers() const { return armed_timers_; }
+
+  /**
+   * @return the length of a tick of the wheel.
+   */
+  std::chrono::milliseconds granularity() const { return granularity_; }
+
+private:
+  class WheelTimer;
+
+  static constexpr uint32_t LevelBits = 6;
+  static constexpr uint32_t SlotsPerLevel = 1 << LevelBits;
+  // Enough levels to hold any 64 bit tick.
+  static constexpr uint32_t Levels = (64 + LevelBits - 1) / LevelBits;
+
+  // A node of an intrusive circular doubly linked list. Timers link themselves into the slots of
+  // the wheel, so that moving a timer between slots is a few pointer updates.
+  struct ListNode {
+    ListNode* prev_{};
+    ListNode* next_{};
+  };
+
+  // A list of timers, headed by a sentinel node.
+  class Slot {
+  public:
+    Slot() { head_.prev_ = head_.next_ = &head_; }
+    Slot(const Slot&) = delete;
+    Slot& operator=(const Slot&) = delete;
+
+    bool empty() const { return head_.next_ == &head_; }
+    WheelTimer& front();
+    void pushBack(WheelTimer& timer);
+    // Moves all the timers of other to the end of this list.
+    void takeAll(Slot& other);
+    static void remove(WheelTimer& timer);
+
+  private:
+    ListNode head_;
+  };
+
+  class WheelTimer : public Timer, public ListNode {
+  public:
+    WheelTimer(TimingWheel& wheel, TimerCb cb) : wheel_(wheel), cb_(std::move(cb)) {}
+    ~WheelTimer() override { disableTimer(); }
+
+    // Timer
+    void disableTimer() override;
+    void enableTimer(const std::chrono::milliseconds& ms,
+                     const ScopeTrackedObject* object) override;
+    void enableHRTimer(const std::chrono::microseconds& us,
+                       const ScopeTrackedObject* object) override;
+    // A timer is linked into a slot exactly when it is armed.
+    bool enabled() override { return next_ != nullptr; }
+
+    TimingWheel& wheel_;
+    const TimerCb cb_;
+    const ScopeTrackedObject* object_{};
+    uint64_t due_tick_{};
+    // The index in slots_ of the slot the timer was last placed in.
+    uint32_t slot_index_{};
+  };
+
+  uint64_t currentTick() const;
+  void schedule(WheelTimer& timer, std::chrono::milliseconds ms);
+  void unschedule(WheelTimer& timer);
+  // Links an unlinked timer into the slot for its due tick, and returns the first tick of the slot.
+  uint64_t insert(WheelTimer& timer);
+  void unlink(WheelTimer& timer);
+  void onTick();
+  // Moves the timers of every slot which comes due by tick now to expiring_.
+  void collectDueSlots(uint64_t now);
+  uint64_t firstOccupiedTick() const;
+  void enableTickTimer();
+
+  Dispatcher& dispatcher_;
+  const std::chrono::milliseconds granularity_;
+  const MonotonicTime start_;
+  // Every occupied slot starts after last_tick_ and within the same slot of the level above as
+  // last_tick_, so the slots of each level which come due as time advances are in order.
+  std::array<Slot, Levels * SlotsPerLevel> slots_;
+  // A bit per slot of each level, set when the slot is occupied.
+  std::array<uint64_t, Levels> occupied_{};
+  // Holds timers which are being expired, so that callbacks can safely disable other timers from
+  // the same slot.
+  Slot expiring_;
+  TimerPtr tick_timer_;
+  // The last tick for which due slots were collected.
+  uint64_t last_tick_{};
+  // No occupied slot starts before this tick.
+  uint64_t next_wakeup_tick_{std::numeric_limits<uint64_t>::max()};
+  uint64_t armed_timers_{};
+};
+
+using TimingWheelPtr = std::unique_ptr<TimingWheel>;
+
+} // namespace Event
+} // namespace Envoy
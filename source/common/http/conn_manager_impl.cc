@@ -38,7 +38,6 @@
 #include "common/network/utility.h"
 #include "common/router/config_impl.h"
 #include "common/runtime/runtime_impl.h"
-#include "common/stats/timespan_impl.h"
 
 #include "absl/strings/escaping.h"
 #include "absl/strings/match.h"
@@ -49,7 +48,7 @@ namespace Http {
 
 namespace {
 
-template <class T> using FilterList = std::list<std::unique_ptr<T>>;
+template <class T> using FilterList = typename T::ListType;
 
 // Shared helper for recording the latest filter used.
 template <class T>
@@ -266,7 +265,7 @@ RequestDecoder& ConnectionManagerImpl::newStream(ResponseEncoder& response_encod
   }
 
   ENVOY_CONN_LOG(debug, "new stream", read_callbacks_->connection());
-  ActiveStreamPtr new_stream(new ActiveStream(*this));
+  ActiveStreamPtr new_stream(activeStreamPool().create(*this));
   new_stream->state_.is_internally_created_ = is_internally_created;
   new_stream->response_encoder_ = &response_encoder;
   new_stream->response_encoder_->getStream().addCallbacks(*new_stream);
@@ -540,11 +539,10 @@ void ConnectionManagerImpl::RdsRouteConfigUpdateRequester::requestRouteConfigUpd
 ConnectionManagerImpl::ActiveStream::ActiveStream(ConnectionManagerImpl& connection_manager)
     : connection_manager_(connection_manager),
       stream_id_(connection_manager.random_generator_.random()),
-      request_response_timespan_(new Stats::HistogramCompletableTimespanImpl(
-          connection_manager_.stats_.named_.downstream_rq_time_, connection_manager_.timeSource())),
+      request_response_timespan_(connection_manager_.stats_.named_.downstream_rq_time_,
+                                 connection_manager_.timeSource()),
       stream_info_(connection_manager_.codec_->protocol(), connection_manager_.timeSource(),
-                   connection_manager.filterState()),
-      upstream_options_(std::make_shared<Network::Socket::Options>()) {
+                   connection_manager.filterState()) {
   ASSERT(!connection_manager.config_.isRoutable() ||
              ((connection_manager.config_.routeConfigProvider() == nullptr &&
                connection_manager.config_.scopedRouteConfigProvider() != nullptr) ||
@@ -555,16 +553,6 @@ ConnectionManagerImpl::ActiveStream::ActiveStream(ConnectionManagerImpl& connect
 
   stream_info_.setRequestIDExtension(connection_manager.config_.requestIDExtension());
 
-  if (connection_manager_.config_.isRoutable() &&
-      connection_manager.config_.routeConfigProvider() != nullptr) {
-    route_config_update_requester_ =
-        std::make_unique<ConnectionManagerImpl::RdsRouteConfigUpdateRequester>(
-            connection_manager.config_.routeConfigProvider());
-  } else if (connection_manager_.config_.isRoutable() &&
-             connection_manager.config_.scopedRouteConfigProvider() != nullptr) {
-    route_config_update_requester_ =
-        std::make_unique<ConnectionManagerImpl::NullRouteConfigUpdateRequester>();
-  }
   ScopeTrackerScopeState scope(this,
                                connection_manager_.read_callbacks_->connection().dispatcher());
 
@@ -592,8 +580,11 @@ ConnectionManagerImpl::ActiveStream::ActiveStream(ConnectionManagerImpl& connect
 
   if (connection_manager_.config_.streamIdleTimeout().count()) {
     idle_timeout_ms_ = connection_manager_.config_.streamIdleTimeout();
-    stream_idle_timer_ = connection_manager_.read_callbacks_->connection().dispatcher().createTimer(
-        [this]() -> void { onIdleTimeout(); });
+    // The idle timer is re-armed on every bit of stream activity and rarely fires, so it lives on
+    // the dispatcher's coarse timer wheel rather than in libevent's timer heap.
+    stream_idle_timer_ =
+        connection_manager_.read_callbacks_->connection().dispatcher().createCoarseTimer(
+            [this]() -> void { onIdleTimeout(); });
     resetIdleTimer();
   }
 
@@ -652,6 +643,13 @@ ConnectionManagerImpl::ActiveStream::~ActiveStream() {
   ASSERT(state_.filter_call_state_ == 0);
 }
 
+bool ConnectionManagerImpl::ActiveStream::recycle() { return activeStreamPool().recycle(this); }
+
+Event::ObjectPool<ConnectionManagerImpl::ActiveStream>& ConnectionManagerImpl::activeStreamPool() {
+  static thread_local Event::ObjectPool<ActiveStream> pool;
+  return pool;
+}
+
 void ConnectionManagerImpl::ActiveStream::resetIdleTimer() {
   if (stream_idle_timer_ != nullptr) {
     // TODO(htuch): If this shows up in performance profiles, optimize by only
@@ -691,6 +689,36 @@ void ConnectionManagerImpl::ActiveStream::onStreamMaxDurationReached() {
   connection_manager_.doEndStream(*this);
 }
 
+void* ConnectionManagerImpl::ActiveStreamDecoderFilter::operator new(size_t size) {
+  ASSERT(size == sizeof(ActiveStreamDecoderFilter));
+  return pool().allocate();
+}
+
+void ConnectionManagerImpl::ActiveStreamDecoderFilter::operator delete(void* storage) {
+  pool().deallocate(storage);
+}
+
+Event::ObjectPool<ConnectionManagerImpl::ActiveStreamDecoderFilter>&
+ConnectionManagerImpl::ActiveStreamDecoderFilter::pool() {
+  static thread_local Event::ObjectPool<ActiveStreamDecoderFilter> pool;
+  return pool;
+}
+
+void* ConnectionManagerImpl::ActiveStreamEncoderFilter::operator new(size_t size) {
+  ASSERT(size == sizeof(ActiveStreamEncoderFilter));
+  return pool().allocate();
+}
+
+void ConnectionManagerImpl::ActiveStreamEncoderFilter::operator delete(void* storage) {
+  pool().deallocate(storage);
+}
+
+Event::ObjectPool<ConnectionManagerImpl::ActiveStreamEncoderFilter>&
+ConnectionManagerImpl::ActiveStreamEncoderFilter::pool() {
+  static thread_local Event::ObjectPool<ActiveStreamEncoderFilter> pool;
+  return pool;
+}
+
 void ConnectionManagerImpl::ActiveStream::addStreamDecoderFilterWorker(
     StreamDecoderFilterSharedPtr filter, bool dual_filter) {
   ActiveStreamDecoderFilterPtr wrapper(new ActiveStreamDecoderFilter(*this, filter, dual_filter));
@@ -1038,9 +1066,9 @@ void ConnectionManagerImpl::ActiveStream::decodeHeaders(ActiveStreamDecoderFilte
                                                         RequestHeaderMap& headers,
                                                         bool end_stream) {
   // Headers filter iteration should always start with the next filter if available.
-  std::list<ActiveStreamDecoderFilterPtr>::iterator entry =
+  ActiveStreamDecoderFilterList::iterator entry =
       commonDecodePrefix(filter, FilterIterationStartState::AlwaysStartFromNext);
-  std::list<ActiveStreamDecoderFilterPtr>::iterator continue_data_entry = decoder_filters_.end();
+  ActiveStreamDecoderFilterList::iterator continue_data_entry = decoder_filters_.end();
 
   for (; entry != decoder_filters_.end(); entry++) {
     ASSERT(!(state_.filter_call_state_ & FilterCallState::DecodeHeaders));
@@ -1128,7 +1156,7 @@ void ConnectionManagerImpl::ActiveStream::decodeData(
   auto trailers_added_entry = decoder_filters_.end();
   const bool trailers_exists_at_start = request_trailers_ != nullptr;
   // Filter iteration may start at the current filter.
-  std::list<ActiveStreamDecoderFilterPtr>::iterator entry =
+  ActiveStreamDecoderFilterList::iterator entry =
       commonDecodePrefix(filter, filter_iteration_start_state);
 
   for (; entry != decoder_filters_.end(); entry++) {
@@ -1279,7 +1307,7 @@ void ConnectionManagerImpl::ActiveStream::decodeTrailers(ActiveStreamDecoderFilt
   }
 
   // Filter iteration may start at the current filter.
-  std::list<ActiveStreamDecoderFilterPtr>::iterator entry =
+  ActiveStreamDecoderFilterList::iterator entry =
       commonDecodePrefix(filter, FilterIterationStartState::CanStartFromCurrent);
 
   for (; entry != decoder_filters_.end(); entry++) {
@@ -1317,7 +1345,7 @@ void ConnectionManagerImpl::ActiveStream::decodeMetadata(MetadataMapPtr&& metada
 void ConnectionManagerImpl::ActiveStream::decodeMetadata(ActiveStreamDecoderFilter* filter,
                                                          MetadataMap& metadata_map) {
   // Filter iteration may start at the current filter.
-  std::list<ActiveStreamDecoderFilterPtr>::iterator entry =
+  ActiveStreamDecoderFilterList::iterator entry =
       commonDecodePrefix(filter, FilterIterationStartState::CanStartFromCurrent);
 
   for (; entry != decoder_filters_.end(); entry++) {
@@ -1353,7 +1381,7 @@ void ConnectionManagerImpl::ActiveStream::disarmRequestTimeout() {
   }
 }
 
-std::list<ConnectionManagerImpl::ActiveStreamEncoderFilterPtr>::iterator
+ConnectionManagerImpl::ActiveStreamEncoderFilterList::iterator
 ConnectionManagerImpl::ActiveStream::commonEncodePrefix(
     ActiveStreamEncoderFilter* filter, bool end_stream,
     FilterIterationStartState filter_iteration_start_state) {
@@ -1374,7 +1402,7 @@ ConnectionManagerImpl::ActiveStream::commonEncodePrefix(
   return std::next(filter->entry());
 }
 
-std::list<ConnectionManagerImpl::ActiveStreamDecoderFilterPtr>::iterator
+ConnectionManagerImpl::ActiveStreamDecoderFilterList::iterator
 ConnectionManagerImpl::ActiveStream::commonDecodePrefix(
     ActiveStreamDecoderFilter* filter, FilterIterationStartState filter_iteration_start_state) {
   if (!filter) {
@@ -1469,6 +1497,17 @@ void ConnectionManagerImpl::ActiveStream::requestRouteConfigUpdate(
   ASSERT(!request_headers_->Host()->value().empty());
   const auto& host_header =
       absl::AsciiStrToLower(request_headers_->Host()->value().getStringView());
+  if (route_config_update_requester_ == nullptr) {
+    if (connection_manager_.config_.isRoutable() &&
+        connection_manager_.config_.routeConfigProvider() != nullptr) {
+      route_config_update_requester_ =
+          std::make_unique<ConnectionManagerImpl::RdsRouteConfigUpdateRequester>(
+              connection_manager_.config_.routeConfigProvider());
+    } else {
+      route_config_update_requester_ =
+          std::make_unique<ConnectionManagerImpl::NullRouteConfigUpdateRequester>();
+    }
+  }
   route_config_update_requester_->requestRouteConfigUpdate(host_header, thread_local_dispatcher,
                                                            std::move(route_config_updated_cb));
 }
@@ -1524,7 +1563,7 @@ void ConnectionManagerImpl::ActiveStream::encode100ContinueHeaders(
   // end-stream, and because there are normal headers coming there's no need for
   // complex continuation logic.
   // 100-continue filter iteration should always start with the next filter if available.
-  std::list<ActiveStreamEncoderFilterPtr>::iterator entry =
+  ActiveStreamEncoderFilterList::iterator entry =
       commonEncodePrefix(filter, false, FilterIterationStartState::AlwaysStartFromNext);
   for (; entry != encoder_filters_.end(); entry++) {
     ASSERT(!(state_.filter_call_state_ & FilterCallState::Encode100ContinueHeaders));
@@ -1559,9 +1598,9 @@ void ConnectionManagerImpl::ActiveStream::encodeHeaders(ActiveStreamEncoderFilte
   disarmRequestTimeout();
 
   // Headers filter iteration should always start with the next filter if available.
-  std::list<ActiveStreamEncoderFilterPtr>::iterator entry =
+  ActiveStreamEncoderFilterList::iterator entry =
       commonEncodePrefix(filter, end_stream, FilterIterationStartState::AlwaysStartFromNext);
-  std::list<ActiveStreamEncoderFilterPtr>::iterator continue_data_entry = encoder_filters_.end();
+  ActiveStreamEncoderFilterList::iterator continue_data_entry = encoder_filters_.end();
 
   for (; entry != encoder_filters_.end(); entry++) {
     ASSERT(!(state_.filter_call_state_ & FilterCallState::EncodeHeaders));
@@ -1727,7 +1766,7 @@ void ConnectionManagerImpl::ActiveStream::encodeMetadata(ActiveStreamEncoderFilt
                                                          MetadataMapPtr&& metadata_map_ptr) {
   resetIdleTimer();
 
-  std::list<ActiveStreamEncoderFilterPtr>::iterator entry =
+  ActiveStreamEncoderFilterList::iterator entry =
       commonEncodePrefix(filter, false, FilterIterationStartState::CanStartFromCurrent);
 
   for (; entry != encoder_filters_.end(); entry++) {
@@ -1799,7 +1838,7 @@ void ConnectionManagerImpl::ActiveStream::encodeData(
   }
 
   // Filter iteration may start at the current filter.
-  std::list<ActiveStreamEncoderFilterPtr>::iterator entry =
+  ActiveStreamEncoderFilterList::iterator entry =
       commonEncodePrefix(filter, end_stream, filter_iteration_start_state);
   auto trailers_added_entry = encoder_filters_.end();
 
@@ -1879,7 +1918,7 @@ void ConnectionManagerImpl::ActiveStream::encodeTrailers(ActiveStreamEncoderFilt
   }
 
   // Filter iteration may start at the current filter.
-  std::list<ActiveStreamEncoderFilterPtr>::iterator entry =
+  ActiveStreamEncoderFilterList::iterator entry =
       commonEncodePrefix(filter, true, FilterIterationStartState::CanStartFromCurrent);
   for (; entry != encoder_filters_.end(); entry++) {
     // If the filter pointed by entry has stopped for all frame type, return now.
@@ -1910,7 +1949,7 @@ void ConnectionManagerImpl::ActiveStream::maybeEndEncode(bool end_stream) {
     ASSERT(!state_.codec_saw_local_complete_);
     state_.codec_saw_local_complete_ = true;
     stream_info_.onLastDownstreamTxByteSent();
-    request_response_timespan_->complete();
+    request_response_timespan_.complete();
     connection_manager_.doEndStream(*this);
   }
 }
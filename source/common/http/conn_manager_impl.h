@@ -32,10 +32,12 @@
 #include "common/buffer/watermark_buffer.h"
 #include "common/common/dump_state_utils.h"
 #include "common/common/linked_object.h"
+#include "common/event/object_pool.h"
 #include "common/grpc/common.h"
 #include "common/http/conn_manager_config.h"
 #include "common/http/user_agent.h"
 #include "common/http/utility.h"
+#include "common/stats/timespan_impl.h"
 #include "common/stream_info/stream_info_impl.h"
 #include "common/tracing/http_tracer_impl.h"
 
@@ -217,15 +219,22 @@ private:
   };
 
   /**
-   * Wrapper for a stream decoder filter.
+   * Wrapper for a stream decoder filter. Wrappers are created for every filter of every stream, so
+   * their storage and list nodes come from per-thread pools.
    */
-  struct ActiveStreamDecoderFilter : public ActiveStreamFilterBase,
-                                     public StreamDecoderFilterCallbacks,
-                                     LinkedObject<ActiveStreamDecoderFilter> {
+  struct ActiveStreamDecoderFilter final
+      : public ActiveStreamFilterBase,
+        public StreamDecoderFilterCallbacks,
+        LinkedObject<ActiveStreamDecoderFilter,
+                     Event::ObjectPoolAllocator<std::unique_ptr<ActiveStreamDecoderFilter>>> {
     ActiveStreamDecoderFilter(ActiveStream& parent, StreamDecoderFilterSharedPtr filter,
                               bool dual_filter)
         : ActiveStreamFilterBase(parent, dual_filter), handle_(filter) {}
 
+    static void* operator new(size_t size);
+    static void operator delete(void* storage);
+    static Event::ObjectPool<ActiveStreamDecoderFilter>& pool();
+
     // ActiveStreamFilterBase
     bool canContinue() override {
       // It is possible for the connection manager to respond directly to a request even while
@@ -304,6 +313,10 @@ private:
     bool recreateStream() override;
 
     void addUpstreamSocketOptions(const Network::Socket::OptionsSharedPtr& options) override {
+      // Most streams never set upstream socket options, so the storage is created on demand.
+      if (parent_.upstream_options_ == nullptr) {
+        parent_.upstream_options_ = std::make_shared<Network::Socket::Options>();
+      }
       Network::Socket::appendOptions(parent_.upstream_options_, options);
     }
 
@@ -335,17 +348,24 @@ private:
   };
 
   using ActiveStreamDecoderFilterPtr = std::unique_ptr<ActiveStreamDecoderFilter>;
+  using ActiveStreamDecoderFilterList = ActiveStreamDecoderFilter::ListType;
 
   /**
-   * Wrapper for a stream encoder filter.
+   * Wrapper for a stream encoder filter, pooled like ActiveStreamDecoderFilter.
    */
-  struct ActiveStreamEncoderFilter : public ActiveStreamFilterBase,
-                                     public StreamEncoderFilterCallbacks,
-                                     LinkedObject<ActiveStreamEncoderFilter> {
+  struct ActiveStreamEncoderFilter final
+      : public ActiveStreamFilterBase,
+        public StreamEncoderFilterCallbacks,
+        LinkedObject<ActiveStreamEncoderFilter,
+                     Event::ObjectPoolAllocator<std::unique_ptr<ActiveStreamEncoderFilter>>> {
     ActiveStreamEncoderFilter(ActiveStream& parent, StreamEncoderFilterSharedPtr filter,
                               bool dual_filter)
         : ActiveStreamFilterBase(parent, dual_filter), handle_(filter) {}
 
+    static void* operator new(size_t size);
+    static void operator delete(void* storage);
+    static Event::ObjectPool<ActiveStreamEncoderFilter>& pool();
+
     // ActiveStreamFilterBase
     bool canContinue() override { return true; }
     Buffer::WatermarkBufferPtr createBuffer() override;
@@ -411,6 +431,7 @@ private:
   };
 
   using ActiveStreamEncoderFilterPtr = std::unique_ptr<ActiveStreamEncoderFilter>;
+  using ActiveStreamEncoderFilterList = ActiveStreamEncoderFilter::ListType;
 
   // Used to abstract making of RouteConfig update request.
   // RdsRouteConfigUpdateRequester is used when an RdsRouteConfigProvider is configured,
@@ -463,11 +484,11 @@ private:
     void addStreamEncoderFilterWorker(StreamEncoderFilterSharedPtr filter, bool dual_filter);
     void chargeStats(const ResponseHeaderMap& headers);
     // Returns the encoder filter to start iteration with.
-    std::list<ActiveStreamEncoderFilterPtr>::iterator
+    ActiveStreamEncoderFilterList::iterator
     commonEncodePrefix(ActiveStreamEncoderFilter* filter, bool end_stream,
                        FilterIterationStartState filter_iteration_start_state);
     // Returns the decoder filter to start iteration with.
-    std::list<ActiveStreamDecoderFilterPtr>::iterator
+    ActiveStreamDecoderFilterList::iterator
     commonDecodePrefix(ActiveStreamDecoderFilter* filter,
                        FilterIterationStartState filter_iteration_start_state);
     const Network::Connection* connection();
@@ -524,6 +545,9 @@ private:
     bool handleDataIfStopAll(ActiveStreamFilterBase& filter, Buffer::Instance& data,
                              bool& filter_streaming);
 
+    // Event::DeferredDeletable
+    bool recycle() override;
+
     // Http::StreamCallbacks
     void onResetStream(StreamResetReason reason,
                        absl::string_view transport_failure_reason) override;
@@ -540,10 +564,10 @@ private:
 
     // Http::FilterChainFactoryCallbacks
     void addStreamDecoderFilter(StreamDecoderFilterSharedPtr filter) override {
-      addStreamDecoderFilterWorker(filter, false);
+      addStreamDecoderFilterWorker(std::move(filter), false);
     }
     void addStreamEncoderFilter(StreamEncoderFilterSharedPtr filter) override {
-      addStreamEncoderFilterWorker(filter, false);
+      addStreamEncoderFilterWorker(std::move(filter), false);
     }
     void addStreamFilter(StreamFilterSharedPtr filter) override {
       addStreamDecoderFilterWorker(filter, true);
@@ -705,10 +729,10 @@ private:
     RequestHeaderMapPtr request_headers_;
     Buffer::WatermarkBufferPtr buffered_request_data_;
     RequestTrailerMapPtr request_trailers_;
-    std::list<ActiveStreamDecoderFilterPtr> decoder_filters_;
-    std::list<ActiveStreamEncoderFilterPtr> encoder_filters_;
+    ActiveStreamDecoderFilterList decoder_filters_;
+    ActiveStreamEncoderFilterList encoder_filters_;
     std::list<AccessLog::InstanceSharedPtr> access_log_handlers_;
-    Stats::TimespanPtr request_response_timespan_;
+    Stats::HistogramCompletableTimespanImpl request_response_timespan_;
     // Per-stream idle timeout.
     Event::TimerPtr stream_idle_timer_;
     // Per-stream request timeout.
@@ -728,13 +752,19 @@ private:
     uint32_t buffer_limit_{0};
     uint32_t high_watermark_count_{0};
     const std::string* decorated_operation_{nullptr};
+    // Created on demand by addUpstreamSocketOptions().
     Network::Socket::OptionsSharedPtr upstream_options_;
+    // Created on demand by requestRouteConfigUpdate().
     std::unique_ptr<RouteConfigUpdateRequester> route_config_update_requester_;
     std::unique_ptr<Tracing::CustomTagMap> tracing_custom_tags_{nullptr};
   };
 
   using ActiveStreamPtr = std::unique_ptr<ActiveStream>;
 
+  // Streams are created and destroyed at request rate, so each thread keeps the storage of recently
+  // destroyed streams for the next ones.
+  static Event::ObjectPool<ActiveStream>& activeStreamPool();
+
   /**
    * Check to see if the connection can be closed after gracefully waiting to send pending codec
    * data.
@@ -1,5 +1,7 @@
 #include "common/http/conn_pool_base.h"
 
+#include <cmath>
+
 #include "common/stats/timespan_impl.h"
 #include "common/upstream/upstream_impl.h"
 
@@ -18,6 +20,8 @@ ConnPoolImplBase::~ConnPoolImplBase() {
 }
 
 void ConnPoolImplBase::destructAllConnections() {
+  // Closing clients below must not trigger speculative replacements.
+  destructing_ = true;
   for (auto* list : {&ready_clients_, &busy_clients_}) {
     while (!list->empty()) {
       list->front()->close();
@@ -44,20 +48,82 @@ void ConnPoolImplBase::tryCreateNewConnection() {
   // too many open connections, and this upstream has no connections, always create one, to
   // prevent pending requests being queued to this upstream with no way to be processed.
   if (can_create_connection || (ready_clients_.empty() && busy_clients_.empty())) {
-    ENVOY_LOG(debug, "creating a new connection");
-    ActiveClientPtr client = instantiateActiveClient();
-    ASSERT(client->state_ == ActiveClient::State::CONNECTING);
-    ASSERT(std::numeric_limits<uint64_t>::max() - connecting_request_capacity_ >=
-           client->effectiveConcurrentRequestLimit());
-    connecting_request_capacity_ += client->effectiveConcurrentRequestLimit();
-    client->moveIntoList(std::move(client), owningList(client->state_));
+    createNewConnection(false);
+  }
+}
+
+void ConnPoolImplBase::tryCreateNewConnections() {
+  tryCreateNewConnection();
+
+  // Cap the number of speculative connections made per call. The ratio is bounded to 3.0, so in
+  // steady state no more than a few connections are needed, and a burst of new connections to a
+  // host which just became healthy again is not desirable.
+  static constexpr uint32_t MaxPreconnectsPerCall = 3;
+  for (uint32_t i = 0; i < MaxPreconnectsPerCall && shouldPreconnect(); ++i) {
+    // Unlike connections for queued requests, speculative connections never bypass the
+    // connection circuit breaker.
+    if (!host_->cluster().resourceManager(priority_).connections().canCreate()) {
+      return;
+    }
+    createNewConnection(true);
   }
 }
 
+bool ConnPoolImplBase::shouldPreconnect() const {
+  const float preconnect_ratio = host_->cluster().perUpstreamPreconnectRatio();
+  // Don't make unhealthy hosts do extra work, especially as upstream selection logic may bypass
+  // them entirely.
+  if (preconnect_ratio <= 1.0 || host_->health() != Upstream::Host::Health::Healthy) {
+    return false;
+  }
+
+  // A draining or destructing pool should not grow.
+  if (destructing_ || !drained_callbacks_.empty()) {
+    return false;
+  }
+
+  // Queued requests which are not covered by connecting clients are handled by
+  // tryCreateNewConnection().
+  if (pending_requests_.size() > connecting_request_capacity_) {
+    return false;
+  }
+
+  const uint64_t anticipated_requests = static_cast<uint64_t>(
+      std::ceil((pending_requests_.size() + num_active_requests_) * preconnect_ratio));
+  uint64_t capacity = connecting_request_capacity_ + num_active_requests_;
+  for (const ActiveClientPtr& client : ready_clients_) {
+    if (capacity >= anticipated_requests) {
+      return false;
+    }
+    const uint64_t limit = client->effectiveConcurrentRequestLimit();
+    const uint64_t active = client->codec_client_->numActiveRequests();
+    if (limit > active) {
+      capacity += limit - active;
+    }
+  }
+  return anticipated_requests > capacity;
+}
+
+void ConnPoolImplBase::createNewConnection(bool preconnect) {
+  ENVOY_LOG(debug, "creating a new connection{}", preconnect ? " (preconnect)" : "");
+  ActiveClientPtr client = instantiateActiveClient();
+  ASSERT(client->state_ == ActiveClient::State::CONNECTING);
+  ASSERT(std::numeric_limits<uint64_t>::max() - connecting_request_capacity_ >=
+         client->effectiveConcurrentRequestLimit());
+  connecting_request_capacity_ += client->effectiveConcurrentRequestLimit();
+  if (preconnect) {
+    client->preconnected_ = true;
+    host_->cluster().stats().upstream_cx_preconnect_total_.inc();
+  }
+  client->moveIntoList(std::move(client), owningList(client->state_));
+}
+
 void ConnPoolImplBase::attachRequestToClient(ActiveClient& client,
                                              ResponseDecoder& response_decoder,
                                              ConnectionPool::Callbacks& callbacks) {
-  ASSERT(client.state_ == ActiveClient::State::READY);
+  // Connections which pipeline requests may be attached to while BUSY.
+  ASSERT(client.state_ == ActiveClient::State::READY ||
+         client.state_ == ActiveClient::State::BUSY);
 
   if (!host_->cluster().resourceManager(priority_).requests().canCreate()) {
     ENVOY_LOG(debug, "max requests overflow");
@@ -66,6 +132,10 @@ void ConnPoolImplBase::attachRequestToClient(ActiveClient& client,
     host_->cluster().stats().upstream_rq_pending_overflow_.inc();
   } else {
     ENVOY_CONN_LOG(debug, "creating stream", *client.codec_client_);
+    if (client.preconnected_) {
+      client.preconnected_ = false;
+      host_->cluster().stats().upstream_cx_preconnect_used_.inc();
+    }
     RequestEncoder& new_encoder = client.newStreamEncoder(response_decoder);
 
     client.remaining_requests_--;
@@ -73,7 +143,8 @@ void ConnPoolImplBase::attachRequestToClient(ActiveClient& client,
       ENVOY_CONN_LOG(debug, "maximum requests per connection, DRAINING", *client.codec_client_);
       host_->cluster().stats().upstream_cx_max_requests_.inc();
       transitionActiveClientState(client, ActiveClient::State::DRAINING);
-    } else if (client.codec_client_->numActiveRequests() >= client.concurrent_request_limit_) {
+    } else if (client.state_ == ActiveClient::State::READY &&
+               client.codec_client_->numActiveRequests() >= client.concurrent_request_limit_) {
       transitionActiveClientState(client, ActiveClient::State::BUSY);
     }
 
@@ -100,10 +171,10 @@ void ConnPoolImplBase::onRequestClosed(ActiveClient& client, bool delay_attachin
       client.codec_client_->numActiveRequests() == 0) {
     // Close out the draining client if we no longer have active requests.
     client.codec_client_->close();
-  } else if (client.state_ == ActiveClient::State::BUSY) {
-    // A request was just ended, so we should be below the limit now.
-    ASSERT(client.codec_client_->numActiveRequests() < client.concurrent_request_limit_);
-
+  } else if (client.state_ == ActiveClient::State::BUSY &&
+             client.codec_client_->numActiveRequests() < client.concurrent_request_limit_) {
+    // A request was just ended, so we are below the limit now unless further requests were
+    // pipelined on the connection.
     transitionActiveClientState(client, ActiveClient::State::READY);
     if (!delay_attaching_request) {
       onUpstreamReady();
@@ -117,6 +188,8 @@ ConnectionPool::Cancellable* ConnPoolImplBase::newStream(ResponseDecoder& respon
     ActiveClient& client = *ready_clients_.front();
     ENVOY_CONN_LOG(debug, "using existing connection", *client.codec_client_);
     attachRequestToClient(client, response_decoder, callbacks);
+    // Consuming ready capacity may require another speculative connection.
+    tryCreateNewConnections();
     return nullptr;
   }
 
@@ -125,7 +198,7 @@ ConnectionPool::Cancellable* ConnPoolImplBase::newStream(ResponseDecoder& respon
 
     // This must come after newPendingRequest() because this function uses the
     // length of pending_requests_ to determine if a new connection is needed.
-    tryCreateNewConnection();
+    tryCreateNewConnections();
 
     return pending;
   } else {
@@ -265,6 +338,9 @@ void ConnPoolImplBase::onConnectionEvent(ConnPoolImplBase::ActiveClient& client,
                    client.codec_client_->connectionFailureReason());
 
     Envoy::Upstream::reportUpstreamCxDestroy(host_, event);
+    if (client.preconnected_) {
+      host_->cluster().stats().upstream_cx_preconnect_unused_.inc();
+    }
     const bool incomplete_request = client.closingWithIncompleteRequest();
     if (incomplete_request) {
       Envoy::Upstream::reportUpstreamCxDestroyActiveRequest(host_, event);
@@ -306,10 +382,9 @@ void ConnPoolImplBase::onConnectionEvent(ConnPoolImplBase::ActiveClient& client,
 
     client.state_ = ActiveClient::State::CLOSED;
 
-    // If we have pending requests and we just lost a connection we should make a new one.
-    if (!pending_requests_.empty()) {
-      tryCreateNewConnection();
-    }
+    // If we have pending requests and we just lost a connection we should make a new one. This
+    // also replaces lost spare capacity if preconnecting is enabled.
+    tryCreateNewConnections();
   } else if (event == Network::ConnectionEvent::Connected) {
     client.conn_connect_ms_->complete();
     client.conn_connect_ms_.reset();
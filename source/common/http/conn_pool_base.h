@@ -90,6 +90,8 @@ protected:
     Event::TimerPtr connect_timer_;
     bool resources_released_{false};
     bool timed_out_{false};
+    // True if this connection was established speculatively and has not yet served a request.
+    bool preconnected_{false};
   };
 
   using ActiveClientPtr = std::unique_ptr<ActiveClient>;
@@ -149,6 +151,17 @@ protected:
   // starving this pool.
   void tryCreateNewConnection();
 
+  // Creates a connection for any queued requests via tryCreateNewConnection(), then tops up
+  // speculative connections as dictated by the cluster's preconnect ratio.
+  void tryCreateNewConnections();
+
+  // Returns true if the anticipated demand on this pool, as scaled by the cluster's preconnect
+  // ratio, exceeds the capacity of all connecting and connected clients.
+  bool shouldPreconnect() const;
+
+  // Instantiates a new client and accounts for its capacity while it is connecting.
+  void createNewConnection(bool preconnect);
+
 public:
   const Upstream::HostConstSharedPtr host_;
   const Upstream::ResourcePriority priority_;
@@ -179,6 +192,9 @@ protected:
   // The number of requests that can be immediately dispatched
   // if all CONNECTING connections become connected.
   uint64_t connecting_request_capacity_{0};
+
+  // Set once destructAllConnections() starts closing clients.
+  bool destructing_{false};
 };
 } // namespace Http
 } // namespace Envoy
@@ -10,6 +10,7 @@
 
 #include "common/common/non_copyable.h"
 #include "common/common/utility.h"
+#include "common/event/object_pool.h"
 #include "common/http/headers.h"
 
 namespace Envoy {
@@ -93,6 +94,11 @@ public:
   void dumpState(std::ostream& os, int indent_level = 0) const override;
 
 protected:
+  struct HeaderEntryImpl;
+  // Header entries are created and destroyed at request rate, so each thread keeps the list nodes
+  // of recently destroyed entries for the next ones.
+  using HeaderEntryList = std::list<HeaderEntryImpl, Event::ObjectPoolAllocator<HeaderEntryImpl>>;
+
   struct HeaderEntryImpl : public HeaderEntry, NonCopyable {
     HeaderEntryImpl(const LowerCaseString& key);
     HeaderEntryImpl(const LowerCaseString& key, HeaderString&& value);
@@ -108,7 +114,7 @@ protected:
 
     HeaderString key_;
     HeaderString value_;
-    std::list<HeaderEntryImpl>::iterator entry_;
+    HeaderEntryList::iterator entry_;
   };
 
   /**
@@ -159,9 +165,9 @@ protected:
     }
 
     template <class Key, class... Value>
-    std::list<HeaderEntryImpl>::iterator insert(Key&& key, Value&&... value) {
+    HeaderEntryList::iterator insert(Key&& key, Value&&... value) {
       const bool is_pseudo_header = isPseudoHeader(key);
-      std::list<HeaderEntryImpl>::iterator i =
+      HeaderEntryList::iterator i =
           headers_.emplace(is_pseudo_header ? pseudo_headers_end_ : headers_.end(),
                            std::forward<Key>(key), std::forward<Value>(value)...);
       if (!is_pseudo_header && pseudo_headers_end_ == headers_.end()) {
@@ -170,7 +176,7 @@ protected:
       return i;
     }
 
-    std::list<HeaderEntryImpl>::iterator erase(std::list<HeaderEntryImpl>::iterator i) {
+    HeaderEntryList::iterator erase(HeaderEntryList::iterator i) {
       if (pseudo_headers_end_ == i) {
         pseudo_headers_end_++;
       }
@@ -189,12 +195,12 @@ protected:
       });
     }
 
-    std::list<HeaderEntryImpl>::iterator begin() { return headers_.begin(); }
-    std::list<HeaderEntryImpl>::iterator end() { return headers_.end(); }
-    std::list<HeaderEntryImpl>::const_iterator begin() const { return headers_.begin(); }
-    std::list<HeaderEntryImpl>::const_iterator end() const { return headers_.end(); }
-    std::list<HeaderEntryImpl>::const_reverse_iterator rbegin() const { return headers_.rbegin(); }
-    std::list<HeaderEntryImpl>::const_reverse_iterator rend() const { return headers_.rend(); }
+    HeaderEntryList::iterator begin() { return headers_.begin(); }
+    HeaderEntryList::iterator end() { return headers_.end(); }
+    HeaderEntryList::const_iterator begin() const { return headers_.begin(); }
+    HeaderEntryList::const_iterator end() const { return headers_.end(); }
+    HeaderEntryList::const_reverse_iterator rbegin() const { return headers_.rbegin(); }
+    HeaderEntryList::const_reverse_iterator rend() const { return headers_.rend(); }
     size_t size() const { return headers_.size(); }
     bool empty() const { return headers_.empty(); }
     void clear() {
@@ -203,8 +209,8 @@ protected:
     }
 
   private:
-    std::list<HeaderEntryImpl> headers_;
-    std::list<HeaderEntryImpl>::iterator pseudo_headers_end_;
+    HeaderEntryList headers_;
+    HeaderEntryList::iterator pseudo_headers_end_;
   };
 
   void insertByKey(HeaderString&& key, HeaderString&& value);
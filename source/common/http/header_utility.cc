@@ -161,6 +161,16 @@ bool HeaderUtility::isConnect(const RequestHeaderMap& headers) {
   return headers.Method() && headers.Method()->value() == Http::Headers::get().MethodValues.Connect;
 }
 
+bool HeaderUtility::isIdempotent(const RequestHeaderMap& headers) {
+  if (!headers.Method()) {
+    return false;
+  }
+  const absl::string_view method = headers.Method()->value().getStringView();
+  const auto& methods = Http::Headers::get().MethodValues;
+  return method == methods.Get || method == methods.Head || method == methods.Options ||
+         method == methods.Trace || method == methods.Put || method == methods.Delete;
+}
+
 void HeaderUtility::addHeaders(HeaderMap& headers, const HeaderMap& headers_to_add) {
   headers_to_add.iterate(
       [](const HeaderEntry& header, void* context) -> HeaderMap::Iterate {
@@ -116,6 +116,12 @@ public:
    */
   static bool isConnect(const RequestHeaderMap& headers);
 
+  /**
+   * @brief a helper function to determine if the headers represent a request with an idempotent
+   * method, as defined by https://tools.ietf.org/html/rfc7231#section-4.2.2.
+   */
+  static bool isIdempotent(const RequestHeaderMap& headers);
+
   /**
    * Add headers from one HeaderMap to another
    * @param headers target where headers will be added
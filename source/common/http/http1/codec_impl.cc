@@ -9,6 +9,7 @@
 #include "envoy/http/header_map.h"
 #include "envoy/network/connection.h"
 
+#include "common/common/cleanup.h"
 #include "common/common/enum_to_int.h"
 #include "common/common/utility.h"
 #include "common/http/exception.h"
@@ -397,11 +398,17 @@ http_parser_settings ConnectionImpl::settings_{
     },
     nullptr, // on_status
     [](http_parser* parser, const char* at, size_t length) -> int {
-      static_cast<ConnectionImpl*>(parser->data)->onHeaderField(at, length);
+      auto* conn_impl = static_cast<ConnectionImpl*>(parser->data);
+      if (!conn_impl->scanning_head_) {
+        conn_impl->onHeaderField(at, length);
+      }
       return 0;
     },
     [](http_parser* parser, const char* at, size_t length) -> int {
-      static_cast<ConnectionImpl*>(parser->data)->onHeaderValue(at, length);
+      auto* conn_impl = static_cast<ConnectionImpl*>(parser->data);
+      if (!conn_impl->scanning_head_) {
+        conn_impl->onHeaderValue(at, length);
+      }
       return 0;
     },
     [](http_parser* parser) -> int {
@@ -528,7 +535,15 @@ void ConnectionImpl::dispatch(Buffer::Instance& data) {
 }
 
 size_t ConnectionImpl::dispatchSlice(const char* slice, size_t len) {
-  ssize_t rc = http_parser_execute(&parser_, &settings_, slice, len);
+  size_t rc = 0;
+  if (head_scanner_ != nullptr && at_message_start_ && len > 0) {
+    rc = dispatchScannedHead(slice, len);
+  }
+  // Note that a zero length span signals the end of the stream to http_parser, so it is only
+  // passed on if nothing has been consumed yet.
+  if (rc == 0 || (rc < len && HTTP_PARSER_ERRNO(&parser_) == HPE_OK)) {
+    rc += http_parser_execute(&parser_, &settings_, slice + rc, len - rc);
+  }
   if (HTTP_PARSER_ERRNO(&parser_) != HPE_OK && HTTP_PARSER_ERRNO(&parser_) != HPE_PAUSED) {
     sendProtocolError(Http1ResponseCodeDetails::get().HttpCodecError);
     throw CodecProtocolException("http/1.1 protocol error: " +
@@ -538,6 +553,45 @@ size_t ConnectionImpl::dispatchSlice(const char* slice, size_t len) {
   return rc;
 }
 
+size_t ConnectionImpl::dispatchScannedHead(const char* slice, size_t len) {
+  if (!head_scanner_->scan(slice, len)) {
+    return 0;
+  }
+  // Heads which could exceed the size or count limits are left to http_parser so that limit
+  // violations and framing errors are reported in the same order as without scanning.
+  const size_t head_length = head_scanner_->headLength();
+  if (head_length > HTTP_MAX_HEADER_SIZE || head_length > max_headers_kb_ * 1024 ||
+      head_scanner_->headers().size() > max_headers_count_) {
+    return 0;
+  }
+
+  scanning_head_ = true;
+  Cleanup stop_scanning([this]() { scanning_head_ = false; });
+  // Returns the offset in the slice up to which http_parser has consumed the span. When paused,
+  // http_parser may not have consumed the last byte of the span, which is then passed again on
+  // the next dispatch.
+  const auto execute = [this, slice](absl::string_view span) -> size_t {
+    return (span.data() - slice) +
+           http_parser_execute(&parser_, &settings_, span.data(), span.size());
+  };
+
+  size_t rc = execute(head_scanner_->requestLine());
+  for (const RequestHeadScanner::HeaderField& header : head_scanner_->headers()) {
+    if (HTTP_PARSER_ERRNO(&parser_) != HPE_OK) {
+      return rc;
+    }
+    if (header.framing_) {
+      rc = execute(header.line_);
+    }
+  }
+  if (HTTP_PARSER_ERRNO(&parser_) != HPE_OK) {
+    return rc;
+  }
+  // The empty line completes the head, at which point the scanned headers are raised from
+  // onHeadersCompleteBase().
+  return execute(absl::string_view(slice + head_length - 2, 2));
+}
+
 void ConnectionImpl::onHeaderField(const char* data, size_t length) {
   // We previously already finished up the headers, these headers are
   // now trailers.
@@ -601,6 +655,15 @@ void ConnectionImpl::onHeaderValue(const char* data, size_t length) {
 int ConnectionImpl::onHeadersCompleteBase() {
   ASSERT(!processing_trailers_);
   ENVOY_CONN_LOG(trace, "onHeadersCompleteBase", connection_);
+  if (scanning_head_) {
+    // Only the framing headers have been seen by http_parser, with their callbacks suppressed.
+    // Raise all of the scanned headers in the order they were received.
+    scanning_head_ = false;
+    for (const RequestHeadScanner::HeaderField& header : head_scanner_->headers()) {
+      onHeaderField(header.name_.data(), header.name_.size());
+      onHeaderValue(header.value_.data(), header.value_.size());
+    }
+  }
   completeLastHeader();
 
   if (!(parser_.http_major == 1 && parser_.http_minor == 1)) {
@@ -681,6 +744,7 @@ void ConnectionImpl::onChunkHeader(bool is_final_chunk) {
 
 void ConnectionImpl::onMessageCompleteBase() {
   ENVOY_CONN_LOG(trace, "message complete", connection_);
+  at_message_start_ = true;
 
   dispatchBufferedBody();
 
@@ -709,13 +773,15 @@ void ConnectionImpl::onMessageBeginBase() {
   // in onHeadersCompleteBase
   protocol_ = Protocol::Http11;
   processing_trailers_ = false;
+  at_message_start_ = false;
   header_parsing_state_ = HeaderParsingState::Field;
   allocHeaders();
   onMessageBegin();
 }
 
 void ConnectionImpl::onResetStreamBase(StreamResetReason reason) {
-  ASSERT(!reset_stream_called_);
+  // The streams of pipelined requests may be reset again while reset callbacks are running.
+  ASSERT(!reset_stream_called_ || parser_.type == HTTP_RESPONSE);
   reset_stream_called_ = true;
   onResetStream(reason);
 }
@@ -740,7 +806,11 @@ ServerConnectionImpl::ServerConnectionImpl(
           Runtime::getInteger("envoy.do_not_use_going_away_max_http2_outbound_responses", 2)),
       flood_protection_(
           Runtime::runtimeFeatureEnabled("envoy.reloadable_features.http1_flood_protection")),
-      headers_with_underscores_action_(headers_with_underscores_action) {}
+      headers_with_underscores_action_(headers_with_underscores_action) {
+  if (settings.parser_backend_ == Http1Settings::ParserBackend::HeadScanner) {
+    head_scanner_ = std::make_unique<RequestHeadScanner>();
+  }
+}
 
 void ServerConnectionImpl::onEncodeComplete() {
   if (active_request_.value().remote_complete_) {
@@ -981,7 +1051,7 @@ ClientConnectionImpl::ClientConnectionImpl(Network::Connection& connection, Stat
                      max_response_headers_count, formatter(settings), settings.enable_trailers_) {}
 
 bool ClientConnectionImpl::cannotHaveBody() {
-  if (pending_response_.has_value() && pending_response_.value().encoder_.headRequest()) {
+  if (!pending_responses_.empty() && pending_responses_.front().encoder_.headRequest()) {
     ASSERT(!pending_response_done_);
     return true;
   } else if (parser_.status_code == 204 || parser_.status_code == 304 ||
@@ -997,31 +1067,38 @@ RequestEncoder& ClientConnectionImpl::newStream(ResponseDecoder& response_decode
     throw CodecClientException("cannot create new streams after calling reset");
   }
 
-  // If reads were disabled due to flow control, we expect reads to always be enabled again before
-  // reusing this connection. This is done when the response is received.
-  ASSERT(connection_.readEnabled());
-
-  ASSERT(!pending_response_.has_value());
-  ASSERT(pending_response_done_);
-  pending_response_.emplace(*this, header_key_formatter_.get(), &response_decoder);
+  if (pending_responses_.empty()) {
+    // If reads were disabled due to flow control, we expect reads to always be enabled again
+    // before reusing this connection. This is done when the response is received.
+    ASSERT(connection_.readEnabled());
+    ASSERT(pending_response_done_);
+  } else {
+    // A pipelined request must not be interleaved with the one before it.
+    ASSERT(encode_complete_);
+  }
+  const bool queued = !pending_responses_.empty();
+  pending_responses_.emplace_back(*this, header_key_formatter_.get(), &response_decoder);
+  pending_responses_.back().queued_ = queued;
   pending_response_done_ = false;
-  return pending_response_.value().encoder_;
+  encode_complete_ = false;
+  return pending_responses_.back().encoder_;
 }
 
 int ClientConnectionImpl::onHeadersComplete() {
   // Handle the case where the client is closing a kept alive connection (by sending a 408
   // with a 'Connection: close' header). In this case we just let response flush out followed
   // by the remote close.
-  if (!pending_response_.has_value() && !resetStreamCalled()) {
+  if (pending_responses_.empty() && !resetStreamCalled()) {
     throw PrematureResponseException(static_cast<Http::Code>(parser_.status_code));
-  } else if (pending_response_.has_value()) {
+  } else if (!pending_responses_.empty()) {
     ASSERT(!pending_response_done_);
+    PendingResponse& response = pending_responses_.front();
     auto& headers = absl::get<ResponseHeaderMapPtr>(headers_or_trailers_);
     ENVOY_CONN_LOG(trace, "Client: onHeadersComplete size={}", connection_, headers->size());
     headers->setStatus(parser_.status_code);
 
     if (parser_.status_code >= 200 && parser_.status_code < 300 &&
-        pending_response_.value().encoder_.connectRequest()) {
+        response.encoder_.connectRequest()) {
       ENVOY_CONN_LOG(trace, "codec entering upgrade mode for CONNECT response.", connection_);
       handling_upgrade_ = true;
     }
@@ -1030,7 +1107,7 @@ int ClientConnectionImpl::onHeadersComplete() {
       // http-parser treats 100 continue headers as their own complete response.
       // Swallow the spurious onMessageComplete and continue processing.
       ignore_message_complete_for_100_continue_ = true;
-      pending_response_.value().decoder_->decode100ContinueHeaders(std::move(headers));
+      response.decoder_->decode100ContinueHeaders(std::move(headers));
 
       // Reset to ensure no information from the continue headers is used for the response headers
       // in case the callee does not move the headers out.
@@ -1038,7 +1115,7 @@ int ClientConnectionImpl::onHeadersComplete() {
     } else if (cannotHaveBody() && !handling_upgrade_) {
       deferred_end_stream_headers_ = true;
     } else {
-      pending_response_.value().decoder_->decodeHeaders(std::move(headers), false);
+      response.decoder_->decodeHeaders(std::move(headers), false);
     }
   }
 
@@ -1048,17 +1125,17 @@ int ClientConnectionImpl::onHeadersComplete() {
 }
 
 bool ClientConnectionImpl::upgradeAllowed() const {
-  if (pending_response_.has_value()) {
-    return pending_response_->encoder_.upgrade_request_;
+  if (!pending_responses_.empty()) {
+    return pending_responses_.front().encoder_.upgrade_request_;
   }
   return false;
 }
 
 void ClientConnectionImpl::onBody(Buffer::Instance& data) {
   ASSERT(!deferred_end_stream_headers_);
-  if (pending_response_.has_value()) {
+  if (!pending_responses_.empty()) {
     ASSERT(!pending_response_done_);
-    pending_response_.value().decoder_->decodeData(data, false);
+    pending_responses_.front().decoder_->decodeData(data, false);
   }
 }
 
@@ -1068,12 +1145,12 @@ void ClientConnectionImpl::onMessageComplete() {
     ignore_message_complete_for_100_continue_ = false;
     return;
   }
-  if (pending_response_.has_value()) {
+  if (!pending_responses_.empty()) {
     ASSERT(!pending_response_done_);
     // After calling decodeData() with end stream set to true, we should no longer be able to reset.
-    PendingResponse& response = pending_response_.value();
-    // Encoder is used as part of decode* calls later in this function so pending_response_ can not
-    // be reset just yet. Preserve the state in pending_response_done_ instead.
+    PendingResponse& response = pending_responses_.front();
+    // Encoder is used as part of decode* calls later in this function so the response can not be
+    // removed just yet. Preserve the state in pending_response_done_ instead.
     pending_response_done_ = true;
 
     // Streams are responsible for unwinding any outstanding readDisable(true)
@@ -1099,38 +1176,66 @@ void ClientConnectionImpl::onMessageComplete() {
       response.decoder_->decodeData(buffer, true);
     }
 
-    // Reset to ensure no information from one requests persists to the next.
-    pending_response_.reset();
+    // Reset to ensure no information from one requests persists to the next. Any pipelined
+    // request behind this one is now the one whose response is expected.
+    pending_responses_.pop_front();
+    pending_response_done_ = pending_responses_.empty();
+    if (!pending_response_done_) {
+      pending_responses_.front().queued_ = false;
+    }
     headers_or_trailers_.emplace<ResponseHeaderMapPtr>(nullptr);
   }
 }
 
 void ClientConnectionImpl::onResetStream(StreamResetReason reason) {
-  // Only raise reset if we did not already dispatch a complete response.
-  if (pending_response_.has_value() && !pending_response_done_) {
-    pending_response_.value().encoder_.runResetCallbacks(reason);
+  // Only raise reset if we did not already dispatch a complete response. A complete response is
+  // left for onMessageComplete() to remove.
+  const auto next_reset = [this]() {
+    auto it = pending_responses_.begin();
+    if (it != pending_responses_.end() && pending_response_done_) {
+      ++it;
+    }
+    return it;
+  };
+  // A reset takes down the whole connection, so when requests are pipelined the other streams are
+  // reset as well. Queued requests have not been answered, so they are reset as refused streams
+  // which may be retried. Each response is moved out of the list before its callbacks run, as a
+  // callback closing the connection resets the remaining streams from within this function.
+  for (auto it = next_reset(); it != pending_responses_.end(); it = next_reset()) {
+    std::list<PendingResponse> resetting;
+    resetting.splice(resetting.begin(), pending_responses_, it);
+    PendingResponse& response = resetting.front();
+    if (response.queued_) {
+      response.encoder_.runResetCallbacks(StreamResetReason::RemoteRefusedStreamReset);
+    } else {
+      response.encoder_.runResetCallbacks(response.encoder_.resetRequested()
+                                              ? reason
+                                              : StreamResetReason::ConnectionTermination);
+    }
+  }
+  if (pending_responses_.empty()) {
     pending_response_done_ = true;
-    pending_response_.reset();
   }
 }
 
 void ClientConnectionImpl::sendProtocolError(absl::string_view details) {
-  if (pending_response_.has_value()) {
+  if (!pending_responses_.empty()) {
     ASSERT(!pending_response_done_);
-    pending_response_.value().encoder_.setDetails(details);
+    pending_responses_.front().encoder_.setDetails(details);
   }
 }
 
 void ClientConnectionImpl::onAboveHighWatermark() {
-  // This should never happen without an active stream/request.
-  pending_response_.value().encoder_.runHighWatermarkCallbacks();
+  // This should never happen without an active stream/request. Requests are only pipelined behind
+  // completely encoded ones, so the last request is the one which may still be writing.
+  pending_responses_.back().encoder_.runHighWatermarkCallbacks();
 }
 
 void ClientConnectionImpl::onBelowLowWatermark() {
   // This can get called without an active stream/request when the response completion causes us to
   // close the connection, but in doing so go below low watermark.
-  if (pending_response_.has_value() && !pending_response_done_) {
-    pending_response_.value().encoder_.runLowWatermarkCallbacks();
+  if (!pending_responses_.empty() && !pending_response_done_) {
+    pending_responses_.back().encoder_.runLowWatermarkCallbacks();
   }
 }
 
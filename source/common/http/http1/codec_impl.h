@@ -18,6 +18,7 @@
 #include "common/http/codec_helper.h"
 #include "common/http/codes.h"
 #include "common/http/header_map_impl.h"
+#include "common/http/http1/head_scanner.h"
 #include "common/http/http1/header_formatter.h"
 
 namespace Envoy {
@@ -148,16 +149,25 @@ public:
       : StreamEncoderImpl(connection, header_key_formatter) {}
   bool headRequest() { return head_request_; }
   bool connectRequest() { return connect_request_; }
+  bool resetRequested() { return reset_requested_; }
 
   // Http::RequestEncoder
   void encodeHeaders(const RequestHeaderMap& headers, bool end_stream) override;
   void encodeTrailers(const RequestTrailerMap& trailers) override { encodeTrailersBase(trailers); }
 
+  // Http::Stream
+  void resetStream(StreamResetReason reason) override {
+    reset_requested_ = true;
+    StreamEncoderImpl::resetStream(reason);
+  }
+
   bool upgrade_request_{};
 
 private:
   bool head_request_{};
   bool connect_request_{};
+  // True if this stream was reset by its user, as opposed to along with a pipelined stream.
+  bool reset_requested_{};
 };
 
 /**
@@ -238,6 +248,8 @@ protected:
   const bool connection_header_sanitization_ : 1;
   const bool enable_trailers_ : 1;
   const bool reject_unsupported_transfer_encodings_ : 1;
+  // Set when requests are parsed with the HeadScanner parser backend.
+  std::unique_ptr<RequestHeadScanner> head_scanner_;
 
 private:
   enum class HeaderParsingState { Field, Value, Done };
@@ -271,6 +283,17 @@ private:
    */
   size_t dispatchSlice(const char* slice, size_t len);
 
+  /**
+   * Dispatch a request head located by head_scanner_ at the start of a memory span. The request
+   * line and the framing headers are fed to http_parser in place, with the header callbacks
+   * suppressed, and all of the scanned headers are raised when http_parser completes the head.
+   * @param slice supplies the start address.
+   * @param len supplies the length of the span.
+   * @return the number of bytes consumed, or 0 if the span does not start with a head which can
+   *         be scanned and must be parsed by http_parser alone.
+   */
+  size_t dispatchScannedHead(const char* slice, size_t len);
+
   /**
    * Called by the http_parser when body data is received.
    * @param data supplies the start address.
@@ -379,6 +402,10 @@ private:
   static http_parser_settings settings_;
 
   HeaderParsingState header_parsing_state_{HeaderParsingState::Field};
+  // True between the end of one message and the start of the next, when a head may be scanned.
+  bool at_message_start_{true};
+  // True while the head located by head_scanner_ is being fed to http_parser.
+  bool scanning_head_{};
   // Used to accumulate the HTTP message body during the current dispatch call. The accumulated body
   // is pushed through the filter pipeline either at the end of the current dispatch call, or when
   // the last byte of the body is processed (whichever happens first).
@@ -506,12 +533,14 @@ private:
 
     RequestEncoderImpl encoder_;
     ResponseDecoder* decoder_;
+    // True while the request is pipelined behind another whose response has not completed.
+    bool queued_{};
   };
 
   bool cannotHaveBody();
 
   // ConnectionImpl
-  void onEncodeComplete() override {}
+  void onEncodeComplete() override { encode_complete_ = true; }
   void onMessageBegin() override {}
   void onUrl(const char*, size_t) override { NOT_IMPLEMENTED_GCOVR_EXCL_LINE; }
   int onHeadersComplete() override;
@@ -544,13 +573,17 @@ private:
     }
   }
 
-  absl::optional<PendingResponse> pending_response_;
-  // TODO(mattklein123): The following bool tracks whether a pending response is complete before
-  // dispatching callbacks. This is needed so that pending_response_ stays valid during callbacks
+  // Responses expected on the connection, in the order the requests were sent. The front is the
+  // response currently being received; any others belong to pipelined requests.
+  std::list<PendingResponse> pending_responses_;
+  // TODO(mattklein123): The following bool tracks whether the front pending response is complete
+  // before dispatching callbacks. This is needed so that the response stays valid during callbacks
   // in order to access the stream, but to avoid invoking callbacks that shouldn't be called once
   // the response is complete. The existence of this variable is hard to reason about and it should
-  // be combined with pending_response_ somehow in a follow up cleanup.
+  // be combined with pending_responses_ somehow in a follow up cleanup.
   bool pending_response_done_{true};
+  // Whether the most recently created request has been completely encoded.
+  bool encode_complete_{true};
   // Set true between receiving 100-Continue headers and receiving the spurious onMessageComplete.
   bool ignore_message_complete_for_100_continue_{};
   // TODO(mattklein123): This should be a member of PendingResponse but this change needs dedicated
@@ -1,5 +1,6 @@
 #include "common/http/http1/conn_pool.h"
 
+#include <algorithm>
 #include <cstdint>
 #include <list>
 #include <memory>
@@ -12,7 +13,9 @@
 
 #include "common/http/codec_client.h"
 #include "common/http/codes.h"
+#include "common/http/header_utility.h"
 #include "common/http/headers.h"
+#include "common/http/utility.h"
 #include "common/runtime/runtime_features.h"
 
 #include "absl/strings/match.h"
@@ -38,6 +41,42 @@ ConnPoolImplBase::ActiveClientPtr ConnPoolImpl::instantiateActiveClient() {
   return std::make_unique<ActiveClient>(*this);
 }
 
+ConnectionPool::Cancellable*
+ConnPoolImpl::newPipelinableStream(ResponseDecoder& response_decoder,
+                                   ConnectionPool::Callbacks& callbacks) {
+  // Idle connections are always preferred, so requests are only pipelined when all connections
+  // are busy.
+  if (ready_clients_.empty()) {
+    ActiveClient* client = pipelineClient();
+    if (client != nullptr) {
+      ENVOY_CONN_LOG(debug, "pipelining request behind {} others", *client->codec_client_,
+                     client->stream_wrappers_.size());
+      attachRequestToClient(*client, response_decoder, callbacks);
+      return nullptr;
+    }
+  }
+  return newStream(response_decoder, callbacks);
+}
+
+ConnPoolImpl::ActiveClient* ConnPoolImpl::pipelineClient() const {
+  if (host_->cluster().http1Settings().max_pipeline_depth_ <= 1) {
+    return nullptr;
+  }
+  // Pick the connection with the fewest outstanding requests.
+  ActiveClient* best = nullptr;
+  for (const ActiveClientPtr& entry : busy_clients_) {
+    ActiveClient& client = static_cast<ActiveClient&>(*entry);
+    if (client.canPipeline() &&
+        (best == nullptr || client.stream_wrappers_.size() < best->stream_wrappers_.size())) {
+      best = &client;
+      if (best->stream_wrappers_.size() == 1) {
+        break;
+      }
+    }
+  }
+  return best;
+}
+
 void ConnPoolImpl::onDownstreamReset(ActiveClient& client) {
   // If we get a downstream reset to an attached client, we just blow it away.
   client.codec_client_->close();
@@ -46,14 +85,16 @@ void ConnPoolImpl::onDownstreamReset(ActiveClient& client) {
 void ConnPoolImpl::onResponseComplete(ActiveClient& client) {
   ENVOY_CONN_LOG(debug, "response complete", *client.codec_client_);
 
-  if (!client.stream_wrapper_->encode_complete_) {
+  // Responses arrive in the order the requests were sent.
+  const StreamWrapper& stream = *client.stream_wrappers_.front();
+  if (!stream.encode_complete_) {
     ENVOY_CONN_LOG(debug, "response before request complete", *client.codec_client_);
     onDownstreamReset(client);
-  } else if (client.stream_wrapper_->close_connection_ || client.codec_client_->remoteClosed()) {
+  } else if (stream.close_connection_ || client.codec_client_->remoteClosed()) {
     ENVOY_CONN_LOG(debug, "saw upstream close connection", *client.codec_client_);
     onDownstreamReset(client);
   } else {
-    client.stream_wrapper_.reset();
+    client.stream_wrappers_.pop_front();
 
     if (!pending_requests_.empty() && !upstream_ready_enabled_) {
       upstream_ready_enabled_ = true;
@@ -78,8 +119,21 @@ ConnPoolImpl::StreamWrapper::~StreamWrapper() {
   parent_.parent().onRequestClosed(parent_, true);
 }
 
+void ConnPoolImpl::StreamWrapper::encodeHeaders(const RequestHeaderMap& headers, bool end_stream) {
+  pipelinable_ =
+      end_stream && HeaderUtility::isIdempotent(headers) && !Utility::isUpgrade(headers);
+  RequestEncoderWrapper::encodeHeaders(headers, end_stream);
+}
+
 void ConnPoolImpl::StreamWrapper::onEncodeComplete() { encode_complete_ = true; }
 
+void ConnPoolImpl::StreamWrapper::onResetStream(StreamResetReason reason, absl::string_view) {
+  if (reason == StreamResetReason::RemoteRefusedStreamReset) {
+    parent_.parent_.host_->cluster().stats().upstream_rq_pipeline_refused_.inc();
+  }
+  parent_.parent().onDownstreamReset(parent_);
+}
+
 void ConnPoolImpl::StreamWrapper::decodeHeaders(ResponseHeaderMapPtr&& headers, bool end_stream) {
   // If Connection: close OR
   //    Http/1.0 and not Connection: keep-alive OR
@@ -114,16 +168,38 @@ ConnPoolImpl::ActiveClient::ActiveClient(ConnPoolImpl& parent)
   parent.host_->cluster().stats().upstream_cx_http1_total_.inc();
 }
 
-bool ConnPoolImpl::ActiveClient::hasActiveRequests() const { return stream_wrapper_ != nullptr; }
+bool ConnPoolImpl::ActiveClient::hasActiveRequests() const { return !stream_wrappers_.empty(); }
 
 bool ConnPoolImpl::ActiveClient::closingWithIncompleteRequest() const {
-  return (stream_wrapper_ != nullptr) && (!stream_wrapper_->decode_complete_);
+  return std::any_of(stream_wrappers_.begin(), stream_wrappers_.end(),
+                     [](const StreamWrapperPtr& stream) { return !stream->decode_complete_; });
 }
 
 RequestEncoder& ConnPoolImpl::ActiveClient::newStreamEncoder(ResponseDecoder& response_decoder) {
-  ASSERT(!stream_wrapper_);
-  stream_wrapper_ = std::make_unique<StreamWrapper>(response_decoder, *this);
-  return *stream_wrapper_;
+  if (!stream_wrappers_.empty()) {
+    ASSERT(canPipeline());
+    parent_.host_->cluster().stats().upstream_rq_pipelined_.inc();
+    parent_.host_->cluster().stats().upstream_rq_pipeline_depth_.recordValue(
+        stream_wrappers_.size() + 1);
+  }
+  stream_wrappers_.push_back(std::make_unique<StreamWrapper>(response_decoder, *this));
+  return *stream_wrappers_.back();
+}
+
+bool ConnPoolImpl::ActiveClient::canPipeline() const {
+  if (state_ != State::BUSY ||
+      stream_wrappers_.size() >= parent_.host_->cluster().http1Settings().max_pipeline_depth_ ||
+      codec_client_->remoteClosed()) {
+    return false;
+  }
+  // Requests are only pipelined behind ones which may be retried if the connection closes before
+  // they are answered, and never while a request is still being written or backed up.
+  return std::all_of(stream_wrappers_.begin(), stream_wrappers_.end(),
+                     [](const StreamWrapperPtr& stream) {
+                       return stream->pipelinable_ && stream->encode_complete_ &&
+                              !stream->close_connection_ &&
+                              !stream->above_write_buffer_high_watermark_;
+                     });
 }
 
 CodecClientPtr ProdConnPoolImpl::createCodecClient(Upstream::Host::CreateConnectionData& data) {
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <list>
+
 #include "envoy/event/timer.h"
 #include "envoy/http/codec.h"
 #include "envoy/upstream/upstream.h"
@@ -28,6 +30,8 @@ public:
 
   // ConnectionPool::Instance
   Http::Protocol protocol() const override { return Http::Protocol::Http11; }
+  ConnectionPool::Cancellable* newPipelinableStream(ResponseDecoder& response_decoder,
+                                                    ConnectionPool::Callbacks& callbacks) override;
 
   // ConnPoolImplBase
   ActiveClientPtr instantiateActiveClient() override;
@@ -41,6 +45,9 @@ protected:
     StreamWrapper(ResponseDecoder& response_decoder, ActiveClient& parent);
     ~StreamWrapper() override;
 
+    // RequestEncoderWrapper
+    void encodeHeaders(const RequestHeaderMap& headers, bool end_stream) override;
+
     // StreamEncoderWrapper
     void onEncodeComplete() override;
 
@@ -50,16 +57,18 @@ protected:
     void onDecodeComplete() override;
 
     // Http::StreamCallbacks
-    void onResetStream(StreamResetReason, absl::string_view) override {
-      parent_.parent().onDownstreamReset(parent_);
-    }
-    void onAboveWriteBufferHighWatermark() override {}
-    void onBelowWriteBufferLowWatermark() override {}
+    void onResetStream(StreamResetReason reason, absl::string_view) override;
+    void onAboveWriteBufferHighWatermark() override { above_write_buffer_high_watermark_ = true; }
+    void onBelowWriteBufferLowWatermark() override { above_write_buffer_high_watermark_ = false; }
 
     ActiveClient& parent_;
     bool encode_complete_{};
     bool close_connection_{};
     bool decode_complete_{};
+    // True if the request is idempotent and was encoded without a body, so that other requests
+    // may be pipelined behind it.
+    bool pipelinable_{};
+    bool above_write_buffer_high_watermark_{};
   };
 
   using StreamWrapperPtr = std::unique_ptr<StreamWrapper>;
@@ -74,11 +83,18 @@ protected:
     bool closingWithIncompleteRequest() const override;
     RequestEncoder& newStreamEncoder(ResponseDecoder& response_decoder) override;
 
-    StreamWrapperPtr stream_wrapper_;
+    // Returns true if another request may be written to the connection behind the ones which have
+    // not been answered yet.
+    bool canPipeline() const;
+
+    // The streams of the requests sent on the connection, in order. The front is the one whose
+    // response is expected next.
+    std::list<StreamWrapperPtr> stream_wrappers_;
   };
 
   void onDownstreamReset(ActiveClient& client);
   void onResponseComplete(ActiveClient& client);
+  ActiveClient* pipelineClient() const;
   ActiveClient& firstReady() const { return static_cast<ActiveClient&>(*ready_clients_.front()); }
   ActiveClient& firstBusy() const { return static_cast<ActiveClient&>(*busy_clients_.front()); }
 
@@ -0,0 +1,157 @@
+#include "common/http/http1/head_scanner.h"
+
+#include <array>
+#include <cstdint>
+#include <cstring>
+
+#include "absl/strings/match.h"
+
+namespace Envoy {
+namespace Http {
+namespace Http1 {
+
+namespace {
+
+// RFC 7230 token characters other than '_'. Names containing '_' are left to http_parser so that
+// the headers_with_underscores_action checks happen in the same order as without scanning.
+const std::array<bool, 256>& headerNameChars() {
+  static const std::array<bool, 256> chars = [] {
+    std::array<bool, 256> chars{};
+    for (const char c : absl::string_view("!#$%&'*+-.^`|~")) {
+      chars[static_cast<uint8_t>(c)] = true;
+    }
+    for (char c = '0'; c <= '9'; c++) {
+      chars[static_cast<uint8_t>(c)] = true;
+    }
+    for (char c = 'a'; c <= 'z'; c++) {
+      chars[static_cast<uint8_t>(c)] = true;
+      chars[static_cast<uint8_t>(c - 'a' + 'A')] = true;
+    }
+    return chars;
+  }();
+  return chars;
+}
+
+bool validHeaderValueChar(uint8_t c) { return c == '\t' || (c >= 0x20 && c != 0x7f); }
+
+const char* findLineEnd(const char* start, const char* end) {
+  return static_cast<const char*>(memchr(start, '\n', end - start));
+}
+
+// The headers which http_parser inspects to determine message framing and connection handling.
+bool isFramingHeader(absl::string_view name) {
+  switch (name.size()) {
+  case 7:
+    return absl::EqualsIgnoreCase(name, "upgrade");
+  case 10:
+    return absl::EqualsIgnoreCase(name, "connection");
+  case 14:
+    return absl::EqualsIgnoreCase(name, "content-length");
+  case 16:
+    return absl::EqualsIgnoreCase(name, "proxy-connection");
+  case 17:
+    return absl::EqualsIgnoreCase(name, "transfer-encoding");
+  default:
+    return false;
+  }
+}
+
+} // namespace
+
+bool RequestHeadScanner::validHeaderValue(const char* start, const char* end) {
+  constexpr uint64_t Ones = 0x0101010101010101ULL;
+  constexpr uint64_t High = 0x8080808080808080ULL;
+  while (end - start >= 8) {
+    uint64_t word;
+    memcpy(&word, start, sizeof(word));
+    // Flag words containing a byte below 0x20 or equal to 0x7f. Both tests are exact as to whether
+    // such a byte is present, though not as to which one it is, so flagged words are checked byte
+    // by byte as horizontal tab is allowed.
+    const uint64_t below_space = (word - Ones * 0x20) & ~word & High;
+    const uint64_t del = word ^ (Ones * 0x7f);
+    const uint64_t is_del = (del - Ones) & ~del & High;
+    if ((below_space | is_del) != 0) {
+      for (const char* c = start; c != start + 8; c++) {
+        if (!validHeaderValueChar(*c)) {
+          return false;
+        }
+      }
+    }
+    start += 8;
+  }
+  for (; start != end; start++) {
+    if (!validHeaderValueChar(*start)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+const char* RequestHeadScanner::scanHeaderName(const char* start, const char* end) {
+  const std::array<bool, 256>& chars = headerNameChars();
+  while (start != end && chars[static_cast<uint8_t>(*start)]) {
+    start++;
+  }
+  return start;
+}
+
+bool RequestHeadScanner::scan(const char* data, size_t length) {
+  headers_.clear();
+  const char* const end = data + length;
+
+  // The shortest request line in the common form is "M / HTTP/1.1\r\n". The request line itself
+  // is validated by http_parser.
+  const char* line_end = findLineEnd(data, end);
+  if (line_end == nullptr || line_end - data < 13 || line_end[-1] != '\r' ||
+      !headerNameChars()[static_cast<uint8_t>(data[0])]) {
+    return false;
+  }
+  const absl::string_view version(line_end - 10, 9);
+  if (version != " HTTP/1.1" && version != " HTTP/1.0") {
+    return false;
+  }
+  request_line_ = absl::string_view(data, line_end + 1 - data);
+
+  const char* line = line_end + 1;
+  while (true) {
+    if (end - line < 2) {
+      return false;
+    }
+    if (line[0] == '\r') {
+      if (line[1] != '\n') {
+        return false;
+      }
+      head_length_ = line + 2 - data;
+      return true;
+    }
+
+    // A bare LF ends up here as the character preceding it is the LF of the previous line.
+    line_end = findLineEnd(line, end);
+    if (line_end == nullptr || line_end[-1] != '\r') {
+      return false;
+    }
+    // Leading whitespace, i.e. an obsolete line folding, is rejected along with any other invalid
+    // name.
+    const char* name_end = scanHeaderName(line, line_end);
+    if (name_end == line || *name_end != ':') {
+      return false;
+    }
+    const char* value = name_end + 1;
+    const char* value_end = line_end - 1;
+    while (value != value_end && (*value == ' ' || *value == '\t')) {
+      value++;
+    }
+    if (!validHeaderValue(value, value_end)) {
+      return false;
+    }
+
+    const absl::string_view name(line, name_end - line);
+    headers_.push_back({name, absl::string_view(value, value_end - value),
+                        absl::string_view(line, line_end + 1 - line), isFramingHeader(name)});
+    line = line_end + 1;
+  }
+}
+
+} // namespace Http1
+} // namespace Http
+} // namespace Envoy
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+#include "absl/strings/string_view.h"
+
+namespace Envoy {
+namespace Http {
+namespace Http1 {
+
+/**
+ * Locates the request line and header fields of an HTTP/1 request head held in a single buffer.
+ * Line ends are found with memchr, which is vectorized by the C library, and header values are
+ * validated a word at a time, so that the head does not have to be driven through http_parser
+ * byte by byte.
+ *
+ * Only heads in the common strict form are accepted: an HTTP/1.0 or HTTP/1.1 request line,
+ * CRLF line endings, header names made of RFC 7230 token characters other than '_' and header
+ * values without control characters other than horizontal tab. Anything else, including a head
+ * which is not complete within the buffer, is rejected and must be parsed by http_parser, which
+ * is then responsible for reporting any error.
+ */
+class RequestHeadScanner {
+public:
+  struct HeaderField {
+    // The header name as received.
+    absl::string_view name_;
+    // The header value with leading whitespace removed. Trailing whitespace is retained, as with
+    // http_parser.
+    absl::string_view value_;
+    // The whole header line including its CRLF.
+    absl::string_view line_;
+    // Whether http_parser uses the header to determine message framing or connection handling,
+    // e.g. content-length or connection.
+    bool framing_;
+  };
+
+  /**
+   * Scans a request head at the start of a buffer. The results remain valid until the next call
+   * and refer to the supplied buffer.
+   * @param data supplies the start of the buffer.
+   * @param length supplies the length of the buffer.
+   * @return true if the buffer starts with a complete request head in the common form.
+   */
+  bool scan(const char* data, size_t length);
+
+  /**
+   * @return the request line including its CRLF.
+   */
+  absl::string_view requestLine() const { return request_line_; }
+
+  /**
+   * @return the header fields in the order they were received.
+   */
+  const std::vector<HeaderField>& headers() const { return headers_; }
+
+  /**
+   * @return the length of the head including the empty line which terminates it.
+   */
+  size_t headLength() const { return head_length_; }
+
+  /**
+   * @return whether the characters in [start, end) are all valid in a header value, i.e. are not
+   *         control characters other than horizontal tab.
+   */
+  static bool validHeaderValue(const char* start, const char* end);
+
+  /**
+   * @return a pointer to the first character in [start, end) which is not allowed in a header
+   *         name, or end if there is none.
+   */
+  static const char* scanHeaderName(const char* start, const char* end);
+
+private:
+  absl::string_view request_line_;
+  std::vector<HeaderField> headers_;
+  size_t head_length_{};
+};
+
+} // namespace Http1
+} // namespace Http
+} // namespace Envoy
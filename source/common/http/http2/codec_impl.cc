@@ -20,6 +20,7 @@
 #include "common/http/header_utility.h"
 #include "common/http/headers.h"
 #include "common/http/utility.h"
+#include "common/runtime/runtime_features.h"
 
 #include "absl/container/fixed_array.h"
 
@@ -53,6 +54,29 @@ public:
 
 using Http2ResponseCodeDetails = ConstSingleton<Http2ResponseCodeDetailValues>;
 
+namespace {
+
+// A received DATA frame payload which refers to the read slice it was dispatched from rather than
+// holding a copy. The slice is released once every payload referring to it has been drained.
+class ReceivedDataFragment : public Buffer::BufferFragment {
+public:
+  ReceivedDataFragment(std::shared_ptr<const Buffer::Instance> dispatch_slice, const uint8_t* data,
+                       size_t size)
+      : dispatch_slice_(std::move(dispatch_slice)), data_(data), size_(size) {}
+
+  // Buffer::BufferFragment
+  const void* data() const override { return data_; }
+  size_t size() const override { return size_; }
+  void done() override { delete this; }
+
+private:
+  const std::shared_ptr<const Buffer::Instance> dispatch_slice_;
+  const uint8_t* const data_;
+  const size_t size_;
+};
+
+} // namespace
+
 bool Utility::reconstituteCrumbledCookies(const HeaderString& key, const HeaderString& value,
                                           HeaderString& cookies) {
   if (key != Headers::get().Cookie.get().c_str()) {
@@ -126,6 +150,7 @@ void ConnectionImpl::StreamImpl::buildHeaders(std::vector<nghttp2_nv>& final_hea
         return HeaderMap::Iterate::Continue;
       },
       &final_headers);
+  parent_.prepareHeadersForSend(final_headers);
 }
 
 void ConnectionImpl::ServerStreamImpl::encode100ContinueHeaders(const ResponseHeaderMap& headers) {
@@ -337,7 +362,20 @@ ssize_t ConnectionImpl::StreamImpl::onDataSourceRead(uint64_t length, uint32_t*
       }
     }
 
-    return std::min(length, pending_send_data_.length());
+    const uint64_t pending_length = pending_send_data_.length();
+    if (pending_length <= length || !parent_.zero_copy_data_) {
+      return std::min(length, pending_length);
+    }
+    // End the frame at a slice boundary unless that makes it much shorter, so that
+    // onDataSourceSend() moves whole slices rather than copying the head of a partial one.
+    uint64_t aligned_length = 0;
+    for (const Buffer::RawSlice& slice : pending_send_data_.getRawSlices(MaxAlignedFrameSlices)) {
+      if (aligned_length + slice.len_ > length) {
+        break;
+      }
+      aligned_length += slice.len_;
+    }
+    return aligned_length >= length / 2 ? aligned_length : length;
   }
 }
 
@@ -377,6 +415,20 @@ void ConnectionImpl::ServerStreamImpl::submitHeaders(const std::vector<nghttp2_n
   ASSERT(rc == 0);
 }
 
+bool ConnectionImpl::ClientStreamImpl::recycle() { return clientStreamPool().recycle(this); }
+
+bool ConnectionImpl::ServerStreamImpl::recycle() { return serverStreamPool().recycle(this); }
+
+Event::ObjectPool<ConnectionImpl::ClientStreamImpl>& ConnectionImpl::clientStreamPool() {
+  static thread_local Event::ObjectPool<ClientStreamImpl> pool;
+  return pool;
+}
+
+Event::ObjectPool<ConnectionImpl::ServerStreamImpl>& ConnectionImpl::serverStreamPool() {
+  static thread_local Event::ObjectPool<ServerStreamImpl> pool;
+  return pool;
+}
+
 void ConnectionImpl::StreamImpl::encodeData(Buffer::Instance& data, bool end_stream) {
   ASSERT(!local_end_stream_);
   local_end_stream_ = end_stream;
@@ -449,7 +501,13 @@ ConnectionImpl::ConnectionImpl(Network::Connection& connection, Stats::Scope& st
       per_stream_buffer_limit_(http2_options.initial_stream_window_size().value()),
       stream_error_on_invalid_http_messaging_(
           http2_options.stream_error_on_invalid_http_messaging()),
-      flood_detected_(false), max_outbound_frames_(http2_options.max_outbound_frames().value()),
+      flood_detected_(false),
+      zero_copy_data_(
+          Runtime::runtimeFeatureEnabled("envoy.reloadable_features.http2_zero_copy_data")),
+      hpack_tuner_(http2_options.adaptive_hpack()
+                       ? std::make_unique<HpackTuner>(http2_options.hpack_table_size().value())
+                       : nullptr),
+      max_outbound_frames_(http2_options.max_outbound_frames().value()),
       frame_buffer_releasor_([this](const Buffer::OwnedBufferFragmentImpl* fragment) {
         releaseOutboundFrame(fragment);
       }),
@@ -469,28 +527,47 @@ ConnectionImpl::~ConnectionImpl() { nghttp2_session_del(session_); }
 
 void ConnectionImpl::dispatch(Buffer::Instance& data) {
   ENVOY_CONN_LOG(trace, "dispatching {} bytes", connection_, data.length());
-  for (const Buffer::RawSlice& slice : data.getRawSlices()) {
-    dispatching_ = true;
-    ssize_t rc =
-        nghttp2_session_mem_recv(session_, static_cast<const uint8_t*>(slice.mem_), slice.len_);
-    if (rc == NGHTTP2_ERR_FLOODED || flood_detected_) {
-      throw FrameFloodException(
-          "Flooding was detected in this HTTP/2 session, and it must be closed");
+  const uint64_t length = data.length();
+  if (zero_copy_data_ && length >= MinReferencedDataLength) {
+    // Take ownership of the read slices one at a time so that DATA frame payloads can refer to the
+    // slice they were received in, see onData().
+    Cleanup dispatch_slice_cleanup([this]() { dispatch_slice_.reset(); });
+    while (data.length() != 0) {
+      dispatch_slice_ = std::make_shared<Buffer::OwnedImpl>();
+      dispatch_slice_->move(data, data.getRawSlices(1).front().len_);
+      dispatch_slice_capacity_ = dispatch_slice_->capacity();
+      for (const Buffer::RawSlice& slice : dispatch_slice_->getRawSlices()) {
+        dispatchSlice(slice);
+      }
     }
-    if (rc != static_cast<ssize_t>(slice.len_)) {
-      throw CodecProtocolException(fmt::format("{}", nghttp2_strerror(rc)));
+  } else {
+    for (const Buffer::RawSlice& slice : data.getRawSlices()) {
+      dispatchSlice(slice);
     }
-
-    dispatching_ = false;
+    data.drain(data.length());
   }
 
-  ENVOY_CONN_LOG(trace, "dispatched {} bytes", connection_, data.length());
-  data.drain(data.length());
+  ENVOY_CONN_LOG(trace, "dispatched {} bytes", connection_, length);
 
   // Decoding incoming frames can generate outbound frames so flush pending.
   sendPendingFrames();
 }
 
+void ConnectionImpl::dispatchSlice(const Buffer::RawSlice& slice) {
+  dispatching_ = true;
+  ssize_t rc =
+      nghttp2_session_mem_recv(session_, static_cast<const uint8_t*>(slice.mem_), slice.len_);
+  if (rc == NGHTTP2_ERR_FLOODED || flood_detected_) {
+    throw FrameFloodException(
+        "Flooding was detected in this HTTP/2 session, and it must be closed");
+  }
+  if (rc != static_cast<ssize_t>(slice.len_)) {
+    throw CodecProtocolException(fmt::format("{}", nghttp2_strerror(rc)));
+  }
+
+  dispatching_ = false;
+}
+
 ConnectionImpl::StreamImpl* ConnectionImpl::getStream(int32_t stream_id) {
   return static_cast<StreamImpl*>(nghttp2_session_get_stream_user_data(session_, stream_id));
 }
@@ -499,7 +576,16 @@ int ConnectionImpl::onData(int32_t stream_id, const uint8_t* data, size_t len) {
   StreamImpl* stream = getStream(stream_id);
   // If this results in buffering too much data, the watermark buffer will call
   // pendingRecvBufferHighWatermark, resulting in ++read_disable_count_
-  stream->pending_recv_data_.add(data, len);
+  if (dispatch_slice_ != nullptr && len >= MinReferencedDataLength &&
+      len * 2 >= dispatch_slice_capacity_) {
+    // The payload lies within the read slice being dispatched, so refer to it rather than copy it.
+    // Payloads which cover less than half of the slice are still copied, as referring to them would
+    // keep the rest of the slice alive while they are buffered.
+    stream->pending_recv_data_.addBufferFragment(
+        *new ReceivedDataFragment(dispatch_slice_, data, len));
+  } else {
+    stream->pending_recv_data_.add(data, len);
+  }
   // Update the window to the peer unless some consumer of this stream's data has hit a flow control
   // limit and disabled reads on this stream
   if (!stream->buffers_overrun()) {
@@ -530,6 +616,10 @@ int ConnectionImpl::onBeforeFrameReceived(const nghttp2_frame_hd* hd) {
   ENVOY_CONN_LOG(trace, "about to recv frame type={}, flags={}", connection_,
                  static_cast<uint64_t>(hd->type), static_cast<uint64_t>(hd->flags));
 
+  if (hd->type == NGHTTP2_HEADERS || hd->type == NGHTTP2_CONTINUATION) {
+    stats_.header_block_bytes_rx_.add(hd->length);
+  }
+
   // Track all the frames without padding here, since this is the only callback we receive
   // for some of them (e.g. CONTINUATION frame, frames sent on closed streams, etc.).
   // HEADERS frame is tracked in onBeginHeaders(), DATA frame is tracked in onFrameReceived().
@@ -569,6 +659,19 @@ int ConnectionImpl::onFrameReceived(const nghttp2_frame* frame) {
     onSettingsForTest(frame->settings);
   }
 
+  if (frame->hd.type == NGHTTP2_HEADERS && hpack_tuner_ != nullptr) {
+    const absl::optional<uint32_t> table_size = hpack_tuner_->onHeaderBlockReceived(
+        nghttp2_session_get_hd_inflate_dynamic_table_size(session_));
+    if (table_size.has_value()) {
+      ENVOY_CONN_LOG(debug, "increasing advertised HPACK table size to {}", connection_,
+                     table_size.value());
+      stats_.hpack_table_size_increased_.inc();
+      const nghttp2_settings_entry setting{NGHTTP2_SETTINGS_HEADER_TABLE_SIZE, table_size.value()};
+      const int rc = nghttp2_submit_settings(session_, NGHTTP2_FLAG_NONE, &setting, 1);
+      ASSERT(rc == 0);
+    }
+  }
+
   StreamImpl* stream = getStream(frame->hd.stream_id);
   if (!stream) {
     return 0;
@@ -671,6 +774,8 @@ int ConnectionImpl::onFrameSend(const nghttp2_frame* frame) {
   }
 
   case NGHTTP2_HEADERS:
+    stats_.header_block_bytes_tx_.add(frame->hd.length);
+    FALLTHRU;
   case NGHTTP2_DATA: {
     StreamImpl* stream = getStream(frame->hd.stream_id);
     stream->local_end_stream_sent_ = frame->hd.flags & NGHTTP2_FLAG_END_STREAM;
@@ -858,6 +963,7 @@ ssize_t ConnectionImpl::packMetadata(int32_t stream_id, uint8_t* buf, size_t len
 
 int ConnectionImpl::saveHeader(const nghttp2_frame* frame, HeaderString&& name,
                                HeaderString&& value) {
+  stats_.header_bytes_rx_.add(name.size() + value.size());
   StreamImpl* stream = getStream(frame->hd.stream_id);
   if (!stream) {
     // We have seen 1 or 2 crashes where we get a headers callback but there is no associated
@@ -889,6 +995,25 @@ int ConnectionImpl::saveHeader(const nghttp2_frame* frame, HeaderString&& name,
   }
 }
 
+void ConnectionImpl::prepareHeadersForSend(std::vector<nghttp2_nv>& final_headers) {
+  uint64_t header_bytes = 0;
+  uint64_t never_indexed = 0;
+  for (nghttp2_nv& header : final_headers) {
+    header_bytes += header.namelen + header.valuelen;
+    if (hpack_tuner_ != nullptr &&
+        hpack_tuner_->neverIndex(
+            absl::string_view(reinterpret_cast<const char*>(header.name), header.namelen),
+            absl::string_view(reinterpret_cast<const char*>(header.value), header.valuelen))) {
+      header.flags |= NGHTTP2_NV_FLAG_NO_INDEX;
+      never_indexed++;
+    }
+  }
+  stats_.header_bytes_tx_.add(header_bytes);
+  if (never_indexed > 0) {
+    stats_.hpack_never_indexed_tx_.add(never_indexed);
+  }
+}
+
 void ConnectionImpl::sendPendingFrames() {
   if (dispatching_ || connection_.state() == Network::Connection::State::Closed) {
     return;
@@ -969,7 +1094,9 @@ void ConnectionImpl::sendSettings(
   // Insert named parameters.
   settings.insert(
       settings.end(),
-      {{NGHTTP2_SETTINGS_HEADER_TABLE_SIZE, http2_options.hpack_table_size().value()},
+      {{NGHTTP2_SETTINGS_HEADER_TABLE_SIZE, hpack_tuner_ != nullptr
+                                                ? hpack_tuner_->advertisedTableSize()
+                                                : http2_options.hpack_table_size().value()},
        {NGHTTP2_SETTINGS_ENABLE_CONNECT_PROTOCOL, http2_options.allow_connect()},
        {NGHTTP2_SETTINGS_MAX_CONCURRENT_STREAMS, http2_options.max_concurrent_streams().value()},
        {NGHTTP2_SETTINGS_INITIAL_WINDOW_SIZE, http2_options.initial_stream_window_size().value()}});
@@ -1164,7 +1291,7 @@ ClientConnectionImpl::ClientConnectionImpl(
 }
 
 RequestEncoder& ClientConnectionImpl::newStream(ResponseDecoder& decoder) {
-  ClientStreamImplPtr stream(new ClientStreamImpl(*this, per_stream_buffer_limit_, decoder));
+  ClientStreamImplPtr stream(clientStreamPool().create(*this, per_stream_buffer_limit_, decoder));
   // If the connection is currently above the high watermark, make sure to inform the new stream.
   // The connection can not pass this on automatically as it has no awareness that a new stream is
   // created.
@@ -1232,7 +1359,7 @@ int ServerConnectionImpl::onBeginHeaders(const nghttp2_frame* frame) {
     return 0;
   }
 
-  ServerStreamImplPtr stream(new ServerStreamImpl(*this, per_stream_buffer_limit_));
+  ServerStreamImplPtr stream(serverStreamPool().create(*this, per_stream_buffer_limit_));
   if (connection_.aboveHighWatermark()) {
     stream->runHighWatermarkCallbacks();
   }
@@ -17,9 +17,11 @@
 #include "common/buffer/watermark_buffer.h"
 #include "common/common/linked_object.h"
 #include "common/common/logger.h"
+#include "common/event/object_pool.h"
 #include "common/http/codec_helper.h"
 #include "common/http/header_map_impl.h"
 #include "common/http/http2/metadata_decoder.h"
+#include "common/http/http2/hpack_tuner.h"
 #include "common/http/http2/metadata_encoder.h"
 #include "common/http/utility.h"
 
@@ -41,8 +43,14 @@ const std::string CLIENT_MAGIC_PREFIX = "PRI * HTTP/2";
  */
 #define ALL_HTTP2_CODEC_STATS(COUNTER)                                                             \
   COUNTER(dropped_headers_with_underscores)                                                        \
+  COUNTER(header_block_bytes_rx)                                                                   \
+  COUNTER(header_block_bytes_tx)                                                                   \
+  COUNTER(header_bytes_rx)                                                                         \
+  COUNTER(header_bytes_tx)                                                                         \
   COUNTER(header_overflow)                                                                         \
   COUNTER(headers_cb_no_stream)                                                                    \
+  COUNTER(hpack_never_indexed_tx)                                                                  \
+  COUNTER(hpack_table_size_increased)                                                              \
   COUNTER(inbound_empty_frames_flood)                                                              \
   COUNTER(inbound_priority_frames_flood)                                                           \
   COUNTER(inbound_window_update_frames_flood)                                                      \
@@ -189,7 +197,7 @@ protected:
     ssize_t onDataSourceRead(uint64_t length, uint32_t* data_flags);
     int onDataSourceSend(const uint8_t* framehd, size_t length);
     void resetStreamWorker(StreamResetReason reason);
-    static void buildHeaders(std::vector<nghttp2_nv>& final_headers, const HeaderMap& headers);
+    void buildHeaders(std::vector<nghttp2_nv>& final_headers, const HeaderMap& headers);
     void saveHeader(HeaderString&& name, HeaderString&& value);
     void encodeHeadersBase(const std::vector<nghttp2_nv>& final_headers, bool end_stream);
     virtual void submitHeaders(const std::vector<nghttp2_nv>& final_headers,
@@ -317,6 +325,9 @@ protected:
       }
     }
 
+    // Event::DeferredDeletable
+    bool recycle() override;
+
     // RequestEncoder
     void encodeHeaders(const RequestHeaderMap& headers, bool end_stream) override;
     void encodeTrailers(const RequestTrailerMap& trailers) override {
@@ -355,6 +366,9 @@ protected:
       headers_or_trailers_.emplace<RequestTrailerMapPtr>(std::make_unique<RequestTrailerMapImpl>());
     }
 
+    // Event::DeferredDeletable
+    bool recycle() override;
+
     // ResponseEncoder
     void encode100ContinueHeaders(const ResponseHeaderMap& headers) override;
     void encodeHeaders(const ResponseHeaderMap& headers, bool end_stream) override;
@@ -368,12 +382,19 @@ protected:
 
   using ServerStreamImplPtr = std::unique_ptr<ServerStreamImpl>;
 
+  // Streams are created and destroyed at request rate, so each thread keeps the storage of recently
+  // destroyed streams for the next ones.
+  static Event::ObjectPool<ClientStreamImpl>& clientStreamPool();
+  static Event::ObjectPool<ServerStreamImpl>& serverStreamPool();
+
   ConnectionImpl* base() { return this; }
   // NOTE: Always use non debug nullptr checks against the return value of this function. There are
   // edge cases (such as for METADATA frames) where nghttp2 will issue a callback for a stream_id
   // that is not associated with an existing stream.
   StreamImpl* getStream(int32_t stream_id);
   int saveHeader(const nghttp2_frame* frame, HeaderString&& name, HeaderString&& value);
+  // Accounts for and marks the header fields about to be sent, see HpackTuner.
+  void prepareHeadersForSend(std::vector<nghttp2_nv>& final_headers);
   void sendPendingFrames();
   void sendSettings(const envoy::config::core::v3::Http2ProtocolOptions& http2_options,
                     bool disable_push);
@@ -393,6 +414,13 @@ protected:
     return absl::nullopt;
   }
 
+  // DATA frame payloads of at least this size which cover at least half of the read slice they were
+  // received in are buffered by reference to that slice. A buffered payload therefore never keeps
+  // more than twice its size alive.
+  static constexpr uint64_t MinReferencedDataLength = 4096;
+  // The number of pending send slices considered when ending a DATA frame at a slice boundary.
+  static constexpr uint64_t MaxAlignedFrameSlices = 16;
+
   static Http2Callbacks http2_callbacks_;
 
   std::list<StreamImplPtr> active_streams_;
@@ -405,6 +433,11 @@ protected:
   bool allow_metadata_;
   const bool stream_error_on_invalid_http_messaging_;
   bool flood_detected_;
+  // Whether received DATA frame payloads are buffered by reference and sent DATA frames are ended
+  // at slice boundaries, see onData() and StreamImpl::onDataSourceRead().
+  const bool zero_copy_data_;
+  // Set if adaptive HPACK is enabled.
+  std::unique_ptr<HpackTuner> hpack_tuner_;
 
   // Set if the type of frame that is about to be sent is PING or SETTINGS with the ACK flag set, or
   // RST_STREAM.
@@ -494,7 +527,12 @@ private:
 
   void releaseOutboundFrame(const Buffer::OwnedBufferFragmentImpl* fragment);
   void releaseOutboundControlFrame(const Buffer::OwnedBufferFragmentImpl* fragment);
+  void dispatchSlice(const Buffer::RawSlice& slice);
 
+  // Holds the read slice being dispatched when zero_copy_data_ is set, shared with the received
+  // DATA frame payloads which refer to it, along with the memory held by the slice.
+  std::shared_ptr<Buffer::OwnedImpl> dispatch_slice_;
+  uint64_t dispatch_slice_capacity_{};
   bool dispatching_ : 1;
   bool raised_goaway_ : 1;
   bool pending_deferred_reset_ : 1;
@@ -0,0 +1,499 @@
+#include "common/http/http2/forwarding_conn_pool.h"
+
+#include "common/buffer/buffer_impl.h"
+#include "common/event/deferred_task.h"
+#include "common/http/header_map_impl.h"
+
+namespace Envoy {
+namespace Http {
+namespace Http2 {
+
+namespace {
+
+std::shared_ptr<MetadataMapVector> copyMetadata(const MetadataMapVector& metadata_map_vector) {
+  auto copy = std::make_shared<MetadataMapVector>();
+  for (const MetadataMapPtr& metadata_map : metadata_map_vector) {
+    copy->push_back(std::make_unique<MetadataMap>(*metadata_map));
+  }
+  return copy;
+}
+
+std::shared_ptr<Buffer::Instance> moveBuffer(Buffer::Instance& data) {
+  auto moved = std::make_shared<Buffer::OwnedImpl>();
+  moved->move(data);
+  return moved;
+}
+
+} // namespace
+
+bool DispatcherHandle::post(std::function<void()> callback) {
+  absl::MutexLock lock(&mutex_);
+  if (!valid_) {
+    return false;
+  }
+  dispatcher_.post([handle = shared_from_this(), callback = std::move(callback)]() -> void {
+    if (handle->valid()) {
+      callback();
+    }
+  });
+  return true;
+}
+
+void DispatcherHandle::invalidate() {
+  absl::MutexLock lock(&mutex_);
+  valid_ = false;
+}
+
+bool DispatcherHandle::valid() {
+  absl::MutexLock lock(&mutex_);
+  return valid_;
+}
+
+ForwardingConnPoolImpl::ForwardingConnPoolImpl(Event::Dispatcher& dispatcher,
+                                               DispatcherHandleSharedPtr owner,
+                                               Upstream::HostConstSharedPtr host,
+                                               OwnerConnPoolLookup owner_pool_lookup)
+    : dispatcher_(dispatcher), handle_(std::make_shared<DispatcherHandle>(dispatcher)),
+      owner_(std::move(owner)), host_(std::move(host)),
+      owner_pool_lookup_(std::move(owner_pool_lookup)) {
+  ASSERT(&dispatcher_ != &owner_->dispatcher());
+}
+
+ForwardingConnPoolImpl::~ForwardingConnPoolImpl() {
+  handle_->invalidate();
+  // Tear down any streams which are still in flight so that the owner side releases its upstream
+  // streams. Ready streams are reset as if their connection went away.
+  while (!streams_.empty()) {
+    LocalStreamSharedPtr stream = streams_.front();
+    streams_.pop_front();
+    stream->postToOwner(
+        [](OwnerStream& owner) -> void { owner.reset(StreamResetReason::ConnectionTermination); });
+    stream->finished_ = true;
+    stream->owner_link_->cancelled_ = true;
+    if (stream->callbacks_for_pool_ == nullptr) {
+      for (StreamCallbacks* callbacks : stream->callbacks_) {
+        callbacks->onResetStream(StreamResetReason::ConnectionTermination, absl::string_view());
+      }
+    }
+  }
+}
+
+void ForwardingConnPoolImpl::addDrainedCallback(DrainedCb cb) {
+  drained_callbacks_.push_back(cb);
+  checkForDrained();
+}
+
+void ForwardingConnPoolImpl::checkForDrained() {
+  if (drained_callbacks_.empty() || !streams_.empty()) {
+    return;
+  }
+
+  ENVOY_LOG(debug, "invoking drained callbacks");
+  for (const DrainedCb& cb : drained_callbacks_) {
+    cb();
+  }
+}
+
+ConnectionPool::Cancellable*
+ForwardingConnPoolImpl::newStream(ResponseDecoder& response_decoder,
+                                  ConnectionPool::Callbacks& callbacks) {
+  ENVOY_LOG(debug, "handing over new stream to owner dispatcher");
+  host_->cluster().stats().upstream_rq_cross_worker_.inc();
+
+  auto stream = std::make_shared<LocalStream>(*this, response_decoder, callbacks);
+
+  // The owner half is created on the owner dispatcher, so that the last reference to it is always
+  // dropped there. The owner pool may invoke its callbacks inline, but those are always posted
+  // back to this dispatcher, so the caller is always handed a cancellable handle.
+  if (!owner_->post([link = stream->owner_link_, owner = owner_, local = handle_,
+                     local_stream = std::weak_ptr<LocalStream>(stream),
+                     lookup = owner_pool_lookup_]() -> void {
+        if (link->cancelled_) {
+          return;
+        }
+        auto owner_stream = std::make_shared<OwnerStream>(owner, local, local_stream);
+        link->stream_ = owner_stream;
+        owner_stream->start(lookup);
+      })) {
+    ENVOY_LOG(debug, "owner dispatcher is gone");
+    callbacks.onPoolFailure(ConnectionPool::PoolFailureReason::LocalConnectionFailure,
+                            "owner connection pool unavailable", nullptr);
+    return nullptr;
+  }
+
+  streams_.push_front(stream);
+  stream->entry_ = streams_.begin();
+  return stream.get();
+}
+
+void ForwardingConnPoolImpl::onStreamFinished(LocalStream& stream) {
+  ASSERT(!stream.finished_);
+  stream.finished_ = true;
+  stream.owner_link_->cancelled_ = true;
+  // The stream may be finished from within one of its own methods, so keep it alive until the
+  // end of the current event loop iteration.
+  LocalStreamSharedPtr removed = *stream.entry_;
+  streams_.erase(stream.entry_);
+  Event::DeferredTaskUtil::deferredRun(dispatcher_, [removed]() -> void {});
+  checkForDrained();
+}
+
+//
+// OwnerStream: only ever runs on the owner dispatcher, including its destructor.
+//
+
+ForwardingConnPoolImpl::OwnerStream::~OwnerStream() {
+  if (!released_) {
+    postToLocal([](LocalStream& local) -> void { local.onOwnerGone(); });
+  }
+}
+
+void ForwardingConnPoolImpl::OwnerStream::start(const OwnerConnPoolLookup& owner_pool_lookup) {
+  ConnectionPool::Instance* pool = owner_pool_lookup();
+  if (pool == nullptr) {
+    // The local half is told that the owner is gone once this object is destroyed.
+    return;
+  }
+
+  self_ = shared_from_this();
+  cancellable_ = pool->newStream(*this, *this);
+}
+
+void ForwardingConnPoolImpl::OwnerStream::encodeHeaders(const RequestHeaderMap& headers,
+                                                        bool end_stream) {
+  if (encoder_ == nullptr) {
+    return;
+  }
+  local_complete_ = end_stream;
+  encoder_->encodeHeaders(headers, end_stream);
+  maybeRelease();
+}
+
+void ForwardingConnPoolImpl::OwnerStream::encodeData(Buffer::Instance& data, bool end_stream) {
+  if (encoder_ == nullptr) {
+    return;
+  }
+  local_complete_ = end_stream;
+  encoder_->encodeData(data, end_stream);
+  maybeRelease();
+}
+
+void ForwardingConnPoolImpl::OwnerStream::encodeTrailers(const RequestTrailerMap& trailers) {
+  if (encoder_ == nullptr) {
+    return;
+  }
+  local_complete_ = true;
+  encoder_->encodeTrailers(trailers);
+  maybeRelease();
+}
+
+void ForwardingConnPoolImpl::OwnerStream::encodeMetadata(
+    const MetadataMapVector& metadata_map_vector) {
+  if (encoder_ != nullptr) {
+    encoder_->encodeMetadata(metadata_map_vector);
+  }
+}
+
+void ForwardingConnPoolImpl::OwnerStream::readDisable(bool disable) {
+  if (encoder_ != nullptr) {
+    encoder_->getStream().readDisable(disable);
+  }
+}
+
+void ForwardingConnPoolImpl::OwnerStream::reset(StreamResetReason reason) {
+  cancelled_ = true;
+  if (encoder_ != nullptr) {
+    // This calls back into onResetStream(), which releases this stream.
+    encoder_->getStream().resetStream(reason);
+    return;
+  }
+
+  if (cancellable_ != nullptr) {
+    cancellable_->cancel();
+    cancellable_ = nullptr;
+  }
+  release();
+}
+
+void ForwardingConnPoolImpl::OwnerStream::decode100ContinueHeaders(
+    ResponseHeaderMapPtr&& headers) {
+  auto holder = std::make_shared<ResponseHeaderMapPtr>(std::move(headers));
+  postToLocal([holder](LocalStream& local) -> void {
+    local.decode100ContinueHeaders(std::move(*holder));
+  });
+}
+
+void ForwardingConnPoolImpl::OwnerStream::decodeHeaders(ResponseHeaderMapPtr&& headers,
+                                                        bool end_stream) {
+  auto holder = std::make_shared<ResponseHeaderMapPtr>(std::move(headers));
+  postToLocal([holder, end_stream](LocalStream& local) -> void {
+    local.decodeHeaders(std::move(*holder), end_stream);
+  });
+  if (end_stream) {
+    remote_complete_ = true;
+    maybeRelease();
+  }
+}
+
+void ForwardingConnPoolImpl::OwnerStream::decodeData(Buffer::Instance& data, bool end_stream) {
+  std::shared_ptr<Buffer::Instance> moved = moveBuffer(data);
+  postToLocal([moved, end_stream](LocalStream& local) -> void {
+    local.decodeData(*moved, end_stream);
+  });
+  if (end_stream) {
+    remote_complete_ = true;
+    maybeRelease();
+  }
+}
+
+void ForwardingConnPoolImpl::OwnerStream::decodeTrailers(ResponseTrailerMapPtr&& trailers) {
+  auto holder = std::make_shared<ResponseTrailerMapPtr>(std::move(trailers));
+  postToLocal([holder](LocalStream& local) -> void { local.decodeTrailers(std::move(*holder)); });
+  remote_complete_ = true;
+  maybeRelease();
+}
+
+void ForwardingConnPoolImpl::OwnerStream::decodeMetadata(MetadataMapPtr&& metadata_map) {
+  auto holder = std::make_shared<MetadataMapPtr>(std::move(metadata_map));
+  postToLocal([holder](LocalStream& local) -> void { local.decodeMetadata(std::move(*holder)); });
+}
+
+void ForwardingConnPoolImpl::OwnerStream::onPoolFailure(
+    ConnectionPool::PoolFailureReason reason, absl::string_view transport_failure_reason,
+    Upstream::HostDescriptionConstSharedPtr host) {
+  cancellable_ = nullptr;
+  postToLocal([reason, details = std::string(transport_failure_reason),
+               host](LocalStream& local) -> void { local.onPoolFailure(reason, details, host); });
+  release();
+}
+
+void ForwardingConnPoolImpl::OwnerStream::onPoolReady(RequestEncoder& encoder,
+                                                      Upstream::HostDescriptionConstSharedPtr host,
+                                                      const StreamInfo::StreamInfo& info) {
+  cancellable_ = nullptr;
+  encoder_ = &encoder;
+  encoder_->getStream().addCallbacks(*this);
+  if (cancelled_) {
+    // The local stream went away while the handover was in flight.
+    encoder_->getStream().resetStream(StreamResetReason::LocalReset);
+    return;
+  }
+
+  ReadyStreamInfo ready_info;
+  ready_info.host_ = std::move(host);
+  ready_info.connection_local_address_ = encoder.getStream().connectionLocalAddress();
+  ready_info.ssl_connection_ = info.downstreamSslConnection();
+  ready_info.buffer_limit_ = encoder.getStream().bufferLimit();
+  auto shared_info = std::make_shared<ReadyStreamInfo>(std::move(ready_info));
+  postToLocal([shared_info](LocalStream& local) -> void {
+    local.onPoolReady(std::move(*shared_info));
+  });
+}
+
+void ForwardingConnPoolImpl::OwnerStream::onResetStream(
+    StreamResetReason reason, absl::string_view transport_failure_reason) {
+  encoder_ = nullptr;
+  postToLocal([reason, details = std::string(transport_failure_reason)](LocalStream& local) {
+    local.onResetStream(reason, details);
+  });
+  release();
+}
+
+void ForwardingConnPoolImpl::OwnerStream::onAboveWriteBufferHighWatermark() {
+  postToLocal([](LocalStream& local) -> void { local.onAboveWriteBufferHighWatermark(); });
+}
+
+void ForwardingConnPoolImpl::OwnerStream::onBelowWriteBufferLowWatermark() {
+  postToLocal([](LocalStream& local) -> void { local.onBelowWriteBufferLowWatermark(); });
+}
+
+void ForwardingConnPoolImpl::OwnerStream::postToLocal(std::function<void(LocalStream&)> cb) {
+  local_->post([local = local_stream_, cb]() -> void {
+    LocalStreamSharedPtr stream = local.lock();
+    if (stream != nullptr && !stream->finished_) {
+      cb(*stream);
+    }
+  });
+}
+
+void ForwardingConnPoolImpl::OwnerStream::maybeRelease() {
+  // Once both directions are complete the codec destroys the upstream stream.
+  if (local_complete_ && remote_complete_) {
+    release();
+  }
+}
+
+void ForwardingConnPoolImpl::OwnerStream::release() {
+  released_ = true;
+  if (encoder_ != nullptr) {
+    encoder_->getStream().removeCallbacks(*this);
+    encoder_ = nullptr;
+  }
+  // Drop the self reference at the end of the current event loop iteration, as this may be
+  // called from within codec or pool callbacks which still reference this object.
+  if (self_ != nullptr) {
+    Event::DeferredTaskUtil::deferredRun(owner_->dispatcher(),
+                                         [self = std::move(self_)]() -> void {});
+  }
+}
+
+//
+// LocalStream: only ever runs on the local dispatcher.
+//
+
+ForwardingConnPoolImpl::LocalStream::LocalStream(ForwardingConnPoolImpl& parent,
+                                                 ResponseDecoder& response_decoder,
+                                                 ConnectionPool::Callbacks& callbacks)
+    : parent_(parent), response_decoder_(response_decoder), callbacks_for_pool_(&callbacks),
+      stream_info_(Protocol::Http2, parent.dispatcher_.timeSource()) {}
+
+void ForwardingConnPoolImpl::LocalStream::onPoolFailure(
+    ConnectionPool::PoolFailureReason reason, const std::string& transport_failure_reason,
+    Upstream::HostDescriptionConstSharedPtr host) {
+  ConnectionPool::Callbacks* callbacks = callbacks_for_pool_;
+  callbacks_for_pool_ = nullptr;
+  parent_.onStreamFinished(*this);
+  callbacks->onPoolFailure(reason, transport_failure_reason, host);
+}
+
+void ForwardingConnPoolImpl::LocalStream::onPoolReady(ReadyStreamInfo&& info) {
+  ready_info_ = std::move(info);
+  stream_info_.setDownstreamSslConnection(ready_info_.ssl_connection_);
+  ConnectionPool::Callbacks* callbacks = callbacks_for_pool_;
+  callbacks_for_pool_ = nullptr;
+  callbacks->onPoolReady(*this, ready_info_.host_, stream_info_);
+}
+
+void ForwardingConnPoolImpl::LocalStream::onResetStream(
+    StreamResetReason reason, const std::string& transport_failure_reason) {
+  parent_.onStreamFinished(*this);
+  for (StreamCallbacks* callbacks : callbacks_) {
+    callbacks->onResetStream(reason, transport_failure_reason);
+  }
+}
+
+void ForwardingConnPoolImpl::LocalStream::onOwnerGone() {
+  if (callbacks_for_pool_ != nullptr) {
+    onPoolFailure(ConnectionPool::PoolFailureReason::LocalConnectionFailure,
+                  "owner connection pool unavailable", nullptr);
+  } else {
+    onResetStream(StreamResetReason::ConnectionTermination, "");
+  }
+}
+
+void ForwardingConnPoolImpl::LocalStream::onAboveWriteBufferHighWatermark() {
+  for (StreamCallbacks* callbacks : callbacks_) {
+    callbacks->onAboveWriteBufferHighWatermark();
+  }
+}
+
+void ForwardingConnPoolImpl::LocalStream::onBelowWriteBufferLowWatermark() {
+  for (StreamCallbacks* callbacks : callbacks_) {
+    callbacks->onBelowWriteBufferLowWatermark();
+  }
+}
+
+void ForwardingConnPoolImpl::LocalStream::decode100ContinueHeaders(
+    ResponseHeaderMapPtr&& headers) {
+  response_decoder_.decode100ContinueHeaders(std::move(headers));
+}
+
+void ForwardingConnPoolImpl::LocalStream::decodeHeaders(ResponseHeaderMapPtr&& headers,
+                                                        bool end_stream) {
+  remote_complete_ = end_stream;
+  response_decoder_.decodeHeaders(std::move(headers), end_stream);
+  maybeFinish();
+}
+
+void ForwardingConnPoolImpl::LocalStream::decodeData(Buffer::Instance& data, bool end_stream) {
+  remote_complete_ = end_stream;
+  response_decoder_.decodeData(data, end_stream);
+  maybeFinish();
+}
+
+void ForwardingConnPoolImpl::LocalStream::decodeTrailers(ResponseTrailerMapPtr&& trailers) {
+  remote_complete_ = true;
+  response_decoder_.decodeTrailers(std::move(trailers));
+  maybeFinish();
+}
+
+void ForwardingConnPoolImpl::LocalStream::decodeMetadata(MetadataMapPtr&& metadata_map) {
+  response_decoder_.decodeMetadata(std::move(metadata_map));
+}
+
+void ForwardingConnPoolImpl::LocalStream::cancel() {
+  ENVOY_LOG(debug, "cancelling handed over stream");
+  callbacks_for_pool_ = nullptr;
+  postToOwner([](OwnerStream& owner) -> void { owner.reset(StreamResetReason::LocalReset); });
+  parent_.onStreamFinished(*this);
+}
+
+void ForwardingConnPoolImpl::LocalStream::encodeHeaders(const RequestHeaderMap& headers,
+                                                        bool end_stream) {
+  local_complete_ = end_stream;
+  std::shared_ptr<RequestHeaderMap> copy = createHeaderMap<RequestHeaderMapImpl>(headers);
+  postToOwner([copy, end_stream](OwnerStream& owner) -> void {
+    owner.encodeHeaders(*copy, end_stream);
+  });
+  maybeFinish();
+}
+
+void ForwardingConnPoolImpl::LocalStream::encodeData(Buffer::Instance& data, bool end_stream) {
+  local_complete_ = end_stream;
+  std::shared_ptr<Buffer::Instance> moved = moveBuffer(data);
+  postToOwner(
+      [moved, end_stream](OwnerStream& owner) -> void { owner.encodeData(*moved, end_stream); });
+  maybeFinish();
+}
+
+void ForwardingConnPoolImpl::LocalStream::encodeTrailers(const RequestTrailerMap& trailers) {
+  local_complete_ = true;
+  std::shared_ptr<RequestTrailerMap> copy = createHeaderMap<RequestTrailerMapImpl>(trailers);
+  postToOwner([copy](OwnerStream& owner) -> void { owner.encodeTrailers(*copy); });
+  maybeFinish();
+}
+
+void ForwardingConnPoolImpl::LocalStream::encodeMetadata(
+    const MetadataMapVector& metadata_map_vector) {
+  std::shared_ptr<MetadataMapVector> copy = copyMetadata(metadata_map_vector);
+  postToOwner([copy](OwnerStream& owner) -> void { owner.encodeMetadata(*copy); });
+}
+
+void ForwardingConnPoolImpl::LocalStream::resetStream(StreamResetReason reason) {
+  if (finished_) {
+    return;
+  }
+  postToOwner([reason](OwnerStream& owner) -> void { owner.reset(reason); });
+  parent_.onStreamFinished(*this);
+  for (StreamCallbacks* callbacks : callbacks_) {
+    callbacks->onResetStream(reason, absl::string_view());
+  }
+}
+
+void ForwardingConnPoolImpl::LocalStream::readDisable(bool disable) {
+  postToOwner([disable](OwnerStream& owner) -> void { owner.readDisable(disable); });
+}
+
+void ForwardingConnPoolImpl::LocalStream::postToOwner(std::function<void(OwnerStream&)> cb) {
+  if (finished_) {
+    return;
+  }
+  // Only the link is posted: the owner half is looked up, and any reference to it dropped, on the
+  // owner dispatcher. If the post fails the owner has shut down and has destroyed the owner half.
+  parent_.owner_->post([link = owner_link_, cb]() -> void {
+    OwnerStreamSharedPtr owner = link->stream_.lock();
+    if (owner != nullptr) {
+      cb(*owner);
+    }
+  });
+}
+
+void ForwardingConnPoolImpl::LocalStream::maybeFinish() {
+  if (local_complete_ && remote_complete_ && !finished_) {
+    parent_.onStreamFinished(*this);
+  }
+}
+
+} // namespace Http2
+} // namespace Http
+} // namespace Envoy
@@ -0,0 +1,275 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <memory>
+
+#include "envoy/event/dispatcher.h"
+#include "envoy/http/codec.h"
+#include "envoy/http/conn_pool.h"
+#include "envoy/ssl/connection.h"
+#include "envoy/upstream/upstream.h"
+
+#include "common/common/logger.h"
+#include "common/common/thread_annotations.h"
+#include "common/stream_info/stream_info_impl.h"
+
+#include "absl/synchronization/mutex.h"
+
+namespace Envoy {
+namespace Http {
+namespace Http2 {
+
+/**
+ * A reference to a dispatcher which other threads may post to for as long as the objects its
+ * callbacks refer to exist. Once the handle is invalidated, posts fail and callbacks which were
+ * posted before but have not run yet are dropped without running.
+ */
+class DispatcherHandle : public std::enable_shared_from_this<DispatcherHandle> {
+public:
+  explicit DispatcherHandle(Event::Dispatcher& dispatcher) : dispatcher_(dispatcher) {}
+
+  /**
+   * Post a callback to the dispatcher. Thread-safe.
+   * @return bool whether the callback was posted, i.e. the handle was still valid.
+   */
+  bool post(std::function<void()> callback);
+
+  /**
+   * Invalidate the handle. Must be called on the dispatcher's thread.
+   */
+  void invalidate();
+
+  /**
+   * @return Event::Dispatcher& the dispatcher. Must only be used on the dispatcher's thread.
+   */
+  Event::Dispatcher& dispatcher() { return dispatcher_; }
+
+private:
+  bool valid();
+
+  Event::Dispatcher& dispatcher_;
+  absl::Mutex mutex_;
+  bool valid_ ABSL_GUARDED_BY(mutex_){true};
+};
+
+using DispatcherHandleSharedPtr = std::shared_ptr<DispatcherHandle>;
+
+/**
+ * Looks up the connection pool which owns upstream connections on behalf of a forwarding pool.
+ * Always invoked on the owner's dispatcher, by a callback posted through the owner's handle. May
+ * return nullptr if the owner no longer knows about the cluster or host.
+ */
+using OwnerConnPoolLookup = std::function<ConnectionPool::Instance*()>;
+
+/**
+ * HTTP/2 connection pool which does not own any connections. Each stream is handed over to a pool
+ * that lives on another worker's dispatcher, and all stream events are posted between the two
+ * dispatchers. This trades a cross-thread hop per stream event for far fewer upstream connections
+ * when many workers talk to the same set of hosts.
+ *
+ * Request headers, trailers and body data are copied or moved into thread-private objects before
+ * they are posted, so neither side ever touches objects owned by the other dispatcher. All posts go
+ * through dispatcher handles, so a side which has shut down is never posted to. Streams whose other
+ * side shuts down are failed or reset.
+ */
+class ForwardingConnPoolImpl : public ConnectionPool::Instance,
+                               protected Logger::Loggable<Logger::Id::pool> {
+public:
+  ForwardingConnPoolImpl(Event::Dispatcher& dispatcher, DispatcherHandleSharedPtr owner,
+                         Upstream::HostConstSharedPtr host, OwnerConnPoolLookup owner_pool_lookup);
+  ~ForwardingConnPoolImpl() override;
+
+  // ConnectionPool::Instance
+  Http::Protocol protocol() const override { return Http::Protocol::Http2; }
+  void addDrainedCallback(DrainedCb cb) override;
+  // Connections are owned, and drained, by the owner pool.
+  void drainConnections() override {}
+  bool hasActiveConnections() const override { return !streams_.empty(); }
+  ConnectionPool::Cancellable* newStream(ResponseDecoder& response_decoder,
+                                         ConnectionPool::Callbacks& callbacks) override;
+  Upstream::HostDescriptionConstSharedPtr host() const override { return host_; }
+
+private:
+  class LocalStream;
+  using LocalStreamSharedPtr = std::shared_ptr<LocalStream>;
+
+  // Properties of the owner's upstream stream which are captured on the owner dispatcher when the
+  // stream becomes ready and handed to the local side by value.
+  struct ReadyStreamInfo {
+    Upstream::HostDescriptionConstSharedPtr host_;
+    Network::Address::InstanceConstSharedPtr connection_local_address_;
+    Ssl::ConnectionInfoConstSharedPtr ssl_connection_;
+    uint32_t buffer_limit_{};
+  };
+
+  class OwnerStream;
+
+  /**
+   * Links the local half of a forwarded stream to its owner half. The owner half is created,
+   * referenced and destroyed only on the owner dispatcher, so the local half never holds a
+   * reference to it which could end up being the last one.
+   */
+  struct OwnerStreamLink {
+    // Only accessed on the owner dispatcher.
+    std::weak_ptr<OwnerStream> stream_;
+    // Set by the local half once it is finished, so that a handover which has not started yet is
+    // skipped.
+    std::atomic<bool> cancelled_{false};
+  };
+
+  using OwnerStreamLinkSharedPtr = std::shared_ptr<OwnerStreamLink>;
+
+  /**
+   * The half of a forwarded stream which lives on the owner dispatcher. It is created, accessed
+   * and destroyed only on the owner dispatcher, and only refers to the local half via a weak
+   * pointer used inside callbacks posted back to the local dispatcher. If it is destroyed before
+   * the stream is complete, e.g. because the owner shut down, the local half is told that the
+   * owner is gone.
+   */
+  class OwnerStream : public ResponseDecoder,
+                      public ConnectionPool::Callbacks,
+                      public StreamCallbacks,
+                      public std::enable_shared_from_this<OwnerStream> {
+  public:
+    OwnerStream(DispatcherHandleSharedPtr owner, DispatcherHandleSharedPtr local,
+                std::weak_ptr<LocalStream> local_stream)
+        : owner_(std::move(owner)), local_(std::move(local)),
+          local_stream_(std::move(local_stream)) {}
+    ~OwnerStream() override;
+
+    void start(const OwnerConnPoolLookup& owner_pool_lookup);
+    void encodeHeaders(const RequestHeaderMap& headers, bool end_stream);
+    void encodeData(Buffer::Instance& data, bool end_stream);
+    void encodeTrailers(const RequestTrailerMap& trailers);
+    void encodeMetadata(const MetadataMapVector& metadata_map_vector);
+    void readDisable(bool disable);
+    void reset(StreamResetReason reason);
+
+    // ResponseDecoder
+    void decode100ContinueHeaders(ResponseHeaderMapPtr&& headers) override;
+    void decodeHeaders(ResponseHeaderMapPtr&& headers, bool end_stream) override;
+    void decodeData(Buffer::Instance& data, bool end_stream) override;
+    void decodeTrailers(ResponseTrailerMapPtr&& trailers) override;
+    void decodeMetadata(MetadataMapPtr&& metadata_map) override;
+
+    // ConnectionPool::Callbacks
+    void onPoolFailure(ConnectionPool::PoolFailureReason reason,
+                       absl::string_view transport_failure_reason,
+                       Upstream::HostDescriptionConstSharedPtr host) override;
+    void onPoolReady(RequestEncoder& encoder, Upstream::HostDescriptionConstSharedPtr host,
+                     const StreamInfo::StreamInfo& info) override;
+
+    // StreamCallbacks
+    void onResetStream(StreamResetReason reason,
+                       absl::string_view transport_failure_reason) override;
+    void onAboveWriteBufferHighWatermark() override;
+    void onBelowWriteBufferLowWatermark() override;
+
+  private:
+    void postToLocal(std::function<void(LocalStream&)> cb);
+    void maybeRelease();
+    void release();
+
+    const DispatcherHandleSharedPtr owner_;
+    const DispatcherHandleSharedPtr local_;
+    const std::weak_ptr<LocalStream> local_stream_;
+    // Keeps this object alive while the owner pool or codec hold references to it.
+    std::shared_ptr<OwnerStream> self_;
+    ConnectionPool::Cancellable* cancellable_{};
+    RequestEncoder* encoder_{};
+    bool local_complete_{};
+    bool remote_complete_{};
+    bool cancelled_{};
+    // Set once the local half has been told how the stream ends, or does not need to be.
+    bool released_{};
+  };
+
+  using OwnerStreamSharedPtr = std::shared_ptr<OwnerStream>;
+
+  /**
+   * The half of a forwarded stream which lives on the local dispatcher. It acts as the pending
+   * request handle and, once ready, as the request encoder handed to the pool user.
+   */
+  class LocalStream : public ConnectionPool::Cancellable,
+                      public RequestEncoder,
+                      public Stream,
+                      public std::enable_shared_from_this<LocalStream> {
+  public:
+    LocalStream(ForwardingConnPoolImpl& parent, ResponseDecoder& response_decoder,
+                ConnectionPool::Callbacks& callbacks);
+
+    void onPoolFailure(ConnectionPool::PoolFailureReason reason,
+                       const std::string& transport_failure_reason,
+                       Upstream::HostDescriptionConstSharedPtr host);
+    void onPoolReady(ReadyStreamInfo&& info);
+    void onResetStream(StreamResetReason reason, const std::string& transport_failure_reason);
+    void onOwnerGone();
+    void onAboveWriteBufferHighWatermark();
+    void onBelowWriteBufferLowWatermark();
+    void decode100ContinueHeaders(ResponseHeaderMapPtr&& headers);
+    void decodeHeaders(ResponseHeaderMapPtr&& headers, bool end_stream);
+    void decodeData(Buffer::Instance& data, bool end_stream);
+    void decodeTrailers(ResponseTrailerMapPtr&& trailers);
+    void decodeMetadata(MetadataMapPtr&& metadata_map);
+
+    // ConnectionPool::Cancellable
+    void cancel() override;
+
+    // RequestEncoder
+    void encodeHeaders(const RequestHeaderMap& headers, bool end_stream) override;
+    void encodeData(Buffer::Instance& data, bool end_stream) override;
+    void encodeTrailers(const RequestTrailerMap& trailers) override;
+    void encodeMetadata(const MetadataMapVector& metadata_map_vector) override;
+    Stream& getStream() override { return *this; }
+    Http1StreamEncoderOptionsOptRef http1StreamEncoderOptions() override { return absl::nullopt; }
+
+    // Stream
+    void addCallbacks(StreamCallbacks& callbacks) override { callbacks_.push_back(&callbacks); }
+    void removeCallbacks(StreamCallbacks& callbacks) override { callbacks_.remove(&callbacks); }
+    void resetStream(StreamResetReason reason) override;
+    void readDisable(bool disable) override;
+    uint32_t bufferLimit() override { return ready_info_.buffer_limit_; }
+    const Network::Address::InstanceConstSharedPtr& connectionLocalAddress() override {
+      return ready_info_.connection_local_address_;
+    }
+
+    ForwardingConnPoolImpl& parent_;
+    ResponseDecoder& response_decoder_;
+    ConnectionPool::Callbacks* callbacks_for_pool_;
+    // The owner half is kept alive by itself once it has been handed to the owner pool, and is
+    // otherwise only referenced on the owner dispatcher.
+    const OwnerStreamLinkSharedPtr owner_link_{std::make_shared<OwnerStreamLink>()};
+    std::list<LocalStreamSharedPtr>::iterator entry_;
+    std::list<StreamCallbacks*> callbacks_;
+    ReadyStreamInfo ready_info_;
+    StreamInfo::StreamInfoImpl stream_info_;
+    bool local_complete_{};
+    bool remote_complete_{};
+    bool finished_{};
+
+    void postToOwner(std::function<void(OwnerStream&)> cb);
+
+  private:
+    void maybeFinish();
+  };
+
+  void onStreamFinished(LocalStream& stream);
+  void checkForDrained();
+
+  Event::Dispatcher& dispatcher_;
+  // Invalidated when this pool is destroyed, so the owner never posts to a dispatcher which may
+  // be gone.
+  const DispatcherHandleSharedPtr handle_;
+  const DispatcherHandleSharedPtr owner_;
+  const Upstream::HostConstSharedPtr host_;
+  const OwnerConnPoolLookup owner_pool_lookup_;
+  std::list<LocalStreamSharedPtr> streams_;
+  std::list<DrainedCb> drained_callbacks_;
+};
+
+} // namespace Http2
+} // namespace Http
+} // namespace Envoy
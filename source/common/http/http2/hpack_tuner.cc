@@ -0,0 +1,81 @@
+#include "common/http/http2/hpack_tuner.h"
+
+#include <algorithm>
+
+#include "common/common/macros.h"
+
+#include "absl/container/flat_hash_set.h"
+#include "absl/hash/hash.h"
+
+namespace Envoy {
+namespace Http {
+namespace Http2 {
+
+namespace {
+
+// The table size advertised to the peer before any adaptation, which is the HTTP/2 default.
+constexpr uint32_t InitialTableSize = 4096;
+
+// Headers whose values are unique to each request.
+const absl::flat_hash_set<absl::string_view>& perRequestHeaders() {
+  CONSTRUCT_ON_FIRST_USE(absl::flat_hash_set<absl::string_view>, "x-request-id",
+                         "x-client-trace-id", "x-b3-traceid", "x-b3-spanid", "x-b3-parentspanid",
+                         "b3", "traceparent", "x-ot-span-context", "x-datadog-trace-id",
+                         "x-datadog-parent-id", "x-amzn-trace-id", "uber-trace-id",
+                         "x-cloud-trace-context", "grpc-trace-bin");
+}
+
+} // namespace
+
+HpackTuner::HpackTuner(uint32_t max_table_size)
+    : max_table_size_(max_table_size),
+      advertised_table_size_(std::min(max_table_size, InitialTableSize)) {}
+
+bool HpackTuner::neverIndex(absl::string_view name, absl::string_view value) {
+  if (perRequestHeaders().contains(name)) {
+    return true;
+  }
+
+  auto it = tracked_names_.find(name);
+  if (it == tracked_names_.end()) {
+    if (tracked_names_.size() >= MaxTrackedNames) {
+      return false;
+    }
+    it = tracked_names_.emplace(std::string(name), TrackedName()).first;
+  }
+  TrackedName& tracked = it->second;
+  const size_t value_hash = absl::Hash<absl::string_view>()(value);
+  if (tracked.sends_ > 0 && tracked.value_hash_ != value_hash) {
+    tracked.changes_++;
+  }
+  tracked.value_hash_ = value_hash;
+  tracked.sends_++;
+  const bool never_index =
+      tracked.sends_ >= MinSendsToJudge && tracked.changes_ * 4 >= tracked.sends_ * 3;
+  // Decay the counts so that a header whose values settle down is indexed again.
+  if (tracked.sends_ == 256) {
+    tracked.sends_ /= 2;
+    tracked.changes_ /= 2;
+  }
+  return never_index;
+}
+
+absl::optional<uint32_t> HpackTuner::onHeaderBlockReceived(size_t table_size) {
+  if (++received_blocks_ < TableSizeSampleBlocks) {
+    return absl::nullopt;
+  }
+  received_blocks_ = 0;
+  // The peer evicts entries to stay within the advertised size, so a table which is nearly full
+  // suggests that a larger one would be used.
+  if (advertised_table_size_ >= max_table_size_ ||
+      table_size < static_cast<uint64_t>(advertised_table_size_) * 3 / 4) {
+    return absl::nullopt;
+  }
+  advertised_table_size_ = static_cast<uint32_t>(
+      std::min<uint64_t>(max_table_size_, static_cast<uint64_t>(advertised_table_size_) * 2));
+  return advertised_table_size_;
+}
+
+} // namespace Http2
+} // namespace Http
+} // namespace Envoy
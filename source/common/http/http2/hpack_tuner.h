@@ -0,0 +1,74 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/strings/string_view.h"
+#include "absl/types/optional.h"
+
+namespace Envoy {
+namespace Http {
+namespace Http2 {
+
+/**
+ * Adapts the use of the HPACK dynamic tables of one HTTP/2 connection to the headers seen on it.
+ *
+ * On the encoder side, header fields which are not worth indexing are identified so that they can
+ * be sent as never-indexed rather than evicting reusable entries from the peer's dynamic table.
+ * These are fields with well-known per-request values, such as request and trace IDs, and fields
+ * whose values have changed on most of the header blocks sent on the connection.
+ *
+ * On the decoder side, the dynamic table size advertised to the peer starts small and is doubled,
+ * up to the configured maximum, each time the peer is found to have filled the table. Connections
+ * whose peers do not make use of a large table therefore do not hold one.
+ */
+class HpackTuner {
+public:
+  /**
+   * @param max_table_size supplies the largest dynamic table size to advertise to the peer.
+   */
+  explicit HpackTuner(uint32_t max_table_size);
+
+  /**
+   * @param name supplies the name of a header field about to be sent.
+   * @param value supplies the value of the header field.
+   * @return whether the header field should be sent as never-indexed.
+   */
+  bool neverIndex(absl::string_view name, absl::string_view value);
+
+  /**
+   * Called when a header block has been received.
+   * @param table_size supplies the current size of the decoder's dynamic table.
+   * @return the new dynamic table size to advertise to the peer, if it should change.
+   */
+  absl::optional<uint32_t> onHeaderBlockReceived(size_t table_size);
+
+  /**
+   * @return the dynamic table size currently advertised to the peer.
+   */
+  uint32_t advertisedTableSize() const { return advertised_table_size_; }
+
+  // The number of header blocks received between checks of the decoder's dynamic table.
+  static constexpr uint32_t TableSizeSampleBlocks = 64;
+  // The number of distinct header names whose values are tracked.
+  static constexpr uint32_t MaxTrackedNames = 64;
+  // The number of times a header field must have been sent before its value changes are judged.
+  static constexpr uint32_t MinSendsToJudge = 8;
+
+private:
+  struct TrackedName {
+    size_t value_hash_{};
+    uint32_t sends_{};
+    uint32_t changes_{};
+  };
+
+  const uint32_t max_table_size_;
+  uint32_t advertised_table_size_;
+  uint32_t received_blocks_{};
+  absl::flat_hash_map<std::string, TrackedName> tracked_names_;
+};
+
+} // namespace Http2
+} // namespace Http
+} // namespace Envoy
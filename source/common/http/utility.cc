@@ -404,6 +404,14 @@ Utility::parseHttp1Settings(const envoy::config::core::v3::Http1ProtocolOptions&
     ret.header_key_format_ = Http1Settings::HeaderKeyFormat::Default;
   }
 
+  if (config.parser_backend() == envoy::config::core::v3::Http1ProtocolOptions::HEAD_SCANNER) {
+    ret.parser_backend_ = Http1Settings::ParserBackend::HeadScanner;
+  } else {
+    ret.parser_backend_ = Http1Settings::ParserBackend::HttpParser;
+  }
+
+  ret.max_pipeline_depth_ = PROTOBUF_GET_WRAPPED_OR_DEFAULT(config, max_pipeline_depth, 1);
+
   return ret;
 }
 
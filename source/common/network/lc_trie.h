@@ -2,6 +2,12 @@
 
 #include <algorithm>
 #include <climits>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <map>
+#include <string>
+#include <type_traits>
 #include <unordered_set>
 #include <vector>
 
@@ -15,6 +21,8 @@
 #include "common/network/utility.h"
 
 #include "absl/numeric/int128.h"
+#include "absl/strings/string_view.h"
+#include "absl/types/span.h"
 #include "fmt/format.h"
 
 namespace Envoy {
@@ -28,6 +36,14 @@ namespace LcTrie {
  */
 constexpr size_t MaxLcTrieNodes = (1 << 20);
 
+/**
+ * Minimum number of IPv4 CIDR ranges for which a DIR-24-8 table is used instead of an LC trie, if
+ * the trie is built with ipv4_direct_table set. The table resolves any address in at most two
+ * memory accesses and has no limit on the number of ranges, but has a fixed size of 64 MiB plus
+ * 1 KiB per /24 holding longer prefixes.
+ */
+constexpr size_t MinIpv4DirectTableRanges = (1 << 16);
+
 /**
  * Level Compressed Trie for associating data with CIDR ranges. Both IPv4 and IPv6 addresses are
  * supported within this class with no calling pattern changes.
@@ -36,7 +52,11 @@ constexpr size_t MaxLcTrieNodes = (1 << 20);
  * by 'S. Nilsson' and 'G. Karlsson'. The paper and reference C implementation can be found here:
  * https://www.nada.kth.se/~snilsson/publications/IP-address-lookup-using-LC-tries/
  *
- * Refer to LcTrieInternal for implementation and algorithm details.
+ * Refer to LcTrieInternal for implementation and algorithm details. Large IPv4 tables may be held
+ * in a DIR-24-8 table instead, refer to Ipv4DirectTable.
+ *
+ * A trie of strings can be saved with snapshot() and loaded again without being built, refer to
+ * LcTrie(absl::string_view).
  */
 template <class T> class LcTrie {
 public:
@@ -47,6 +67,9 @@ public:
    * @param fill_factor supplies the fraction of completeness to use when calculating the branch
    *                    value for a sub-trie.
    * @param root_branching_factor supplies the branching factor at the root.
+   * @param ipv4_direct_table if true, IPv4 ranges are held in a DIR-24-8 table rather than an LC
+   *                          trie when there are at least MinIpv4DirectTableRanges of them. Only
+   *                          worth its 64 MiB for very large tables, e.g. IP tags.
    *
    * TODO(ccaraman): Investigate if a non-zero root branching factor should be the default. The
    * paper suggests for large LC-Tries to use the value '16'. It reduces the depth of the trie.
@@ -55,17 +78,32 @@ public:
    * let consumers decide.
    */
   LcTrie(const std::vector<std::pair<T, std::vector<Address::CidrRange>>>& data,
-         bool exclusive = false, double fill_factor = 0.5, uint32_t root_branching_factor = 0) {
+         bool exclusive = false, double fill_factor = 0.5, uint32_t root_branching_factor = 0,
+         bool ipv4_direct_table = false) {
 
     // The LcTrie implementation uses 20-bit "pointers" in its compact internal representation,
     // so it cannot hold more than 2^20 nodes. But the number of nodes can be greater than the
     // number of supported prefixes. Given N prefixes in the data input list, step 2 below can
     // produce a new list of up to 2*N prefixes to insert in the LC trie. And the LC trie can
     // use up to 2*N/fill_factor nodes.
-    size_t num_prefixes = 0;
+    //
+    // IPv4 tables of at least MinIpv4DirectTableRanges ranges don't use an LC trie if
+    // ipv4_direct_table is set, so they aren't subject to this limit.
+    size_t num_ipv4_prefixes = 0;
+    size_t num_ipv6_prefixes = 0;
     for (const auto& pair_data : data) {
-      num_prefixes += pair_data.second.size();
+      for (const auto& cidr_range : pair_data.second) {
+        if (cidr_range.ip()->version() == Address::IpVersion::v4) {
+          ++num_ipv4_prefixes;
+        } else {
+          ++num_ipv6_prefixes;
+        }
+      }
     }
+    const bool use_ipv4_direct_table =
+        ipv4_direct_table && num_ipv4_prefixes >= MinIpv4DirectTableRanges;
+    const size_t num_prefixes =
+        num_ipv6_prefixes + (use_ipv4_direct_table ? 0 : num_ipv4_prefixes);
     const size_t max_prefixes = MaxLcTrieNodes * fill_factor / 2;
     if (num_prefixes > max_prefixes) {
       throw EnvoyException(fmt::format("The input vector has '{0}' CIDR range entries. LC-Trie "
@@ -167,27 +205,132 @@ public:
     //    4 |      - |    0 |           - |  A,C | 4th child of node 0, reached if next bits are 11
     //
     // The Nilsson and Karlsson paper linked in lc_trie.h has a more thorough example.
+    //
+    // With ipv4_direct_table, large IPv4 tables use the disjoint prefixes to fill a DIR-24-8 table
+    // instead.
 
-    ipv4_trie_.reset(new LcTrieInternal<Ipv4>(ipv4_prefixes, fill_factor, root_branching_factor));
+    if (use_ipv4_direct_table) {
+      ipv4_table_ = std::make_unique<Ipv4DirectTable>(ipv4_prefixes);
+    } else {
+      ipv4_trie_.reset(
+          new LcTrieInternal<Ipv4>(ipv4_prefixes, fill_factor, root_branching_factor));
+    }
     ipv6_trie_.reset(new LcTrieInternal<Ipv6>(ipv6_prefixes, fill_factor, root_branching_factor));
   }
 
+  /**
+   * Load a trie from a snapshot made by snapshot(). Lookups use the structures held by the
+   * snapshot in place rather than copies of them, so loading a large snapshot costs little more
+   * than checking it. Only the data of the CIDR ranges is copied. A snapshot that isn't aligned to
+   * 16 bytes is copied first.
+   * @param snapshot supplies the snapshot, which must outlive the trie and must not change while
+   *        the trie is in use.
+   * @throw EnvoyException if the snapshot is invalid.
+   */
+  explicit LcTrie(absl::string_view snapshot) {
+    static_assert(std::is_same<T, std::string>::value, "Only tries of strings have snapshots.");
+    if (reinterpret_cast<uintptr_t>(snapshot.data()) % alignof(Ipv6) != 0) {
+      aligned_snapshot_.resize((snapshot.size() + sizeof(Ipv6) - 1) / sizeof(Ipv6));
+      memcpy(aligned_snapshot_.data(), snapshot.data(), snapshot.size());
+      snapshot = absl::string_view(reinterpret_cast<const char*>(aligned_snapshot_.data()),
+                                   snapshot.size());
+    }
+
+    const SnapshotReader reader(snapshot);
+    if (reader.ipv4DirectTable()) {
+      ipv4_table_ = std::make_unique<Ipv4DirectTable>(reader);
+    } else {
+      ipv4_trie_ = std::make_unique<LcTrieInternal<Ipv4>>(reader, Ipv4Nodes, Ipv4Leaves, Ipv4Data);
+    }
+    ipv6_trie_ = std::make_unique<LcTrieInternal<Ipv6>>(reader, Ipv6Nodes, Ipv6Leaves, Ipv6Data);
+  }
+
   /**
    * Retrieve data associated with the CIDR range that contains `ip_address`. Both IPv4 and IPv6
    * addresses are supported.
    * @param  ip_address supplies the IP address.
    * @return a vector of data from the CIDR ranges and IP addresses that contains 'ip_address'. An
    * empty vector is returned if no prefix contains 'ip_address' or there is no data for the IP
-   * version of the ip_address.
+   * version of the ip_address. The vector is owned by the trie.
    */
-  std::vector<T> getData(const Network::Address::InstanceConstSharedPtr& ip_address) const {
+  const std::vector<T>& getData(const Network::Address::InstanceConstSharedPtr& ip_address) const {
     if (ip_address->ip()->version() == Address::IpVersion::v4) {
       Ipv4 ip = ntohl(ip_address->ip()->ipv4()->address());
-      return ipv4_trie_->getData(ip);
+      if (ipv4_table_ != nullptr) {
+        return ipv4_table_->data(ipv4_table_->lookup(ip));
+      }
+      return ipv4_trie_->data(ipv4_trie_->lookup(ip));
     } else {
       Ipv6 ip = Utility::Ip6ntohl(ip_address->ip()->ipv6()->address());
-      return ipv6_trie_->getData(ip);
+      return ipv6_trie_->data(ipv6_trie_->lookup(ip));
+    }
+  }
+
+  /**
+   * Retrieve data associated with the CIDR ranges that contain each of `ip_addresses`. This is
+   * equivalent to calling getData() for each address, but the trie is walked for several
+   * addresses at once so that the memory accesses of different addresses overlap.
+   * @param ip_addresses supplies the IP addresses.
+   * @return a vector with the data of each address, in the order of `ip_addresses`. The data is
+   * owned by the trie.
+   */
+  std::vector<const std::vector<T>*>
+  getData(const std::vector<Network::Address::InstanceConstSharedPtr>& ip_addresses) const {
+    std::vector<Ipv4> ipv4_addresses;
+    std::vector<size_t> ipv4_positions;
+    std::vector<Ipv6> ipv6_addresses;
+    std::vector<size_t> ipv6_positions;
+    for (size_t i = 0; i < ip_addresses.size(); i++) {
+      const Address::Ip* ip = ip_addresses[i]->ip();
+      if (ip->version() == Address::IpVersion::v4) {
+        ipv4_addresses.push_back(ntohl(ip->ipv4()->address()));
+        ipv4_positions.push_back(i);
+      } else {
+        ipv6_addresses.push_back(Utility::Ip6ntohl(ip->ipv6()->address()));
+        ipv6_positions.push_back(i);
+      }
+    }
+
+    std::vector<const std::vector<T>*> data(ip_addresses.size());
+    if (ipv4_table_ != nullptr) {
+      batchGetData(*ipv4_table_, ipv4_addresses, ipv4_positions, data);
+    } else {
+      batchGetData(*ipv4_trie_, ipv4_addresses, ipv4_positions, data);
+    }
+    batchGetData(*ipv6_trie_, ipv6_addresses, ipv6_positions, data);
+    return data;
+  }
+
+  /**
+   * @return the distinct data of all the CIDR ranges, in no particular order.
+   */
+  std::vector<T> values() const {
+    DataSet values;
+    if (ipv4_table_ != nullptr) {
+      ipv4_table_->dataTable().values(values);
+    } else {
+      ipv4_trie_->dataTable().values(values);
+    }
+    ipv6_trie_->dataTable().values(values);
+    return std::vector<T>(values.begin(), values.end());
+  }
+
+  /**
+   * Save the trie so that it can be loaded with LcTrie(absl::string_view). The snapshot holds the
+   * lookup structures as they are laid out in memory, so it can only be loaded on the platform
+   * it was made on.
+   * @return the snapshot.
+   */
+  std::string snapshot() const {
+    static_assert(std::is_same<T, std::string>::value, "Only tries of strings have snapshots.");
+    SnapshotWriter writer;
+    if (ipv4_table_ != nullptr) {
+      ipv4_table_->snapshot(writer);
+    } else {
+      ipv4_trie_->snapshot(writer, Ipv4Nodes, Ipv4Leaves, Ipv4Data);
     }
+    ipv6_trie_->snapshot(writer, Ipv6Nodes, Ipv6Leaves, Ipv6Data);
+    return writer.finish(ipv4_table_ != nullptr);
   }
 
 private:
@@ -233,6 +376,270 @@ private:
   using DataSet = std::unordered_set<T>;
   using DataSetSharedPtr = std::shared_ptr<DataSet>;
 
+  // Index of the data of addresses that no CIDR range contains.
+  static constexpr uint32_t NoData = UINT32_MAX;
+
+  // Number of addresses that batch lookups walk through a trie at once.
+  static constexpr size_t LookupBatchSize = 8;
+
+  // Snapshots start with a SnapshotHeader locating the sections of the snapshot, which each hold
+  // an array of a lookup structure or the serialized data of a DataTable. Sections are aligned so
+  // that the arrays can be used in place.
+  static constexpr uint32_t SnapshotMagic = 0x4c435452;
+  static constexpr uint32_t SnapshotVersion = 1;
+  static constexpr size_t SnapshotAlignment = 64;
+
+  enum SnapshotSection : uint32_t {
+    Ipv4Nodes,
+    Ipv4Leaves,
+    Ipv4Data,
+    Ipv4Tbl24,
+    Ipv4Tbl8,
+    Ipv6Nodes,
+    Ipv6Leaves,
+    Ipv6Data,
+    SnapshotSectionCount
+  };
+
+  struct SnapshotHeader {
+    uint32_t magic_;
+    uint32_t version_;
+    uint32_t ipv4_direct_table_;
+    uint32_t unused_;
+    struct {
+      uint64_t offset_;
+      uint64_t size_;
+    } sections_[SnapshotSectionCount];
+  };
+
+  static void throwInvalidSnapshot(const std::string& reason) {
+    throw EnvoyException(fmt::format("Invalid LC-Trie snapshot: {}.", reason));
+  }
+
+  static void appendUint32(std::string& output, uint32_t value) {
+    output.append(reinterpret_cast<const char*>(&value), sizeof(value));
+  }
+
+  static uint32_t readUint32(absl::string_view& input) {
+    uint32_t value;
+    if (input.size() < sizeof(value)) {
+      throwInvalidSnapshot("truncated data");
+    }
+    memcpy(&value, input.data(), sizeof(value));
+    input.remove_prefix(sizeof(value));
+    return value;
+  }
+
+  /**
+   * Assembles the sections of a snapshot.
+   */
+  class SnapshotWriter {
+  public:
+    SnapshotWriter() : output_(alignedSize(sizeof(SnapshotHeader)), '\0') {}
+
+    /**
+     * Add a section holding the elements of `array`.
+     */
+    template <class Array> void add(SnapshotSection section, const Array& array) {
+      add(section, absl::string_view(reinterpret_cast<const char*>(array.data()),
+                                     array.size() * sizeof(*array.data())));
+    }
+
+    void add(SnapshotSection section, absl::string_view bytes) {
+      output_.resize(alignedSize(output_.size()), '\0');
+      header_.sections_[section].offset_ = output_.size();
+      header_.sections_[section].size_ = bytes.size();
+      output_.append(bytes.data(), bytes.size());
+    }
+
+    /**
+     * @return the snapshot.
+     */
+    std::string finish(bool ipv4_direct_table) {
+      header_.magic_ = SnapshotMagic;
+      header_.version_ = SnapshotVersion;
+      header_.ipv4_direct_table_ = ipv4_direct_table;
+      memcpy(&output_[0], &header_, sizeof(header_));
+      return std::move(output_);
+    }
+
+  private:
+    static size_t alignedSize(size_t size) {
+      return (size + SnapshotAlignment - 1) / SnapshotAlignment * SnapshotAlignment;
+    }
+
+    SnapshotHeader header_{};
+    std::string output_;
+  };
+
+  /**
+   * Locates the sections of a snapshot, checking that they are within its bounds.
+   */
+  class SnapshotReader {
+  public:
+    explicit SnapshotReader(absl::string_view snapshot) : snapshot_(snapshot) {
+      if (snapshot.size() < sizeof(SnapshotHeader)) {
+        throwInvalidSnapshot("truncated header");
+      }
+      memcpy(&header_, snapshot.data(), sizeof(header_));
+      if (header_.magic_ != SnapshotMagic) {
+        throwInvalidSnapshot("bad magic number");
+      }
+      if (header_.version_ != SnapshotVersion) {
+        throwInvalidSnapshot(fmt::format("unsupported version {}", header_.version_));
+      }
+      for (const auto& section : header_.sections_) {
+        if (section.offset_ % SnapshotAlignment != 0 || section.offset_ > snapshot.size() ||
+            section.size_ > snapshot.size() - section.offset_) {
+          throwInvalidSnapshot("section out of bounds");
+        }
+      }
+    }
+
+    bool ipv4DirectTable() const { return header_.ipv4_direct_table_ != 0; }
+
+    absl::string_view bytes(SnapshotSection section) const {
+      return snapshot_.substr(header_.sections_[section].offset_, header_.sections_[section].size_);
+    }
+
+    /**
+     * @return a view of the elements held by `section`.
+     */
+    template <class U> absl::Span<const U> array(SnapshotSection section) const {
+      const absl::string_view section_bytes = bytes(section);
+      if (section_bytes.size() % sizeof(U) != 0) {
+        throwInvalidSnapshot("truncated section");
+      }
+      return absl::Span<const U>(reinterpret_cast<const U*>(section_bytes.data()),
+                                 section_bytes.size() / sizeof(U));
+    }
+
+  private:
+    const absl::string_view snapshot_;
+    SnapshotHeader header_;
+  };
+
+  /**
+   * The data of the disjoint prefixes of a lookup structure, referenced by index. Lookups only
+   * touch the data once the prefix has been found, which keeps the structures walked during the
+   * lookup compact.
+   */
+  class DataTable {
+  public:
+    DataTable() = default;
+
+    /**
+     * Load data serialized by serialize().
+     * @throw EnvoyException if the data is invalid.
+     */
+    explicit DataTable(absl::string_view serialized) {
+      // Sets and values each take at least 4 bytes, which bounds the allocations.
+      const uint32_t count = readUint32(serialized);
+      if (count > serialized.size() / sizeof(uint32_t)) {
+        throwInvalidSnapshot("truncated data");
+      }
+      data_.reserve(count);
+      for (uint32_t i = 0; i < count; i++) {
+        const uint32_t size = readUint32(serialized);
+        if (size > serialized.size() / sizeof(uint32_t)) {
+          throwInvalidSnapshot("truncated data");
+        }
+        std::vector<T> values(size);
+        for (T& value : values) {
+          const uint32_t length = readUint32(serialized);
+          if (length > serialized.size()) {
+            throwInvalidSnapshot("truncated data");
+          }
+          value.assign(serialized.data(), length);
+          serialized.remove_prefix(length);
+        }
+        data_.push_back(std::move(values));
+      }
+    }
+
+    /**
+     * Add the data of the next prefix. Leaf pushing gives adjacent prefixes the same data
+     * inherited from a wider range, so the data of the previous prefix is reused when equal.
+     * @return the index of the data.
+     */
+    uint32_t add(const DataSet& data) {
+      if (data_.empty() || data_.back().size() != data.size() ||
+          !std::all_of(data_.back().begin(), data_.back().end(),
+                       [&data](const T& value) { return data.count(value) != 0; })) {
+        data_.emplace_back(data.begin(), data.end());
+      }
+      return data_.size() - 1;
+    }
+
+    /**
+     * @return the data at `index`, which is empty for NoData.
+     */
+    const std::vector<T>& get(uint32_t index) const {
+      if (index == NoData) {
+        return empty_;
+      }
+      return data_[index];
+    }
+
+    size_t size() const { return data_.size(); }
+
+    /**
+     * Add the data of all the sets to `values`.
+     */
+    void values(DataSet& values) const {
+      for (const auto& data : data_) {
+        values.insert(data.begin(), data.end());
+      }
+    }
+
+    /**
+     * Serialize the data sets, merging the equal ones.
+     * @param indexes receives the index in the serialized data of each set.
+     * @return the serialized data.
+     */
+    std::string serialize(std::vector<uint32_t>& indexes) const {
+      std::map<std::vector<T>, uint32_t> sets;
+      std::string serialized_sets;
+      indexes.reserve(data_.size());
+      for (const auto& data : data_) {
+        std::vector<T> key = data;
+        std::sort(key.begin(), key.end());
+        const uint32_t index = sets.size();
+        const auto result = sets.emplace(std::move(key), index);
+        if (result.second) {
+          appendUint32(serialized_sets, data.size());
+          for (const T& value : data) {
+            appendUint32(serialized_sets, value.size());
+            serialized_sets.append(value);
+          }
+        }
+        indexes.push_back(result.first->second);
+      }
+      std::string serialized;
+      appendUint32(serialized, sets.size());
+      return serialized + serialized_sets;
+    }
+
+  private:
+    std::vector<std::vector<T>> data_;
+    const std::vector<T> empty_;
+  };
+
+  /**
+   * Look up several addresses in the given lookup structure and set the data of each at the
+   * corresponding position.
+   */
+  template <class Table, class IpType>
+  static void batchGetData(const Table& table, const std::vector<IpType>& ip_addresses,
+                           const std::vector<size_t>& positions,
+                           std::vector<const std::vector<T>*>& data) {
+    std::vector<uint32_t> indexes(ip_addresses.size());
+    table.lookup(ip_addresses.data(), ip_addresses.size(), indexes.data());
+    for (size_t i = 0; i < indexes.size(); i++) {
+      data[positions[i]] = &table.data(indexes[i]);
+    }
+  }
+
   /**
    * Structure to hold a CIDR range and the data associated with it.
    */
@@ -425,12 +832,41 @@ private:
                    uint32_t root_branching_factor);
 
     /**
-     * Retrieve the data associated with the CIDR range that contains `ip_address`.
+     * Load a LC-Trie from the given sections of a snapshot.
+     * @throw EnvoyException if the sections don't hold a valid LC-Trie.
+     */
+    LcTrieInternal(const SnapshotReader& reader, SnapshotSection nodes, SnapshotSection leaves,
+                   SnapshotSection data);
+
+    /**
+     * Add the LC-Trie to the given sections of a snapshot.
+     */
+    void snapshot(SnapshotWriter& writer, SnapshotSection nodes, SnapshotSection leaves,
+                  SnapshotSection data) const;
+
+    /**
+     * Find the CIDR range that contains `ip_address`.
      * @param  ip_address supplies the IP address in host byte order.
-     * @return a vector of data from the CIDR ranges and IP addresses that encompasses the input.
-     * An empty vector is returned if the LC Trie is empty.
+     * @return the index of the data of the CIDR range, or NoData if no CIDR range contains the
+     * address.
+     */
+    uint32_t lookup(const IpType& ip_address) const;
+
+    /**
+     * Find the CIDR ranges that contain `count` addresses, walking the trie for up to
+     * LookupBatchSize addresses at once.
+     * @param ip_addresses supplies the IP addresses in host byte order.
+     * @param count supplies the number of addresses.
+     * @param data_indexes receives the index of the data of each address, as lookup() would.
      */
-    std::vector<T> getData(const IpType& ip_address) const;
+    void lookup(const IpType* ip_addresses, size_t count, uint32_t* data_indexes) const;
+
+    /**
+     * @return the data at an index returned by lookup().
+     */
+    const std::vector<T>& data(uint32_t index) const { return data_.get(index); }
+
+    const DataTable& dataTable() const { return data_; }
 
   private:
     /**
@@ -454,6 +890,39 @@ private:
       ASSERT(next_free_index <= trie_.size());
       trie_.resize(next_free_index);
       trie_.shrink_to_fit();
+
+      // Only the ranges are needed to check the leaves found by lookups, so they are kept
+      // contiguously, apart from the data.
+      leaf_storage_.reserve(ip_prefixes_.size());
+      for (const auto& prefix : ip_prefixes_) {
+        leaf_storage_.push_back({prefix.ip_, prefix.length_, data_.add(prefix.data_)});
+      }
+      ip_prefixes_.clear();
+      ip_prefixes_.shrink_to_fit();
+
+      nodes_ = trie_;
+      leaves_ = leaf_storage_;
+    }
+
+    /**
+     * Check that lookups of any address only access nodes and leaves within bounds, and that the
+     * leaves refer to existing data, as the trie may come from an untrusted snapshot.
+     * @throw EnvoyException if the trie is invalid.
+     */
+    void validate() const;
+
+    /**
+     * The path taken through the trie to match an address may have contained skips, so the
+     * leaf found for it is only a match if its CIDR range really contains the address.
+     * @return the index of the data of the leaf if it contains `ip_address`, otherwise NoData.
+     */
+    uint32_t leafData(uint32_t leaf, const IpType& ip_address) const {
+      const Leaf& entry = leaves_[leaf];
+      if (extractBits<IpType, address_size>(0, entry.length_, entry.ip_) ==
+          extractBits<IpType, address_size>(0, entry.length_, ip_address)) {
+        return entry.data_index_;
+      }
+      return NoData;
     }
 
     // Thin wrapper around computeBranch output to facilitate code readability.
@@ -666,8 +1135,8 @@ private:
      * - Skip: the next 7 bits represent the number of bits to skip when looking at an IP address.
      * This value can be between 0 and 127, so IPv6 is supported.
      * - Address: the remaining 20 bits represent an index either into the trie_ or the
-     * ip_prefixes_. If branch_ != 0, the index is for the trie_. If branch == zero, the index is
-     * for the ip_prefixes_.
+     * leaves_. If branch_ != 0, the index is for the trie_. If branch == zero, the index is
+     * for the leaves_.
      *
      * Note: If more than 2^19-1 CIDR ranges are to be stored in trie_, uint64_t should be used
      * instead.
@@ -678,24 +1147,177 @@ private:
       uint32_t address_ : 20; // If this 20-bit size changes, please change MaxLcTrieNodes too.
     };
 
+    /**
+     * The CIDR range of a leaf of the trie and the index of its data.
+     */
+    struct Leaf {
+      IpType ip_;
+      uint32_t length_ : 8;
+      uint32_t data_index_ : 24;
+    };
+
+    // The sorted prefixes the trie is built from. Only used while building.
+    std::vector<IpPrefix<IpType>> ip_prefixes_;
+
+    // Main trie search structure, as built. Empty when the trie is loaded from a snapshot.
+    std::vector<LcNode> trie_;
+    std::vector<Leaf> leaf_storage_;
+
+    // The nodes and leaves used by lookups, either those built or those of a snapshot.
+    absl::Span<const LcNode> nodes_;
     // The CIDR range and data needs to be maintained separately from the LC-Trie. A LC-Trie skips
     // chunks of data while searching for a match. This means that the node found in the LC-Trie
     // is not guaranteed to have the IP address in range. The last step prior to returning
     // associated data is to check the CIDR range pointed to by the node in the LC-Trie has
     // the IP address in range.
-    std::vector<IpPrefix<IpType>> ip_prefixes_;
-
-    // Main trie search structure.
-    std::vector<LcNode> trie_;
+    absl::Span<const Leaf> leaves_;
+    DataTable data_;
 
     const double fill_factor_;
     const uint32_t root_branching_factor_;
   };
 
+  /**
+   * DIR-24-8 table mapping IPv4 addresses to the data of the CIDR range containing them, as
+   * described in 'Routing lookups in hardware at memory access speeds' by 'P. Gupta', 'S. Lin'
+   * and 'N. McKeown'.
+   *
+   * The first level holds an entry for each /24. Unless a /24 contains prefixes longer than 24
+   * bits, its entry directly holds the data of the range containing it. Otherwise the entry
+   * refers to a second level block of 256 entries, one for each address of the /24. Entries hold
+   * the index of their data plus one, so that 0 means no data.
+   */
+  class Ipv4DirectTable {
+  public:
+    /**
+     * @param prefixes supplies disjoint prefixes, as pushed to the leaves of a BinaryTrie.
+     */
+    explicit Ipv4DirectTable(const std::vector<IpPrefix<Ipv4>>& prefixes)
+        : tbl24_storage_(Tbl24Size) {
+      for (const auto& prefix : prefixes) {
+        const uint32_t entry = data_.add(prefix.data_) + 1;
+        if (prefix.length_ <= 24) {
+          std::fill_n(tbl24_storage_.begin() + (prefix.ip_ >> 8), 1 << (24 - prefix.length_),
+                      entry);
+          continue;
+        }
+        uint32_t& slot = tbl24_storage_[prefix.ip_ >> 8];
+        if ((slot & Tbl8Block) == 0) {
+          // The prefixes are disjoint, so a /24 containing a longer prefix isn't filled.
+          ASSERT(slot == 0);
+          slot = Tbl8Block | (tbl8_storage_.size() >> 8);
+          tbl8_storage_.resize(tbl8_storage_.size() + 256);
+        }
+        std::fill_n(tbl8_storage_.begin() + (((slot & ~Tbl8Block) << 8) | (prefix.ip_ & 0xff)),
+                    1 << (32 - prefix.length_), entry);
+      }
+      tbl24_ = tbl24_storage_;
+      tbl8_ = tbl8_storage_;
+    }
+
+    /**
+     * Load a table from a snapshot.
+     * @throw EnvoyException if the snapshot doesn't hold a valid table.
+     */
+    explicit Ipv4DirectTable(const SnapshotReader& reader)
+        : tbl24_(reader.template array<uint32_t>(Ipv4Tbl24)),
+          tbl8_(reader.template array<uint32_t>(Ipv4Tbl8)), data_(reader.bytes(Ipv4Data)) {
+      if (tbl24_.size() != Tbl24Size || tbl8_.size() % 256 != 0) {
+        throwInvalidSnapshot("bad DIR-24-8 table size");
+      }
+      // Every entry is checked, as a lookup may read any of them.
+      const uint32_t max_entry = data_.size();
+      const uint32_t blocks = tbl8_.size() >> 8;
+      for (const uint32_t entry : tbl24_) {
+        if ((entry & Tbl8Block) == 0 ? entry > max_entry : (entry & ~Tbl8Block) >= blocks) {
+          throwInvalidSnapshot("bad DIR-24-8 entry");
+        }
+      }
+      for (const uint32_t entry : tbl8_) {
+        if (entry > max_entry) {
+          throwInvalidSnapshot("bad DIR-24-8 entry");
+        }
+      }
+    }
+
+    /**
+     * Add the table to a snapshot.
+     */
+    void snapshot(SnapshotWriter& writer) const {
+      std::vector<uint32_t> indexes;
+      writer.add(Ipv4Data, data_.serialize(indexes));
+      const auto remap = [&indexes](uint32_t entry) -> uint32_t {
+        return entry == 0 || (entry & Tbl8Block) != 0 ? entry : indexes[entry - 1] + 1;
+      };
+      std::vector<uint32_t> entries(tbl24_.size());
+      std::transform(tbl24_.begin(), tbl24_.end(), entries.begin(), remap);
+      writer.add(Ipv4Tbl24, entries);
+      entries.resize(tbl8_.size());
+      std::transform(tbl8_.begin(), tbl8_.end(), entries.begin(), remap);
+      writer.add(Ipv4Tbl8, entries);
+    }
+
+    /**
+     * @return the index of the data of the CIDR range containing `ip_address`, or NoData.
+     */
+    uint32_t lookup(Ipv4 ip_address) const {
+      const uint32_t entry = tbl24_[ip_address >> 8];
+      if ((entry & Tbl8Block) == 0) {
+        // NoData for an entry of 0.
+        return entry - 1;
+      }
+      return tbl8_[((entry & ~Tbl8Block) << 8) | (ip_address & 0xff)] - 1;
+    }
+
+    /**
+     * Look up `count` addresses. The lookups are independent of each other, so they overlap
+     * without walking them in lockstep as for tries.
+     */
+    void lookup(const Ipv4* ip_addresses, size_t count, uint32_t* data_indexes) const {
+      for (size_t i = 0; i < count; i++) {
+        data_indexes[i] = lookup(ip_addresses[i]);
+      }
+    }
+
+    /**
+     * @return the data at an index returned by lookup().
+     */
+    const std::vector<T>& data(uint32_t index) const { return data_.get(index); }
+
+    const DataTable& dataTable() const { return data_; }
+
+  private:
+    // Set in first level entries that refer to a second level block.
+    static constexpr uint32_t Tbl8Block = 1u << 31;
+    static constexpr size_t Tbl24Size = 1 << 24;
+
+    // The table as built. Empty when the table is loaded from a snapshot.
+    std::vector<uint32_t> tbl24_storage_;
+    std::vector<uint32_t> tbl8_storage_;
+
+    // The table used by lookups, either the one built or the one of a snapshot.
+    absl::Span<const uint32_t> tbl24_;
+    absl::Span<const uint32_t> tbl8_;
+    DataTable data_;
+  };
+
+  // Holds a copy of a snapshot that wasn't suitably aligned to be used in place.
+  std::vector<Ipv6> aligned_snapshot_;
+
+  // IPv4 CIDR ranges are held in either of these.
   std::unique_ptr<LcTrieInternal<Ipv4>> ipv4_trie_;
+  std::unique_ptr<Ipv4DirectTable> ipv4_table_;
   std::unique_ptr<LcTrieInternal<Ipv6>> ipv6_trie_;
 };
 
+template <class T> constexpr uint32_t LcTrie<T>::NoData;
+template <class T> constexpr size_t LcTrie<T>::LookupBatchSize;
+template <class T> constexpr uint32_t LcTrie<T>::SnapshotMagic;
+template <class T> constexpr uint32_t LcTrie<T>::SnapshotVersion;
+template <class T> constexpr size_t LcTrie<T>::SnapshotAlignment;
+template <class T> constexpr uint32_t LcTrie<T>::Ipv4DirectTable::Tbl8Block;
+template <class T> constexpr size_t LcTrie<T>::Ipv4DirectTable::Tbl24Size;
+
 template <class T>
 template <class IpType, uint32_t address_size>
 LcTrie<T>::LcTrieInternal<IpType, address_size>::LcTrieInternal(std::vector<IpPrefix<IpType>>& data,
@@ -707,14 +1329,89 @@ LcTrie<T>::LcTrieInternal<IpType, address_size>::LcTrieInternal(std::vector<IpPr
 
 template <class T>
 template <class IpType, uint32_t address_size>
-std::vector<T>
-LcTrie<T>::LcTrieInternal<IpType, address_size>::getData(const IpType& ip_address) const {
-  std::vector<T> return_vector;
-  if (trie_.empty()) {
-    return return_vector;
+LcTrie<T>::LcTrieInternal<IpType, address_size>::LcTrieInternal(const SnapshotReader& reader,
+                                                                SnapshotSection nodes,
+                                                                SnapshotSection leaves,
+                                                                SnapshotSection data)
+    : nodes_(reader.template array<LcNode>(nodes)), leaves_(reader.template array<Leaf>(leaves)),
+      data_(reader.bytes(data)), fill_factor_(0), root_branching_factor_(0) {
+  validate();
+}
+
+template <class T>
+template <class IpType, uint32_t address_size>
+void LcTrie<T>::LcTrieInternal<IpType, address_size>::snapshot(SnapshotWriter& writer,
+                                                               SnapshotSection nodes,
+                                                               SnapshotSection leaves,
+                                                               SnapshotSection data) const {
+  std::vector<uint32_t> indexes;
+  writer.add(data, data_.serialize(indexes));
+  writer.add(nodes, nodes_);
+  std::vector<Leaf> remapped_leaves(leaves_.size());
+  for (size_t i = 0; i < leaves_.size(); i++) {
+    // The leaf is zeroed so that its padding is deterministic.
+    Leaf& leaf = remapped_leaves[i];
+    memset(&leaf, 0, sizeof(leaf));
+    leaf.ip_ = leaves_[i].ip_;
+    leaf.length_ = leaves_[i].length_;
+    leaf.data_index_ = indexes[leaves_[i].data_index_];
   }
+  writer.add(leaves, remapped_leaves);
+}
 
-  LcNode node = trie_[0];
+template <class T>
+template <class IpType, uint32_t address_size>
+void LcTrie<T>::LcTrieInternal<IpType, address_size>::validate() const {
+  for (const Leaf& leaf : leaves_) {
+    if (leaf.length_ > address_size || leaf.data_index_ >= data_.size()) {
+      throwInvalidSnapshot("bad leaf");
+    }
+  }
+  if (nodes_.empty()) {
+    return;
+  }
+
+  // Walk the whole trie, as lookups would. The children of the nodes of a valid trie don't
+  // overlap, so no node is visited twice, which bounds the walk.
+  struct Visit {
+    uint32_t node_;
+    // The position of the bits of the address to branch on at the node.
+    uint32_t position_;
+  };
+  std::vector<Visit> pending{{0, nodes_[0].skip_}};
+  size_t visits = 1;
+  while (!pending.empty()) {
+    const Visit visit = pending.back();
+    pending.pop_back();
+    const LcNode& node = nodes_[visit.node_];
+    if (node.branch_ == 0) {
+      if (node.address_ >= leaves_.size()) {
+        throwInvalidSnapshot("leaf out of bounds");
+      }
+      continue;
+    }
+    if (visit.position_ + node.branch_ > address_size ||
+        uint64_t(node.address_) + (uint64_t(1) << node.branch_) > nodes_.size()) {
+      throwInvalidSnapshot("node out of bounds");
+    }
+    visits += 1u << node.branch_;
+    if (visits > nodes_.size()) {
+      throwInvalidSnapshot("node visited more than once");
+    }
+    for (uint32_t child = node.address_; child < node.address_ + (1u << node.branch_); child++) {
+      pending.push_back({child, visit.position_ + node.branch_ + nodes_[child].skip_});
+    }
+  }
+}
+
+template <class T>
+template <class IpType, uint32_t address_size>
+uint32_t LcTrie<T>::LcTrieInternal<IpType, address_size>::lookup(const IpType& ip_address) const {
+  if (nodes_.empty()) {
+    return NoData;
+  }
+
+  LcNode node = nodes_[0];
   uint32_t branch = node.branch_;
   uint32_t position = node.skip_;
   uint32_t address = node.address_;
@@ -723,21 +1420,57 @@ LcTrie<T>::LcTrieInternal<IpType, address_size>::getData(const IpType& ip_addres
   while (branch != 0) {
     // branch is at most 2^5-1= 31 bits to extract, so we can safely cast the
     // output of extractBits to uint32_t without any data loss.
-    node = trie_[address + static_cast<uint32_t>(
-                               extractBits<IpType, address_size>(position, branch, ip_address))];
+    node = nodes_[address + static_cast<uint32_t>(
+                                extractBits<IpType, address_size>(position, branch, ip_address))];
     position += branch + node.skip_;
     branch = node.branch_;
     address = node.address_;
   }
 
-  // The path taken through the trie to match the ip_address may have contained skips,
-  // so it is necessary to check whether the matched prefix really contains the
-  // ip_address.
-  const auto& prefix = ip_prefixes_[address];
-  if (prefix.contains(ip_address)) {
-    return std::vector<T>(prefix.data_.begin(), prefix.data_.end());
+  return leafData(address, ip_address);
+}
+
+template <class T>
+template <class IpType, uint32_t address_size>
+void LcTrie<T>::LcTrieInternal<IpType, address_size>::lookup(const IpType* ip_addresses,
+                                                             size_t count,
+                                                             uint32_t* data_indexes) const {
+  if (nodes_.empty()) {
+    std::fill_n(data_indexes, count, NoData);
+    return;
+  }
+
+  LcNode nodes[LookupBatchSize];
+  uint32_t positions[LookupBatchSize];
+  for (size_t first = 0; first < count; first += LookupBatchSize) {
+    const size_t n = std::min(count - first, size_t(LookupBatchSize));
+    for (size_t i = 0; i < n; i++) {
+      nodes[i] = nodes_[0];
+      positions[i] = nodes[i].skip_;
+    }
+
+    // Each round descends one level for each address that hasn't reached a leaf yet. The nodes
+    // loaded within a round don't depend on each other, so their cache misses overlap instead of
+    // being serialized as when looking up one address after another.
+    bool descending = true;
+    while (descending) {
+      descending = false;
+      for (size_t i = 0; i < n; i++) {
+        const uint32_t branch = nodes[i].branch_;
+        if (branch != 0) {
+          nodes[i] = nodes_[nodes[i].address_ +
+                            static_cast<uint32_t>(extractBits<IpType, address_size>(
+                                positions[i], branch, ip_addresses[first + i]))];
+          positions[i] += branch + nodes[i].skip_;
+          descending = true;
+        }
+      }
+    }
+
+    for (size_t i = 0; i < n; i++) {
+      data_indexes[first + i] = leafData(nodes[i].address_, ip_addresses[first + i]);
+    }
   }
-  return std::vector<T>();
 }
 
 } // namespace LcTrie
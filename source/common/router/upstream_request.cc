@@ -22,6 +22,7 @@
 #include "common/grpc/common.h"
 #include "common/http/codes.h"
 #include "common/http/header_map_impl.h"
+#include "common/http/header_utility.h"
 #include "common/http/headers.h"
 #include "common/http/message_impl.h"
 #include "common/http/utility.h"
@@ -497,11 +498,19 @@ void UpstreamRequest::enableDataFromDownstreamForFlowControl() {
 
 void HttpConnPool::newStream(GenericConnectionPoolCallbacks* callbacks) {
   callbacks_ = callbacks;
+  UpstreamRequest& upstream_request = *callbacks->upstreamRequest();
+  // Complete idempotent requests without a body may be pipelined, as they can be retried if the
+  // connection closes before they are answered.
+  const Http::RequestHeaderMap* headers = upstream_request.parent().downstreamHeaders();
+  const bool pipelinable = upstream_request.encodeComplete() && headers != nullptr &&
+                           Http::HeaderUtility::isIdempotent(*headers) &&
+                           !Http::Utility::isUpgrade(*headers);
   // It's possible for a reset to happen inline within the newStream() call. In this case, we
   // might get deleted inline as well. Only write the returned handle out if it is not nullptr to
   // deal with this case.
   Http::ConnectionPool::Cancellable* handle =
-      conn_pool_.newStream(*callbacks->upstreamRequest(), *this);
+      pipelinable ? conn_pool_.newPipelinableStream(upstream_request, *this)
+                  : conn_pool_.newStream(upstream_request, *this);
   if (handle) {
     conn_pool_stream_handle_ = handle;
   }
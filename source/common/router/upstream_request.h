@@ -135,6 +135,7 @@ public:
   void upstreamCanary(bool value) { upstream_canary_ = value; }
   bool upstreamCanary() { return upstream_canary_; }
   bool awaitingHeaders() { return awaiting_headers_; }
+  bool encodeComplete() const { return encode_complete_; }
   void recordTimeoutBudget(bool value) { record_timeout_budget_ = value; }
   bool createPerTryTimeoutOnRequestComplete() {
     return create_per_try_timeout_on_request_complete_;
@@ -76,6 +76,7 @@ constexpr const char* runtime_features[] = {
 constexpr const char* disabled_runtime_features[] = {
     // Sentinel and test flag.
     "envoy.reloadable_features.test_feature_false",
+    "envoy.reloadable_features.http2_zero_copy_data",
 };
 
 RuntimeFeatures::RuntimeFeatures() {
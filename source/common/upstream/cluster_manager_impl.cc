@@ -20,6 +20,7 @@
 #include "common/common/assert.h"
 #include "common/common/enum_to_int.h"
 #include "common/common/fmt.h"
+#include "common/common/hash.h"
 #include "common/common/utility.h"
 #include "common/config/new_grpc_mux_impl.h"
 #include "common/config/utility.h"
@@ -28,6 +29,7 @@
 #include "common/http/async_client_impl.h"
 #include "common/http/http1/conn_pool.h"
 #include "common/http/http2/conn_pool.h"
+#include "common/http/http2/forwarding_conn_pool.h"
 #include "common/network/resolver_impl.h"
 #include "common/network/utility.h"
 #include "common/protobuf/utility.h"
@@ -41,10 +43,27 @@
 #include "common/upstream/ring_hash_lb.h"
 #include "common/upstream/subset_lb.h"
 
+#include "absl/strings/numbers.h"
+#include "absl/strings/strip.h"
+
 namespace Envoy {
 namespace Upstream {
 namespace {
 
+// Appended to the pool hash key of HTTP/2 pools which own connections shared across workers.
+constexpr uint8_t SharedHttp2PoolKeyMarker = 0xff;
+
+// Workers are named after their index, which identifies them regardless of the order in which they
+// start and stop. Returns nullopt for the main thread.
+absl::optional<uint32_t> workerIndex(Event::Dispatcher& dispatcher) {
+  absl::string_view name = dispatcher.name();
+  uint32_t index;
+  if (absl::ConsumePrefix(&name, "worker_") && absl::SimpleAtoi(name, &index)) {
+    return index;
+  }
+  return absl::nullopt;
+}
+
 void addOptionsIfNotNull(Network::Socket::OptionsSharedPtr& options,
                          const Network::Socket::OptionsSharedPtr& to_add) {
   if (to_add != nullptr) {
@@ -909,7 +928,16 @@ ProtobufTypes::MessagePtr ClusterManagerImpl::dumpClusterConfigs() {
 ClusterManagerImpl::ThreadLocalClusterManagerImpl::ThreadLocalClusterManagerImpl(
     ClusterManagerImpl& parent, Event::Dispatcher& dispatcher,
     const absl::optional<std::string>& local_cluster_name)
-    : parent_(parent), thread_local_dispatcher_(dispatcher) {
+    : parent_(parent), thread_local_dispatcher_(dispatcher),
+      worker_index_(&dispatcher != &parent.dispatcher_ ? workerIndex(dispatcher) : absl::nullopt),
+      worker_dispatchers_(parent.worker_dispatchers_) {
+  // Connections initiated on the main thread are never shared, as the main thread must be able to
+  // make progress (e.g. on xDS) independently of the workers.
+  if (worker_index_.has_value()) {
+    worker_ = std::make_shared<const Worker>(dispatcher, *this);
+    worker_dispatchers_->add(worker_index_.value(), worker_);
+  }
+
   // If local cluster is defined then we need to initialize it first.
   if (local_cluster_name) {
     ENVOY_LOG(debug, "adding TLS local cluster {}", local_cluster_name.value());
@@ -942,6 +970,11 @@ ClusterManagerImpl::ThreadLocalClusterManagerImpl::~ThreadLocalClusterManagerImp
   // member update callback registered with the local cluster.
   ENVOY_LOG(debug, "shutting down thread local cluster manager");
   destroying_ = true;
+  if (worker_ != nullptr) {
+    // Callbacks posted by other workers refer to this object and to the pools destroyed below.
+    worker_->dispatcher_->invalidate();
+    worker_dispatchers_->remove(worker_index_.value());
+  }
   host_http_conn_pool_map_.clear();
   host_tcp_conn_pool_map_.clear();
   ASSERT(host_tcp_conn_map_.empty());
@@ -1092,6 +1125,16 @@ void ClusterManagerImpl::ThreadLocalClusterManagerImpl::updateClusterMembership(
                                            std::move(locality_weights), hosts_added, hosts_removed,
                                            overprovisioning_factor);
 
+  // Rebuilt from all priorities as a host moving between priorities may be removed from one after
+  // being added to the other.
+  if (cluster_entry->cluster_info_->sharedHttp2PoolOwnerWorkers() > 0) {
+    cluster_entry->shared_http2_hosts_.clear();
+    for (const auto& host_set : cluster_entry->priority_set_.hostSetsPerPriority()) {
+      cluster_entry->shared_http2_hosts_.insert(host_set->hosts().begin(),
+                                                host_set->hosts().end());
+    }
+  }
+
   // If an LB is thread aware, create a new worker local LB on membership changes.
   if (cluster_entry->lb_factory_ != nullptr) {
     ENVOY_LOG(debug, "re-creating local LB for TLS cluster {}", name);
@@ -1228,6 +1271,84 @@ ClusterManagerImpl::ThreadLocalClusterManagerImpl::ClusterEntry::~ClusterEntry()
   }
 }
 
+void ClusterManagerImpl::WorkerDispatchers::add(uint32_t index, WorkerConstSharedPtr worker) {
+  absl::MutexLock lock(&lock_);
+  if (index >= workers_.size()) {
+    workers_.resize(index + 1);
+  }
+  workers_[index] = std::move(worker);
+  generation_++;
+}
+
+void ClusterManagerImpl::WorkerDispatchers::remove(uint32_t index) {
+  absl::MutexLock lock(&lock_);
+  workers_[index] = nullptr;
+  generation_++;
+}
+
+void ClusterManagerImpl::WorkerDispatchers::refresh(std::vector<WorkerConstSharedPtr>& snapshot,
+                                                    uint64_t& generation) {
+  if (generation_.load() == generation) {
+    return;
+  }
+
+  absl::MutexLock lock(&lock_);
+  snapshot = workers_;
+  generation = generation_.load();
+}
+
+ClusterManagerImpl::WorkerConstSharedPtr
+ClusterManagerImpl::ThreadLocalClusterManagerImpl::sharedHttp2PoolOwner(
+    const HostConstSharedPtr& host, uint32_t owner_workers) {
+  if (worker_ == nullptr || destroying_) {
+    return nullptr;
+  }
+
+  // Hash the address rather than the host pointer so that all workers agree on the owner even if
+  // the host was re-created by a cluster update. The owner is identified by its worker index, so
+  // workers agree on it while others are still starting. Until the owner has started, or if there
+  // is no worker with that index, each worker uses its own connections.
+  const uint64_t hash = HashUtil::xxHash64(host->address()->asStringView());
+  const uint32_t owner = hash % owner_workers;
+  if (owner == worker_index_.value()) {
+    return worker_;
+  }
+
+  worker_dispatchers_->refresh(worker_dispatchers_snapshot_, worker_dispatchers_generation_);
+  return owner < worker_dispatchers_snapshot_.size() ? worker_dispatchers_snapshot_[owner]
+                                                      : nullptr;
+}
+
+Http::ConnectionPool::Instance*
+ClusterManagerImpl::ThreadLocalClusterManagerImpl::ownedHttp2ConnPool(
+    const std::string& cluster_name, const HostConstSharedPtr& host, ResourcePriority priority,
+    const std::vector<uint8_t>& hash_key,
+    const Network::ConnectionSocket::OptionsSharedPtr& options,
+    const Network::TransportSocketOptionsSharedPtr& transport_socket_options) {
+  if (destroying_) {
+    return nullptr;
+  }
+  const auto cluster = thread_local_clusters_.find(cluster_name);
+  if (cluster == thread_local_clusters_.end() ||
+      cluster->second->shared_http2_hosts_.count(host) == 0) {
+    return nullptr;
+  }
+
+  ConnPoolsContainer& container = *getHttpConnPoolsContainer(host, true);
+  ConnPoolsContainer::ConnPools::PoolOptRef pool =
+      container.pools_->getPool(priority, hash_key, [&]() {
+        return parent_.factory_.allocateConnPool(thread_local_dispatcher_, host, priority,
+                                                 Http::Protocol::Http2, options,
+                                                 transport_socket_options);
+      });
+
+  if (pool.has_value()) {
+    return &(pool.value().get());
+  } else {
+    return nullptr;
+  }
+}
+
 Http::ConnectionPool::Instance*
 ClusterManagerImpl::ThreadLocalClusterManagerImpl::ClusterEntry::connPool(
     ResourcePriority priority, Http::Protocol protocol, LoadBalancerContext* context) {
@@ -1262,6 +1383,41 @@ ClusterManagerImpl::ThreadLocalClusterManagerImpl::ClusterEntry::connPool(
     have_transport_socket_options = true;
   }
 
+  const Network::TransportSocketOptionsSharedPtr transport_socket_options =
+      have_transport_socket_options ? context->upstreamTransportSocketOptions() : nullptr;
+
+  if (protocol == Http::Protocol::Http2 && cluster_info_->sharedHttp2PoolOwnerWorkers() > 0) {
+    WorkerConstSharedPtr owner =
+        parent_.sharedHttp2PoolOwner(host, cluster_info_->sharedHttp2PoolOwnerWorkers());
+    // Pools which own connections on behalf of other workers are keyed separately from forwarding
+    // pools. The owner uses them for its own streams as well.
+    std::vector<uint8_t> owned_hash_key = hash_key;
+    owned_hash_key.push_back(SharedHttp2PoolKeyMarker);
+    if (owner == parent_.worker_) {
+      hash_key = std::move(owned_hash_key);
+    } else if (owner != nullptr) {
+      ConnPoolsContainer& container = *parent_.getHttpConnPoolsContainer(host, true);
+      ConnPoolsContainer::ConnPools::PoolOptRef pool =
+          container.pools_->getPool(priority, hash_key, [&]() {
+            // The lookup only runs on the owner's dispatcher, through the owner's handle, so the
+            // owner's thread local cluster manager is alive whenever it runs.
+            Http::Http2::OwnerConnPoolLookup lookup =
+                [&owner_cluster_manager = owner->cluster_manager_,
+                 cluster_name = cluster_info_->name(), host, priority,
+                 owned_hash_key = std::move(owned_hash_key),
+                 options = !upstream_options->empty() ? upstream_options : nullptr,
+                 transport_socket_options]() {
+                  return owner_cluster_manager.ownedHttp2ConnPool(cluster_name, host, priority,
+                                                                  owned_hash_key, options,
+                                                                  transport_socket_options);
+                };
+            return std::make_unique<Http::Http2::ForwardingConnPoolImpl>(
+                parent_.thread_local_dispatcher_, owner->dispatcher_, host, std::move(lookup));
+          });
+      return pool.has_value() ? &(pool.value().get()) : nullptr;
+    }
+  }
+
   ConnPoolsContainer& container = *parent_.getHttpConnPoolsContainer(host, true);
 
   // Note: to simplify this, we assume that the factory is only called in the scope of this
@@ -1270,8 +1426,7 @@ ClusterManagerImpl::ThreadLocalClusterManagerImpl::ClusterEntry::connPool(
       container.pools_->getPool(priority, hash_key, [&]() {
         return parent_.parent_.factory_.allocateConnPool(
             parent_.thread_local_dispatcher_, host, priority, protocol,
-            !upstream_options->empty() ? upstream_options : nullptr,
-            have_transport_socket_options ? context->upstreamTransportSocketOptions() : nullptr);
+            !upstream_options->empty() ? upstream_options : nullptr, transport_socket_options);
       });
 
   if (pool.has_value()) {
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <array>
+#include <atomic>
 #include <cstdint>
 #include <functional>
 #include <list>
@@ -27,10 +28,14 @@
 #include "common/config/grpc_mux_impl.h"
 #include "common/config/subscription_factory_impl.h"
 #include "common/http/async_client_impl.h"
+#include "common/http/http2/forwarding_conn_pool.h"
 #include "common/upstream/load_stats_reporter.h"
 #include "common/upstream/priority_conn_pool_map.h"
 #include "common/upstream/upstream_impl.h"
 
+#include "absl/container/flat_hash_set.h"
+#include "absl/synchronization/mutex.h"
+
 namespace Envoy {
 namespace Upstream {
 
@@ -250,6 +255,42 @@ protected:
                                             const HostVector& hosts_removed);
 
 private:
+  struct ThreadLocalClusterManagerImpl;
+
+  /**
+   * A worker which may own HTTP/2 connections on behalf of other workers.
+   */
+  struct Worker {
+    Worker(Event::Dispatcher& dispatcher, ThreadLocalClusterManagerImpl& cluster_manager)
+        : dispatcher_(std::make_shared<Http::Http2::DispatcherHandle>(dispatcher)),
+          cluster_manager_(cluster_manager) {}
+
+    // Invalidated when the worker's thread local cluster manager is destroyed.
+    const Http::Http2::DispatcherHandleSharedPtr dispatcher_;
+    // Only used on the worker's thread, by callbacks posted through dispatcher_.
+    ThreadLocalClusterManagerImpl& cluster_manager_;
+  };
+  using WorkerConstSharedPtr = std::shared_ptr<const Worker>;
+
+  /**
+   * Workers which may own HTTP/2 connections shared with other workers, by worker index. Each
+   * worker's thread local cluster manager registers itself, so this is guarded by a lock. Readers
+   * cache a snapshot and only take the lock when the generation changes. This is shared with the
+   * thread local cluster managers as they may outlive the cluster manager during shutdown.
+   */
+  struct WorkerDispatchers {
+    void add(uint32_t index, WorkerConstSharedPtr worker);
+    void remove(uint32_t index);
+    // Copies the registered workers into the snapshot if the generation has changed.
+    void refresh(std::vector<WorkerConstSharedPtr>& snapshot, uint64_t& generation);
+
+    absl::Mutex lock_;
+    // Workers which have not registered yet, or are gone, are nullptr.
+    std::vector<WorkerConstSharedPtr> workers_ ABSL_GUARDED_BY(lock_);
+    std::atomic<uint64_t> generation_{};
+  };
+  using WorkerDispatchersSharedPtr = std::shared_ptr<WorkerDispatchers>;
+
   /**
    * Thread local cached cluster data. Each thread local cluster gets updates from the parent
    * central dynamic cluster (if applicable). It maintains load balancer state and any created
@@ -320,6 +361,9 @@ private:
 
       ThreadLocalClusterManagerImpl& parent_;
       PrioritySetImpl priority_set_;
+      // The hosts of all priorities, only maintained if HTTP/2 connections are shared across
+      // workers.
+      absl::flat_hash_set<HostConstSharedPtr> shared_http2_hosts_;
       // LB factory if applicable. Not all load balancer types have a factory. LB types that have
       // a factory will create a new LB on every membership update. LB types that don't have a
       // factory will create an LB on construction and use it forever.
@@ -352,6 +396,18 @@ private:
 
     ConnPoolsContainer* getHttpConnPoolsContainer(const HostConstSharedPtr& host,
                                                   bool allocate = false);
+    // Returns the worker which owns HTTP/2 connections to the given host, or nullptr if this thread
+    // is not a worker or the owner is not running.
+    WorkerConstSharedPtr sharedHttp2PoolOwner(const HostConstSharedPtr& host,
+                                              uint32_t owner_workers);
+    // Returns (allocating if needed) the HTTP/2 pool owned by this worker on behalf of streams
+    // forwarded from other workers. Returns nullptr if the cluster or host is gone or we are
+    // shutting down, as pools of hosts which are already gone would never be drained.
+    Http::ConnectionPool::Instance*
+    ownedHttp2ConnPool(const std::string& cluster_name, const HostConstSharedPtr& host,
+                       ResourcePriority priority, const std::vector<uint8_t>& hash_key,
+                       const Network::ConnectionSocket::OptionsSharedPtr& options,
+                       const Network::TransportSocketOptionsSharedPtr& transport_socket_options);
 
     ClusterManagerImpl& parent_;
     Event::Dispatcher& thread_local_dispatcher_;
@@ -366,6 +422,14 @@ private:
     std::list<Envoy::Upstream::ClusterUpdateCallbacks*> update_callbacks_;
     const PrioritySet* local_priority_set_{};
     bool destroying_{};
+    // The index of the worker this object lives on, if not on the main thread.
+    const absl::optional<uint32_t> worker_index_;
+    const WorkerDispatchersSharedPtr worker_dispatchers_;
+    // This worker, as registered in worker_dispatchers_.
+    WorkerConstSharedPtr worker_;
+    // Snapshot of the registered workers, refreshed whenever the generation changes.
+    std::vector<WorkerConstSharedPtr> worker_dispatchers_snapshot_;
+    uint64_t worker_dispatchers_generation_{};
   };
 
   struct ClusterData {
@@ -484,6 +548,7 @@ private:
   Event::Dispatcher& dispatcher_;
   Http::Context& http_context_;
   Config::SubscriptionFactoryImpl subscription_factory_;
+  const WorkerDispatchersSharedPtr worker_dispatchers_{std::make_shared<WorkerDispatchers>()};
 };
 
 } // namespace Upstream
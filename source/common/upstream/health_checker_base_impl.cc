@@ -35,6 +35,7 @@ HealthCheckerImplBase::HealthCheckerImplBase(const Cluster& cluster,
           PROTOBUF_GET_MS_OR_DEFAULT(config, unhealthy_edge_interval, unhealthy_interval_.count())),
       healthy_edge_interval_(
           PROTOBUF_GET_MS_OR_DEFAULT(config, healthy_edge_interval, interval_.count())),
+      interval_wheel_(initIntervalWheel(config, dispatcher)),
       transport_socket_options_(initTransportSocketOptions(config)),
       transport_socket_match_metadata_(initTransportSocketMatchMetadata(config)) {
   cluster_.prioritySet().addMemberUpdateCb(
@@ -70,6 +71,26 @@ MetadataConstSharedPtr HealthCheckerImplBase::initTransportSocketMatchMetadata(
   return nullptr;
 }
 
+Event::TimingWheelPtr
+HealthCheckerImplBase::initIntervalWheel(const envoy::config::core::v3::HealthCheck& config,
+                                         Event::Dispatcher& dispatcher) {
+  if (!config.has_batched_scheduling()) {
+    return nullptr;
+  }
+
+  return std::make_unique<Event::TimingWheel>(
+      dispatcher,
+      std::chrono::milliseconds(
+          PROTOBUF_GET_MS_OR_DEFAULT(config.batched_scheduling(), granularity, 100)));
+}
+
+Event::TimerPtr HealthCheckerImplBase::createIntervalTimer(Event::TimerCb cb) {
+  if (interval_wheel_ != nullptr) {
+    return interval_wheel_->createTimer(std::move(cb));
+  }
+  return dispatcher_.createTimer(std::move(cb));
+}
+
 HealthCheckerImplBase::~HealthCheckerImplBase() {
   // ASSERTs inside the session destructor check to make sure we have been previously deferred
   // deleted. Unify that logic here before actual destruction happens.
@@ -93,7 +114,8 @@ void HealthCheckerImplBase::decDegraded() {
 HealthCheckerStats HealthCheckerImplBase::generateStats(Stats::Scope& scope) {
   std::string prefix("health_check.");
   return {ALL_HEALTH_CHECKER_STATS(POOL_COUNTER_PREFIX(scope, prefix),
-                                   POOL_GAUGE_PREFIX(scope, prefix))};
+                                   POOL_GAUGE_PREFIX(scope, prefix),
+                                   POOL_HISTOGRAM_PREFIX(scope, prefix))};
 }
 
 void HealthCheckerImplBase::incHealthy() {
@@ -247,7 +269,7 @@ void HealthCheckerImplBase::start() {
 HealthCheckerImplBase::ActiveHealthCheckSession::ActiveHealthCheckSession(
     HealthCheckerImplBase& parent, HostSharedPtr host)
     : host_(host), parent_(parent),
-      interval_timer_(parent.dispatcher_.createTimer([this]() -> void { onIntervalBase(); })),
+      interval_timer_(parent.createIntervalTimer([this]() -> void { onIntervalBase(); })),
       timeout_timer_(parent.dispatcher_.createTimer([this]() -> void { onTimeoutBase(); })) {
 
   if (!host->healthFlagGet(Host::HealthFlag::FAILED_ACTIVE_HC)) {
@@ -329,7 +351,7 @@ void HealthCheckerImplBase::ActiveHealthCheckSession::handleSuccess(bool degrade
   parent_.runCallbacks(host_, changed_state);
 
   timeout_timer_->disableTimer();
-  interval_timer_->enableTimer(parent_.interval(HealthState::Healthy, changed_state));
+  scheduleCheck(parent_.interval(HealthState::Healthy, changed_state));
 }
 
 HealthTransition HealthCheckerImplBase::ActiveHealthCheckSession::setUnhealthy(
@@ -379,7 +401,7 @@ void HealthCheckerImplBase::ActiveHealthCheckSession::handleFailure(
   }
 
   if (interval_timer_ != nullptr) {
-    interval_timer_->enableTimer(parent_.interval(HealthState::Unhealthy, changed_state));
+    scheduleCheck(parent_.interval(HealthState::Unhealthy, changed_state));
   }
 }
 
@@ -395,7 +417,20 @@ HealthCheckerImplBase::ActiveHealthCheckSession::clearPendingFlag(HealthTransiti
   return changed_state;
 }
 
+void HealthCheckerImplBase::ActiveHealthCheckSession::scheduleCheck(
+    std::chrono::milliseconds interval) {
+  next_check_time_ = parent_.dispatcher_.timeSource().monotonicTime() + interval;
+  interval_timer_->enableTimer(interval);
+}
+
 void HealthCheckerImplBase::ActiveHealthCheckSession::onIntervalBase() {
+  const MonotonicTime now = parent_.dispatcher_.timeSource().monotonicTime();
+  if (now > next_check_time_) {
+    parent_.stats_.scheduling_lag_ms_.recordValue(
+        std::chrono::duration_cast<std::chrono::milliseconds>(now - next_check_time_).count());
+  } else {
+    parent_.stats_.scheduling_lag_ms_.recordValue(0);
+  }
   onInterval();
   timeout_timer_->enableTimer(parent_.timeout_);
   parent_.stats_.attempt_.inc();
@@ -407,11 +442,15 @@ void HealthCheckerImplBase::ActiveHealthCheckSession::onTimeoutBase() {
 }
 
 void HealthCheckerImplBase::ActiveHealthCheckSession::onInitialInterval() {
-  if (parent_.initial_jitter_.count() == 0) {
-    onIntervalBase();
+  if (parent_.initial_jitter_.count() != 0) {
+    scheduleCheck(parent_.intervalWithJitter(0, parent_.initial_jitter_));
+  } else if (parent_.interval_wheel_ != nullptr) {
+    // Spread the first round of checks across an interval so that a large cluster does not open
+    // all of its health check connections at once.
+    scheduleCheck(parent_.intervalWithJitter(0, parent_.interval_));
   } else {
-    interval_timer_->enableTimer(
-        std::chrono::milliseconds(parent_.intervalWithJitter(0, parent_.initial_jitter_)));
+    next_check_time_ = parent_.dispatcher_.timeSource().monotonicTime();
+    onIntervalBase();
   }
 }
 
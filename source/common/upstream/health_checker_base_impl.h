@@ -11,6 +11,7 @@
 
 #include "common/common/logger.h"
 #include "common/common/matchers.h"
+#include "common/event/timing_wheel.h"
 #include "common/network/transport_socket_options_impl.h"
 
 namespace Envoy {
@@ -19,7 +20,7 @@ namespace Upstream {
 /**
  * All health checker stats. @see stats_macros.h
  */
-#define ALL_HEALTH_CHECKER_STATS(COUNTER, GAUGE)                                                   \
+#define ALL_HEALTH_CHECKER_STATS(COUNTER, GAUGE, HISTOGRAM)                                        \
   COUNTER(attempt)                                                                                 \
   COUNTER(failure)                                                                                 \
   COUNTER(network_failure)                                                                         \
@@ -27,13 +28,15 @@ namespace Upstream {
   COUNTER(success)                                                                                 \
   COUNTER(verify_cluster)                                                                          \
   GAUGE(degraded, Accumulate)                                                                      \
-  GAUGE(healthy, Accumulate)
+  GAUGE(healthy, Accumulate)                                                                       \
+  HISTOGRAM(scheduling_lag_ms, Milliseconds)
 
 /**
  * Definition of all health checker stats. @see stats_macros.h
  */
 struct HealthCheckerStats {
-  ALL_HEALTH_CHECKER_STATS(GENERATE_COUNTER_STRUCT, GENERATE_GAUGE_STRUCT)
+  ALL_HEALTH_CHECKER_STATS(GENERATE_COUNTER_STRUCT, GENERATE_GAUGE_STRUCT,
+                           GENERATE_HISTOGRAM_STRUCT)
 };
 
 /**
@@ -81,10 +84,13 @@ protected:
     void onTimeoutBase();
     virtual void onDeferredDelete() PURE;
     void onInitialInterval();
+    // Arms the interval timer and remembers when the next check is due, for the lag statistic.
+    void scheduleCheck(std::chrono::milliseconds interval);
 
     HealthCheckerImplBase& parent_;
     Event::TimerPtr interval_timer_;
     Event::TimerPtr timeout_timer_;
+    MonotonicTime next_check_time_;
     uint32_t num_unhealthy_{};
     uint32_t num_healthy_{};
     bool first_check_{true};
@@ -126,6 +132,7 @@ private:
   };
 
   void addHosts(const HostVector& hosts);
+  Event::TimerPtr createIntervalTimer(Event::TimerCb cb);
   void decHealthy();
   void decDegraded();
   HealthCheckerStats generateStats(Stats::Scope& scope);
@@ -142,6 +149,9 @@ private:
   initTransportSocketOptions(const envoy::config::core::v3::HealthCheck& config);
   static MetadataConstSharedPtr
   initTransportSocketMatchMetadata(const envoy::config::core::v3::HealthCheck& config);
+  static Event::TimingWheelPtr
+  initIntervalWheel(const envoy::config::core::v3::HealthCheck& config,
+                    Event::Dispatcher& dispatcher);
 
   static const std::chrono::milliseconds NO_TRAFFIC_INTERVAL;
 
@@ -154,6 +164,9 @@ private:
   const std::chrono::milliseconds unhealthy_interval_;
   const std::chrono::milliseconds unhealthy_edge_interval_;
   const std::chrono::milliseconds healthy_edge_interval_;
+  // Drives the interval timers of all sessions if batched scheduling is configured. This must
+  // outlive the sessions.
+  const Event::TimingWheelPtr interval_wheel_;
   std::unordered_map<HostSharedPtr, ActiveHealthCheckSessionPtr> active_sessions_;
   uint64_t local_process_healthy_{};
   uint64_t local_process_degraded_{};
@@ -1,5 +1,6 @@
 #include "common/upstream/outlier_detection_impl.h"
 
+#include <algorithm>
 #include <chrono>
 #include <cstdint>
 #include <memory>
@@ -35,12 +36,31 @@ DetectorSharedPtr DetectorImplFactory::createForCluster(
   }
 }
 
+namespace {
+
+// Sharding the success rate counters costs a cache line per shard for every host, so it is only
+// worth it for clusters with few, very busy hosts. It is off unless enabled through runtime.
+uint32_t successRateCounterShards(DetectorImpl& detector) {
+  return std::max<uint64_t>(
+      std::min<uint64_t>(detector.runtime().snapshot().getInteger(
+                             "outlier_detection.success_rate_counter_shards", 1),
+                         SuccessRateAccumulatorBucket::MaxShards),
+      1);
+}
+
+} // namespace
+
 DetectorHostMonitorImpl::DetectorHostMonitorImpl(std::shared_ptr<DetectorImpl> detector,
                                                  HostSharedPtr host)
     : detector_(detector), host_(host),
       // add Success Rate monitors
-      external_origin_sr_monitor_(envoy::data::cluster::v2alpha::SUCCESS_RATE),
-      local_origin_sr_monitor_(envoy::data::cluster::v2alpha::SUCCESS_RATE_LOCAL_ORIGIN) {
+      external_origin_sr_monitor_(envoy::data::cluster::v2alpha::SUCCESS_RATE,
+                                  successRateCounterShards(*detector)),
+      // The local origin monitor is only written to when external/local errors are split.
+      local_origin_sr_monitor_(envoy::data::cluster::v2alpha::SUCCESS_RATE_LOCAL_ORIGIN,
+                               detector->config().splitExternalLocalOriginErrors()
+                                   ? successRateCounterShards(*detector)
+                                   : 1) {
   // Setup method to call when putResult is invoked. Depending on the config's
   // split_external_local_origin_errors_ boolean value different method is called.
   put_result_func_ = detector->config().splitExternalLocalOriginErrors()
@@ -65,8 +85,9 @@ void DetectorHostMonitorImpl::updateCurrentSuccessRateBucket() {
 }
 
 void DetectorHostMonitorImpl::putHttpResponseCode(uint64_t response_code) {
-  external_origin_sr_monitor_.incTotalReqCounter();
-  if (Http::CodeUtility::is5xx(response_code)) {
+  const bool is_5xx = Http::CodeUtility::is5xx(response_code);
+  external_origin_sr_monitor_.putResult(!is_5xx);
+  if (is_5xx) {
     std::shared_ptr<DetectorImpl> detector = detector_.lock();
     if (!detector) {
       // It's possible for the cluster/detector to go away while we still have a host in use.
@@ -88,9 +109,14 @@ void DetectorHostMonitorImpl::putHttpResponseCode(uint64_t response_code) {
       detector->onConsecutive5xx(host_.lock());
     }
   } else {
-    external_origin_sr_monitor_.incSuccessReqCounter();
-    consecutive_5xx_ = 0;
-    consecutive_gateway_failure_ = 0;
+    // Only write the counters when they need resetting, so that their cache line is not bounced
+    // between workers on every successful response.
+    if (consecutive_5xx_.load(std::memory_order_relaxed) != 0) {
+      consecutive_5xx_ = 0;
+    }
+    if (consecutive_gateway_failure_.load(std::memory_order_relaxed) != 0) {
+      consecutive_gateway_failure_ = 0;
+    }
   }
 }
 
@@ -185,7 +211,7 @@ void DetectorHostMonitorImpl::localOriginFailure() {
     // It's possible for the cluster/detector to go away while we still have a host in use.
     return;
   }
-  local_origin_sr_monitor_.incTotalReqCounter();
+  local_origin_sr_monitor_.putResult(false);
   if (++consecutive_local_origin_failure_ ==
       detector->runtime().snapshot().getInteger(
           "outlier_detection.consecutive_local_origin_failure",
@@ -201,8 +227,7 @@ void DetectorHostMonitorImpl::localOriginNoFailure() {
     return;
   }
 
-  local_origin_sr_monitor_.incTotalReqCounter();
-  local_origin_sr_monitor_.incSuccessReqCounter();
+  local_origin_sr_monitor_.putResult(true);
 
   resetConsecutiveLocalOriginFailure();
 }
@@ -553,9 +578,10 @@ void DetectorImpl::onConsecutiveErrorWorker(
   }
 }
 
-DetectorImpl::EjectionPair DetectorImpl::successRateEjectionThreshold(
-    double success_rate_sum, const std::vector<HostSuccessRatePair>& valid_success_rate_hosts,
-    double success_rate_stdev_factor) {
+DetectorImpl::EjectionPair
+DetectorImpl::successRateEjectionThreshold(const std::vector<double>& success_rates,
+                                           double success_rate_stdev_factor) {
+  ASSERT(!success_rates.empty());
   // This function is using mean and standard deviation as statistical measures for outlier
   // detection. First the mean is calculated by dividing the sum of success rate data over the
   // number of data points. Then variance is calculated by taking the mean of the
@@ -566,19 +592,44 @@ DetectorImpl::EjectionPair DetectorImpl::successRateEjectionThreshold(
   //
   // For example with a data set that looks like success_rate_data = {50, 100, 100, 100, 100} the
   // math would work as follows:
-  // success_rate_sum = 450
   // mean = 90
   // variance = 400
   // stdev = 20
   // threshold returned = 52
-  double mean = success_rate_sum / valid_success_rate_hosts.size();
-  double variance = 0;
-  std::for_each(valid_success_rate_hosts.begin(), valid_success_rate_hosts.end(),
-                [&variance, mean](HostSuccessRatePair v) {
-                  variance += std::pow(v.success_rate_ - mean, 2);
-                });
-  variance /= valid_success_rate_hosts.size();
-  double stdev = std::sqrt(variance);
+  //
+  // Both reductions keep Lanes independent partial sums, which the compiler can hold in a vector
+  // register without having to reassociate floating point additions.
+  constexpr size_t Lanes = 4;
+  const size_t size = success_rates.size();
+  const size_t vector_size = size - size % Lanes;
+  const double* rates = success_rates.data();
+
+  double sums[Lanes] = {};
+  for (size_t i = 0; i < vector_size; i += Lanes) {
+    for (size_t lane = 0; lane < Lanes; lane++) {
+      sums[lane] += rates[i + lane];
+    }
+  }
+  double sum = (sums[0] + sums[1]) + (sums[2] + sums[3]);
+  for (size_t i = vector_size; i < size; i++) {
+    sum += rates[i];
+  }
+  const double mean = sum / size;
+
+  double squares[Lanes] = {};
+  for (size_t i = 0; i < vector_size; i += Lanes) {
+    for (size_t lane = 0; lane < Lanes; lane++) {
+      const double diff = rates[i + lane] - mean;
+      squares[lane] += diff * diff;
+    }
+  }
+  double variance = (squares[0] + squares[1]) + (squares[2] + squares[3]);
+  for (size_t i = vector_size; i < size; i++) {
+    const double diff = rates[i] - mean;
+    variance += diff * diff;
+  }
+  variance /= size;
+  const double stdev = std::sqrt(variance);
 
   return {mean, (mean - (success_rate_stdev_factor * stdev))};
 }
@@ -596,10 +647,6 @@ void DetectorImpl::processSuccessRateEjections(
       runtime_.snapshot().getInteger("outlier_detection.failure_percentage_request_volume",
                                      config_.failurePercentageRequestVolume());
 
-  std::vector<HostSuccessRatePair> valid_success_rate_hosts;
-  std::vector<HostSuccessRatePair> valid_failure_percentage_hosts;
-  double success_rate_sum = 0;
-
   // Reset the Detector's success rate mean and stdev.
   getSRNums(monitor_type) = {-1, -1};
 
@@ -609,57 +656,73 @@ void DetectorImpl::processSuccessRateEjections(
     return;
   }
 
-  // reserve upper bound of vector size to avoid reallocation.
-  valid_success_rate_hosts.reserve(host_monitors_.size());
-  valid_failure_percentage_hosts.reserve(host_monitors_.size());
-
+  // Gather the counters of all hosts which are not already ejected into contiguous arrays. The
+  // success rates, the filtering by request volume and the threshold math below are then plain
+  // loops over arrays which the compiler can vectorize, which matters for large clusters.
+  std::vector<const std::pair<const HostSharedPtr, DetectorHostMonitorImpl*>*> hosts;
+  std::vector<double> success_counts;
+  std::vector<double> request_volumes;
+  hosts.reserve(host_monitors_.size());
+  success_counts.reserve(host_monitors_.size());
+  request_volumes.reserve(host_monitors_.size());
   for (const auto& host : host_monitors_) {
     // Don't do work if the host is already ejected.
-    if (!host.first->healthFlagGet(Host::HealthFlag::FAILED_OUTLIER_CHECK)) {
-      absl::optional<std::pair<double, uint64_t>> host_success_rate_and_volume =
-          host.second->getSRMonitor(monitor_type)
-              .successRateAccumulator()
-              .getSuccessRateAndVolume();
-
-      if (!host_success_rate_and_volume) {
-        continue;
-      }
-      double success_rate = host_success_rate_and_volume.value().first;
-      double request_volume = host_success_rate_and_volume.value().second;
+    if (host.first->healthFlagGet(Host::HealthFlag::FAILED_OUTLIER_CHECK)) {
+      continue;
+    }
+    const std::pair<uint64_t, uint64_t> success_and_total =
+        host.second->getSRMonitor(monitor_type).successRateAccumulator().successAndTotal();
+    if (!success_and_total.second) {
+      continue;
+    }
+    hosts.push_back(&host);
+    success_counts.push_back(success_and_total.first);
+    request_volumes.push_back(success_and_total.second);
+  }
 
-      if (request_volume >=
-          std::min(success_rate_request_volume, failure_percentage_request_volume)) {
-        host.second->successRate(monitor_type, success_rate);
-      }
+  const size_t num_hosts = hosts.size();
+  std::vector<double> success_rates(num_hosts);
+  for (size_t i = 0; i < num_hosts; i++) {
+    success_rates[i] = success_counts[i] * 100.0 / request_volumes[i];
+  }
 
-      if (request_volume >= success_rate_request_volume) {
-        valid_success_rate_hosts.emplace_back(HostSuccessRatePair(host.first, success_rate));
-        success_rate_sum += success_rate;
-      }
-      if (request_volume >= failure_percentage_request_volume) {
-        valid_failure_percentage_hosts.emplace_back(HostSuccessRatePair(host.first, success_rate));
-      }
+  const double min_request_volume =
+      std::min(success_rate_request_volume, failure_percentage_request_volume);
+  std::vector<double> valid_success_rates;
+  std::vector<size_t> valid_success_rate_hosts;
+  std::vector<size_t> valid_failure_percentage_hosts;
+  valid_success_rates.reserve(num_hosts);
+  valid_success_rate_hosts.reserve(num_hosts);
+  valid_failure_percentage_hosts.reserve(num_hosts);
+  for (size_t i = 0; i < num_hosts; i++) {
+    if (request_volumes[i] >= min_request_volume) {
+      hosts[i]->second->successRate(monitor_type, success_rates[i]);
+    }
+    if (request_volumes[i] >= success_rate_request_volume) {
+      valid_success_rates.push_back(success_rates[i]);
+      valid_success_rate_hosts.push_back(i);
+    }
+    if (request_volumes[i] >= failure_percentage_request_volume) {
+      valid_failure_percentage_hosts.push_back(i);
     }
   }
 
-  if (!valid_success_rate_hosts.empty() &&
-      valid_success_rate_hosts.size() >= success_rate_minimum_hosts) {
+  if (!valid_success_rates.empty() && valid_success_rates.size() >= success_rate_minimum_hosts) {
     const double success_rate_stdev_factor =
         runtime_.snapshot().getInteger("outlier_detection.success_rate_stdev_factor",
                                        config_.successRateStdevFactor()) /
         1000.0;
-    getSRNums(monitor_type) = successRateEjectionThreshold(
-        success_rate_sum, valid_success_rate_hosts, success_rate_stdev_factor);
+    getSRNums(monitor_type) =
+        successRateEjectionThreshold(valid_success_rates, success_rate_stdev_factor);
     const double success_rate_ejection_threshold = getSRNums(monitor_type).ejection_threshold_;
-    for (const auto& host_success_rate_pair : valid_success_rate_hosts) {
-      if (host_success_rate_pair.success_rate_ < success_rate_ejection_threshold) {
+    for (size_t i = 0; i < valid_success_rates.size(); i++) {
+      if (valid_success_rates[i] < success_rate_ejection_threshold) {
         stats_.ejections_success_rate_.inc(); // Deprecated.
+        const auto& host = *hosts[valid_success_rate_hosts[i]];
         const envoy::data::cluster::v2alpha::OutlierEjectionType type =
-            host_monitors_[host_success_rate_pair.host_]
-                ->getSRMonitor(monitor_type)
-                .getEjectionType();
+            host.second->getSRMonitor(monitor_type).getEjectionType();
         updateDetectedEjectionStats(type);
-        ejectHost(host_success_rate_pair.host_, type);
+        ejectHost(host.first, type);
       }
     }
   }
@@ -669,8 +732,8 @@ void DetectorImpl::processSuccessRateEjections(
     const double failure_percentage_threshold = runtime_.snapshot().getInteger(
         "outlier_detection.failure_percentage_threshold", config_.failurePercentageThreshold());
 
-    for (const auto& host_success_rate_pair : valid_failure_percentage_hosts) {
-      if ((100.0 - host_success_rate_pair.success_rate_) >= failure_percentage_threshold) {
+    for (const size_t i : valid_failure_percentage_hosts) {
+      if ((100.0 - success_rates[i]) >= failure_percentage_threshold) {
         // We should eject.
 
         // The ejection type returned by the SuccessRateMonitor's getEjectionType() will be a
@@ -680,7 +743,7 @@ void DetectorImpl::processSuccessRateEjections(
                 ? envoy::data::cluster::v2alpha::FAILURE_PERCENTAGE
                 : envoy::data::cluster::v2alpha::FAILURE_PERCENTAGE_LOCAL_ORIGIN;
         updateDetectedEjectionStats(type);
-        ejectHost(host_success_rate_pair.host_, type);
+        ejectHost(hosts[i]->first, type);
       }
     }
   }
@@ -782,10 +845,60 @@ void EventLoggerImpl::setCommonEventParams(
   TimestampUtil::systemClockToTimestamp(time_source_.systemTime(), *event.mutable_timestamp());
 }
 
+namespace {
+
+uint32_t shardMask(uint32_t shards) {
+  uint32_t rounded = 1;
+  while (rounded < shards && rounded < SuccessRateAccumulatorBucket::MaxShards) {
+    rounded <<= 1;
+  }
+  return rounded - 1;
+}
+
+} // namespace
+
+SuccessRateAccumulatorBucket::SuccessRateAccumulatorBucket(uint32_t shards)
+    : shard_mask_(shardMask(shards)) {
+  if (shard_mask_ != 0) {
+    shards_.reset(new Shard[shard_mask_ + 1]);
+  }
+}
+
+std::pair<uint64_t, uint64_t> SuccessRateAccumulatorBucket::successAndTotal() const {
+  if (shards_ == nullptr) {
+    return {counters_.success_.load(std::memory_order_relaxed),
+            counters_.total_.load(std::memory_order_relaxed)};
+  }
+  uint64_t success = 0;
+  uint64_t total = 0;
+  for (uint32_t i = 0; i <= shard_mask_; i++) {
+    success += shards_[i].counters_.success_.load(std::memory_order_relaxed);
+    total += shards_[i].counters_.total_.load(std::memory_order_relaxed);
+  }
+  return {success, total};
+}
+
+void SuccessRateAccumulatorBucket::reset() {
+  if (shards_ == nullptr) {
+    counters_.success_.store(0, std::memory_order_relaxed);
+    counters_.total_.store(0, std::memory_order_relaxed);
+    return;
+  }
+  for (uint32_t i = 0; i <= shard_mask_; i++) {
+    shards_[i].counters_.success_.store(0, std::memory_order_relaxed);
+    shards_[i].counters_.total_.store(0, std::memory_order_relaxed);
+  }
+}
+
+uint32_t SuccessRateAccumulatorBucket::threadShard() {
+  static std::atomic<uint32_t> next_shard{0};
+  static thread_local const uint32_t shard = next_shard++;
+  return shard;
+}
+
 SuccessRateAccumulatorBucket* SuccessRateAccumulator::updateCurrentWriter() {
   // Right now current is being written to and backup is not. Flush the backup and swap.
-  backup_success_rate_bucket_->success_request_counter_ = 0;
-  backup_success_rate_bucket_->total_request_counter_ = 0;
+  backup_success_rate_bucket_->reset();
 
   current_success_rate_bucket_.swap(backup_success_rate_bucket_);
 
@@ -793,14 +906,14 @@ SuccessRateAccumulatorBucket* SuccessRateAccumulator::updateCurrentWriter() {
 }
 
 absl::optional<std::pair<double, uint64_t>> SuccessRateAccumulator::getSuccessRateAndVolume() {
-  if (!backup_success_rate_bucket_->total_request_counter_) {
+  const std::pair<uint64_t, uint64_t> success_and_total = successAndTotal();
+  if (!success_and_total.second) {
     return absl::nullopt;
   }
 
-  double success_rate = backup_success_rate_bucket_->success_request_counter_ * 100.0 /
-                        backup_success_rate_bucket_->total_request_counter_;
+  double success_rate = success_and_total.first * 100.0 / success_and_total.second;
 
-  return {{success_rate, backup_success_rate_bucket_->total_request_counter_}};
+  return {{success_rate, success_and_total.second}};
 }
 
 } // namespace Outlier
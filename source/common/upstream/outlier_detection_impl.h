@@ -21,6 +21,8 @@
 #include "envoy/upstream/outlier_detection.h"
 #include "envoy/upstream/upstream.h"
 
+#include "absl/base/optimization.h"
+
 namespace Envoy {
 namespace Upstream {
 namespace Outlier {
@@ -55,18 +57,72 @@ public:
 };
 
 /**
- * Thin struct to facilitate calculations for success rate outlier detection.
+ * Request counters for one success rate window. By default a bucket is a single pair of counters.
+ * With more than one shard the counters are split into cache line sized shards and a thread always
+ * writes to the same shard, so workers reporting results for a busy host do not contend on a
+ * single cache line, at the cost of one cache line per shard. Readers sum all shards.
  */
-struct HostSuccessRatePair {
-  HostSuccessRatePair(HostSharedPtr host, double success_rate)
-      : host_(host), success_rate_(success_rate) {}
-  HostSharedPtr host_;
-  double success_rate_;
-};
+class SuccessRateAccumulatorBucket {
+public:
+  static constexpr uint32_t MaxShards = 16;
+
+  /**
+   * @param shards supplies the number of shards. It is rounded up to a power of two and capped at
+   *               MaxShards. A single shard is held inline and allocates nothing.
+   */
+  explicit SuccessRateAccumulatorBucket(uint32_t shards);
+
+  /**
+   * Records the result of a request against the calling thread's shard.
+   * @param success supplies whether the request succeeded.
+   */
+  void put(bool success) {
+    Counters& counters =
+        shards_ == nullptr ? counters_ : shards_[threadShard() & shard_mask_].counters_;
+    if (success) {
+      counters.success_.fetch_add(1, std::memory_order_relaxed);
+    }
+    counters.total_.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  /**
+   * Sums all shards.
+   * @return the number of successful and total requests in the window.
+   */
+  std::pair<uint64_t, uint64_t> successAndTotal() const;
 
-struct SuccessRateAccumulatorBucket {
-  std::atomic<uint64_t> success_request_counter_;
-  std::atomic<uint64_t> total_request_counter_;
+  /**
+   * Clears all shards.
+   */
+  void reset();
+
+  /**
+   * @return the number of shards in use.
+   */
+  uint32_t shards() const { return shard_mask_ + 1; }
+
+private:
+  struct Counters {
+    std::atomic<uint64_t> success_{0};
+    std::atomic<uint64_t> total_{0};
+  };
+
+  // Padded rather than aligned as over-aligned allocation is not available in C++14. With a stride
+  // of one cache line no two shards ever share a line, whatever the alignment of the array.
+  struct Shard {
+    Counters counters_;
+    char padding_[ABSL_CACHELINE_SIZE - sizeof(Counters)];
+  };
+
+  // Index used by the calling thread to pick a shard. Threads are numbered in the order in which
+  // they first record a result, so up to MaxShards workers never share a shard.
+  static uint32_t threadShard();
+
+  const uint32_t shard_mask_;
+  // Used when there is a single shard.
+  Counters counters_;
+  // Only allocated when there is more than one shard.
+  std::unique_ptr<Shard[]> shards_;
 };
 
 /**
@@ -76,9 +132,9 @@ struct SuccessRateAccumulatorBucket {
  */
 class SuccessRateAccumulator {
 public:
-  SuccessRateAccumulator()
-      : current_success_rate_bucket_(new SuccessRateAccumulatorBucket()),
-        backup_success_rate_bucket_(new SuccessRateAccumulatorBucket()) {}
+  explicit SuccessRateAccumulator(uint32_t shards = 1)
+      : current_success_rate_bucket_(new SuccessRateAccumulatorBucket(shards)),
+        backup_success_rate_bucket_(new SuccessRateAccumulatorBucket(shards)) {}
 
   /**
    * This function updates the bucket to write data to.
@@ -96,6 +152,13 @@ public:
    */
   absl::optional<std::pair<double, uint64_t>> getSuccessRateAndVolume();
 
+  /**
+   * @return the number of successful and total requests in the last completed window.
+   */
+  std::pair<uint64_t, uint64_t> successAndTotal() const {
+    return backup_success_rate_bucket_->successAndTotal();
+  }
+
 private:
   std::unique_ptr<SuccessRateAccumulatorBucket> current_success_rate_bucket_;
   std::unique_ptr<SuccessRateAccumulatorBucket> backup_success_rate_bucket_;
@@ -103,8 +166,9 @@ private:
 
 class SuccessRateMonitor {
 public:
-  SuccessRateMonitor(envoy::data::cluster::v2alpha::OutlierEjectionType ejection_type)
-      : ejection_type_(ejection_type), success_rate_(-1) {
+  SuccessRateMonitor(envoy::data::cluster::v2alpha::OutlierEjectionType ejection_type,
+                     uint32_t shards = 1)
+      : success_rate_accumulator_(shards), ejection_type_(ejection_type), success_rate_(-1) {
     // Point the success_rate_accumulator_bucket_ pointer to a bucket.
     updateCurrentSuccessRateBucket();
   }
@@ -114,10 +178,7 @@ public:
   void updateCurrentSuccessRateBucket() {
     success_rate_accumulator_bucket_.store(success_rate_accumulator_.updateCurrentWriter());
   }
-  void incTotalReqCounter() { success_rate_accumulator_bucket_.load()->total_request_counter_++; }
-  void incSuccessReqCounter() {
-    success_rate_accumulator_bucket_.load()->success_request_counter_++;
-  }
+  void putResult(bool success) { success_rate_accumulator_bucket_.load()->put(success); }
 
   envoy::data::cluster::v2alpha::OutlierEjectionType getEjectionType() const {
     return ejection_type_;
@@ -350,20 +411,19 @@ public:
   /**
    * This function returns pair of double values for success rate outlier detection. The pair
    * contains the average success rate of all valid hosts in the cluster and the ejection threshold.
-   * If a host's success rate is under this threshold, the host is an outlier.
-   * @param success_rate_sum is the sum of the data in the success_rate_data vector.
-   * @param valid_success_rate_hosts is the vector containing the individual success rate data
-   *        points.
+   * If a host's success rate is under this threshold, the host is an outlier. The sum and variance
+   * are computed in plain loops over doubles which the compiler can vectorize, which matters for
+   * large clusters.
+   * @param success_rates supplies the success rates of all valid hosts. Must not be empty.
+   * @param success_rate_stdev_factor supplies the factor applied to the standard deviation.
    * @return EjectionPair
    */
   struct EjectionPair {
     double success_rate_average_; // average success rate of all valid hosts in the cluster
     double ejection_threshold_;   // ejection threshold for the cluster
   };
-  static EjectionPair
-  successRateEjectionThreshold(double success_rate_sum,
-                               const std::vector<HostSuccessRatePair>& valid_success_rate_hosts,
-                               double success_rate_stdev_factor);
+  static EjectionPair successRateEjectionThreshold(const std::vector<double>& success_rates,
+                                                   double success_rate_stdev_factor);
 
 private:
   DetectorImpl(const Cluster& cluster, const envoy::config::cluster::v3::OutlierDetection& config,
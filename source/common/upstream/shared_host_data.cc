@@ -0,0 +1,67 @@
+#include "common/upstream/shared_host_data.h"
+
+#include <algorithm>
+
+#include "common/common/assert.h"
+
+#include "absl/hash/hash.h"
+
+namespace Envoy {
+namespace Upstream {
+
+SINGLETON_MANAGER_REGISTRATION(shared_address_pool);
+
+constexpr size_t SharedAddressPool::MinPurgeThreshold;
+
+HostLocalityConstSharedPtr
+HostLocalityPool::getLocality(const envoy::config::core::v3::Locality& locality) {
+  auto it = localities_.find(locality);
+  if (it == localities_.end()) {
+    it = localities_
+             .emplace(locality, std::make_shared<const HostLocality>(locality, symbol_table_))
+             .first;
+  }
+  return it->second;
+}
+
+Network::Address::InstanceConstSharedPtr
+SharedAddressPool::getAddress(const Network::Address::InstanceConstSharedPtr& address) {
+  ASSERT(address != nullptr);
+  const absl::string_view address_string = address->asStringView();
+  const size_t key = absl::Hash<absl::string_view>()(address_string);
+  auto it = addresses_.find(key);
+  if (it != addresses_.end()) {
+    Network::Address::InstanceConstSharedPtr existing = it->second.lock();
+    if (existing != nullptr) {
+      return existing->asStringView() == address_string ? existing : address;
+    }
+    it->second = address;
+    return address;
+  }
+
+  addresses_.emplace(key, address);
+  if (addresses_.size() >= purge_threshold_) {
+    purgeExpired();
+  }
+  return address;
+}
+
+void SharedAddressPool::purgeExpired() {
+  for (auto it = addresses_.begin(); it != addresses_.end();) {
+    if (it->second.expired()) {
+      addresses_.erase(it++);
+    } else {
+      ++it;
+    }
+  }
+  // Purge again once the pool has doubled, which keeps purging amortized O(1) per address.
+  purge_threshold_ = std::max(MinPurgeThreshold, addresses_.size() * 2);
+}
+
+SharedAddressPoolSharedPtr SharedAddressPool::get(Singleton::Manager& manager) {
+  return manager.getTyped<SharedAddressPool>(SINGLETON_MANAGER_REGISTERED_NAME(shared_address_pool),
+                                             [] { return std::make_shared<SharedAddressPool>(); });
+}
+
+} // namespace Upstream
+} // namespace Envoy
@@ -0,0 +1,100 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+
+#include "envoy/config/core/v3/base.pb.h"
+#include "envoy/network/address.h"
+#include "envoy/singleton/instance.h"
+#include "envoy/singleton/manager.h"
+#include "envoy/stats/symbol_table.h"
+#include "envoy/upstream/locality.h"
+
+#include "common/common/non_copyable.h"
+#include "common/stats/symbol_table_impl.h"
+
+#include "absl/container/flat_hash_map.h"
+
+namespace Envoy {
+namespace Upstream {
+
+/**
+ * A host's locality along with the stat name of its zone. With the compact host representation
+ * all hosts of a cluster which are in the same locality share one instance.
+ */
+class HostLocality : NonCopyable {
+public:
+  HostLocality(const envoy::config::core::v3::Locality& locality, Stats::SymbolTable& symbol_table)
+      : locality_(locality), zone_stat_name_(locality.zone(), symbol_table) {}
+
+  const envoy::config::core::v3::Locality& locality() const { return locality_; }
+  Stats::StatName zoneStatName() const { return zone_stat_name_.statName(); }
+
+private:
+  const envoy::config::core::v3::Locality locality_;
+  Stats::StatNameManagedStorage zone_stat_name_;
+};
+
+using HostLocalityConstSharedPtr = std::shared_ptr<const HostLocality>;
+
+/**
+ * Hands out one HostLocality per distinct locality. Localities are few and long lived, so they are
+ * kept for the lifetime of the pool. Must only be used from the main thread.
+ */
+class HostLocalityPool {
+public:
+  explicit HostLocalityPool(Stats::SymbolTable& symbol_table) : symbol_table_(symbol_table) {}
+
+  /**
+   * @param locality supplies the locality to look up.
+   * @return the shared instance for the locality, creating it if needed.
+   */
+  HostLocalityConstSharedPtr getLocality(const envoy::config::core::v3::Locality& locality);
+
+  size_t size() const { return localities_.size(); }
+
+private:
+  Stats::SymbolTable& symbol_table_;
+  absl::flat_hash_map<envoy::config::core::v3::Locality, HostLocalityConstSharedPtr, LocalityHash,
+                      LocalityEqualTo>
+      localities_;
+};
+
+/**
+ * Shares address objects between hosts with identical addresses, across all clusters which use the
+ * compact host representation. The pool only holds weak references, so an address is freed once
+ * the last host using it goes away, and expired entries are purged as the pool grows. Must only be
+ * used from the main thread, though the addresses it hands out may be released from any thread.
+ */
+class SharedAddressPool : public Singleton::Instance {
+public:
+  /**
+   * @param address supplies a newly resolved address.
+   * @return an existing address equal to the supplied one, or the supplied address which is then
+   *         shared with later callers.
+   */
+  Network::Address::InstanceConstSharedPtr
+  getAddress(const Network::Address::InstanceConstSharedPtr& address);
+
+  size_t size() const { return addresses_.size(); }
+
+  /**
+   * @return the pool registered with the singleton manager, creating it if needed.
+   */
+  static std::shared_ptr<SharedAddressPool> get(Singleton::Manager& manager);
+
+private:
+  void purgeExpired();
+
+  // Keyed by the hash of the address string rather than the string itself to avoid storing a
+  // second copy of every address. Colliding addresses are simply not shared.
+  absl::flat_hash_map<size_t, std::weak_ptr<const Network::Address::Instance>> addresses_;
+  size_t purge_threshold_{MinPurgeThreshold};
+
+  static constexpr size_t MinPurgeThreshold = 1024;
+};
+
+using SharedAddressPoolSharedPtr = std::shared_ptr<SharedAddressPool>;
+
+} // namespace Upstream
+} // namespace Envoy
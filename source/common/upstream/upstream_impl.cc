@@ -239,10 +239,9 @@ HostVector filterHosts(const std::unordered_set<HostSharedPtr>& hosts,
 
 } // namespace
 
-HostDescriptionImpl::HostDescriptionImpl(
+HostDescriptionImplBase::HostDescriptionImplBase(
     ClusterInfoConstSharedPtr cluster, const std::string& hostname,
     Network::Address::InstanceConstSharedPtr dest_address, MetadataConstSharedPtr metadata,
-    const envoy::config::core::v3::Locality& locality,
     const envoy::config::endpoint::v3::Endpoint::HealthCheckConfig& health_check_config,
     uint32_t priority)
     : cluster_(cluster), hostname_(hostname),
@@ -251,9 +250,7 @@ HostDescriptionImpl::HostDescriptionImpl(
                                               Config::MetadataFilters::get().ENVOY_LB,
                                               Config::MetadataEnvoyLbKeys::get().CANARY)
                   .bool_value()),
-      metadata_(metadata), locality_(locality),
-      locality_zone_stat_name_(locality.zone(), cluster->statsScope().symbolTable()),
-      priority_(priority),
+      metadata_(metadata), priority_(priority),
       socket_factory_(resolveTransportSocketFactory(dest_address, metadata_.get())) {
   if (health_check_config.port_value() != 0 && dest_address->type() != Network::Address::Type::Ip) {
     // Setting the health check port to non-0 only works for IP-type addresses. Setting the port
@@ -267,7 +264,7 @@ HostDescriptionImpl::HostDescriptionImpl(
           : Network::Utility::getAddressWithPort(*dest_address, health_check_config.port_value());
 }
 
-Network::TransportSocketFactory& HostDescriptionImpl::resolveTransportSocketFactory(
+Network::TransportSocketFactory& HostDescriptionImplBase::resolveTransportSocketFactory(
     const Network::Address::InstanceConstSharedPtr& dest_address,
     const envoy::config::core::v3::Metadata* metadata) const {
   auto match = cluster_->transportSocketMatcher().resolve(metadata);
@@ -278,15 +275,18 @@ Network::TransportSocketFactory& HostDescriptionImpl::resolveTransportSocketFact
   return match.factory_;
 }
 
-Host::CreateConnectionData HostImpl::createConnection(
+template <class DescriptionImpl>
+Host::CreateConnectionData HostImplBase<DescriptionImpl>::createConnection(
     Event::Dispatcher& dispatcher, const Network::ConnectionSocket::OptionsSharedPtr& options,
     Network::TransportSocketOptionsSharedPtr transport_socket_options) const {
-  return {createConnection(dispatcher, *cluster_, address_, socket_factory_, options,
-                           transport_socket_options),
-          shared_from_this()};
+  return {createConnection(dispatcher, *this->cluster_, this->address_, this->socket_factory_,
+                           options, transport_socket_options),
+          this->shared_from_this()};
 }
 
-void HostImpl::setEdsHealthFlag(envoy::config::core::v3::HealthStatus health_status) {
+template <class DescriptionImpl>
+void HostImplBase<DescriptionImpl>::setEdsHealthFlag(
+    envoy::config::core::v3::HealthStatus health_status) {
   switch (health_status) {
   case envoy::config::core::v3::UNHEALTHY:
     FALLTHRU;
@@ -304,25 +304,27 @@ void HostImpl::setEdsHealthFlag(envoy::config::core::v3::HealthStatus health_sta
   }
 }
 
-Host::CreateConnectionData HostImpl::createHealthCheckConnection(
+template <class DescriptionImpl>
+Host::CreateConnectionData HostImplBase<DescriptionImpl>::createHealthCheckConnection(
     Event::Dispatcher& dispatcher,
     Network::TransportSocketOptionsSharedPtr transport_socket_options,
     const envoy::config::core::v3::Metadata* metadata) const {
 
   Network::TransportSocketFactory& factory =
-      (metadata != nullptr) ? resolveTransportSocketFactory(healthCheckAddress(), metadata)
-                            : socket_factory_;
-  return {createConnection(dispatcher, *cluster_, healthCheckAddress(), factory, nullptr,
+      (metadata != nullptr) ? this->resolveTransportSocketFactory(healthCheckAddress(), metadata)
+                            : this->socket_factory_;
+  return {createConnection(dispatcher, *this->cluster_, healthCheckAddress(), factory, nullptr,
                            transport_socket_options),
-          shared_from_this()};
+          this->shared_from_this()};
 }
 
-Network::ClientConnectionPtr
-HostImpl::createConnection(Event::Dispatcher& dispatcher, const ClusterInfo& cluster,
-                           const Network::Address::InstanceConstSharedPtr& address,
-                           Network::TransportSocketFactory& socket_factory,
-                           const Network::ConnectionSocket::OptionsSharedPtr& options,
-                           Network::TransportSocketOptionsSharedPtr transport_socket_options) {
+template <class DescriptionImpl>
+Network::ClientConnectionPtr HostImplBase<DescriptionImpl>::createConnection(
+    Event::Dispatcher& dispatcher, const ClusterInfo& cluster,
+    const Network::Address::InstanceConstSharedPtr& address,
+    Network::TransportSocketFactory& socket_factory,
+    const Network::ConnectionSocket::OptionsSharedPtr& options,
+    Network::TransportSocketOptionsSharedPtr transport_socket_options) {
   Network::ConnectionSocket::OptionsSharedPtr connection_options;
   if (cluster.clusterSocketOptions() != nullptr) {
     if (options) {
@@ -345,7 +347,31 @@ HostImpl::createConnection(Event::Dispatcher& dispatcher, const ClusterInfo& clu
   return connection;
 }
 
-void HostImpl::weight(uint32_t new_weight) { weight_ = std::max(1U, new_weight); }
+template <class DescriptionImpl> void HostImplBase<DescriptionImpl>::weight(uint32_t new_weight) {
+  weight_ = std::max(1U, new_weight);
+}
+
+template class HostImplBase<HostDescriptionImpl>;
+template class HostImplBase<HostDescriptionImplBase>;
+
+HostStats& CompactHostImpl::allocateStats() const {
+  auto stats = std::make_unique<HostStats>();
+  HostStats* expected = nullptr;
+  if (stats_.compare_exchange_strong(expected, stats.get(), std::memory_order_acq_rel)) {
+    return *stats.release();
+  }
+  // Another thread allocated the stats first.
+  return *expected;
+}
+
+const HostStats& CompactHostImpl::statsIfAllocated() const {
+  const HostStats* stats = stats_.load(std::memory_order_acquire);
+  if (stats != nullptr) {
+    return *stats;
+  }
+  static const HostStats* empty_stats = new HostStats();
+  return *empty_stats;
+}
 
 std::vector<HostsPerLocalityConstSharedPtr> HostsPerLocalityImpl::filter(
     const std::vector<std::function<bool(const Host&)>>& predicates) const {
@@ -675,6 +701,14 @@ ClusterInfoImpl::ClusterInfoImpl(
           std::chrono::milliseconds(PROTOBUF_GET_MS_REQUIRED(config, connect_timeout))),
       per_connection_buffer_limit_bytes_(
           PROTOBUF_GET_WRAPPED_OR_DEFAULT(config, per_connection_buffer_limit_bytes, 1024 * 1024)),
+      per_upstream_preconnect_ratio_(PROTOBUF_GET_WRAPPED_OR_DEFAULT(
+          config.preconnect_policy(), per_upstream_preconnect_ratio, 1.0)),
+      shared_http2_pool_owner_workers_(
+          config.has_shared_http2_connection_pool()
+              ? PROTOBUF_GET_WRAPPED_OR_DEFAULT(config.shared_http2_connection_pool(),
+                                                owner_workers, 1)
+              : 0),
+      compact_host_representation_(config.compact_host_representation()),
       socket_matcher_(std::move(socket_matcher)), stats_scope_(std::move(stats_scope)),
       stats_(generateStats(*stats_scope_)), load_report_stats_store_(stats_scope_->symbolTable()),
       load_report_stats_(generateLoadReportStats(load_report_stats_store_)),
@@ -872,6 +906,10 @@ ClusterImplBase::ClusterImplBase(
       symbol_table_(stats_scope->symbolTable()),
       const_metadata_shared_pool_(Config::Metadata::getConstMetadataSharedPool(
           factory_context.singletonManager(), factory_context.dispatcher())) {
+  if (cluster.compact_host_representation()) {
+    host_locality_pool_ = std::make_unique<HostLocalityPool>(symbol_table_);
+    shared_address_pool_ = SharedAddressPool::get(factory_context.singletonManager());
+  }
   factory_context.setInitManager(init_manager_);
   auto socket_factory = createTransportSocketFactory(cluster, factory_context);
   auto socket_matcher = std::make_unique<TransportSocketMatcherImpl>(
@@ -1072,6 +1110,20 @@ ClusterImplBase::resolveProtoAddress(const envoy::config::core::v3::Address& add
   }
 }
 
+HostLocalityConstSharedPtr
+ClusterImplBase::hostLocality(const envoy::config::core::v3::Locality& locality) {
+  ASSERT(host_locality_pool_ != nullptr);
+  return host_locality_pool_->getLocality(locality);
+}
+
+Network::Address::InstanceConstSharedPtr
+ClusterImplBase::hostAddress(const Network::Address::InstanceConstSharedPtr& address) {
+  if (shared_address_pool_ == nullptr || address == nullptr) {
+    return address;
+  }
+  return shared_address_pool_->getAddress(address);
+}
+
 void ClusterImplBase::validateEndpointsForZoneAwareRouting(
     const envoy::config::endpoint::v3::LocalityLbEndpoints& endpoints) const {
   if (local_cluster_ && endpoints.priority() > 0) {
@@ -1196,10 +1248,21 @@ void PriorityStateManager::registerHostForPriority(
   auto metadata = lb_endpoint.has_metadata()
                       ? parent_.constMetadataSharedPool()->getObject(lb_endpoint.metadata())
                       : nullptr;
-  const HostSharedPtr host(new HostImpl(
-      parent_.info(), hostname, address, metadata, lb_endpoint.load_balancing_weight().value(),
-      locality_lb_endpoint.locality(), lb_endpoint.endpoint().health_check_config(),
-      locality_lb_endpoint.priority(), lb_endpoint.health_status()));
+  HostSharedPtr host;
+  if (parent_.info()->compactHostRepresentation()) {
+    host.reset(new CompactHostImpl(
+        parent_.info(), hostname, parent_.hostAddress(address), metadata,
+        lb_endpoint.load_balancing_weight().value(),
+        parent_.hostLocality(locality_lb_endpoint.locality()),
+        lb_endpoint.endpoint().health_check_config(), locality_lb_endpoint.priority(),
+        lb_endpoint.health_status()));
+  } else {
+    host.reset(new HostImpl(parent_.info(), hostname, address, metadata,
+                            lb_endpoint.load_balancing_weight().value(),
+                            locality_lb_endpoint.locality(),
+                            lb_endpoint.endpoint().health_check_config(),
+                            locality_lb_endpoint.priority(), lb_endpoint.health_status()));
+  }
   registerHostForPriority(host, locality_lb_endpoint);
 }
 
@@ -47,6 +47,7 @@
 #include "common/upstream/load_balancer_impl.h"
 #include "common/upstream/outlier_detection_impl.h"
 #include "common/upstream/resource_manager_impl.h"
+#include "common/upstream/shared_host_data.h"
 #include "common/upstream/transport_socket_match_impl.h"
 
 #include "server/transport_socket_config_impl.h"
@@ -66,15 +67,15 @@ public:
 };
 
 /**
- * Implementation of Upstream::HostDescription.
+ * Implementation of Upstream::HostDescription, apart from the storage of the locality and the
+ * stats which differs between the regular and the compact host representation.
  */
-class HostDescriptionImpl : virtual public HostDescription,
-                            protected Logger::Loggable<Logger::Id::upstream> {
+class HostDescriptionImplBase : virtual public HostDescription,
+                                protected Logger::Loggable<Logger::Id::upstream> {
 public:
-  HostDescriptionImpl(
+  HostDescriptionImplBase(
       ClusterInfoConstSharedPtr cluster, const std::string& hostname,
       Network::Address::InstanceConstSharedPtr dest_address, MetadataConstSharedPtr metadata,
-      const envoy::config::core::v3::Locality& locality,
       const envoy::config::endpoint::v3::Endpoint::HealthCheckConfig& health_check_config,
       uint32_t priority);
 
@@ -119,17 +120,12 @@ public:
       return *null_outlier_detector;
     }
   }
-  HostStats& stats() const override { return stats_; }
   const std::string& hostnameForHealthChecks() const override { return health_checks_hostname_; }
   const std::string& hostname() const override { return hostname_; }
   Network::Address::InstanceConstSharedPtr address() const override { return address_; }
   Network::Address::InstanceConstSharedPtr healthCheckAddress() const override {
     return health_check_address_;
   }
-  const envoy::config::core::v3::Locality& locality() const override { return locality_; }
-  Stats::StatName localityZoneStatName() const override {
-    return locality_zone_stat_name_.statName();
-  }
   uint32_t priority() const override { return priority_; }
   void priority(uint32_t priority) override { priority_ = priority; }
   Network::TransportSocketFactory&
@@ -145,9 +141,6 @@ protected:
   std::atomic<bool> canary_;
   mutable absl::Mutex metadata_mutex_;
   MetadataConstSharedPtr metadata_ ABSL_GUARDED_BY(metadata_mutex_);
-  const envoy::config::core::v3::Locality locality_;
-  Stats::StatNameManagedStorage locality_zone_stat_name_;
-  mutable HostStats stats_;
   Outlier::DetectorHostMonitorPtr outlier_detector_;
   HealthCheckHostMonitorPtr health_checker_;
   std::atomic<uint32_t> priority_;
@@ -155,29 +148,56 @@ protected:
 };
 
 /**
- * Implementation of Upstream::Host.
+ * Implementation of Upstream::HostDescription which holds its locality and stats inline.
  */
-class HostImpl : public HostDescriptionImpl,
-                 public Host,
-                 public std::enable_shared_from_this<HostImpl> {
+class HostDescriptionImpl : public HostDescriptionImplBase {
 public:
-  HostImpl(ClusterInfoConstSharedPtr cluster, const std::string& hostname,
-           Network::Address::InstanceConstSharedPtr address, MetadataConstSharedPtr metadata,
-           uint32_t initial_weight, const envoy::config::core::v3::Locality& locality,
-           const envoy::config::endpoint::v3::Endpoint::HealthCheckConfig& health_check_config,
-           uint32_t priority, const envoy::config::core::v3::HealthStatus health_status)
-      : HostDescriptionImpl(cluster, hostname, address, metadata, locality, health_check_config,
-                            priority),
-        used_(true) {
+  HostDescriptionImpl(
+      ClusterInfoConstSharedPtr cluster, const std::string& hostname,
+      Network::Address::InstanceConstSharedPtr dest_address, MetadataConstSharedPtr metadata,
+      const envoy::config::core::v3::Locality& locality,
+      const envoy::config::endpoint::v3::Endpoint::HealthCheckConfig& health_check_config,
+      uint32_t priority)
+      : HostDescriptionImplBase(cluster, hostname, dest_address, metadata, health_check_config,
+                                priority),
+        locality_(locality),
+        locality_zone_stat_name_(locality.zone(), cluster->statsScope().symbolTable()) {}
+
+  // Upstream::HostDescription
+  HostStats& stats() const override { return stats_; }
+  const envoy::config::core::v3::Locality& locality() const override { return locality_; }
+  Stats::StatName localityZoneStatName() const override {
+    return locality_zone_stat_name_.statName();
+  }
+
+protected:
+  const envoy::config::core::v3::Locality locality_;
+  Stats::StatNameManagedStorage locality_zone_stat_name_;
+  mutable HostStats stats_;
+};
+
+/**
+ * Implementation of Upstream::Host on top of either HostDescriptionImpl, for hosts which hold their
+ * locality and stats inline, or HostDescriptionImplBase, for hosts which store them otherwise and
+ * implement their accessors.
+ */
+template <class DescriptionImpl>
+class HostImplBase : public DescriptionImpl,
+                     public Host,
+                     public std::enable_shared_from_this<HostImplBase<DescriptionImpl>> {
+public:
+  /**
+   * @param description_args supplies the arguments of the DescriptionImpl constructor.
+   */
+  template <class... DescriptionArgs>
+  HostImplBase(uint32_t initial_weight, const envoy::config::core::v3::HealthStatus health_status,
+               DescriptionArgs&&... description_args)
+      : DescriptionImpl(std::forward<DescriptionArgs>(description_args)...), used_(true) {
     setEdsHealthFlag(health_status);
     weight(initial_weight);
   }
 
   // Upstream::Host
-  std::vector<std::pair<absl::string_view, Stats::PrimitiveCounterReference>>
-  counters() const override {
-    return stats_.counters();
-  }
   CreateConnectionData createConnection(
       Event::Dispatcher& dispatcher, const Network::ConnectionSocket::OptionsSharedPtr& options,
       Network::TransportSocketOptionsSharedPtr transport_socket_options) const override;
@@ -186,10 +206,6 @@ public:
                               Network::TransportSocketOptionsSharedPtr transport_socket_options,
                               const envoy::config::core::v3::Metadata* metadata) const override;
 
-  std::vector<std::pair<absl::string_view, Stats::PrimitiveGaugeReference>>
-  gauges() const override {
-    return stats_.gauges();
-  }
   void healthFlagClear(HealthFlag flag) override { health_flags_ &= ~enumToInt(flag); }
   bool healthFlagGet(HealthFlag flag) const override { return health_flags_ & enumToInt(flag); }
   void healthFlagSet(HealthFlag flag) override { health_flags_ |= enumToInt(flag); }
@@ -202,10 +218,10 @@ public:
   }
 
   void setHealthChecker(HealthCheckHostMonitorPtr&& health_checker) override {
-    health_checker_ = std::move(health_checker);
+    this->health_checker_ = std::move(health_checker);
   }
   void setOutlierDetector(Outlier::DetectorHostMonitorPtr&& outlier_detector) override {
-    outlier_detector_ = std::move(outlier_detector);
+    this->outlier_detector_ = std::move(outlier_detector);
   }
   Host::Health health() const override {
     // If any of the unhealthy flags are set, host is unhealthy.
@@ -248,6 +264,81 @@ private:
   std::atomic<bool> used_;
 };
 
+extern template class HostImplBase<HostDescriptionImpl>;
+extern template class HostImplBase<HostDescriptionImplBase>;
+
+/**
+ * Implementation of Upstream::Host which holds its locality and stats inline.
+ */
+class HostImpl : public HostImplBase<HostDescriptionImpl> {
+public:
+  HostImpl(ClusterInfoConstSharedPtr cluster, const std::string& hostname,
+           Network::Address::InstanceConstSharedPtr address, MetadataConstSharedPtr metadata,
+           uint32_t initial_weight, const envoy::config::core::v3::Locality& locality,
+           const envoy::config::endpoint::v3::Endpoint::HealthCheckConfig& health_check_config,
+           uint32_t priority, const envoy::config::core::v3::HealthStatus health_status)
+      : HostImplBase(initial_weight, health_status, cluster, hostname, address, metadata, locality,
+                     health_check_config, priority) {}
+
+  // Upstream::Host
+  std::vector<std::pair<absl::string_view, Stats::PrimitiveCounterReference>>
+  counters() const override {
+    return stats_.counters();
+  }
+  std::vector<std::pair<absl::string_view, Stats::PrimitiveGaugeReference>>
+  gauges() const override {
+    return stats_.gauges();
+  }
+};
+
+/**
+ * Implementation of Upstream::Host for the compact host representation. The locality is shared
+ * with the other hosts of the cluster in the same locality, and the stats are only allocated once
+ * the host is first used. Until then the host reports all of its stats as zero.
+ */
+class CompactHostImpl : public HostImplBase<HostDescriptionImplBase> {
+public:
+  CompactHostImpl(
+      ClusterInfoConstSharedPtr cluster, const std::string& hostname,
+      Network::Address::InstanceConstSharedPtr address, MetadataConstSharedPtr metadata,
+      uint32_t initial_weight, HostLocalityConstSharedPtr locality,
+      const envoy::config::endpoint::v3::Endpoint::HealthCheckConfig& health_check_config,
+      uint32_t priority, const envoy::config::core::v3::HealthStatus health_status)
+      : HostImplBase(initial_weight, health_status, cluster, hostname, address, metadata,
+                     health_check_config, priority),
+        locality_(std::move(locality)) {}
+  ~CompactHostImpl() override { delete stats_.load(); }
+
+  // Upstream::HostDescription
+  HostStats& stats() const override {
+    HostStats* stats = stats_.load(std::memory_order_acquire);
+    return stats != nullptr ? *stats : allocateStats();
+  }
+  const envoy::config::core::v3::Locality& locality() const override {
+    return locality_->locality();
+  }
+  Stats::StatName localityZoneStatName() const override { return locality_->zoneStatName(); }
+
+  // Upstream::Host
+  std::vector<std::pair<absl::string_view, Stats::PrimitiveCounterReference>>
+  counters() const override {
+    return statsIfAllocated().counters();
+  }
+  std::vector<std::pair<absl::string_view, Stats::PrimitiveGaugeReference>>
+  gauges() const override {
+    return statsIfAllocated().gauges();
+  }
+
+private:
+  HostStats& allocateStats() const;
+  // Returns stats shared by all hosts which always read as zero if they have not been allocated.
+  const HostStats& statsIfAllocated() const;
+
+  const HostLocalityConstSharedPtr locality_;
+  // Never changes once set.
+  mutable std::atomic<HostStats*> stats_{};
+};
+
 class HostsPerLocalityImpl : public HostsPerLocality {
 public:
   HostsPerLocalityImpl() : HostsPerLocalityImpl(std::vector<HostVector>(), false) {}
@@ -534,6 +625,11 @@ public:
   uint32_t perConnectionBufferLimitBytes() const override {
     return per_connection_buffer_limit_bytes_;
   }
+  float perUpstreamPreconnectRatio() const override { return per_upstream_preconnect_ratio_; }
+  uint32_t sharedHttp2PoolOwnerWorkers() const override {
+    return shared_http2_pool_owner_workers_;
+  }
+  bool compactHostRepresentation() const override { return compact_host_representation_; }
   uint64_t features() const override { return features_; }
   const Http::Http1Settings& http1Settings() const override { return http1_settings_; }
   const envoy::config::core::v3::Http2ProtocolOptions& http2Options() const override {
@@ -617,6 +713,9 @@ private:
   const std::chrono::milliseconds connect_timeout_;
   absl::optional<std::chrono::milliseconds> idle_timeout_;
   const uint32_t per_connection_buffer_limit_bytes_;
+  const float per_upstream_preconnect_ratio_;
+  const uint32_t shared_http2_pool_owner_workers_;
+  const bool compact_host_representation_;
   TransportSocketMatcherPtr socket_matcher_;
   Stats::ScopePtr stats_scope_;
   mutable ClusterStats stats_;
@@ -708,6 +807,22 @@ public:
     return const_metadata_shared_pool_;
   }
 
+  /**
+   * @param locality supplies the locality of a new host. Only valid with the compact host
+   *        representation.
+   * @return the locality to give to the host, shared with the cluster's other hosts in the same
+   *         locality.
+   */
+  HostLocalityConstSharedPtr hostLocality(const envoy::config::core::v3::Locality& locality);
+
+  /**
+   * @param address supplies the resolved address of a new host.
+   * @return the address to give to the host. With the compact host representation it is shared
+   *         with identical hosts of all clusters using the compact host representation.
+   */
+  Network::Address::InstanceConstSharedPtr
+  hostAddress(const Network::Address::InstanceConstSharedPtr& address);
+
   // Upstream::Cluster
   HealthChecker* healthChecker() override { return health_checker_.get(); }
   ClusterInfoConstSharedPtr info() const override { return info_; }
@@ -773,6 +888,9 @@ private:
   const bool local_cluster_;
   Stats::SymbolTable& symbol_table_;
   Config::ConstMetadataSharedPoolSharedPtr const_metadata_shared_pool_;
+  // Only set with the compact host representation.
+  std::unique_ptr<HostLocalityPool> host_locality_pool_;
+  SharedAddressPoolSharedPtr shared_address_pool_;
 };
 
 using ClusterImplBaseSharedPtr = std::shared_ptr<ClusterImplBase>;
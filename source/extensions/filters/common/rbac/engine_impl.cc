@@ -1,8 +1,12 @@
 #include "extensions/filters/common/rbac/engine_impl.h"
 
+#include <algorithm>
+#include <map>
+
 #include "envoy/config/rbac/v3/rbac.pb.h"
 
 #include "common/http/header_map_impl.h"
+#include "common/protobuf/protobuf.h"
 
 namespace Envoy {
 namespace Extensions {
@@ -10,6 +14,61 @@ namespace Filters {
 namespace Common {
 namespace RBAC {
 
+namespace {
+
+std::string deterministicSerialization(const Protobuf::Message& message) {
+  std::string bytes;
+  {
+    // The CodedOutputStream needs to be destroyed before the string is read.
+    Protobuf::io::StringOutputStream string_stream(&bytes);
+    Protobuf::io::CodedOutputStream coded_stream(&string_stream);
+    coded_stream.SetSerializationDeterministic(true);
+    message.SerializeToCodedStream(&coded_stream);
+  }
+  return bytes;
+}
+
+// Collects the principal names matched by a principal if it only matches peers authenticated with
+// an exact principal name, returning false otherwise.
+bool exactPrincipalNames(const envoy::config::rbac::v3::Principal& principal,
+                         std::vector<std::string>& names) {
+  switch (principal.identifier_case()) {
+  case envoy::config::rbac::v3::Principal::IdentifierCase::kAuthenticated: {
+    const auto& auth = principal.authenticated();
+    if (!auth.has_principal_name() ||
+        auth.principal_name().match_pattern_case() !=
+            envoy::type::matcher::v3::StringMatcher::MatchPatternCase::kExact ||
+        auth.principal_name().ignore_case()) {
+      return false;
+    }
+    names.push_back(auth.principal_name().exact());
+    return true;
+  }
+  case envoy::config::rbac::v3::Principal::IdentifierCase::kOrIds:
+    for (const auto& id : principal.or_ids().ids()) {
+      if (!exactPrincipalNames(id, names)) {
+        return false;
+      }
+    }
+    return true;
+  default:
+    return false;
+  }
+}
+
+} // namespace
+
+template <class RuleType>
+uint32_t
+RoleBasedAccessControlEngineImpl::addRule(const RuleType& rule,
+                                          absl::flat_hash_map<std::string, uint32_t>& ids) {
+  const auto result = ids.emplace(deterministicSerialization(rule), rules_.size());
+  if (result.second) {
+    rules_.push_back(Matcher::create(rule));
+  }
+  return result.first->second;
+}
+
 RoleBasedAccessControlEngineImpl::RoleBasedAccessControlEngineImpl(
     const envoy::config::rbac::v3::RBAC& rules)
     : allowed_if_matched_(rules.action() == envoy::config::rbac::v3::RBAC::ALLOW) {
@@ -21,31 +80,140 @@ RoleBasedAccessControlEngineImpl::RoleBasedAccessControlEngineImpl(
     }
   }
 
+  // The first matching policy in the order of the names is the effective one.
+  std::map<std::string, const envoy::config::rbac::v3::Policy*> sorted_policies;
   for (const auto& policy : rules.policies()) {
-    policies_.emplace(policy.first, std::make_unique<PolicyMatcher>(policy.second, builder_.get()));
+    sorted_policies.emplace(policy.first, &policy.second);
   }
+
+  absl::flat_hash_map<std::string, uint32_t> permission_ids;
+  absl::flat_hash_map<std::string, uint32_t> principal_ids;
+  for (const auto& entry : sorted_policies) {
+    const uint32_t index = policies_.size();
+    const envoy::config::rbac::v3::Policy& config = *entry.second;
+    auto policy = std::make_unique<Policy>(entry.first, config);
+    if (config.has_condition()) {
+      policy->expr_ = Expr::createExpression(*builder_, policy->condition_);
+    }
+    for (const auto& permission : config.permissions()) {
+      policy->permissions_.push_back(addRule(permission, permission_ids));
+    }
+
+    std::vector<std::string> names;
+    policy->indexed_ = true;
+    for (const auto& principal : config.principals()) {
+      if (!exactPrincipalNames(principal, names)) {
+        policy->indexed_ = false;
+        break;
+      }
+    }
+    if (policy->indexed_) {
+      for (const std::string& name : names) {
+        std::vector<uint32_t>& indexed = principal_index_[name];
+        // The same name may be listed more than once by a policy.
+        if (indexed.empty() || indexed.back() != index) {
+          indexed.push_back(index);
+        }
+      }
+    } else {
+      for (const auto& principal : config.principals()) {
+        policy->principals_.push_back(addRule(principal, principal_ids));
+      }
+      unindexed_policies_.push_back(index);
+    }
+    policies_.push_back(std::move(policy));
+  }
+}
+
+bool RoleBasedAccessControlEngineImpl::anyMatches(const std::vector<uint32_t>& rules,
+                                                  const Network::Connection& connection,
+                                                  const Envoy::Http::RequestHeaderMap& headers,
+                                                  const StreamInfo::StreamInfo& info,
+                                                  std::vector<RuleResult>& results) const {
+  for (const uint32_t rule : rules) {
+    RuleResult& result = results[rule];
+    if (result == RuleResult::Unknown) {
+      result = rules_[rule]->matches(connection, headers, info) ? RuleResult::Matched
+                                                                : RuleResult::NotMatched;
+    }
+    if (result == RuleResult::Matched) {
+      return true;
+    }
+  }
+  return false;
+}
+
+bool RoleBasedAccessControlEngineImpl::matches(const Policy& policy,
+                                               const Network::Connection& connection,
+                                               const Envoy::Http::RequestHeaderMap& headers,
+                                               const StreamInfo::StreamInfo& info,
+                                               std::vector<RuleResult>& results) const {
+  return anyMatches(policy.permissions_, connection, headers, info, results) &&
+         (policy.indexed_ || anyMatches(policy.principals_, connection, headers, info, results)) &&
+         (policy.expr_ == nullptr ? true : Expr::matches(*policy.expr_, info, headers));
+}
+
+void RoleBasedAccessControlEngineImpl::indexedPolicies(const Network::Connection& connection,
+                                                       std::vector<uint32_t>& policies) const {
+  const auto& ssl = connection.ssl();
+  if (!ssl) {
+    return;
+  }
+
+  // The same names as AuthenticatedMatcher: the URI SANs, the DNS SANs and the subject.
+  const auto add = [this, &policies](const std::string& name) {
+    const auto it = principal_index_.find(name);
+    if (it != principal_index_.end()) {
+      policies.insert(policies.end(), it->second.begin(), it->second.end());
+    }
+  };
+  for (const std::string& uri : ssl->uriSanPeerCertificate()) {
+    add(uri);
+  }
+  for (const std::string& dns : ssl->dnsSansPeerCertificate()) {
+    add(dns);
+  }
+  add(ssl->subjectPeerCertificate());
 }
 
 bool RoleBasedAccessControlEngineImpl::allowed(const Network::Connection& connection,
                                                const Envoy::Http::RequestHeaderMap& headers,
                                                const StreamInfo::StreamInfo& info,
                                                std::string* effective_policy_id) const {
-  bool matched = false;
+  std::vector<uint32_t> indexed;
+  if (!principal_index_.empty()) {
+    indexedPolicies(connection, indexed);
+    std::sort(indexed.begin(), indexed.end());
+    indexed.erase(std::unique(indexed.begin(), indexed.end()), indexed.end());
+  }
 
-  for (const auto& policy : policies_) {
-    if (policy.second->matches(connection, headers, info)) {
-      matched = true;
-      if (effective_policy_id != nullptr) {
-        *effective_policy_id = policy.first;
-      }
+  // Visit the unindexed policies and the indexed policies of the peer in order.
+  std::vector<RuleResult> results(rules_.size(), RuleResult::Unknown);
+  const Policy* matched = nullptr;
+  auto unindexed_it = unindexed_policies_.begin();
+  auto indexed_it = indexed.begin();
+  while (unindexed_it != unindexed_policies_.end() || indexed_it != indexed.end()) {
+    uint32_t index;
+    if (indexed_it == indexed.end() ||
+        (unindexed_it != unindexed_policies_.end() && *unindexed_it < *indexed_it)) {
+      index = *unindexed_it++;
+    } else {
+      index = *indexed_it++;
+    }
+    if (matches(*policies_[index], connection, headers, info, results)) {
+      matched = policies_[index].get();
       break;
     }
   }
 
+  if (matched != nullptr && effective_policy_id != nullptr) {
+    *effective_policy_id = matched->name_;
+  }
+
   // only allowed if:
   //   - matched and ALLOW action
   //   - not matched and DENY action
-  return matched == allowed_if_matched_;
+  return (matched != nullptr) == allowed_if_matched_;
 }
 
 bool RoleBasedAccessControlEngineImpl::allowed(const Network::Connection& connection,
@@ -1,16 +1,31 @@
 #pragma once
 
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
 #include "envoy/config/rbac/v3/rbac.pb.h"
 
 #include "extensions/filters/common/rbac/engine.h"
 #include "extensions/filters/common/rbac/matchers.h"
 
+#include "absl/container/flat_hash_map.h"
+
 namespace Envoy {
 namespace Extensions {
 namespace Filters {
 namespace Common {
 namespace RBAC {
 
+/**
+ * Evaluates the policies in the order of their names, the first matching policy being the
+ * effective one. The policies are compiled into a graph sharing the matchers of identical
+ * permission and principal rules, so that a rule used by many policies is created once and
+ * evaluated at most once per request. Policies whose principals are all exact authenticated
+ * principal names (e.g. SPIFFE IDs) are indexed by these names and only considered for requests
+ * presenting one of them.
+ */
 class RoleBasedAccessControlEngineImpl : public RoleBasedAccessControlEngine, NonCopyable {
 public:
   RoleBasedAccessControlEngineImpl(const envoy::config::rbac::v3::RBAC& rules);
@@ -22,9 +37,48 @@ public:
                std::string* effective_policy_id) const override;
 
 private:
+  // The result of a shared rule, memoized for the duration of a request.
+  enum class RuleResult : uint8_t { Unknown, Matched, NotMatched };
+
+  struct Policy {
+    Policy(const std::string& name, const envoy::config::rbac::v3::Policy& policy)
+        : name_(name), condition_(policy.condition()) {}
+
+    const std::string name_;
+    // Indexes into rules_, any of which must match.
+    std::vector<uint32_t> permissions_;
+    std::vector<uint32_t> principals_;
+    // Whether the policy is only reached through principal_index_, in which case its principals
+    // are known to match.
+    bool indexed_{};
+    const google::api::expr::v1alpha1::Expr condition_;
+    Expr::ExpressionPtr expr_;
+  };
+
+  // Returns the index in rules_ of the matcher of a rule, creating it unless an identical rule
+  // has been added before. ids maps the deterministic serialization of the rules to their index.
+  template <class RuleType>
+  uint32_t addRule(const RuleType& rule, absl::flat_hash_map<std::string, uint32_t>& ids);
+  bool matches(const Policy& policy, const Network::Connection& connection,
+               const Envoy::Http::RequestHeaderMap& headers, const StreamInfo::StreamInfo& info,
+               std::vector<RuleResult>& results) const;
+  bool anyMatches(const std::vector<uint32_t>& rules, const Network::Connection& connection,
+                  const Envoy::Http::RequestHeaderMap& headers, const StreamInfo::StreamInfo& info,
+                  std::vector<RuleResult>& results) const;
+  // Appends the indexes of the policies indexed by the peer's principal names.
+  void indexedPolicies(const Network::Connection& connection,
+                       std::vector<uint32_t>& policies) const;
+
   const bool allowed_if_matched_;
 
-  std::map<std::string, std::unique_ptr<PolicyMatcher>> policies_;
+  // Sorted by name.
+  std::vector<std::unique_ptr<Policy>> policies_;
+  // Indexes of the policies which are not indexed, in order.
+  std::vector<uint32_t> unindexed_policies_;
+  absl::flat_hash_map<std::string, std::vector<uint32_t>> principal_index_;
+
+  // The distinct permission and principal rules of all policies.
+  std::vector<MatcherConstSharedPtr> rules_;
 
   Protobuf::Arena constant_arena_;
   Expr::BuilderPtr builder_;
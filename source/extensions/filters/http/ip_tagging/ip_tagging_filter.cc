@@ -1,8 +1,10 @@
 #include "extensions/filters/http/ip_tagging/ip_tagging_filter.h"
 
 #include "envoy/config/core/v3/address.pb.h"
+#include "envoy/config/core/v3/base.pb.h"
 #include "envoy/extensions/filters/http/ip_tagging/v3/ip_tagging.pb.h"
 
+#include "common/config/datasource.h"
 #include "common/http/header_map_impl.h"
 #include "common/http/headers.h"
 
@@ -15,22 +17,34 @@ namespace IpTagging {
 
 IpTaggingFilterConfig::IpTaggingFilterConfig(
     const envoy::extensions::filters::http::ip_tagging::v3::IPTagging& config,
-    const std::string& stat_prefix, Stats::Scope& scope, Runtime::Loader& runtime)
+    const std::string& stat_prefix, Stats::Scope& scope, Runtime::Loader& runtime, Api::Api& api)
     : request_type_(requestTypeEnum(config.request_type())), scope_(scope), runtime_(runtime),
       stat_name_set_(scope.symbolTable().makeSet("IpTagging")),
       stats_prefix_(stat_name_set_->add(stat_prefix + "ip_tagging")),
       no_hit_(stat_name_set_->add("no_hit")), total_(stat_name_set_->add("total")),
       unknown_tag_(stat_name_set_->add("unknown_tag.hit")) {
 
-  // Once loading IP tags from a file system is supported, the restriction on the size
-  // of the set should be removed and observability into what tags are loaded needs
-  // to be implemented.
-  // TODO(ccaraman): Remove size check once file system support is implemented.
-  // Work is tracked by issue https://github.com/envoyproxy/envoy/issues/2695.
-  if (config.ip_tags().empty()) {
-    throw EnvoyException("HTTP IP Tagging Filter requires ip_tags to be specified.");
+  if (config.ip_tags().empty() && !config.has_compiled_ip_tags()) {
+    throw EnvoyException(
+        "HTTP IP Tagging Filter requires ip_tags or compiled_ip_tags to be specified.");
   }
+  if (!config.ip_tags().empty() && config.has_compiled_ip_tags()) {
+    throw EnvoyException("HTTP IP Tagging Filter requires only one of ip_tags and "
+                         "compiled_ip_tags to be specified.");
+  }
+
+  if (config.has_compiled_ip_tags()) {
+    loadCompiledIpTags(config.compiled_ip_tags(), api);
+  } else {
+    trie_ = buildTrie(config);
+  }
+  for (const std::string& tag : trie_->values()) {
+    stat_name_set_->rememberBuiltin(absl::StrCat(tag, ".hit"));
+  }
+}
 
+std::unique_ptr<Network::LcTrie::LcTrie<std::string>> IpTaggingFilterConfig::buildTrie(
+    const envoy::extensions::filters::http::ip_tagging::v3::IPTagging& config) {
   std::vector<std::pair<std::string, std::vector<Network::Address::CidrRange>>> tag_data;
   tag_data.reserve(config.ip_tags().size());
   for (const auto& ip_tag : config.ip_tags()) {
@@ -50,9 +64,18 @@ IpTaggingFilterConfig::IpTaggingFilterConfig(
     }
 
     tag_data.emplace_back(ip_tag.ip_tag_name(), cidr_set);
-    stat_name_set_->rememberBuiltin(absl::StrCat(ip_tag.ip_tag_name(), ".hit"));
   }
-  trie_ = std::make_unique<Network::LcTrie::LcTrie<std::string>>(tag_data);
+  return std::make_unique<Network::LcTrie::LcTrie<std::string>>(
+      tag_data, /*exclusive=*/false, /*fill_factor=*/0.5, /*root_branching_factor=*/0,
+      config.ipv4_direct_table());
+}
+
+void IpTaggingFilterConfig::loadCompiledIpTags(
+    const envoy::config::core::v3::DataSource& compiled_ip_tags, Api::Api& api) {
+  // Lookups trust the snapshot once it is validated, so a file is read into memory of its own
+  // rather than mapped, where truncating or rewriting the file would corrupt the trie in use.
+  compiled_ip_tags_ = Config::DataSource::read(compiled_ip_tags, /*allow_empty=*/false, api);
+  trie_ = std::make_unique<Network::LcTrie::LcTrie<std::string>>(compiled_ip_tags_);
 }
 
 void IpTaggingFilterConfig::incCounter(Stats::StatName name) {
@@ -77,7 +100,7 @@ Http::FilterHeadersStatus IpTaggingFilter::decodeHeaders(Http::RequestHeaderMap&
     return Http::FilterHeadersStatus::Continue;
   }
 
-  std::vector<std::string> tags =
+  const std::vector<std::string>& tags =
       config_->trie().getData(callbacks_->streamInfo().downstreamRemoteAddress());
 
   if (!tags.empty()) {
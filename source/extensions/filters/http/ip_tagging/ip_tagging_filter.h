@@ -6,6 +6,7 @@
 #include <utility>
 #include <vector>
 
+#include "envoy/api/api.h"
 #include "envoy/common/exception.h"
 #include "envoy/extensions/filters/http/ip_tagging/v3/ip_tagging.pb.h"
 #include "envoy/http/filter.h"
@@ -14,6 +15,7 @@
 
 #include "common/network/cidr_range.h"
 #include "common/network/lc_trie.h"
+#include "common/protobuf/protobuf.h"
 #include "common/stats/symbol_table_impl.h"
 
 namespace Envoy {
@@ -33,7 +35,7 @@ class IpTaggingFilterConfig {
 public:
   IpTaggingFilterConfig(const envoy::extensions::filters::http::ip_tagging::v3::IPTagging& config,
                         const std::string& stat_prefix, Stats::Scope& scope,
-                        Runtime::Loader& runtime);
+                        Runtime::Loader& runtime, Api::Api& api);
 
   Runtime::Loader& runtime() { return runtime_; }
   Stats::Scope& scope() { return scope_; }
@@ -46,6 +48,13 @@ public:
   void incNoHit() { incCounter(no_hit_); }
   void incTotal() { incCounter(total_); }
 
+  /**
+   * Build the trie of the IP tags of a configuration.
+   * @throw EnvoyException if a CIDR range is invalid.
+   */
+  static std::unique_ptr<Network::LcTrie::LcTrie<std::string>>
+  buildTrie(const envoy::extensions::filters::http::ip_tagging::v3::IPTagging& config);
+
 private:
   static FilterRequestType requestTypeEnum(
       envoy::extensions::filters::http::ip_tagging::v3::IPTagging::RequestType request_type) {
@@ -62,6 +71,8 @@ private:
   }
 
   void incCounter(Stats::StatName name);
+  void loadCompiledIpTags(const envoy::config::core::v3::DataSource& compiled_ip_tags,
+                          Api::Api& api);
 
   const FilterRequestType request_type_;
   Stats::Scope& scope_;
@@ -71,6 +82,9 @@ private:
   const Stats::StatName no_hit_;
   const Stats::StatName total_;
   const Stats::StatName unknown_tag_;
+  // Hold the compiled IP tags that a trie loaded from them uses in place, so they must outlive
+  // trie_.
+  std::string compiled_ip_tags_;
   std::unique_ptr<Network::LcTrie::LcTrie<std::string>> trie_;
 };
 
@@ -0,0 +1,429 @@
+#include "extensions/private_key_providers/thread_pool/thread_pool_private_key_provider.h"
+
+#include <algorithm>
+#include <chrono>
+
+#include "envoy/api/api.h"
+#include "envoy/common/exception.h"
+#include "envoy/extensions/private_key_providers/thread_pool/v3/thread_pool.pb.h"
+
+#include "common/common/assert.h"
+#include "common/common/macros.h"
+#include "common/config/datasource.h"
+#include "common/protobuf/utility.h"
+
+#include "openssl/evp.h"
+#include "openssl/rsa.h"
+#include "openssl/x509.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace PrivateKeyMethodProvider {
+namespace ThreadPool {
+
+namespace {
+
+constexpr uint32_t DefaultThreads = 2;
+constexpr uint32_t DefaultMaxQueuedOperations = 1024;
+
+bool sign(EVP_PKEY* pkey, uint16_t signature_algorithm, const std::vector<uint8_t>& in,
+          std::vector<uint8_t>& out) {
+  const EVP_MD* md = SSL_get_signature_algorithm_digest(signature_algorithm);
+  if (md == nullptr) {
+    return false;
+  }
+
+  bssl::ScopedEVP_MD_CTX ctx;
+  EVP_PKEY_CTX* pkey_ctx;
+  if (!EVP_DigestSignInit(ctx.get(), &pkey_ctx, md, nullptr, pkey)) {
+    return false;
+  }
+  if (SSL_is_signature_algorithm_rsa_pss(signature_algorithm) &&
+      (!EVP_PKEY_CTX_set_rsa_padding(pkey_ctx, RSA_PKCS1_PSS_PADDING) ||
+       !EVP_PKEY_CTX_set_rsa_pss_saltlen(pkey_ctx, -1))) {
+    return false;
+  }
+
+  size_t out_len = 0;
+  if (!EVP_DigestSign(ctx.get(), nullptr, &out_len, in.data(), in.size())) {
+    return false;
+  }
+  out.resize(out_len);
+  if (!EVP_DigestSign(ctx.get(), out.data(), &out_len, in.data(), in.size())) {
+    return false;
+  }
+  out.resize(out_len);
+  return true;
+}
+
+bool decrypt(EVP_PKEY* pkey, const std::vector<uint8_t>& in, std::vector<uint8_t>& out) {
+  RSA* rsa = EVP_PKEY_get0_RSA(pkey);
+  if (rsa == nullptr) {
+    return false;
+  }
+
+  size_t out_len = 0;
+  out.resize(RSA_size(rsa));
+  if (!RSA_decrypt(rsa, &out_len, out.data(), out.size(), in.data(), in.size(), RSA_NO_PADDING)) {
+    return false;
+  }
+  out.resize(out_len);
+  return true;
+}
+
+ThreadPoolPrivateKeyConnection* connection(SSL* ssl, int index) {
+  auto* ops = static_cast<ThreadPoolPrivateKeyConnection*>(SSL_get_ex_data(ssl, index));
+  if (ops == nullptr || ops->next_ == nullptr) {
+    return ops;
+  }
+  // Several certificates of this key type use thread pool providers, so use the provider with the
+  // key of the certificate selected for the handshake.
+  X509* cert = SSL_get_certificate(ssl);
+  if (cert == nullptr) {
+    return nullptr;
+  }
+  for (; ops != nullptr; ops = ops->next_) {
+    if (ops->provider_.matchesCertificate(*cert)) {
+      return ops;
+    }
+  }
+  return nullptr;
+}
+
+ssl_private_key_result_t privateKeySign(SSL* ssl, int index, uint8_t* out, size_t* out_len,
+                                        size_t max_out, uint16_t signature_algorithm,
+                                        const uint8_t* in, size_t in_len) {
+  ThreadPoolPrivateKeyConnection* ops = connection(ssl, index);
+  if (ops == nullptr) {
+    return ssl_private_key_failure;
+  }
+  return ops->provider_.start(*ops, false, signature_algorithm, in, in_len, out, out_len, max_out);
+}
+
+ssl_private_key_result_t privateKeyComplete(SSL* ssl, int index, uint8_t* out, size_t* out_len,
+                                            size_t max_out) {
+  ThreadPoolPrivateKeyConnection* ops = connection(ssl, index);
+  if (ops == nullptr) {
+    return ssl_private_key_failure;
+  }
+  return ops->provider_.complete(*ops, out, out_len, max_out);
+}
+
+ssl_private_key_result_t rsaPrivateKeySign(SSL* ssl, uint8_t* out, size_t* out_len,
+                                           size_t max_out, uint16_t signature_algorithm,
+                                           const uint8_t* in, size_t in_len) {
+  return privateKeySign(ssl, ThreadPoolPrivateKeyMethodProvider::rsaConnectionIndex(), out,
+                        out_len, max_out, signature_algorithm, in, in_len);
+}
+
+ssl_private_key_result_t rsaPrivateKeyDecrypt(SSL* ssl, uint8_t* out, size_t* out_len,
+                                              size_t max_out, const uint8_t* in, size_t in_len) {
+  ThreadPoolPrivateKeyConnection* ops =
+      connection(ssl, ThreadPoolPrivateKeyMethodProvider::rsaConnectionIndex());
+  if (ops == nullptr) {
+    return ssl_private_key_failure;
+  }
+  return ops->provider_.start(*ops, true, 0, in, in_len, out, out_len, max_out);
+}
+
+ssl_private_key_result_t rsaPrivateKeyComplete(SSL* ssl, uint8_t* out, size_t* out_len,
+                                               size_t max_out) {
+  return privateKeyComplete(ssl, ThreadPoolPrivateKeyMethodProvider::rsaConnectionIndex(), out,
+                            out_len, max_out);
+}
+
+ssl_private_key_result_t ecdsaPrivateKeySign(SSL* ssl, uint8_t* out, size_t* out_len,
+                                             size_t max_out, uint16_t signature_algorithm,
+                                             const uint8_t* in, size_t in_len) {
+  return privateKeySign(ssl, ThreadPoolPrivateKeyMethodProvider::ecdsaConnectionIndex(), out,
+                        out_len, max_out, signature_algorithm, in, in_len);
+}
+
+ssl_private_key_result_t ecdsaPrivateKeyDecrypt(SSL*, uint8_t*, size_t*, size_t, const uint8_t*,
+                                                size_t) {
+  // Only RSA key exchange decrypts with the private key.
+  return ssl_private_key_failure;
+}
+
+ssl_private_key_result_t ecdsaPrivateKeyComplete(SSL* ssl, uint8_t* out, size_t* out_len,
+                                                 size_t max_out) {
+  return privateKeyComplete(ssl, ThreadPoolPrivateKeyMethodProvider::ecdsaConnectionIndex(), out,
+                            out_len, max_out);
+}
+
+int createIndex() {
+  int index = SSL_get_ex_new_index(0, nullptr, nullptr, nullptr, nullptr);
+  RELEASE_ASSERT(index >= 0, "Failed to get SSL user data index.");
+  return index;
+}
+
+} // namespace
+
+void PrivateKeyOperation::complete() {
+  absl::MutexLock lock(&mutex_);
+  if (cancelled_) {
+    return;
+  }
+  // The connection can't be closed, and so the dispatcher can't go away, while the lock is held.
+  PrivateKeyOperationSharedPtr self = shared_from_this();
+  dispatcher_.post([self]() -> void {
+    {
+      absl::MutexLock lock(&self->mutex_);
+      if (self->cancelled_) {
+        return;
+      }
+    }
+    self->done_ = true;
+    self->cb_.onPrivateKeyMethodComplete();
+  });
+}
+
+void PrivateKeyOperation::cancel() {
+  absl::MutexLock lock(&mutex_);
+  cancelled_ = true;
+}
+
+bool PrivateKeyOperation::cancelled() {
+  absl::MutexLock lock(&mutex_);
+  return cancelled_;
+}
+
+ThreadPoolPrivateKeyMethodProvider::ThreadPoolPrivateKeyMethodProvider(
+    const envoy::extensions::private_key_providers::thread_pool::v3::
+        ThreadPoolPrivateKeyMethodConfig& config,
+    Server::Configuration::TransportSocketFactoryContext& factory_context)
+    : time_source_(factory_context.api().timeSource()),
+      stats_(generateStats(factory_context.scope())),
+      max_queued_operations_(PROTOBUF_GET_WRAPPED_OR_DEFAULT(config, max_queued_operations,
+                                                             DefaultMaxQueuedOperations)) {
+  const std::string private_key =
+      Config::DataSource::read(config.private_key(), false, factory_context.api());
+  bssl::UniquePtr<BIO> bio(
+      BIO_new_mem_buf(const_cast<char*>(private_key.data()), private_key.size()));
+  RELEASE_ASSERT(bio != nullptr, "");
+  pkey_.reset(PEM_read_bio_PrivateKey(bio.get(), nullptr, nullptr, nullptr));
+  if (pkey_ == nullptr) {
+    throw EnvoyException("Failed to load private key for the thread pool private key provider");
+  }
+
+  method_ = std::make_shared<SSL_PRIVATE_KEY_METHOD>();
+  switch (EVP_PKEY_id(pkey_.get())) {
+  case EVP_PKEY_RSA:
+    method_->sign = rsaPrivateKeySign;
+    method_->decrypt = rsaPrivateKeyDecrypt;
+    method_->complete = rsaPrivateKeyComplete;
+    break;
+  case EVP_PKEY_EC:
+    method_->sign = ecdsaPrivateKeySign;
+    method_->decrypt = ecdsaPrivateKeyDecrypt;
+    method_->complete = ecdsaPrivateKeyComplete;
+    break;
+  default:
+    throw EnvoyException(
+        "The thread pool private key provider only supports RSA and ECDSA private keys");
+  }
+
+  const uint32_t threads = PROTOBUF_GET_WRAPPED_OR_DEFAULT(config, threads, DefaultThreads);
+  for (uint32_t i = 0; i < threads; i++) {
+    threads_.push_back(
+        factory_context.api().threadFactory().createThread([this]() -> void { threadRoutine(); }));
+  }
+}
+
+ThreadPoolPrivateKeyMethodProvider::~ThreadPoolPrivateKeyMethodProvider() {
+  {
+    absl::MutexLock lock(&mutex_);
+    shutdown_ = true;
+  }
+  for (Thread::ThreadPtr& thread : threads_) {
+    thread->join();
+  }
+  absl::MutexLock lock(&mutex_);
+  stats_.queue_depth_.sub(queue_.size());
+}
+
+ThreadPoolPrivateKeyProviderStats
+ThreadPoolPrivateKeyMethodProvider::generateStats(Stats::Scope& scope) {
+  const std::string prefix = "private_key_provider.thread_pool.";
+  return {ALL_THREAD_POOL_PRIVATE_KEY_PROVIDER_STATS(POOL_COUNTER_PREFIX(scope, prefix),
+                                                     POOL_GAUGE_PREFIX(scope, prefix),
+                                                     POOL_HISTOGRAM_PREFIX(scope, prefix))};
+}
+
+void ThreadPoolPrivateKeyMethodProvider::threadRoutine() {
+  while (true) {
+    PrivateKeyOperationSharedPtr operation;
+    {
+      absl::MutexLock lock(&mutex_);
+      mutex_.Await(absl::Condition(this, &ThreadPoolPrivateKeyMethodProvider::hasWork));
+      if (shutdown_) {
+        // Operations still queued belong to connections which have been closed, since open
+        // connections keep the provider alive.
+        return;
+      }
+      operation = std::move(queue_.front());
+      queue_.pop_front();
+    }
+    stats_.queue_depth_.dec();
+    if (operation->cancelled()) {
+      // Don't spend a pool thread on handshakes the client has given up on.
+      continue;
+    }
+    perform(*operation);
+    operation->complete();
+  }
+}
+
+void ThreadPoolPrivateKeyMethodProvider::perform(PrivateKeyOperation& operation) {
+  operation.started_at_ = time_source_.monotonicTime();
+  operation.success_ = operation.decrypt_
+                           ? decrypt(pkey_.get(), operation.input_, operation.output_)
+                           : sign(pkey_.get(), operation.signature_algorithm_, operation.input_,
+                                  operation.output_);
+  operation.finished_at_ = time_source_.monotonicTime();
+  if (!operation.success_) {
+    stats_.operation_failed_.inc();
+  }
+}
+
+ssl_private_key_result_t ThreadPoolPrivateKeyMethodProvider::start(
+    ThreadPoolPrivateKeyConnection& connection, bool decrypt, uint16_t signature_algorithm,
+    const uint8_t* in, size_t in_len, uint8_t* out, size_t* out_len, size_t max_out) {
+  // BoringSSL performs at most one private key operation at a time for a connection.
+  ASSERT(connection.operation_ == nullptr);
+  stats_.operations_.inc();
+
+  auto operation = std::make_shared<PrivateKeyOperation>(connection.cb_, connection.dispatcher_);
+  operation->decrypt_ = decrypt;
+  operation->signature_algorithm_ = signature_algorithm;
+  // The input is only valid for the duration of this call.
+  operation->input_.assign(in, in + in_len);
+  operation->queued_at_ = time_source_.monotonicTime();
+
+  {
+    absl::MutexLock lock(&mutex_);
+    if (queue_.size() < max_queued_operations_) {
+      queue_.push_back(operation);
+      stats_.queue_depth_.inc();
+      connection.operation_ = std::move(operation);
+      return ssl_private_key_retry;
+    }
+  }
+
+  // The pool is saturated. Performing the operation here rather than failing the handshake bounds
+  // the memory held by queued operations, while the workers still make progress.
+  ENVOY_LOG(debug, "private key operation queue is full, performing operation on the worker");
+  stats_.queue_full_.inc();
+  perform(*operation);
+  recordTimes(*operation);
+  return copyOutput(*operation, out, out_len, max_out);
+}
+
+ssl_private_key_result_t
+ThreadPoolPrivateKeyMethodProvider::complete(ThreadPoolPrivateKeyConnection& connection,
+                                             uint8_t* out, size_t* out_len, size_t max_out) {
+  if (connection.operation_ == nullptr) {
+    return ssl_private_key_failure;
+  }
+  if (!connection.operation_->done_) {
+    // The operation didn't finish yet, retry.
+    return ssl_private_key_retry;
+  }
+
+  PrivateKeyOperationSharedPtr operation = std::move(connection.operation_);
+  recordTimes(*operation);
+  return copyOutput(*operation, out, out_len, max_out);
+}
+
+void ThreadPoolPrivateKeyMethodProvider::recordTimes(const PrivateKeyOperation& operation) {
+  stats_.queue_time_us_.recordValue(std::chrono::duration_cast<std::chrono::microseconds>(
+                                        operation.started_at_ - operation.queued_at_)
+                                        .count());
+  stats_.operation_time_us_.recordValue(std::chrono::duration_cast<std::chrono::microseconds>(
+                                            operation.finished_at_ - operation.started_at_)
+                                            .count());
+}
+
+ssl_private_key_result_t
+ThreadPoolPrivateKeyMethodProvider::copyOutput(const PrivateKeyOperation& operation, uint8_t* out,
+                                               size_t* out_len, size_t max_out) {
+  if (!operation.success_ || operation.output_.size() > max_out) {
+    return ssl_private_key_failure;
+  }
+  std::copy(operation.output_.begin(), operation.output_.end(), out);
+  *out_len = operation.output_.size();
+  return ssl_private_key_success;
+}
+
+void ThreadPoolPrivateKeyMethodProvider::registerPrivateKeyMethod(
+    SSL* ssl, Ssl::PrivateKeyConnectionCallbacks& cb, Event::Dispatcher& dispatcher) {
+  // The connection states of the providers of all the RSA certificates of a context are chained
+  // under one index and those of the ECDSA certificates under another. The BoringSSL callbacks
+  // pick a state by the certificate selected for the handshake.
+  const int index = connectionIndex();
+  auto* head = static_cast<ThreadPoolPrivateKeyConnection*>(SSL_get_ex_data(ssl, index));
+  for (const ThreadPoolPrivateKeyConnection* ops = head; ops != nullptr; ops = ops->next_) {
+    if (&ops->provider_ == this) {
+      throw EnvoyException("The thread pool private key provider is already registered for the "
+                           "same SSL object.");
+    }
+  }
+  auto* ops = new ThreadPoolPrivateKeyConnection(*this, cb, dispatcher);
+  ops->next_ = head;
+  SSL_set_ex_data(ssl, index, ops);
+}
+
+void ThreadPoolPrivateKeyMethodProvider::unregisterPrivateKeyMethod(SSL* ssl) {
+  const int index = connectionIndex();
+  auto* head = static_cast<ThreadPoolPrivateKeyConnection*>(SSL_get_ex_data(ssl, index));
+  ThreadPoolPrivateKeyConnection** link = &head;
+  while (*link != nullptr && &(*link)->provider_ != this) {
+    link = &(*link)->next_;
+  }
+  ThreadPoolPrivateKeyConnection* ops = *link;
+  if (ops == nullptr) {
+    return;
+  }
+  *link = ops->next_;
+  SSL_set_ex_data(ssl, index, head);
+  if (ops->operation_ != nullptr) {
+    ops->operation_->cancel();
+  }
+  delete ops;
+}
+
+bool ThreadPoolPrivateKeyMethodProvider::matchesCertificate(X509& cert) const {
+  bssl::UniquePtr<EVP_PKEY> public_key(X509_get_pubkey(&cert));
+  return public_key != nullptr && EVP_PKEY_cmp(public_key.get(), pkey_.get()) == 1;
+}
+
+bool ThreadPoolPrivateKeyMethodProvider::checkFips() {
+  if (EVP_PKEY_id(pkey_.get()) == EVP_PKEY_RSA) {
+    RSA* rsa_private_key = EVP_PKEY_get0_RSA(pkey_.get());
+    return rsa_private_key != nullptr && RSA_check_fips(rsa_private_key);
+  }
+  const EC_KEY* ecdsa_private_key = EVP_PKEY_get0_EC_KEY(pkey_.get());
+  return ecdsa_private_key != nullptr && EC_KEY_check_fips(ecdsa_private_key);
+}
+
+Ssl::BoringSslPrivateKeyMethodSharedPtr
+ThreadPoolPrivateKeyMethodProvider::getBoringSslPrivateKeyMethod() {
+  return method_;
+}
+
+int ThreadPoolPrivateKeyMethodProvider::connectionIndex() const {
+  return EVP_PKEY_id(pkey_.get()) == EVP_PKEY_RSA ? rsaConnectionIndex() : ecdsaConnectionIndex();
+}
+
+int ThreadPoolPrivateKeyMethodProvider::rsaConnectionIndex() {
+  CONSTRUCT_ON_FIRST_USE(int, createIndex());
+}
+
+int ThreadPoolPrivateKeyMethodProvider::ecdsaConnectionIndex() {
+  CONSTRUCT_ON_FIRST_USE(int, createIndex());
+}
+
+} // namespace ThreadPool
+} // namespace PrivateKeyMethodProvider
+} // namespace Extensions
+} // namespace Envoy
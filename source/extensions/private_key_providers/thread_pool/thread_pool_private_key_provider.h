@@ -0,0 +1,199 @@
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <vector>
+
+#include "envoy/common/time.h"
+#include "envoy/event/dispatcher.h"
+#include "envoy/extensions/private_key_providers/thread_pool/v3/thread_pool.pb.h"
+#include "envoy/server/transport_socket_config.h"
+#include "envoy/ssl/private_key/private_key.h"
+#include "envoy/ssl/private_key/private_key_callbacks.h"
+#include "envoy/stats/scope.h"
+#include "envoy/stats/stats_macros.h"
+#include "envoy/thread/thread.h"
+
+#include "common/common/logger.h"
+#include "common/common/thread_annotations.h"
+
+#include "absl/synchronization/mutex.h"
+#include "openssl/ssl.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace PrivateKeyMethodProvider {
+namespace ThreadPool {
+
+/**
+ * All thread pool private key provider stats. @see stats_macros.h
+ */
+#define ALL_THREAD_POOL_PRIVATE_KEY_PROVIDER_STATS(COUNTER, GAUGE, HISTOGRAM)                      \
+  COUNTER(operation_failed)                                                                        \
+  COUNTER(operations)                                                                              \
+  COUNTER(queue_full)                                                                              \
+  GAUGE(queue_depth, Accumulate)                                                                   \
+  HISTOGRAM(operation_time_us, Microseconds)                                                       \
+  HISTOGRAM(queue_time_us, Microseconds)
+
+/**
+ * Struct definition for all thread pool private key provider stats. @see stats_macros.h
+ */
+struct ThreadPoolPrivateKeyProviderStats {
+  ALL_THREAD_POOL_PRIVATE_KEY_PROVIDER_STATS(GENERATE_COUNTER_STRUCT, GENERATE_GAUGE_STRUCT,
+                                             GENERATE_HISTOGRAM_STRUCT)
+};
+
+/**
+ * A signing or decryption operation of one connection. The worker thread of the connection fills
+ * in the input and queues the operation, a pool thread performs it and posts its completion back to
+ * the worker's dispatcher unless the connection has been closed in the meantime.
+ */
+class PrivateKeyOperation : public std::enable_shared_from_this<PrivateKeyOperation> {
+public:
+  PrivateKeyOperation(Ssl::PrivateKeyConnectionCallbacks& cb, Event::Dispatcher& dispatcher)
+      : cb_(cb), dispatcher_(dispatcher) {}
+
+  /**
+   * Called on the pool thread once the output has been set. Resumes the handshake on the worker
+   * thread.
+   */
+  void complete();
+
+  /**
+   * Called on the worker thread when the connection is closed. After this returns the connection
+   * callbacks and the dispatcher are never used again.
+   */
+  void cancel();
+
+  /**
+   * @return bool whether the connection has been closed.
+   */
+  bool cancelled();
+
+  // Set by the worker thread before the operation is queued.
+  bool decrypt_{};
+  uint16_t signature_algorithm_{};
+  std::vector<uint8_t> input_;
+  MonotonicTime queued_at_;
+
+  // Set by the thread performing the operation. The worker thread only reads them once done_ is
+  // set, which happens in the callback posted by complete().
+  bool success_{};
+  std::vector<uint8_t> output_;
+  MonotonicTime started_at_;
+  MonotonicTime finished_at_;
+  bool done_{};
+
+private:
+  Ssl::PrivateKeyConnectionCallbacks& cb_;
+  Event::Dispatcher& dispatcher_;
+  absl::Mutex mutex_;
+  bool cancelled_ ABSL_GUARDED_BY(mutex_){};
+};
+
+using PrivateKeyOperationSharedPtr = std::shared_ptr<PrivateKeyOperation>;
+
+class ThreadPoolPrivateKeyMethodProvider;
+
+/**
+ * Per connection state, stored in the SSL object's ex_data. Certificates of the same key type share
+ * an index, so when several of them use thread pool providers the states of their providers are
+ * chained.
+ */
+struct ThreadPoolPrivateKeyConnection {
+  ThreadPoolPrivateKeyConnection(ThreadPoolPrivateKeyMethodProvider& provider,
+                                 Ssl::PrivateKeyConnectionCallbacks& cb,
+                                 Event::Dispatcher& dispatcher)
+      : provider_(provider), cb_(cb), dispatcher_(dispatcher) {}
+
+  ThreadPoolPrivateKeyMethodProvider& provider_;
+  Ssl::PrivateKeyConnectionCallbacks& cb_;
+  Event::Dispatcher& dispatcher_;
+  // The operation in progress, if any.
+  PrivateKeyOperationSharedPtr operation_;
+  // The state of the next provider of the same key type registered for the connection, if any.
+  ThreadPoolPrivateKeyConnection* next_{};
+};
+
+/**
+ * A private key method provider which performs the private key operations of TLS handshakes on a
+ * bounded pool of threads it owns, so that the expensive RSA and ECDSA operations of full
+ * handshakes don't block the worker threads. When the queue of the pool is full the operation is
+ * performed on the worker thread instead.
+ */
+class ThreadPoolPrivateKeyMethodProvider : public virtual Ssl::PrivateKeyMethodProvider,
+                                           Logger::Loggable<Logger::Id::connection> {
+public:
+  ThreadPoolPrivateKeyMethodProvider(
+      const envoy::extensions::private_key_providers::thread_pool::v3::
+          ThreadPoolPrivateKeyMethodConfig& config,
+      Server::Configuration::TransportSocketFactoryContext& factory_context);
+  ~ThreadPoolPrivateKeyMethodProvider() override;
+
+  // Ssl::PrivateKeyMethodProvider
+  void registerPrivateKeyMethod(SSL* ssl, Ssl::PrivateKeyConnectionCallbacks& cb,
+                                Event::Dispatcher& dispatcher) override;
+  void unregisterPrivateKeyMethod(SSL* ssl) override;
+  bool checkFips() override;
+  Ssl::BoringSslPrivateKeyMethodSharedPtr getBoringSslPrivateKeyMethod() override;
+
+  /**
+   * Start a private key operation for a connection. Called from the BoringSSL sign and decrypt
+   * callbacks on the worker thread.
+   * @return ssl_private_key_retry if the operation has been queued, otherwise the result of
+   *         performing it on the calling thread.
+   */
+  ssl_private_key_result_t start(ThreadPoolPrivateKeyConnection& connection, bool decrypt,
+                                 uint16_t signature_algorithm, const uint8_t* in, size_t in_len,
+                                 uint8_t* out, size_t* out_len, size_t max_out);
+
+  /**
+   * Copy the output of the connection's operation once the pool has completed it. Called from the
+   * BoringSSL complete callback on the worker thread.
+   */
+  ssl_private_key_result_t complete(ThreadPoolPrivateKeyConnection& connection, uint8_t* out,
+                                    size_t* out_len, size_t max_out);
+
+  /**
+   * Perform an operation with the provider's key, setting its output. Thread-safe.
+   */
+  void perform(PrivateKeyOperation& operation);
+
+  /**
+   * @return whether the provider's key is the private key of the certificate.
+   */
+  bool matchesCertificate(X509& cert) const;
+
+  static int rsaConnectionIndex();
+  static int ecdsaConnectionIndex();
+
+private:
+  static ThreadPoolPrivateKeyProviderStats generateStats(Stats::Scope& scope);
+
+  void threadRoutine();
+  bool hasWork() const ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_) {
+    return shutdown_ || !queue_.empty();
+  }
+  int connectionIndex() const;
+  // Histograms are thread local to the recording thread, so they are only recorded by workers.
+  void recordTimes(const PrivateKeyOperation& operation);
+  ssl_private_key_result_t copyOutput(const PrivateKeyOperation& operation, uint8_t* out,
+                                      size_t* out_len, size_t max_out);
+
+  bssl::UniquePtr<EVP_PKEY> pkey_;
+  Ssl::BoringSslPrivateKeyMethodSharedPtr method_;
+  TimeSource& time_source_;
+  ThreadPoolPrivateKeyProviderStats stats_;
+  const uint32_t max_queued_operations_;
+  absl::Mutex mutex_;
+  std::deque<PrivateKeyOperationSharedPtr> queue_ ABSL_GUARDED_BY(mutex_);
+  bool shutdown_ ABSL_GUARDED_BY(mutex_){};
+  std::vector<Thread::ThreadPtr> threads_;
+};
+
+} // namespace ThreadPool
+} // namespace PrivateKeyMethodProvider
+} // namespace Extensions
+} // namespace Envoy
@@ -0,0 +1,25 @@
+#pragma once
+
+#include <string>
+
+#include "common/singleton/const_singleton.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace PrivateKeyMethodProvider {
+
+/**
+ * Well-known private key provider names.
+ * NOTE: New private key providers should use the well known name: envoy.tls.key_providers.name.
+ */
+class PrivateKeyProviderNameValues {
+public:
+  // Provider performing private key operations on a dedicated thread pool.
+  const std::string ThreadPool = "envoy.tls.key_providers.thread_pool";
+};
+
+using PrivateKeyProviderNames = ConstSingleton<PrivateKeyProviderNameValues>;
+
+} // namespace PrivateKeyMethodProvider
+} // namespace Extensions
+} // namespace Envoy
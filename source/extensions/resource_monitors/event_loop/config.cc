@@ -0,0 +1,28 @@
+#include "extensions/resource_monitors/event_loop/config.h"
+
+#include "envoy/config/resource_monitor/event_loop/v2alpha/event_loop.pb.h"
+#include "envoy/config/resource_monitor/event_loop/v2alpha/event_loop.pb.validate.h"
+#include "envoy/registry/registry.h"
+
+#include "extensions/resource_monitors/event_loop/event_loop_monitor.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace ResourceMonitors {
+namespace EventLoopMonitor {
+
+Server::ResourceMonitorPtr EventLoopMonitorFactory::createResourceMonitorFromProtoTyped(
+    const envoy::config::resource_monitor::event_loop::v2alpha::EventLoopConfig& config,
+    Server::Configuration::ResourceMonitorFactoryContext& context) {
+  return std::make_unique<EventLoopMonitor>(config, context.threadLocal());
+}
+
+/**
+ * Static registration for the event loop resource monitor factory. @see RegistryFactory.
+ */
+REGISTER_FACTORY(EventLoopMonitorFactory, Server::Configuration::ResourceMonitorFactory);
+
+} // namespace EventLoopMonitor
+} // namespace ResourceMonitors
+} // namespace Extensions
+} // namespace Envoy
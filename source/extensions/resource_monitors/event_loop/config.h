@@ -0,0 +1,30 @@
+#pragma once
+
+#include "envoy/config/resource_monitor/event_loop/v2alpha/event_loop.pb.h"
+#include "envoy/config/resource_monitor/event_loop/v2alpha/event_loop.pb.validate.h"
+#include "envoy/server/resource_monitor_config.h"
+
+#include "extensions/resource_monitors/common/factory_base.h"
+#include "extensions/resource_monitors/well_known_names.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace ResourceMonitors {
+namespace EventLoopMonitor {
+
+class EventLoopMonitorFactory
+    : public Common::FactoryBase<
+          envoy::config::resource_monitor::event_loop::v2alpha::EventLoopConfig> {
+public:
+  EventLoopMonitorFactory() : FactoryBase(ResourceMonitorNames::get().EventLoop) {}
+
+private:
+  Server::ResourceMonitorPtr createResourceMonitorFromProtoTyped(
+      const envoy::config::resource_monitor::event_loop::v2alpha::EventLoopConfig& config,
+      Server::Configuration::ResourceMonitorFactoryContext& context) override;
+};
+
+} // namespace EventLoopMonitor
+} // namespace ResourceMonitors
+} // namespace Extensions
+} // namespace Envoy
@@ -0,0 +1,67 @@
+#include "extensions/resource_monitors/event_loop/event_loop_monitor.h"
+
+#include <algorithm>
+
+#include "common/common/lock_guard.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace ResourceMonitors {
+namespace EventLoopMonitor {
+
+EventLoopMonitor::ThreadLocalLoopTimes::ThreadLocalLoopTimes(Event::Dispatcher& dispatcher)
+    : dispatcher_(dispatcher), last_(dispatcher.loopTimes()) {}
+
+double EventLoopMonitor::ThreadLocalLoopTimes::sample() {
+  const Event::DispatcherLoopTimes times = dispatcher_.loopTimes();
+  const std::chrono::microseconds busy = times.busy_time_ - last_.busy_time_;
+  const std::chrono::microseconds total = busy + (times.poll_time_ - last_.poll_time_);
+  last_ = times;
+  return total.count() > 0 ? static_cast<double>(busy.count()) / total.count() : 0;
+}
+
+EventLoopMonitor::EventLoopMonitor(
+    const envoy::config::resource_monitor::event_loop::v2alpha::EventLoopConfig&,
+    ThreadLocal::SlotAllocator& slot_allocator)
+    : slot_(slot_allocator.allocateSlot()) {}
+
+void EventLoopMonitor::updateResourceUsage(Server::ResourceMonitor::Callbacks& callbacks) {
+  if (!slot_initialized_) {
+    // Workers register with thread local storage after the overload manager creates its monitors,
+    // so the slot is only set on the first update. Creating the per-thread state enables loop time
+    // tracking on each dispatcher.
+    slot_initialized_ = true;
+    slot_->set([](Event::Dispatcher& dispatcher) -> ThreadLocal::ThreadLocalObjectSharedPtr {
+      return std::make_shared<ThreadLocalLoopTimes>(dispatcher);
+    });
+  }
+
+  auto update = std::make_shared<Update>();
+  slot_->runOnAllThreads(
+      [update](ThreadLocal::ThreadLocalObjectSharedPtr object)
+          -> ThreadLocal::ThreadLocalObjectSharedPtr {
+        if (object != nullptr) {
+          const double utilization =
+              std::dynamic_pointer_cast<ThreadLocalLoopTimes>(object)->sample();
+          Thread::LockGuard lock(update->lock_);
+          update->max_utilization_ = std::max(update->max_utilization_, utilization);
+        }
+        return object;
+      },
+      [update, alive = std::weak_ptr<bool>(alive_), &callbacks]() {
+        if (alive.expired()) {
+          return;
+        }
+        Server::ResourceUsage usage;
+        {
+          Thread::LockGuard lock(update->lock_);
+          usage.resource_pressure_ = update->max_utilization_;
+        }
+        callbacks.onSuccess(usage);
+      });
+}
+
+} // namespace EventLoopMonitor
+} // namespace ResourceMonitors
+} // namespace Extensions
+} // namespace Envoy
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <memory>
+
+#include "envoy/config/resource_monitor/event_loop/v2alpha/event_loop.pb.h"
+#include "envoy/event/dispatcher.h"
+#include "envoy/server/resource_monitor.h"
+#include "envoy/thread_local/thread_local.h"
+
+#include "common/common/thread.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace ResourceMonitors {
+namespace EventLoopMonitor {
+
+/**
+ * Reports the utilization of the busiest event loop: the largest fraction of time that any thread
+ * with thread local storage spent processing events rather than polling for them since the
+ * previous update. Each update samples the main thread and all workers, so a worker which is stuck
+ * processing delays the update until it gets around to it.
+ */
+class EventLoopMonitor : public Server::ResourceMonitor {
+public:
+  EventLoopMonitor(const envoy::config::resource_monitor::event_loop::v2alpha::EventLoopConfig&
+                       config,
+                   ThreadLocal::SlotAllocator& slot_allocator);
+
+  // Server::ResourceMonitor
+  void updateResourceUsage(Server::ResourceMonitor::Callbacks& callbacks) override;
+
+private:
+  // A thread's loop times as of the previous update.
+  struct ThreadLocalLoopTimes : public ThreadLocal::ThreadLocalObject {
+    ThreadLocalLoopTimes(Event::Dispatcher& dispatcher);
+
+    // Returns the fraction of time the loop was busy since the previous call.
+    double sample();
+
+    Event::Dispatcher& dispatcher_;
+    Event::DispatcherLoopTimes last_;
+  };
+
+  // Collects the highest utilization across threads during an update.
+  struct Update {
+    Thread::MutexBasicLockable lock_;
+    double max_utilization_ ABSL_GUARDED_BY(lock_){};
+  };
+
+  ThreadLocal::SlotPtr slot_;
+  bool slot_initialized_{};
+  // Lets an update which completes after the monitor is gone find out.
+  std::shared_ptr<bool> alive_{std::make_shared<bool>(true)};
+};
+
+} // namespace EventLoopMonitor
+} // namespace ResourceMonitors
+} // namespace Extensions
+} // namespace Envoy
@@ -13,6 +13,9 @@ namespace ResourceMonitors {
  */
 class ResourceMonitorNameValues {
 public:
+  // Monitor of the utilization of the busiest event loop.
+  const std::string EventLoop = "envoy.resource_monitors.event_loop";
+
   // Heap monitor with statically configured max.
   const std::string FixedHeap = "envoy.resource_monitors.fixed_heap";
 
@@ -51,8 +51,9 @@ ProtobufTypes::MessagePtr DownstreamSslSocketFactory::createEmptyConfigProto() {
 REGISTER_FACTORY(DownstreamSslSocketFactory,
                  Server::Configuration::DownstreamTransportSocketConfigFactory){"tls"};
 
-Ssl::ContextManagerPtr SslContextManagerFactory::createContextManager(TimeSource& time_source) {
-  return std::make_unique<ContextManagerImpl>(time_source);
+Ssl::ContextManagerPtr SslContextManagerFactory::createContextManager(
+    TimeSource& time_source, Ssl::SessionTicketKeyStorage* session_ticket_key_storage) {
+  return std::make_unique<ContextManagerImpl>(time_source, session_ticket_key_storage);
 }
 
 static Envoy::Registry::RegisterInternalFactory<SslContextManagerFactory,
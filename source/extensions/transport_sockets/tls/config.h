@@ -46,7 +46,9 @@ DECLARE_FACTORY(DownstreamSslSocketFactory);
 
 class SslContextManagerFactory : public Ssl::ContextManagerFactory {
 public:
-  Ssl::ContextManagerPtr createContextManager(TimeSource& time_source) override;
+  Ssl::ContextManagerPtr
+  createContextManager(TimeSource& time_source,
+                       Ssl::SessionTicketKeyStorage* session_ticket_key_storage) override;
 };
 
 DECLARE_FACTORY(SslContextManagerFactory);
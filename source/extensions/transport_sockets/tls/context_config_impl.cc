@@ -139,6 +139,8 @@ Secret::TlsSessionTicketKeysConfigProviderSharedPtr getTlsSessionTicketKeysConfi
   }
   case envoy::extensions::transport_sockets::tls::v3::DownstreamTlsContext::
       SessionTicketKeysTypeCase::kDisableStatelessSessionResumption:
+  case envoy::extensions::transport_sockets::tls::v3::DownstreamTlsContext::
+      SessionTicketKeysTypeCase::kSessionTicketKeyRotation:
   case envoy::extensions::transport_sockets::tls::v3::DownstreamTlsContext::
       SessionTicketKeysTypeCase::SESSION_TICKET_KEYS_TYPE_NOT_SET:
     return nullptr;
@@ -159,8 +161,26 @@ bool getStatelessSessionResumptionDisabled(
   }
 }
 
+absl::optional<Ssl::ServerContextConfig::SessionTicketKeyRotation> getSessionTicketKeyRotation(
+    const envoy::extensions::transport_sockets::tls::v3::DownstreamTlsContext& config,
+    std::chrono::milliseconds default_rotation_interval, uint32_t default_decryption_keys) {
+  if (config.session_ticket_keys_type_case() !=
+      envoy::extensions::transport_sockets::tls::v3::DownstreamTlsContext::
+          SessionTicketKeysTypeCase::kSessionTicketKeyRotation) {
+    return absl::nullopt;
+  }
+  const auto& rotation = config.session_ticket_key_rotation();
+  return Ssl::ServerContextConfig::SessionTicketKeyRotation{
+      std::chrono::milliseconds(PROTOBUF_GET_MS_OR_DEFAULT(rotation, rotation_interval,
+                                                           default_rotation_interval.count())),
+      PROTOBUF_GET_WRAPPED_OR_DEFAULT(rotation, decryption_keys, default_decryption_keys)};
+}
+
 } // namespace
 
+const uint32_t ContextConfigImpl::DEFAULT_INITIAL_RECORD_SIZE = 1400;
+const uint32_t ContextConfigImpl::DEFAULT_INITIAL_RECORD_BYTES = 16384;
+
 ContextConfigImpl::ContextConfigImpl(
     const envoy::extensions::transport_sockets::tls::v3::CommonTlsContext& config,
     const unsigned default_min_protocol_version, const unsigned default_max_protocol_version,
@@ -178,7 +198,18 @@ ContextConfigImpl::ContextConfigImpl(
       min_protocol_version_(tlsVersionFromProto(config.tls_params().tls_minimum_protocol_version(),
                                                 default_min_protocol_version)),
       max_protocol_version_(tlsVersionFromProto(config.tls_params().tls_maximum_protocol_version(),
-                                                default_max_protocol_version)) {
+                                                default_max_protocol_version)),
+      kernel_tls_offload_(config.kernel_tls_offload()),
+      initial_record_size_(config.has_record_sizing()
+                               ? PROTOBUF_GET_WRAPPED_OR_DEFAULT(config.record_sizing(),
+                                                                 initial_record_size,
+                                                                 DEFAULT_INITIAL_RECORD_SIZE)
+                               : 0),
+      initial_record_bytes_(config.has_record_sizing()
+                                ? PROTOBUF_GET_WRAPPED_OR_DEFAULT(config.record_sizing(),
+                                                                  initial_record_bytes,
+                                                                  DEFAULT_INITIAL_RECORD_BYTES)
+                                : 0) {
   if (certificate_validation_context_provider_ != nullptr) {
     if (default_cvc_) {
       // We need to validate combined certificate validation context.
@@ -379,6 +410,10 @@ const std::string ServerContextConfigImpl::DEFAULT_CIPHER_SUITES =
     "AES256-GCM-SHA384:"
     "AES256-SHA";
 
+const std::chrono::milliseconds
+    ServerContextConfigImpl::DEFAULT_SESSION_TICKET_KEY_ROTATION_INTERVAL = std::chrono::hours(1);
+const uint32_t ServerContextConfigImpl::DEFAULT_SESSION_TICKET_DECRYPTION_KEYS = 2;
+
 const std::string ServerContextConfigImpl::DEFAULT_CURVES =
 #ifndef BORINGSSL_FIPS
     "X25519:"
@@ -393,7 +428,11 @@ ServerContextConfigImpl::ServerContextConfigImpl(
       require_client_certificate_(
           PROTOBUF_GET_WRAPPED_OR_DEFAULT(config, require_client_certificate, false)),
       session_ticket_keys_provider_(getTlsSessionTicketKeysConfigProvider(factory_context, config)),
-      disable_stateless_session_resumption_(getStatelessSessionResumptionDisabled(config)) {
+      disable_stateless_session_resumption_(getStatelessSessionResumptionDisabled(config)),
+      session_ticket_key_rotation_(
+          getSessionTicketKeyRotation(config, DEFAULT_SESSION_TICKET_KEY_ROTATION_INTERVAL,
+                                      DEFAULT_SESSION_TICKET_DECRYPTION_KEYS)),
+      shared_session_cache_(config.shared_session_cache()) {
 
   if (session_ticket_keys_provider_ != nullptr) {
     // Validate tls session ticket keys early to reject bad sds updates.
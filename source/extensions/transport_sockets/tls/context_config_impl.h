@@ -43,6 +43,9 @@ public:
   }
   unsigned minProtocolVersion() const override { return min_protocol_version_; };
   unsigned maxProtocolVersion() const override { return max_protocol_version_; };
+  bool kernelTlsOffload() const override { return kernel_tls_offload_; }
+  uint32_t initialRecordSize() const override { return initial_record_size_; }
+  uint32_t initialRecordBytes() const override { return initial_record_bytes_; }
 
   bool isReady() const override {
     const bool tls_is_ready =
@@ -69,6 +72,9 @@ protected:
   Api::Api& api_;
 
 private:
+  static const uint32_t DEFAULT_INITIAL_RECORD_SIZE;
+  static const uint32_t DEFAULT_INITIAL_RECORD_BYTES;
+
   static unsigned tlsVersionFromProto(
       const envoy::extensions::transport_sockets::tls::v3::TlsParameters::TlsProtocol& version,
       unsigned default_version);
@@ -94,6 +100,9 @@ private:
   Envoy::Common::CallbackHandle* cvc_validation_callback_handle_{};
   const unsigned min_protocol_version_;
   const unsigned max_protocol_version_;
+  const bool kernel_tls_offload_;
+  const uint32_t initial_record_size_;
+  const uint32_t initial_record_bytes_;
 };
 
 class ClientContextConfigImpl : public ContextConfigImpl, public Envoy::Ssl::ClientContextConfig {
@@ -150,12 +159,18 @@ public:
   bool disableStatelessSessionResumption() const override {
     return disable_stateless_session_resumption_;
   }
+  const absl::optional<SessionTicketKeyRotation>& sessionTicketKeyRotation() const override {
+    return session_ticket_key_rotation_;
+  }
+  bool sharedSessionCache() const override { return shared_session_cache_; }
 
 private:
   static const unsigned DEFAULT_MIN_VERSION;
   static const unsigned DEFAULT_MAX_VERSION;
   static const std::string DEFAULT_CIPHER_SUITES;
   static const std::string DEFAULT_CURVES;
+  static const std::chrono::milliseconds DEFAULT_SESSION_TICKET_KEY_ROTATION_INTERVAL;
+  static const uint32_t DEFAULT_SESSION_TICKET_DECRYPTION_KEYS;
 
   const bool require_client_certificate_;
   std::vector<SessionTicketKey> session_ticket_keys_;
@@ -169,6 +184,8 @@ private:
 
   absl::optional<std::chrono::seconds> session_timeout_;
   const bool disable_stateless_session_resumption_;
+  const absl::optional<SessionTicketKeyRotation> session_ticket_key_rotation_;
+  const bool shared_session_cache_;
 };
 
 } // namespace Tls
@@ -63,6 +63,9 @@ ContextImpl::ContextImpl(Stats::Scope& scope, const Envoy::Ssl::ContextConfig& c
                          TimeSource& time_source)
     : scope_(scope), stats_(generateStats(scope)), time_source_(time_source),
       tls_max_version_(config.maxProtocolVersion()),
+      kernel_tls_offload_(config.kernelTlsOffload()),
+      initial_record_size_(config.initialRecordSize()),
+      initial_record_bytes_(config.initialRecordBytes()),
       stat_name_set_(scope.symbolTable().makeSet("TransportSockets::Tls")),
       unknown_ssl_cipher_(stat_name_set_->add("unknown_ssl_cipher")),
       unknown_ssl_curve_(stat_name_set_->add("unknown_ssl_curve")),
@@ -253,7 +256,6 @@ ContextImpl::ContextImpl(Stats::Scope& scope, const Envoy::Ssl::ContextConfig& c
     }
   }
 
-  std::unordered_set<int> cert_pkey_ids;
   for (uint32_t i = 0; i < tls_certificates.size(); ++i) {
     auto& ctx = tls_contexts_[i];
     // Load certificate chain.
@@ -298,11 +300,6 @@ ContextImpl::ContextImpl(Stats::Scope& scope, const Envoy::Ssl::ContextConfig& c
 
     bssl::UniquePtr<EVP_PKEY> public_key(X509_get_pubkey(ctx.cert_chain_.get()));
     const int pkey_id = EVP_PKEY_id(public_key.get());
-    if (!cert_pkey_ids.insert(pkey_id).second) {
-      throw EnvoyException(fmt::format("Failed to load certificate chain from {}, at most one "
-                                       "certificate of a given type may be specified",
-                                       ctx.cert_chain_file_path_));
-    }
     ctx.is_ecdsa_ = pkey_id == EVP_PKEY_EC;
     switch (pkey_id) {
     case EVP_PKEY_EC: {
@@ -941,8 +938,15 @@ uint16_t ClientContextImpl::parseSigningAlgorithmsForTest(const std::string& sig
 ServerContextImpl::ServerContextImpl(Stats::Scope& scope,
                                      const Envoy::Ssl::ServerContextConfig& config,
                                      const std::vector<std::string>& server_names,
-                                     TimeSource& time_source)
-    : ContextImpl(scope, config, time_source), session_ticket_keys_(config.sessionTicketKeys()) {
+                                     TimeSource& time_source,
+                                     SessionTicketKeyRingSharedPtr session_ticket_key_ring,
+                                     SessionCacheSharedPtr session_cache)
+    : ContextImpl(scope, config, time_source), session_ticket_keys_(config.sessionTicketKeys()),
+      session_ticket_key_rotation_(config.sessionTicketKeyRotation()),
+      session_ticket_key_ring_(session_ticket_key_rotation_.has_value()
+                                   ? std::move(session_ticket_key_ring)
+                                   : nullptr),
+      session_cache_(config.sharedSessionCache() ? std::move(session_cache) : nullptr) {
   if (config.tlsCertificates().empty()) {
     throw EnvoyException("Server TlsCertificates must have a certificate specified");
   }
@@ -951,6 +955,7 @@ ServerContextImpl::ServerContextImpl(Stats::Scope& scope,
   // since we should have a common ID for session resumption no matter what cert
   // is used. We do this early because it can throw an EnvoyException.
   const SessionContextID session_id = generateHashForSessionContextId(server_names);
+  indexServerNames();
 
   // First, configure the base context for ClientHello interception.
   // TODO(htuch): replace with SSL_IDENTITY when we have this as a means to do multi-cert in
@@ -982,6 +987,13 @@ ServerContextImpl::ServerContextImpl(Stats::Scope& scope,
 
     if (config.disableStatelessSessionResumption()) {
       SSL_CTX_set_options(ctx.ssl_ctx_.get(), SSL_OP_NO_TICKET);
+    } else if (session_ticket_key_ring_ != nullptr) {
+      SSL_CTX_set_tlsext_ticket_key_cb(
+          ctx.ssl_ctx_.get(),
+          [](SSL* ssl, uint8_t* key_name, uint8_t* iv, EVP_CIPHER_CTX* ctx, HMAC_CTX* hmac_ctx,
+             int encrypt) -> int {
+            return fromSsl(ssl)->rotatedSessionTicketProcess(key_name, iv, ctx, hmac_ctx, encrypt);
+          });
     } else if (!session_ticket_keys_.empty()) {
       SSL_CTX_set_tlsext_ticket_key_cb(
           ctx.ssl_ctx_.get(),
@@ -996,6 +1008,20 @@ ServerContextImpl::ServerContextImpl(Stats::Scope& scope,
           });
     }
 
+    if (session_cache_ != nullptr) {
+      // Store sessions only in the shared cache, which BoringSSL reaches through the callbacks.
+      SSL_CTX_set_session_cache_mode(ctx.ssl_ctx_.get(),
+                                     SSL_SESS_CACHE_SERVER | SSL_SESS_CACHE_NO_INTERNAL);
+      SSL_CTX_sess_set_new_cb(ctx.ssl_ctx_.get(), [](SSL* ssl, SSL_SESSION* session) -> int {
+        return fromSsl(ssl)->newSessionCallback(session);
+      });
+      SSL_CTX_sess_set_get_cb(
+          ctx.ssl_ctx_.get(),
+          [](SSL* ssl, const uint8_t* id, int id_len, int* out_copy) -> SSL_SESSION* {
+            return fromSsl(ssl)->getSessionCallback(id, id_len, out_copy);
+          });
+    }
+
     if (config.sessionTimeout()) {
       auto timeout = config.sessionTimeout().value().count();
       SSL_CTX_set_timeout(ctx.ssl_ctx_.get(), uint32_t(timeout));
@@ -1201,6 +1227,80 @@ int ServerContextImpl::sessionTicketProcess(SSL*, uint8_t* key_name, uint8_t* iv
   }
 }
 
+int ServerContextImpl::rotatedSessionTicketProcess(uint8_t* key_name, uint8_t* iv,
+                                                   EVP_CIPHER_CTX* ctx, HMAC_CTX* hmac_ctx,
+                                                   int encrypt) {
+  const EVP_MD* hmac = EVP_sha256();
+  const EVP_CIPHER* cipher = EVP_aes_256_cbc();
+  RELEASE_ASSERT(sizeof(SessionTicketKeyRing::Key::aes_key_) == EVP_CIPHER_key_length(cipher), "");
+  static_assert(sizeof(SessionTicketKeyRing::Key::name_) == SSL_TICKET_KEY_NAME_LEN,
+                "Expected key.name length");
+
+  SessionTicketKeyRing::Key key;
+  bool newest = true;
+  if (encrypt == 1) {
+    if (session_ticket_key_ring_->encryptionKey(session_ticket_key_rotation_->rotation_interval_,
+                                                key)) {
+      stats_.session_ticket_key_rotated_.inc();
+    }
+    std::copy_n(key.name_, SSL_TICKET_KEY_NAME_LEN, key_name);
+
+    const int rc = RAND_bytes(iv, EVP_CIPHER_iv_length(cipher));
+    ASSERT(rc);
+
+    if (!EVP_EncryptInit_ex(ctx, cipher, nullptr, key.aes_key_, iv)) {
+      return -1;
+    }
+  } else {
+    if (!session_ticket_key_ring_->decryptionKey(
+            key_name, session_ticket_key_rotation_->decryption_keys_, key, newest)) {
+      stats_.session_ticket_unknown_key_.inc();
+      return 0; // decryption failed
+    }
+
+    if (!EVP_DecryptInit_ex(ctx, cipher, nullptr, key.aes_key_, iv)) {
+      return -1;
+    }
+  }
+
+  if (!HMAC_Init_ex(hmac_ctx, key.hmac_key_, sizeof(key.hmac_key_), hmac, nullptr)) {
+    return -1;
+  }
+
+  // Tickets which were not encrypted with the newest key are renewed.
+  return newest ? 1 : 2;
+}
+
+int ServerContextImpl::newSessionCallback(SSL_SESSION* session) {
+  unsigned id_length;
+  SSL_SESSION_get_id(session, &id_length);
+  if (id_length == 0) {
+    return 0;
+  }
+  session_cache_->insert(bssl::UniquePtr<SSL_SESSION>(session));
+  return 1; // Tell BoringSSL that we took ownership of the session.
+}
+
+SSL_SESSION* ServerContextImpl::getSessionCallback(const uint8_t* id, int id_len, int* out_copy) {
+  bssl::UniquePtr<SSL_SESSION> session =
+      session_cache_->lookup(absl::string_view(reinterpret_cast<const char*>(id), id_len));
+  if (session == nullptr) {
+    stats_.session_cache_miss_.inc();
+    return nullptr;
+  }
+  stats_.session_cache_hit_.inc();
+  // Hand the reference returned by the cache over to BoringSSL.
+  *out_copy = 0;
+  return session.release();
+}
+
+ServerContextImpl* ServerContextImpl::fromSsl(SSL* ssl) {
+  ContextImpl* context_impl = static_cast<ContextImpl*>(SSL_CTX_get_app_data(SSL_get_SSL_CTX(ssl)));
+  ServerContextImpl* server_context_impl = dynamic_cast<ServerContextImpl*>(context_impl);
+  RELEASE_ASSERT(server_context_impl != nullptr, ""); // for Coverity
+  return server_context_impl;
+}
+
 bool ServerContextImpl::isClientEcdsaCapable(const SSL_CLIENT_HELLO* ssl_client_hello) {
   CBS client_hello;
   CBS_init(&client_hello, ssl_client_hello->client_hello, ssl_client_hello->client_hello_len);
@@ -1271,19 +1371,68 @@ bool ServerContextImpl::isClientEcdsaCapable(const SSL_CLIENT_HELLO* ssl_client_
   return false;
 }
 
+absl::string_view ServerContextImpl::serverName(const SSL_CLIENT_HELLO* ssl_client_hello) {
+  const uint8_t* data;
+  size_t len;
+  if (!SSL_early_callback_ctx_extension_get(ssl_client_hello, TLSEXT_TYPE_server_name, &data,
+                                            &len)) {
+    return {};
+  }
+  // https://tools.ietf.org/html/rfc6066#section-3 allows a single host name.
+  CBS extension, server_name_list, host_name;
+  uint8_t name_type;
+  CBS_init(&extension, data, len);
+  if (!CBS_get_u16_length_prefixed(&extension, &server_name_list) || CBS_len(&extension) != 0 ||
+      !CBS_get_u8(&server_name_list, &name_type) || name_type != TLSEXT_NAMETYPE_host_name ||
+      !CBS_get_u16_length_prefixed(&server_name_list, &host_name)) {
+    return {};
+  }
+  return {reinterpret_cast<const char*>(CBS_data(&host_name)), CBS_len(&host_name)};
+}
+
+void ServerContextImpl::indexServerNames() {
+  for (uint32_t i = 0; i < tls_contexts_.size(); i++) {
+    const TlsContext& ctx = tls_contexts_[i];
+    uint32_t& default_certificate =
+        ctx.is_ecdsa_ ? default_certificates_.ecdsa_ : default_certificates_.other_;
+    if (default_certificate == ServerNameIndex::Certificates::None) {
+      default_certificate = i;
+    }
+    if (tls_contexts_.size() == 1) {
+      continue;
+    }
+    for (const std::string& name : ServerNameIndex::certificateNames(*ctx.cert_chain_)) {
+      if (!server_name_index_.add(name, i, ctx.is_ecdsa_)) {
+        throw EnvoyException(fmt::format("Failed to load certificate chain from {}, at most one "
+                                         "certificate of a given type may be specified for {}",
+                                         ctx.cert_chain_file_path_, name));
+      }
+    }
+  }
+}
+
 enum ssl_select_cert_result_t
 ServerContextImpl::selectTlsContext(const SSL_CLIENT_HELLO* ssl_client_hello) {
-  const bool client_ecdsa_capable = isClientEcdsaCapable(ssl_client_hello);
-  // Fallback on first certificate.
-  const TlsContext* selected_ctx = &tls_contexts_[0];
-  for (const auto& ctx : tls_contexts_) {
-    if (client_ecdsa_capable == ctx.is_ecdsa_) {
-      selected_ctx = &ctx;
-      break;
-    }
+  if (tls_contexts_.size() == 1) {
+    return ssl_select_cert_success;
+  }
+
+  const ServerNameIndex::Certificates* certificates =
+      server_name_index_.find(serverName(ssl_client_hello));
+  if (certificates == nullptr) {
+    certificates = &default_certificates_;
   }
-  RELEASE_ASSERT(SSL_set_SSL_CTX(ssl_client_hello->ssl, selected_ctx->ssl_ctx_.get()) != nullptr,
-                 "");
+  // Prefer the key type the client supports, but fall back on the other one rather than failing
+  // the handshake.
+  const bool client_ecdsa_capable = isClientEcdsaCapable(ssl_client_hello);
+  uint32_t selected = client_ecdsa_capable ? certificates->ecdsa_ : certificates->other_;
+  if (selected == ServerNameIndex::Certificates::None) {
+    selected = client_ecdsa_capable ? certificates->other_ : certificates->ecdsa_;
+  }
+  ASSERT(selected < tls_contexts_.size());
+  RELEASE_ASSERT(
+      SSL_set_SSL_CTX(ssl_client_hello->ssl, tls_contexts_[selected].ssl_ctx_.get()) != nullptr,
+      "");
   return ssl_select_cert_success;
 }
 
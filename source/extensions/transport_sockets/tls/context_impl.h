@@ -18,6 +18,9 @@
 #include "common/stats/symbol_table_impl.h"
 
 #include "extensions/transport_sockets/tls/context_manager_impl.h"
+#include "extensions/transport_sockets/tls/server_name_index.h"
+#include "extensions/transport_sockets/tls/session_cache.h"
+#include "extensions/transport_sockets/tls/session_ticket_key_ring.h"
 
 #include "absl/synchronization/mutex.h"
 #include "openssl/ssl.h"
@@ -40,7 +43,13 @@ namespace Tls {
   COUNTER(fail_verify_no_cert)                                                                     \
   COUNTER(fail_verify_error)                                                                       \
   COUNTER(fail_verify_san)                                                                         \
-  COUNTER(fail_verify_cert_hash)
+  COUNTER(fail_verify_cert_hash)                                                                   \
+  COUNTER(kernel_tls_offloaded)                                                                    \
+  COUNTER(kernel_tls_unsupported)                                                                  \
+  COUNTER(session_cache_hit)                                                                       \
+  COUNTER(session_cache_miss)                                                                      \
+  COUNTER(session_ticket_key_rotated)                                                              \
+  COUNTER(session_ticket_unknown_key)
 
 /**
  * Wrapper struct for SSL stats. @see stats_macros.h
@@ -88,6 +97,24 @@ public:
 
   SslStats& stats() { return stats_; }
 
+  /**
+   * @return true if connections should try to offload record encryption to the kernel once the
+   *         handshake completes.
+   */
+  bool kernelTlsOffload() const { return kernel_tls_offload_; }
+
+  /**
+   * @return the maximum plaintext size of the records written at the start of a connection, or 0
+   *         if all records are written at the maximum size.
+   */
+  uint32_t initialRecordSize() const { return initial_record_size_; }
+
+  /**
+   * @return the number of plaintext bytes written with initialRecordSize() records before a
+   *         connection switches to maximum size records.
+   */
+  uint32_t initialRecordBytes() const { return initial_record_bytes_; }
+
   /**
    * The global SSL-library index used for storing a pointer to the SslExtendedSocketInfo
    * class in the SSL instance, for retrieval in callbacks.
@@ -192,6 +219,9 @@ protected:
   std::string cert_chain_file_path_;
   TimeSource& time_source_;
   const unsigned tls_max_version_;
+  const bool kernel_tls_offload_;
+  const uint32_t initial_record_size_;
+  const uint32_t initial_record_bytes_;
   mutable Stats::StatNameSetPtr stat_name_set_;
   const Stats::StatName unknown_ssl_cipher_;
   const Stats::StatName unknown_ssl_curve_;
@@ -227,7 +257,9 @@ private:
 class ServerContextImpl : public ContextImpl, public Envoy::Ssl::ServerContext {
 public:
   ServerContextImpl(Stats::Scope& scope, const Envoy::Ssl::ServerContextConfig& config,
-                    const std::vector<std::string>& server_names, TimeSource& time_source);
+                    const std::vector<std::string>& server_names, TimeSource& time_source,
+                    SessionTicketKeyRingSharedPtr session_ticket_key_ring,
+                    SessionCacheSharedPtr session_cache);
 
 private:
   using SessionContextID = std::array<uint8_t, SSL_MAX_SSL_SESSION_ID_LENGTH>;
@@ -236,7 +268,15 @@ private:
                          unsigned int inlen);
   int sessionTicketProcess(SSL* ssl, uint8_t* key_name, uint8_t* iv, EVP_CIPHER_CTX* ctx,
                            HMAC_CTX* hmac_ctx, int encrypt);
+  int rotatedSessionTicketProcess(uint8_t* key_name, uint8_t* iv, EVP_CIPHER_CTX* ctx,
+                                  HMAC_CTX* hmac_ctx, int encrypt);
+  int newSessionCallback(SSL_SESSION* session);
+  SSL_SESSION* getSessionCallback(const uint8_t* id, int id_len, int* out_copy);
+  static ServerContextImpl* fromSsl(SSL* ssl);
   bool isClientEcdsaCapable(const SSL_CLIENT_HELLO* ssl_client_hello);
+  // Returns the host name of the SNI extension of the ClientHello, or an empty string.
+  static absl::string_view serverName(const SSL_CLIENT_HELLO* ssl_client_hello);
+  void indexServerNames();
   // Select the TLS certificate context in SSL_CTX_set_select_certificate_cb() callback with
   // ClientHello details.
   enum ssl_select_cert_result_t selectTlsContext(const SSL_CLIENT_HELLO* ssl_client_hello);
@@ -244,6 +284,15 @@ private:
   SessionContextID generateHashForSessionContextId(const std::vector<std::string>& server_names);
 
   const std::vector<Envoy::Ssl::ServerContextConfig::SessionTicketKey> session_ticket_keys_;
+  const absl::optional<Envoy::Ssl::ServerContextConfig::SessionTicketKeyRotation>
+      session_ticket_key_rotation_;
+  // Only set if session ticket keys are rotated, or if the shared session cache is used.
+  const SessionTicketKeyRingSharedPtr session_ticket_key_ring_;
+  const SessionCacheSharedPtr session_cache_;
+  // The certificates covering each server name, consulted when there are several certificates.
+  ServerNameIndex server_name_index_;
+  // The first certificate of each key type, used when no certificate covers the SNI.
+  ServerNameIndex::Certificates default_certificates_;
 };
 
 } // namespace Tls
@@ -13,6 +13,13 @@ namespace Extensions {
 namespace TransportSockets {
 namespace Tls {
 
+ContextManagerImpl::ContextManagerImpl(TimeSource& time_source,
+                                       Ssl::SessionTicketKeyStorage* session_ticket_key_storage)
+    : time_source_(time_source),
+      session_ticket_key_ring_(
+          std::make_shared<SessionTicketKeyRing>(session_ticket_key_storage, time_source)),
+      session_cache_(std::make_shared<SessionCache>()) {}
+
 ContextManagerImpl::~ContextManagerImpl() {
   removeEmptyContexts();
   KNOWN_ISSUE_ASSERT(contexts_.empty(), "https://github.com/envoyproxy/envoy/issues/10030");
@@ -45,7 +52,8 @@ ContextManagerImpl::createSslServerContext(Stats::Scope& scope,
   }
 
   Envoy::Ssl::ServerContextSharedPtr context =
-      std::make_shared<ServerContextImpl>(scope, config, server_names, time_source_);
+      std::make_shared<ServerContextImpl>(scope, config, server_names, time_source_,
+                                          session_ticket_key_ring_, session_cache_);
   removeEmptyContexts();
   contexts_.emplace_back(context);
   return context;
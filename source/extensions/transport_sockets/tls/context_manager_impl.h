@@ -6,9 +6,12 @@
 #include "envoy/common/time.h"
 #include "envoy/ssl/context_manager.h"
 #include "envoy/ssl/private_key/private_key.h"
+#include "envoy/ssl/session_ticket_key_storage.h"
 #include "envoy/stats/scope.h"
 
 #include "extensions/transport_sockets/tls/private_key/private_key_manager_impl.h"
+#include "extensions/transport_sockets/tls/session_cache.h"
+#include "extensions/transport_sockets/tls/session_ticket_key_ring.h"
 
 namespace Envoy {
 namespace Extensions {
@@ -24,7 +27,8 @@ namespace Tls {
  */
 class ContextManagerImpl final : public Envoy::Ssl::ContextManager {
 public:
-  ContextManagerImpl(TimeSource& time_source) : time_source_(time_source) {}
+  ContextManagerImpl(TimeSource& time_source,
+                     Ssl::SessionTicketKeyStorage* session_ticket_key_storage = nullptr);
   ~ContextManagerImpl() override;
 
   // Ssl::ContextManager
@@ -44,6 +48,9 @@ private:
   void removeEmptyContexts();
   TimeSource& time_source_;
   std::list<std::weak_ptr<Envoy::Ssl::Context>> contexts_;
+  // Shared with the server contexts, which may outlive the manager.
+  const SessionTicketKeyRingSharedPtr session_ticket_key_ring_;
+  const SessionCacheSharedPtr session_cache_;
   PrivateKeyMethodManagerImpl private_key_method_manager_{};
 };
 
@@ -0,0 +1,179 @@
+#include "extensions/transport_sockets/tls/kernel_tls.h"
+
+#include <array>
+#include <cstring>
+
+#include "common/api/os_sys_calls_impl.h"
+
+#include "openssl/mem.h"
+#include "openssl/nid.h"
+
+#ifdef __linux__
+#include <linux/tls.h>
+
+// These may be missing from older libc headers even when the kernel headers have kTLS.
+#ifndef TCP_ULP
+#define TCP_ULP 31
+#endif
+#ifndef SOL_TLS
+#define SOL_TLS 282
+#endif
+#endif
+
+namespace Envoy {
+namespace Extensions {
+namespace TransportSockets {
+namespace Tls {
+namespace KernelTls {
+
+#ifdef __linux__
+namespace {
+
+// TLS 1.2 AES-GCM uses a 4 byte implicit nonce (salt) per direction and no MAC keys.
+constexpr size_t SaltSize = 4;
+constexpr size_t MaxKeySize = 32;
+
+size_t keySize(const SSL* ssl) {
+  switch (SSL_CIPHER_get_cipher_nid(SSL_get_current_cipher(ssl))) {
+  case NID_aes_128_gcm:
+    return TLS_CIPHER_AES_GCM_128_KEY_SIZE;
+  case NID_aes_256_gcm:
+    return TLS_CIPHER_AES_GCM_256_KEY_SIZE;
+  default:
+    return 0;
+  }
+}
+
+template <class CryptoInfo>
+bool setCryptoInfo(os_fd_t fd, int direction, uint16_t cipher_type, const uint8_t* key,
+                   const uint8_t* salt, uint64_t sequence) {
+  CryptoInfo info;
+  memset(&info, 0, sizeof(info));
+  info.info.version = TLS_1_2_VERSION;
+  info.info.cipher_type = cipher_type;
+  memcpy(info.key, key, sizeof(info.key));
+  memcpy(info.salt, salt, sizeof(info.salt));
+  // BoringSSL uses the record sequence number as the explicit nonce, and the kernel increments
+  // both together.
+  const uint64_t sequence_be = htobe64(sequence);
+  memcpy(info.iv, &sequence_be, sizeof(info.iv));
+  memcpy(info.rec_seq, &sequence_be, sizeof(info.rec_seq));
+  const int rc =
+      Api::OsSysCallsSingleton::get().setsockopt(fd, SOL_TLS, direction, &info, sizeof(info)).rc_;
+  OPENSSL_cleanse(&info, sizeof(info));
+  return rc == 0;
+}
+
+bool installKeys(const SSL* ssl, os_fd_t fd, bool transmit) {
+  const size_t key_size = keySize(ssl);
+  // The key block holds the client and server write keys followed by their salts.
+  const size_t key_block_size = 2 * (key_size + SaltSize);
+  std::array<uint8_t, 2 * (MaxKeySize + SaltSize)> key_block;
+  if (key_size == 0 || SSL_get_key_block_len(ssl) != key_block_size ||
+      !SSL_generate_key_block(ssl, key_block.data(), key_block_size)) {
+    return false;
+  }
+
+  // A client transmits with the client keys and receives with the server keys, and vice versa.
+  const bool client_keys = transmit != static_cast<bool>(SSL_is_server(ssl));
+  const uint8_t* key = key_block.data() + (client_keys ? 0 : key_size);
+  const uint8_t* salt = key_block.data() + 2 * key_size + (client_keys ? 0 : SaltSize);
+  const uint64_t sequence = transmit ? SSL_get_write_sequence(ssl) : SSL_get_read_sequence(ssl);
+  const int direction = transmit ? TLS_TX : TLS_RX;
+
+  const bool installed =
+      key_size == TLS_CIPHER_AES_GCM_128_KEY_SIZE
+          ? setCryptoInfo<tls12_crypto_info_aes_gcm_128>(fd, direction, TLS_CIPHER_AES_GCM_128,
+                                                          key, salt, sequence)
+          : setCryptoInfo<tls12_crypto_info_aes_gcm_256>(fd, direction, TLS_CIPHER_AES_GCM_256,
+                                                          key, salt, sequence);
+  OPENSSL_cleanse(key_block.data(), key_block.size());
+  return installed;
+}
+
+} // namespace
+
+bool supported(const SSL* ssl) {
+  return SSL_version(ssl) == TLS1_2_VERSION && keySize(ssl) != 0;
+}
+
+bool attach(os_fd_t fd) {
+  static const char ulp[] = "tls";
+  return Api::OsSysCallsSingleton::get().setsockopt(fd, IPPROTO_TCP, TCP_ULP, ulp, sizeof(ulp))
+             .rc_ == 0;
+}
+
+bool enableTx(const SSL* ssl, os_fd_t fd) { return installKeys(ssl, fd, true); }
+
+bool enableRx(const SSL* ssl, os_fd_t fd) { return installKeys(ssl, fd, false); }
+
+Api::SysCallSizeResult readRecord(os_fd_t fd, const iovec* iov, int num_iov,
+                                  uint8_t& record_type) {
+  char control[CMSG_SPACE(sizeof(uint8_t))];
+  msghdr msg;
+  memset(&msg, 0, sizeof(msg));
+  msg.msg_iov = const_cast<iovec*>(iov);
+  msg.msg_iovlen = num_iov;
+  msg.msg_control = control;
+  msg.msg_controllen = sizeof(control);
+
+  const Api::SysCallSizeResult result = Api::OsSysCallsSingleton::get().recvmsg(fd, &msg, 0);
+  record_type = RecordTypeApplicationData;
+  if (result.rc_ > 0) {
+    // The kernel only attaches the record type to records other than application data.
+    for (cmsghdr* cmsg = CMSG_FIRSTHDR(&msg); cmsg != nullptr; cmsg = CMSG_NXTHDR(&msg, cmsg)) {
+      if (cmsg->cmsg_level == SOL_TLS && cmsg->cmsg_type == TLS_GET_RECORD_TYPE) {
+        record_type = *reinterpret_cast<uint8_t*>(CMSG_DATA(cmsg));
+      }
+    }
+  }
+  return result;
+}
+
+Api::SysCallSizeResult sendAlert(os_fd_t fd, uint8_t level, uint8_t description) {
+  uint8_t alert[2] = {level, description};
+  iovec iov;
+  iov.iov_base = alert;
+  iov.iov_len = sizeof(alert);
+
+  char control[CMSG_SPACE(sizeof(uint8_t))];
+  memset(control, 0, sizeof(control));
+  msghdr msg;
+  memset(&msg, 0, sizeof(msg));
+  msg.msg_iov = &iov;
+  msg.msg_iovlen = 1;
+  msg.msg_control = control;
+  msg.msg_controllen = sizeof(control);
+
+  cmsghdr* cmsg = CMSG_FIRSTHDR(&msg);
+  cmsg->cmsg_level = SOL_TLS;
+  cmsg->cmsg_type = TLS_SET_RECORD_TYPE;
+  cmsg->cmsg_len = CMSG_LEN(sizeof(uint8_t));
+  *reinterpret_cast<uint8_t*>(CMSG_DATA(cmsg)) = RecordTypeAlert;
+
+  return Api::OsSysCallsSingleton::get().sendmsg(fd, &msg, 0);
+}
+
+#else
+
+bool supported(const SSL*) { return false; }
+
+bool attach(os_fd_t) { return false; }
+
+bool enableTx(const SSL*, os_fd_t) { return false; }
+
+bool enableRx(const SSL*, os_fd_t) { return false; }
+
+Api::SysCallSizeResult readRecord(os_fd_t, const iovec*, int, uint8_t&) {
+  return {-1, ENOTSUP};
+}
+
+Api::SysCallSizeResult sendAlert(os_fd_t, uint8_t, uint8_t) { return {-1, ENOTSUP}; }
+
+#endif
+
+} // namespace KernelTls
+} // namespace Tls
+} // namespace TransportSockets
+} // namespace Extensions
+} // namespace Envoy
@@ -0,0 +1,84 @@
+#pragma once
+
+#include <cstdint>
+
+#include "envoy/api/os_sys_calls.h"
+#include "envoy/common/platform.h"
+
+#include "openssl/ssl.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace TransportSockets {
+namespace Tls {
+namespace KernelTls {
+
+// TLS record content types.
+constexpr uint8_t RecordTypeAlert = 21;
+constexpr uint8_t RecordTypeApplicationData = 23;
+
+// TLS alert levels and descriptions.
+constexpr uint8_t AlertLevelWarning = 1;
+constexpr uint8_t AlertCloseNotify = 0;
+
+/**
+ * Checks whether the parameters negotiated by a connection can be handed over to the kernel. Only
+ * TLS 1.2 with AES-GCM is supported, since BoringSSL only exports TLS 1.2 key material.
+ * @param ssl supplies the connection, which must have completed its handshake.
+ * @return bool true if the connection's records can be encrypted by the kernel.
+ */
+bool supported(const SSL* ssl);
+
+/**
+ * Attaches the kernel TLS upper layer protocol to a TCP socket. Data keeps flowing unchanged until
+ * keys are installed with enableTx() or enableRx().
+ * @param fd supplies the socket.
+ * @return bool true on success, false if the kernel does not support TLS.
+ */
+bool attach(os_fd_t fd);
+
+/**
+ * Installs a connection's transmit keys and sequence number on its socket. Once this succeeds,
+ * plaintext written to the socket is sent as encrypted application data records, and SSL_write()
+ * must no longer be used.
+ * @param ssl supplies the connection, which must satisfy supported().
+ * @param fd supplies the socket, to which attach() must have succeeded.
+ * @return bool true on success.
+ */
+bool enableTx(const SSL* ssl, os_fd_t fd);
+
+/**
+ * Installs a connection's receive keys and sequence number on its socket. Once this succeeds,
+ * records must be read with readRecord() instead of SSL_read(). BoringSSL must not hold any data
+ * it has read from the socket, @see SSL_has_pending().
+ * @param ssl supplies the connection, which must satisfy supported().
+ * @param fd supplies the socket, to which attach() must have succeeded.
+ * @return bool true on success.
+ */
+bool enableRx(const SSL* ssl, os_fd_t fd);
+
+/**
+ * Reads the plaintext of records of a single type from a socket with receive keys installed.
+ * @param fd supplies the socket.
+ * @param iov supplies the buffers to read into.
+ * @param num_iov supplies the number of buffers.
+ * @param record_type receives the content type of the records that were read.
+ * @return Api::SysCallSizeResult the result of the read.
+ */
+Api::SysCallSizeResult readRecord(os_fd_t fd, const iovec* iov, int num_iov,
+                                  uint8_t& record_type);
+
+/**
+ * Sends an alert through a socket with transmit keys installed.
+ * @param fd supplies the socket.
+ * @param level supplies the alert level.
+ * @param description supplies the alert description.
+ * @return Api::SysCallSizeResult the result of the write.
+ */
+Api::SysCallSizeResult sendAlert(os_fd_t fd, uint8_t level, uint8_t description);
+
+} // namespace KernelTls
+} // namespace Tls
+} // namespace TransportSockets
+} // namespace Extensions
+} // namespace Envoy
@@ -0,0 +1,68 @@
+#include "extensions/transport_sockets/tls/server_name_index.h"
+
+#include "extensions/transport_sockets/tls/utility.h"
+
+#include "absl/strings/ascii.h"
+#include "absl/strings/match.h"
+#include "openssl/x509v3.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace TransportSockets {
+namespace Tls {
+
+constexpr uint32_t ServerNameIndex::Certificates::None;
+
+bool ServerNameIndex::add(absl::string_view name, uint32_t index, bool is_ecdsa) {
+  std::string key = absl::AsciiStrToLower(name);
+  absl::flat_hash_map<std::string, Certificates>* map = &exact_;
+  if (absl::StartsWith(key, "*.")) {
+    key.erase(0, 1);
+    map = &wildcard_;
+  }
+  uint32_t& certificate = is_ecdsa ? (*map)[key].ecdsa_ : (*map)[key].other_;
+  if (certificate != Certificates::None) {
+    return false;
+  }
+  certificate = index;
+  return true;
+}
+
+const ServerNameIndex::Certificates* ServerNameIndex::find(absl::string_view server_name) const {
+  if (server_name.empty()) {
+    return nullptr;
+  }
+  const std::string name = absl::AsciiStrToLower(server_name);
+  auto it = exact_.find(name);
+  if (it != exact_.end()) {
+    return &it->second;
+  }
+  // A wildcard covers a single label, so "*.example.com" matches "www.example.com" but neither
+  // "example.com" nor "a.www.example.com".
+  const size_t dot = name.find('.');
+  if (dot == 0 || dot == std::string::npos || wildcard_.empty()) {
+    return nullptr;
+  }
+  it = wildcard_.find(absl::string_view(name).substr(dot));
+  return it != wildcard_.end() ? &it->second : nullptr;
+}
+
+std::vector<std::string> ServerNameIndex::certificateNames(X509& cert) {
+  std::vector<std::string> names = Utility::getSubjectAltNames(cert, GEN_DNS);
+  if (!names.empty()) {
+    return names;
+  }
+  X509_NAME* subject = X509_get_subject_name(&cert);
+  const int i = X509_NAME_get_index_by_NID(subject, NID_commonName, -1);
+  if (i >= 0) {
+    const ASN1_STRING* cn = X509_NAME_ENTRY_get_data(X509_NAME_get_entry(subject, i));
+    names.emplace_back(reinterpret_cast<const char*>(ASN1_STRING_get0_data(cn)),
+                       ASN1_STRING_length(cn));
+  }
+  return names;
+}
+
+} // namespace Tls
+} // namespace TransportSockets
+} // namespace Extensions
+} // namespace Envoy
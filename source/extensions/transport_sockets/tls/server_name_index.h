@@ -0,0 +1,74 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/strings/string_view.h"
+#include "openssl/ssl.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace TransportSockets {
+namespace Tls {
+
+/**
+ * Maps the server names covered by the certificates of a server context to the certificates, so
+ * that the certificate for the SNI of a ClientHello is found in constant time however many
+ * certificates the context has. A name may have one certificate of each key type, from which the
+ * handshake picks according to the client's capabilities.
+ *
+ * Exact names take precedence over wildcard names, which only match a single leftmost label as
+ * described in RFC 6125. Names are matched case insensitively.
+ */
+class ServerNameIndex {
+public:
+  /**
+   * Certificates for a server name, as indexes into the certificates of the context.
+   */
+  struct Certificates {
+    static constexpr uint32_t None = UINT32_MAX;
+
+    uint32_t ecdsa_{None};
+    uint32_t other_{None};
+  };
+
+  /**
+   * Add a certificate for a server name.
+   * @param name supplies the server name, which may be a wildcard such as "*.example.com".
+   * @param index supplies the index of the certificate.
+   * @param is_ecdsa supplies whether the certificate has an ECDSA key.
+   * @return false if the name already has a certificate of the same key type.
+   */
+  bool add(absl::string_view name, uint32_t index, bool is_ecdsa);
+
+  /**
+   * Find the certificates for the SNI of a ClientHello.
+   * @param server_name supplies the SNI.
+   * @return const Certificates* the certificates of the exact name if any, otherwise of the
+   *         matching wildcard name, or nullptr if no certificate covers the name.
+   */
+  const Certificates* find(absl::string_view server_name) const;
+
+  /**
+   * @return bool whether the index holds no names.
+   */
+  bool empty() const { return exact_.empty() && wildcard_.empty(); }
+
+  /**
+   * @return the names covered by a certificate: its DNS SANs, or its subject CN if it has none.
+   */
+  static std::vector<std::string> certificateNames(X509& cert);
+
+private:
+  // Keyed by the lower case name.
+  absl::flat_hash_map<std::string, Certificates> exact_;
+  // Keyed by the lower case name without the leading "*", e.g. ".example.com".
+  absl::flat_hash_map<std::string, Certificates> wildcard_;
+};
+
+} // namespace Tls
+} // namespace TransportSockets
+} // namespace Extensions
+} // namespace Envoy
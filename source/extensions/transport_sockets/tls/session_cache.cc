@@ -0,0 +1,65 @@
+#include "extensions/transport_sockets/tls/session_cache.h"
+
+#include <algorithm>
+
+#include "common/common/assert.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace TransportSockets {
+namespace Tls {
+
+SessionCache::SessionCache(uint32_t capacity)
+    : shard_capacity_(std::max(capacity / NumShards, 1U)) {}
+
+void SessionCache::insert(bssl::UniquePtr<SSL_SESSION> session) {
+  unsigned id_length;
+  const uint8_t* id_data = SSL_SESSION_get_id(session.get(), &id_length);
+  ASSERT(id_length > 0);
+  std::string id(reinterpret_cast<const char*>(id_data), id_length);
+
+  Shard& shard = this->shard(id);
+  absl::MutexLock lock(&shard.mutex_);
+  auto it = shard.index_.find(id);
+  if (it != shard.index_.end()) {
+    shard.sessions_.erase(it->second);
+    shard.index_.erase(it);
+  } else if (shard.sessions_.size() >= shard_capacity_) {
+    shard.index_.erase(shard.sessions_.back().first);
+    shard.sessions_.pop_back();
+  }
+  shard.sessions_.emplace_front(id, std::move(session));
+  shard.index_.emplace(std::move(id), shard.sessions_.begin());
+}
+
+bssl::UniquePtr<SSL_SESSION> SessionCache::lookup(absl::string_view id) {
+  Shard& shard = this->shard(id);
+  absl::MutexLock lock(&shard.mutex_);
+  auto it = shard.index_.find(id);
+  if (it == shard.index_.end()) {
+    return nullptr;
+  }
+  shard.sessions_.splice(shard.sessions_.begin(), shard.sessions_, it->second);
+  SSL_SESSION* session = it->second->second.get();
+  SSL_SESSION_up_ref(session);
+  return bssl::UniquePtr<SSL_SESSION>(session);
+}
+
+uint64_t SessionCache::size() {
+  uint64_t size = 0;
+  for (Shard& shard : shards_) {
+    absl::MutexLock lock(&shard.mutex_);
+    size += shard.sessions_.size();
+  }
+  return size;
+}
+
+SessionCache::Shard& SessionCache::shard(absl::string_view id) {
+  // Session IDs are random, so their first byte spreads sessions evenly across the shards.
+  return shards_[id.empty() ? 0 : static_cast<uint8_t>(id[0]) % NumShards];
+}
+
+} // namespace Tls
+} // namespace TransportSockets
+} // namespace Extensions
+} // namespace Envoy
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <string>
+
+#include "common/common/non_copyable.h"
+#include "common/common/thread_annotations.h"
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/strings/string_view.h"
+#include "absl/synchronization/mutex.h"
+#include "openssl/ssl.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace TransportSockets {
+namespace Tls {
+
+/**
+ * A bounded cache of TLS sessions keyed by session ID, shared by all server contexts which enable
+ * it instead of the cache BoringSSL keeps in each SSL_CTX. Sessions are only resumed by a context
+ * whose session ID context matches the one the session was established with, so contexts for
+ * different certificates can safely share the cache.
+ *
+ * The cache is split into shards, each with its own lock and least recently used eviction, so that
+ * workers completing handshakes at the same time rarely contend.
+ */
+class SessionCache : NonCopyable {
+public:
+  static constexpr uint32_t DefaultCapacity = 20480;
+
+  /**
+   * @param capacity supplies the maximum number of sessions held by the cache.
+   */
+  explicit SessionCache(uint32_t capacity = DefaultCapacity);
+
+  /**
+   * Add a session, evicting the least recently used session of its shard if the shard is full.
+   * @param session supplies the session, which must have a session ID.
+   */
+  void insert(bssl::UniquePtr<SSL_SESSION> session);
+
+  /**
+   * Find a session by ID.
+   * @param id supplies the session ID.
+   * @return bssl::UniquePtr<SSL_SESSION> a new reference to the session, or nullptr if there is no
+   *         such session. BoringSSL checks whether the session has expired.
+   */
+  bssl::UniquePtr<SSL_SESSION> lookup(absl::string_view id);
+
+  /**
+   * @return the number of sessions currently held by the cache.
+   */
+  uint64_t size();
+
+private:
+  static constexpr uint32_t NumShards = 16;
+
+  struct Shard {
+    using SessionList = std::list<std::pair<std::string, bssl::UniquePtr<SSL_SESSION>>>;
+
+    absl::Mutex mutex_;
+    // Sessions ordered from the most to the least recently used.
+    SessionList sessions_ ABSL_GUARDED_BY(mutex_);
+    absl::flat_hash_map<std::string, SessionList::iterator> index_ ABSL_GUARDED_BY(mutex_);
+  };
+
+  Shard& shard(absl::string_view id);
+
+  const uint32_t shard_capacity_;
+  std::array<Shard, NumShards> shards_;
+};
+
+using SessionCacheSharedPtr = std::shared_ptr<SessionCache>;
+
+} // namespace Tls
+} // namespace TransportSockets
+} // namespace Extensions
+} // namespace Envoy
@@ -0,0 +1,119 @@
+#include "extensions/transport_sockets/tls/session_ticket_key_ring.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "common/common/assert.h"
+#include "common/common/lock_guard.h"
+
+#include "openssl/rand.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace TransportSockets {
+namespace Tls {
+namespace {
+
+constexpr uint32_t MaxKeys = Ssl::RotatedSessionTicketKeys::MaxKeys;
+
+} // namespace
+
+SessionTicketKeyRing::SessionTicketKeyRing(Ssl::SessionTicketKeyStorage* storage,
+                                           TimeSource& time_source)
+    : local_storage_(storage == nullptr ? std::make_unique<LocalStorage>() : nullptr),
+      storage_(storage == nullptr ? *local_storage_ : *storage), time_source_(time_source) {}
+
+bool SessionTicketKeyRing::encryptionKey(std::chrono::milliseconds rotation_interval, Key& key) {
+  {
+    absl::ReaderMutexLock lock(&snapshot_mutex_);
+    if (isFresh(snapshot_, rotation_interval)) {
+      key = snapshot_.keys_[0];
+      return false;
+    }
+  }
+
+  bool rotated = false;
+  Thread::LockGuard storage_lock(storage_.lock());
+  Ssl::RotatedSessionTicketKeys& keys = storage_.keys();
+  // Another thread or process may have rotated the keys since the snapshot was taken.
+  if (!isFresh(keys, rotation_interval)) {
+    rotate(keys);
+    storage_.generation().fetch_add(1, std::memory_order_release);
+    rotated = true;
+  }
+  absl::MutexLock lock(&snapshot_mutex_);
+  updateSnapshot();
+  key = snapshot_.keys_[0];
+  return rotated;
+}
+
+bool SessionTicketKeyRing::decryptionKey(const uint8_t* name, uint32_t decryption_keys, Key& key,
+                                         bool& newest) {
+  {
+    absl::ReaderMutexLock lock(&snapshot_mutex_);
+    if (findKey(snapshot_, name, decryption_keys, key, newest)) {
+      return true;
+    }
+    // Tickets with unknown key names, e.g. issued by another server or with long expired keys, fall
+    // back to a full handshake without contending on the shared lock unless the keys have changed.
+    if (storage_.generation().load(std::memory_order_acquire) == snapshot_generation_) {
+      return false;
+    }
+  }
+
+  // The ticket may have been encrypted with a key which another process generated, e.g. the other
+  // side of a hot restart, so look again at the current keys.
+  Thread::LockGuard storage_lock(storage_.lock());
+  absl::MutexLock lock(&snapshot_mutex_);
+  updateSnapshot();
+  return findKey(snapshot_, name, decryption_keys, key, newest);
+}
+
+void SessionTicketKeyRing::updateSnapshot() {
+  // Called with the storage lock held, so the keys and their generation are consistent.
+  snapshot_ = storage_.keys();
+  snapshot_generation_ = storage_.generation().load(std::memory_order_relaxed);
+}
+
+bool SessionTicketKeyRing::isFresh(const Ssl::RotatedSessionTicketKeys& keys,
+                                   std::chrono::milliseconds rotation_interval) const {
+  if (keys.num_keys_ == 0) {
+    return false;
+  }
+  const int64_t now = std::chrono::duration_cast<std::chrono::milliseconds>(
+                          time_source_.systemTime().time_since_epoch())
+                          .count();
+  return now - keys.keys_[0].created_at_ < rotation_interval.count();
+}
+
+bool SessionTicketKeyRing::findKey(const Ssl::RotatedSessionTicketKeys& keys, const uint8_t* name,
+                                   uint32_t decryption_keys, Key& key, bool& newest) {
+  const uint32_t num_keys = std::min({keys.num_keys_, decryption_keys, MaxKeys});
+  for (uint32_t i = 0; i < num_keys; i++) {
+    if (std::memcmp(keys.keys_[i].name_, name, sizeof(keys.keys_[i].name_)) == 0) {
+      key = keys.keys_[i];
+      newest = i == 0;
+      return true;
+    }
+  }
+  return false;
+}
+
+void SessionTicketKeyRing::rotate(Ssl::RotatedSessionTicketKeys& keys) {
+  const uint32_t num_keys = std::min(keys.num_keys_ + 1, MaxKeys);
+  std::memmove(&keys.keys_[1], &keys.keys_[0], (num_keys - 1) * sizeof(Key));
+
+  Key& key = keys.keys_[0];
+  RELEASE_ASSERT(RAND_bytes(key.name_, sizeof(key.name_)) == 1, "");
+  RELEASE_ASSERT(RAND_bytes(key.hmac_key_, sizeof(key.hmac_key_)) == 1, "");
+  RELEASE_ASSERT(RAND_bytes(key.aes_key_, sizeof(key.aes_key_)) == 1, "");
+  key.created_at_ = std::chrono::duration_cast<std::chrono::milliseconds>(
+                        time_source_.systemTime().time_since_epoch())
+                        .count();
+  keys.num_keys_ = num_keys;
+}
+
+} // namespace Tls
+} // namespace TransportSockets
+} // namespace Extensions
+} // namespace Envoy
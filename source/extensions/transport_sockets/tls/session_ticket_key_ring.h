@@ -0,0 +1,94 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+
+#include "envoy/common/time.h"
+#include "envoy/ssl/session_ticket_key_storage.h"
+
+#include "common/common/non_copyable.h"
+#include "common/common/thread.h"
+
+#include "absl/synchronization/mutex.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace TransportSockets {
+namespace Tls {
+
+/**
+ * Automatically rotated session ticket keys, shared by all server contexts which enable
+ * rotation. The authoritative keys live in a SessionTicketKeyStorage, which may be shared with
+ * other Envoy processes across a hot restart and is guarded by a process shared lock. Handshakes
+ * work on a local snapshot of the keys, so that the shared lock is only taken when a key is due
+ * for rotation or when a ticket carries a key name which the snapshot does not know about and the
+ * keys have changed since the snapshot was taken.
+ */
+class SessionTicketKeyRing : NonCopyable {
+public:
+  using Key = Ssl::RotatedSessionTicketKeys::Key;
+
+  /**
+   * @param storage supplies the storage for the keys, or nullptr to keep them in this process.
+   * @param time_source supplies the time source used to decide when keys are rotated.
+   */
+  SessionTicketKeyRing(Ssl::SessionTicketKeyStorage* storage, TimeSource& time_source);
+
+  /**
+   * Get the key which encrypts new session tickets, generating a new key first if the newest key
+   * is older than the rotation interval.
+   * @param rotation_interval supplies how long a key is used before it is rotated.
+   * @param key receives the key.
+   * @return bool true if this call generated a new key.
+   */
+  bool encryptionKey(std::chrono::milliseconds rotation_interval, Key& key);
+
+  /**
+   * Find the key which decrypts a session ticket.
+   * @param name supplies the key name carried by the ticket.
+   * @param decryption_keys supplies the number of most recent keys to consider.
+   * @param key receives the key if it is found.
+   * @param newest receives true if the key is the newest key, i.e. the ticket does not need to be
+   *        renewed.
+   * @return bool true if the key is found.
+   */
+  bool decryptionKey(const uint8_t* name, uint32_t decryption_keys, Key& key, bool& newest);
+
+private:
+  class LocalStorage : public Ssl::SessionTicketKeyStorage {
+  public:
+    // Ssl::SessionTicketKeyStorage
+    Thread::BasicLockable& lock() override { return lock_; }
+    Ssl::RotatedSessionTicketKeys& keys() override { return keys_; }
+    std::atomic<uint64_t>& generation() override { return generation_; }
+
+  private:
+    Thread::MutexBasicLockable lock_;
+    Ssl::RotatedSessionTicketKeys keys_{};
+    std::atomic<uint64_t> generation_{0};
+  };
+
+  bool isFresh(const Ssl::RotatedSessionTicketKeys& keys,
+               std::chrono::milliseconds rotation_interval) const;
+  static bool findKey(const Ssl::RotatedSessionTicketKeys& keys, const uint8_t* name,
+                      uint32_t decryption_keys, Key& key, bool& newest);
+  void rotate(Ssl::RotatedSessionTicketKeys& keys);
+  void updateSnapshot() ABSL_EXCLUSIVE_LOCKS_REQUIRED(snapshot_mutex_);
+
+  std::unique_ptr<LocalStorage> local_storage_;
+  Ssl::SessionTicketKeyStorage& storage_;
+  TimeSource& time_source_;
+  absl::Mutex snapshot_mutex_;
+  Ssl::RotatedSessionTicketKeys snapshot_ ABSL_GUARDED_BY(snapshot_mutex_){};
+  // Generation of the storage which snapshot_ was copied from.
+  uint64_t snapshot_generation_ ABSL_GUARDED_BY(snapshot_mutex_){0};
+};
+
+using SessionTicketKeyRingSharedPtr = std::shared_ptr<SessionTicketKeyRing>;
+
+} // namespace Tls
+} // namespace TransportSockets
+} // namespace Extensions
+} // namespace Envoy
@@ -1,5 +1,7 @@
 #include "extensions/transport_sockets/tls/ssl_socket.h"
 
+#include <cstring>
+
 #include "envoy/stats/scope.h"
 
 #include "common/common/assert.h"
@@ -7,6 +9,7 @@
 #include "common/common/hex.h"
 #include "common/http/headers.h"
 
+#include "extensions/transport_sockets/tls/kernel_tls.h"
 #include "extensions/transport_sockets/tls/utility.h"
 
 #include "absl/strings/str_replace.h"
@@ -50,6 +53,10 @@ SslSocket::SslSocket(Envoy::Ssl::ContextSharedPtr ctx, InitialState state,
   ssl_ = ssl.get();
   info_ = std::make_shared<SslSocketInfo>(std::move(ssl), ctx_);
 
+  // A write which is retried after SSL_ERROR_WANT_WRITE may find its data in a different place,
+  // @see Utility::recordData().
+  SSL_set_mode(ssl_, SSL_MODE_ACCEPT_MOVING_WRITE_BUFFER);
+
   if (state == InitialState::Client) {
     SSL_set_connect_state(ssl_);
   } else {
@@ -106,6 +113,10 @@ Network::IoResult SslSocket::doRead(Buffer::Instance& read_buffer) {
     }
   }
 
+  if (kernel_tls_rx_) {
+    return kernelTlsRead(read_buffer);
+  }
+
   bool keep_reading = true;
   bool end_stream = false;
   PostIoAction action = PostIoAction::KeepOpen;
@@ -154,6 +165,75 @@ Network::IoResult SslSocket::doRead(Buffer::Instance& read_buffer) {
 
   ENVOY_CONN_LOG(trace, "ssl read {} bytes", callbacks_->connection(), bytes_read);
 
+  if (action == PostIoAction::KeepOpen && !end_stream) {
+    maybeEnableKernelTlsRx();
+  }
+  return {action, bytes_read, end_stream};
+}
+
+Network::IoResult SslSocket::kernelTlsRead(Buffer::Instance& read_buffer) {
+  PostIoAction action = PostIoAction::KeepOpen;
+  uint64_t bytes_read = 0;
+  bool end_stream = false;
+  while (true) {
+    Buffer::RawSlice slices[2];
+    const uint64_t num_slices = read_buffer.reserve(16384, slices, 2);
+    iovec iov[2];
+    for (uint64_t i = 0; i < num_slices; i++) {
+      iov[i].iov_base = slices[i].mem_;
+      iov[i].iov_len = slices[i].len_;
+    }
+    uint8_t record_type;
+    const Api::SysCallSizeResult result =
+        KernelTls::readRecord(callbacks_->ioHandle().fd(), iov, num_slices, record_type);
+    ENVOY_CONN_LOG(trace, "kernel tls read returns: {}", callbacks_->connection(), result.rc_);
+    if (result.rc_ < 0) {
+      if (result.errno_ != EAGAIN) {
+        // The kernel fails reads of records which do not decrypt, among other errors.
+        failure_reason_ = absl::StrCat("TLS error: kernel read failed: ", strerror(result.errno_));
+        ctx_->stats().connection_error_.inc();
+        action = PostIoAction::Close;
+      }
+      break;
+    }
+    if (result.rc_ == 0) {
+      // The peer closed the connection without a close_notify alert, which BoringSSL also treats
+      // as an error.
+      action = PostIoAction::Close;
+      break;
+    }
+    if (record_type != KernelTls::RecordTypeApplicationData) {
+      const uint8_t* record = static_cast<const uint8_t*>(slices[0].mem_);
+      if (record_type == KernelTls::RecordTypeAlert && result.rc_ >= 2 &&
+          slices[0].len_ >= 2 && record[1] == KernelTls::AlertCloseNotify) {
+        end_stream = true;
+      } else {
+        // Other alerts are fatal, and handshake records after the handshake would be a
+        // renegotiation, which isn't supported.
+        failure_reason_ =
+            absl::StrCat("TLS error: unexpected record type ", static_cast<int>(record_type));
+        ctx_->stats().connection_error_.inc();
+        action = PostIoAction::Close;
+      }
+      break;
+    }
+
+    uint64_t remaining = result.rc_;
+    uint64_t slices_to_commit = 0;
+    for (uint64_t i = 0; i < num_slices && remaining > 0; i++) {
+      slices[i].len_ = std::min<uint64_t>(slices[i].len_, remaining);
+      remaining -= slices[i].len_;
+      slices_to_commit++;
+    }
+    read_buffer.commit(slices, slices_to_commit);
+    bytes_read += result.rc_;
+    if (callbacks_->shouldDrainReadBuffer()) {
+      callbacks_->setReadBufferReady();
+      break;
+    }
+  }
+
+  ENVOY_CONN_LOG(trace, "kernel tls read {} bytes", callbacks_->connection(), bytes_read);
   return {action, bytes_read, end_stream};
 }
 
@@ -176,6 +256,7 @@ PostIoAction SslSocket::doHandshake() {
     ENVOY_CONN_LOG(debug, "handshake complete", callbacks_->connection());
     state_ = SocketState::HandshakeComplete;
     ctx_->logHandshake(ssl_);
+    enableKernelTls();
     callbacks_->raiseEvent(Network::ConnectionEvent::Connected);
 
     // It's possible that we closed during the handshake callback.
@@ -202,6 +283,35 @@ PostIoAction SslSocket::doHandshake() {
   }
 }
 
+void SslSocket::enableKernelTls() {
+  if (!ctx_->kernelTlsOffload()) {
+    return;
+  }
+  const os_fd_t fd = callbacks_->ioHandle().fd();
+  if (!KernelTls::supported(ssl_) || !KernelTls::attach(fd) || !KernelTls::enableTx(ssl_, fd)) {
+    ENVOY_CONN_LOG(debug, "kernel tls offload unavailable", callbacks_->connection());
+    ctx_->stats().kernel_tls_unsupported_.inc();
+    return;
+  }
+  ENVOY_CONN_LOG(debug, "kernel tls transmit offload enabled", callbacks_->connection());
+  ctx_->stats().kernel_tls_offloaded_.inc();
+  kernel_tls_tx_ = true;
+  kernel_tls_rx_pending_ = true;
+  maybeEnableKernelTlsRx();
+}
+
+void SslSocket::maybeEnableKernelTlsRx() {
+  // Any data BoringSSL has already read from the socket, including partial records, must still be
+  // decrypted by it, so receive offload is only enabled once BoringSSL's read buffer is empty.
+  if (!kernel_tls_rx_pending_ || SSL_has_pending(ssl_)) {
+    return;
+  }
+  kernel_tls_rx_pending_ = false;
+  kernel_tls_rx_ = KernelTls::enableRx(ssl_, callbacks_->ioHandle().fd());
+  ENVOY_CONN_LOG(debug, "kernel tls receive offload {}", callbacks_->connection(),
+                 kernel_tls_rx_ ? "enabled" : "unavailable");
+}
+
 void SslSocket::drainErrorQueue() {
   bool saw_error = false;
   bool saw_counted_error = false;
@@ -229,6 +339,13 @@ void SslSocket::drainErrorQueue() {
   }
 }
 
+uint64_t SslSocket::maxRecordSize() const {
+  // Small records can be decrypted as soon as their first TCP segments arrive, which matters while
+  // the congestion window is small. Full size records have the lowest overhead after that.
+  return bytes_written_ < ctx_->initialRecordBytes() ? ctx_->initialRecordSize()
+                                                     : Utility::MaxRecordSize;
+}
+
 Network::IoResult SslSocket::doWrite(Buffer::Instance& write_buffer, bool end_stream) {
   ASSERT(state_ != SocketState::ShutdownSent || write_buffer.length() == 0);
   if (state_ != SocketState::HandshakeComplete && state_ != SocketState::ShutdownSent) {
@@ -238,12 +355,16 @@ Network::IoResult SslSocket::doWrite(Buffer::Instance& write_buffer, bool end_st
     }
   }
 
+  if (kernel_tls_tx_) {
+    return kernelTlsWrite(write_buffer, end_stream);
+  }
+
   uint64_t bytes_to_write;
   if (bytes_to_retry_) {
     bytes_to_write = bytes_to_retry_;
     bytes_to_retry_ = 0;
   } else {
-    bytes_to_write = std::min(write_buffer.length(), static_cast<uint64_t>(16384));
+    bytes_to_write = Utility::nextRecordSize(write_buffer, maxRecordSize());
   }
 
   uint64_t total_bytes_written = 0;
@@ -253,15 +374,16 @@ Network::IoResult SslSocket::doWrite(Buffer::Instance& write_buffer, bool end_st
 
     // SSL_write() requires that if a previous call returns SSL_ERROR_WANT_WRITE, we need to call
     // it again with the same parameters. This is done by tracking last write size, but not write
-    // data, since linearize() will return the same undrained data anyway.
+    // data, since Utility::recordData() will return the same undrained data anyway.
     ASSERT(bytes_to_write <= write_buffer.length());
-    int rc = SSL_write(ssl_, write_buffer.linearize(bytes_to_write), bytes_to_write);
+    int rc = SSL_write(ssl_, Utility::recordData(write_buffer, bytes_to_write), bytes_to_write);
     ENVOY_CONN_LOG(trace, "ssl write returns: {}", callbacks_->connection(), rc);
     if (rc > 0) {
       ASSERT(rc == static_cast<int>(bytes_to_write));
       total_bytes_written += rc;
+      bytes_written_ += rc;
       write_buffer.drain(rc);
-      bytes_to_write = std::min(write_buffer.length(), static_cast<uint64_t>(16384));
+      bytes_to_write = Utility::nextRecordSize(write_buffer, maxRecordSize());
     } else {
       int err = SSL_get_error(ssl_, rc);
       switch (err) {
@@ -286,6 +408,30 @@ Network::IoResult SslSocket::doWrite(Buffer::Instance& write_buffer, bool end_st
   return {PostIoAction::KeepOpen, total_bytes_written, false};
 }
 
+Network::IoResult SslSocket::kernelTlsWrite(Buffer::Instance& write_buffer, bool end_stream) {
+  // The kernel frames and encrypts whatever is written to the socket, so the buffer is written
+  // directly from its slices.
+  uint64_t total_bytes_written = 0;
+  while (write_buffer.length() > 0) {
+    Api::IoCallUint64Result result = write_buffer.write(callbacks_->ioHandle());
+    if (!result.ok()) {
+      ENVOY_CONN_LOG(trace, "kernel tls write error: {}", callbacks_->connection(),
+                     result.err_->getErrorDetails());
+      if (result.err_->getErrorCode() == Api::IoError::IoErrorCode::Again) {
+        break;
+      }
+      return {PostIoAction::Close, total_bytes_written, false};
+    }
+    ENVOY_CONN_LOG(trace, "kernel tls write returns: {}", callbacks_->connection(), result.rc_);
+    total_bytes_written += result.rc_;
+  }
+
+  if (write_buffer.length() == 0 && end_stream) {
+    shutdownSsl();
+  }
+  return {PostIoAction::KeepOpen, total_bytes_written, false};
+}
+
 void SslSocket::onConnected() { ASSERT(state_ == SocketState::PreHandshake); }
 
 Ssl::ConnectionInfoConstSharedPtr SslSocket::ssl() const { return info_; }
@@ -294,9 +440,16 @@ void SslSocket::shutdownSsl() {
   ASSERT(state_ != SocketState::PreHandshake);
   if (state_ != SocketState::ShutdownSent &&
       callbacks_->connection().state() != Network::Connection::State::Closed) {
-    int rc = SSL_shutdown(ssl_);
-    ENVOY_CONN_LOG(debug, "SSL shutdown: rc={}", callbacks_->connection(), rc);
-    drainErrorQueue();
+    if (kernel_tls_tx_) {
+      // BoringSSL no longer knows the write sequence number, so the alert goes through the kernel.
+      const Api::SysCallSizeResult result = KernelTls::sendAlert(
+          callbacks_->ioHandle().fd(), KernelTls::AlertLevelWarning, KernelTls::AlertCloseNotify);
+      ENVOY_CONN_LOG(debug, "kernel tls shutdown: rc={}", callbacks_->connection(), result.rc_);
+    } else {
+      int rc = SSL_shutdown(ssl_);
+      ENVOY_CONN_LOG(debug, "SSL shutdown: rc={}", callbacks_->connection(), rc);
+      drainErrorQueue();
+    }
     state_ = SocketState::ShutdownSent;
   }
 }
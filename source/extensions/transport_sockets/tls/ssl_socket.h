@@ -128,6 +128,11 @@ private:
   ReadResult sslReadIntoSlice(Buffer::RawSlice& slice);
 
   Network::PostIoAction doHandshake();
+  uint64_t maxRecordSize() const;
+  void enableKernelTls();
+  void maybeEnableKernelTlsRx();
+  Network::IoResult kernelTlsRead(Buffer::Instance& read_buffer);
+  Network::IoResult kernelTlsWrite(Buffer::Instance& write_buffer, bool end_stream);
   void drainErrorQueue();
   void shutdownSsl();
   bool isThreadSafe() const {
@@ -138,8 +143,15 @@ private:
   Network::TransportSocketCallbacks* callbacks_{};
   ContextImplSharedPtr ctx_;
   uint64_t bytes_to_retry_{};
+  // Plaintext bytes written so far, which drive the record sizing policy.
+  uint64_t bytes_written_{};
   std::string failure_reason_;
   SocketState state_;
+  // Whether records are encrypted and decrypted by the kernel, @see KernelTls. Receive offload
+  // waits until BoringSSL has no data of its own left to decrypt.
+  bool kernel_tls_tx_{};
+  bool kernel_tls_rx_{};
+  bool kernel_tls_rx_pending_{};
 
   SSL* ssl_;
   Ssl::ConnectionInfoConstSharedPtr info_;
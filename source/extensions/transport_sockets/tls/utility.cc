@@ -1,5 +1,7 @@
 #include "extensions/transport_sockets/tls/utility.h"
 
+#include <algorithm>
+
 #include "common/common/assert.h"
 #include "common/network/address_impl.h"
 
@@ -217,6 +219,32 @@ absl::optional<std::string> Utility::getLastCryptoError() {
   return absl::nullopt;
 }
 
+uint64_t Utility::nextRecordSize(const Buffer::Instance& buffer, uint64_t max_record_size) {
+  ASSERT(max_record_size <= MaxRecordSize);
+  const uint64_t record_size = std::min(buffer.length(), max_record_size);
+  if (record_size == 0) {
+    return 0;
+  }
+  const uint64_t front_slice_size = buffer.getRawSlices(1)[0].len_;
+  if (front_slice_size < record_size && front_slice_size >= MinSliceRecordSize) {
+    return front_slice_size;
+  }
+  return record_size;
+}
+
+const void* Utility::recordData(const Buffer::Instance& buffer, uint64_t size) {
+  ASSERT(size > 0 && size <= MaxRecordSize && size <= buffer.length());
+  const Buffer::RawSlice front_slice = buffer.getRawSlices(1)[0];
+  if (front_slice.len_ >= size) {
+    return front_slice.mem_;
+  }
+  // SSL_write() encrypts the record into its own buffer before returning, so the scratch record
+  // can be shared by all connections on a thread.
+  static thread_local uint8_t record[MaxRecordSize];
+  buffer.copyOut(0, size, record);
+  return record;
+}
+
 } // namespace Tls
 } // namespace TransportSockets
 } // namespace Extensions
@@ -1,8 +1,11 @@
 #pragma once
 
+#include <cstdint>
 #include <string>
 #include <vector>
 
+#include "envoy/buffer/buffer.h"
+
 #include "common/common/utility.h"
 
 #include "absl/types/optional.h"
@@ -90,6 +93,34 @@ SystemTime getExpirationTime(const X509& cert);
  */
 absl::optional<std::string> getLastCryptoError();
 
+// The maximum plaintext size of a TLS record.
+constexpr uint64_t MaxRecordSize = 16384;
+
+// The front slice of a write buffer is written as a record of its own rather than copied to join
+// it with the next slice if it holds at least this many bytes. Records this large have a framing
+// and encryption overhead of less than 1%, which is cheaper than copying the slice.
+constexpr uint64_t MinSliceRecordSize = 4096;
+
+/**
+ * Determines the plaintext size of the next record to write from a buffer. Records are cut at the
+ * end of the buffer's front slice when that slice is large enough to be written without a copy.
+ * @param buffer supplies the data to write.
+ * @param max_record_size supplies the largest record to write, at most MaxRecordSize.
+ * @return uint64_t the size of the next record, which is 0 only if the buffer is empty.
+ */
+uint64_t nextRecordSize(const Buffer::Instance& buffer, uint64_t max_record_size);
+
+/**
+ * Returns contiguous memory holding the first bytes of a buffer, for use with SSL_write(). Unlike
+ * Buffer::Instance::linearize() this never modifies the buffer: a record within the front slice is
+ * returned in place, and other records are copied into a per-thread scratch record which stays
+ * valid until the next call on the same thread.
+ * @param buffer supplies the data to write.
+ * @param size supplies the size of the record, at most MaxRecordSize and the buffer's length.
+ * @return const void* the record.
+ */
+const void* recordData(const Buffer::Instance& buffer, uint64_t size);
+
 } // namespace Utility
 } // namespace Tls
 } // namespace TransportSockets
@@ -1,5 +1,7 @@
 #include "server/filter_chain_manager_impl.h"
 
+#include <algorithm>
+
 #include "envoy/config/listener/v3/listener_components.pb.h"
 
 #include "common/common/cleanup.h"
@@ -31,7 +33,9 @@ PerFilterChainFactoryContextImpl::PerFilterChainFactoryContextImpl(
     : parent_context_(parent_context), init_manager_(init_manager) {}
 
 bool PerFilterChainFactoryContextImpl::drainClose() const {
-  return is_draining_.load() || parent_context_.drainDecision().drainClose();
+  const Network::DrainDecision* filter_chain_drain_decision = filter_chain_drain_decision_.load();
+  return (filter_chain_drain_decision != nullptr && filter_chain_drain_decision->drainClose()) ||
+         parent_context_.drainDecision().drainClose();
 }
 
 Network::DrainDecision& PerFilterChainFactoryContextImpl::drainDecision() { return *this; }
@@ -223,10 +227,7 @@ void FilterChainManagerImpl::addFilterChainForDestinationPorts(
     const std::vector<std::string>& source_ips,
     const absl::Span<const Protobuf::uint32> source_ports,
     const Network::FilterChainSharedPtr& filter_chain) {
-  if (destination_ports_map.find(destination_port) == destination_ports_map.end()) {
-    destination_ports_map[destination_port] =
-        std::make_pair<DestinationIPsMap, DestinationIPsTriePtr>(DestinationIPsMap{}, nullptr);
-  }
+  // The trie of the port is built by convertIPsToTries() once all filter chains are added.
   addFilterChainForDestinationIPs(destination_ports_map[destination_port].first, destination_ips,
                                   server_names, transport_protocol, application_protocols,
                                   source_type, source_ips, source_ports, filter_chain);
@@ -354,10 +355,8 @@ void FilterChainManagerImpl::addFilterChainForSourcePorts(
 
 namespace {
 
-// Template function for creating a CIDR list entry for either source or destination address.
-template <class T>
-std::pair<T, std::vector<Network::Address::CidrRange>> makeCidrListEntry(const std::string& cidr,
-                                                                         const T& data) {
+// Create the CIDR ranges for either a source or a destination address.
+std::vector<Network::Address::CidrRange> makeCidrRanges(const std::string& cidr) {
   std::vector<Network::Address::CidrRange> subnets;
   if (cidr == EMPTY_STRING) {
     if (Network::Address::ipFamilySupported(AF_INET)) {
@@ -371,7 +370,7 @@ std::pair<T, std::vector<Network::Address::CidrRange>> makeCidrListEntry(const s
   } else {
     subnets.push_back(Network::Address::CidrRange::create(cidr));
   }
-  return std::make_pair<T, std::vector<Network::Address::CidrRange>>(T(data), std::move(subnets));
+  return subnets;
 }
 
 }; // namespace
@@ -384,14 +383,14 @@ FilterChainManagerImpl::findFilterChain(const Network::ConnectionSocket& socket)
   if (address->type() == Network::Address::Type::Ip) {
     const auto port_match = destination_ports_map_.find(address->ip()->port());
     if (port_match != destination_ports_map_.end()) {
-      return findFilterChainForDestinationIP(*port_match->second.second, socket);
+      return findFilterChainForDestinationIP(port_match->second.second, socket);
     }
   }
 
   // Match on catch-all port 0.
   const auto port_match = destination_ports_map_.find(0);
   if (port_match != destination_ports_map_.end()) {
-    return findFilterChainForDestinationIP(*port_match->second.second, socket);
+    return findFilterChainForDestinationIP(port_match->second.second, socket);
   }
 
   return nullptr;
@@ -405,10 +404,9 @@ const Network::FilterChain* FilterChainManagerImpl::findFilterChainForDestinatio
   }
 
   // Match on both: exact IP and wider CIDR ranges using LcTrie.
-  const auto& data = destination_ips_trie.getData(address);
-  if (!data.empty()) {
-    ASSERT(data.size() == 1);
-    return findFilterChainForServerName(*data.back(), socket);
+  const ServerNamesMapSharedPtr* server_names_map = destination_ips_trie.match(address);
+  if (server_names_map != nullptr) {
+    return findFilterChainForServerName(**server_names_map, socket);
   }
 
   return nullptr;
@@ -416,7 +414,7 @@ const Network::FilterChain* FilterChainManagerImpl::findFilterChainForDestinatio
 
 const Network::FilterChain* FilterChainManagerImpl::findFilterChainForServerName(
     const ServerNamesMap& server_names_map, const Network::ConnectionSocket& socket) const {
-  const std::string server_name(socket.requestedServerName());
+  const absl::string_view server_name = socket.requestedServerName();
 
   // Match on exact server name, i.e. "www.example.com" for "www.example.com".
   const auto server_name_exact_match = server_names_map.find(server_name);
@@ -427,7 +425,7 @@ const Network::FilterChain* FilterChainManagerImpl::findFilterChainForServerName
   // Match on all wildcard domains, i.e. ".example.com" and ".com" for "www.example.com".
   size_t pos = server_name.find('.', 1);
   while (pos < server_name.size() - 1 && pos != std::string::npos) {
-    const std::string wildcard = server_name.substr(pos);
+    const absl::string_view wildcard = server_name.substr(pos);
     const auto server_name_wildcard_match = server_names_map.find(wildcard);
     if (server_name_wildcard_match != server_names_map.end()) {
       return findFilterChainForTransportProtocol(server_name_wildcard_match->second, socket);
@@ -447,7 +445,7 @@ const Network::FilterChain* FilterChainManagerImpl::findFilterChainForServerName
 const Network::FilterChain* FilterChainManagerImpl::findFilterChainForTransportProtocol(
     const TransportProtocolsMap& transport_protocols_map,
     const Network::ConnectionSocket& socket) const {
-  const std::string transport_protocol(socket.detectedTransportProtocol());
+  const absl::string_view transport_protocol = socket.detectedTransportProtocol();
 
   // Match on exact transport protocol, e.g. "tls".
   const auto transport_protocol_match = transport_protocols_map.find(transport_protocol);
@@ -501,18 +499,18 @@ const Network::FilterChain* FilterChainManagerImpl::findFilterChainForSourceType
 
   if (is_local_connection) {
     if (!filter_chain_local.first.empty()) {
-      return findFilterChainForSourceIpAndPort(*filter_chain_local.second, socket);
+      return findFilterChainForSourceIpAndPort(filter_chain_local.second, socket);
     }
   } else {
     if (!filter_chain_external.first.empty()) {
-      return findFilterChainForSourceIpAndPort(*filter_chain_external.second, socket);
+      return findFilterChainForSourceIpAndPort(filter_chain_external.second, socket);
     }
   }
 
   const auto& filter_chain_any = source_types[envoy::config::listener::v3::FilterChainMatch::ANY];
 
   if (!filter_chain_any.first.empty()) {
-    return findFilterChainForSourceIpAndPort(*filter_chain_any.second, socket);
+    return findFilterChainForSourceIpAndPort(filter_chain_any.second, socket);
   } else {
     return nullptr;
   }
@@ -526,13 +524,12 @@ const Network::FilterChain* FilterChainManagerImpl::findFilterChainForSourceIpAn
   }
 
   // Match on both: exact IP and wider CIDR ranges using LcTrie.
-  const auto& data = source_ips_trie.getData(address);
-  if (data.empty()) {
+  const SourcePortsMapSharedPtr* source_ports_map_ptr = source_ips_trie.match(address);
+  if (source_ports_map_ptr == nullptr) {
     return nullptr;
   }
 
-  ASSERT(data.size() == 1);
-  const auto& source_ports_map = *data.back();
+  const auto& source_ports_map = **source_ports_map_ptr;
   const uint32_t source_port = address->ip()->port();
   const auto port_match = source_ports_map.find(source_port);
 
@@ -553,43 +550,74 @@ const Network::FilterChain* FilterChainManagerImpl::findFilterChainForSourceIpAn
 }
 
 void FilterChainManagerImpl::convertIPsToTries() {
+  // Listeners with many filter chains typically configure the same CIDR ranges, most often none,
+  // for most of them, so that only a few distinct tries need to be built.
+  CidrRangesTrieCache cache;
   for (auto& port : destination_ports_map_) {
-    // These variables are used as we build up the destination CIDRs used for the trie.
     auto& destination_ips_pair = port.second;
     auto& destination_ips_map = destination_ips_pair.first;
-    std::vector<std::pair<ServerNamesMapSharedPtr, std::vector<Network::Address::CidrRange>>>
-        destination_ips_list;
-    destination_ips_list.reserve(destination_ips_map.size());
+    convertIPsToTrie(destination_ips_map, destination_ips_pair.second, cache);
 
+    // We need to get access to all of the source IP strings so that we can convert them into
+    // a trie like we did for the destination IPs above.
     for (const auto& entry : destination_ips_map) {
-      destination_ips_list.push_back(makeCidrListEntry(entry.first, entry.second));
-
-      // This hugely nested for loop greatly pains me, but I'm not sure how to make it better.
-      // We need to get access to all of the source IP strings so that we can convert them into
-      // a trie like we did for the destination IPs above.
       for (auto& server_names_entry : *entry.second) {
         for (auto& transport_protocols_entry : server_names_entry.second) {
           for (auto& application_protocols_entry : transport_protocols_entry.second) {
             for (auto& source_array_entry : application_protocols_entry.second) {
-              auto& source_ips_map = source_array_entry.first;
-              std::vector<
-                  std::pair<SourcePortsMapSharedPtr, std::vector<Network::Address::CidrRange>>>
-                  source_ips_list;
-              source_ips_list.reserve(source_ips_map.size());
-
-              for (auto& source_ip : source_ips_map) {
-                source_ips_list.push_back(makeCidrListEntry(source_ip.first, source_ip.second));
+              // Source types without filter chains are never matched against.
+              if (!source_array_entry.first.empty()) {
+                convertIPsToTrie(source_array_entry.first, source_array_entry.second, cache);
               }
-
-              source_array_entry.second = std::make_unique<SourceIPsTrie>(source_ips_list, true);
             }
           }
         }
       }
     }
+  }
+}
+
+template <class T>
+void FilterChainManagerImpl::convertIPsToTrie(const absl::flat_hash_map<std::string, T>& ips_map,
+                                              CidrRangesMatcher<T>& matcher,
+                                              CidrRangesTrieCache& cache) {
+  std::vector<std::string> cidrs;
+  cidrs.reserve(ips_map.size());
+  for (const auto& entry : ips_map) {
+    cidrs.push_back(entry.first);
+  }
+  std::sort(cidrs.begin(), cidrs.end());
+
+  matcher.entries_.clear();
+  matcher.entries_.reserve(cidrs.size());
+  for (const auto& cidr : cidrs) {
+    matcher.entries_.push_back(ips_map.at(cidr));
+  }
+
+  if (cidrs.size() == 1 && cidrs[0] == EMPTY_STRING && catchAllMatchesAnyAddress()) {
+    matcher.trie_ = nullptr;
+    return;
+  }
+
+  CidrRangesTrieConstSharedPtr& trie = cache[cidrs];
+  if (trie == nullptr) {
+    std::vector<std::pair<uint32_t, std::vector<Network::Address::CidrRange>>> cidr_ranges;
+    cidr_ranges.reserve(cidrs.size());
+    for (uint32_t i = 0; i < cidrs.size(); i++) {
+      cidr_ranges.emplace_back(i, makeCidrRanges(cidrs[i]));
+    }
+    trie = std::make_shared<const CidrRangesTrie>(cidr_ranges, true);
+  }
+  matcher.trie_ = trie;
+}
 
-    destination_ips_pair.second = std::make_unique<DestinationIPsTrie>(destination_ips_list, true);
+bool FilterChainManagerImpl::catchAllMatchesAnyAddress() {
+  // The catch-all ranges only cover the supported IP families, but no connection can have an
+  // address of an unsupported family, except for the fake IPv4 address of UDS connections.
+  if (!catch_all_matches_any_address_.has_value()) {
+    catch_all_matches_any_address_ = Network::Address::ipFamilySupported(AF_INET);
   }
+  return catch_all_matches_any_address_.value();
 }
 
 std::shared_ptr<Network::DrainableFilterChain> FilterChainManagerImpl::findExistingFilterChain(
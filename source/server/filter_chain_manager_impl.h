@@ -3,6 +3,8 @@
 #include <atomic>
 #include <cstdint>
 #include <memory>
+#include <string>
+#include <vector>
 
 #include "envoy/config/listener/v3/listener_components.pb.h"
 #include "envoy/network/drain_decision.h"
@@ -19,6 +21,7 @@
 #include "server/filter_chain_factory_context_callback.h"
 
 #include "absl/container/flat_hash_map.h"
+#include "absl/types/optional.h"
 
 namespace Envoy {
 namespace Server {
@@ -77,12 +80,15 @@ public:
   Configuration::TransportSocketFactoryContext& getTransportSocketFactoryContext() const override;
   Stats::Scope& listenerScope() override;
 
-  void startDraining() override { is_draining_.store(true); }
+  void startDraining(const Network::DrainDecision& drain_decision) override {
+    filter_chain_drain_decision_.store(&drain_decision);
+  }
 
 private:
   Configuration::FactoryContext& parent_context_;
   Init::Manager& init_manager_;
-  std::atomic<bool> is_draining_{false};
+  // Set once the filter chain is removed or changed by a listener update.
+  std::atomic<const Network::DrainDecision*> filter_chain_drain_decision_{nullptr};
 };
 
 class FilterChainImpl : public Network::DrainableFilterChain {
@@ -99,7 +105,9 @@ public:
   const std::vector<Network::FilterFactoryCb>& networkFilterFactories() const override {
     return filters_factory_;
   }
-  void startDraining() override { factory_context_->startDraining(); }
+  void startDraining(const Network::DrainDecision& drain_decision) override {
+    factory_context_->startDraining(drain_decision);
+  }
 
   void setFilterChainFactoryContext(
       Configuration::FilterChainFactoryContextPtr filter_chain_factory_context) {
@@ -198,13 +206,49 @@ public:
   const FcContextMap& filterChainsByMessage() const { return fc_contexts_; }
 
 private:
+  using CidrRangesTrie = Network::LcTrie::LcTrie<uint32_t>;
+  using CidrRangesTrieConstSharedPtr = std::shared_ptr<const CidrRangesTrie>;
+  // Tries built while converting the IPs of the filter chains, keyed by their sorted CIDR ranges.
+  using CidrRangesTrieCache =
+      absl::flat_hash_map<std::vector<std::string>, CidrRangesTrieConstSharedPtr>;
+
+  /**
+   * Matches the address of a connection against the CIDR ranges of a branch, the most specific
+   * range winning. The trie maps the ranges to indexes into the entries of the branch rather than
+   * to the entries themselves, so that all the branches configured with the same ranges, e.g. the
+   * destination ports of a listener which doesn't match on destination IPs, share one trie.
+   */
+  template <class T> struct CidrRangesMatcher {
+    const T* match(const Network::Address::InstanceConstSharedPtr& address) const {
+      if (trie_ == nullptr) {
+        // The branch only has the catch-all range.
+        return entries_.empty() ? nullptr : &entries_[0];
+      }
+      const std::vector<uint32_t>& indexes = trie_->getData(address);
+      if (indexes.empty()) {
+        return nullptr;
+      }
+      ASSERT(indexes.size() == 1);
+      return &entries_[indexes.back()];
+    }
+
+    // Ordered like the sorted CIDR ranges the trie was built from.
+    std::vector<T> entries_;
+    // Null if the only range is the catch-all one, which needs no lookup.
+    CidrRangesTrieConstSharedPtr trie_;
+  };
+
   void convertIPsToTries();
+  template <class T>
+  void convertIPsToTrie(const absl::flat_hash_map<std::string, T>& ips_map,
+                        CidrRangesMatcher<T>& matcher, CidrRangesTrieCache& cache);
+  bool catchAllMatchesAnyAddress();
+
   using SourcePortsMap = absl::flat_hash_map<uint16_t, Network::FilterChainSharedPtr>;
   using SourcePortsMapSharedPtr = std::shared_ptr<SourcePortsMap>;
   using SourceIPsMap = absl::flat_hash_map<std::string, SourcePortsMapSharedPtr>;
-  using SourceIPsTrie = Network::LcTrie::LcTrie<SourcePortsMapSharedPtr>;
-  using SourceIPsTriePtr = std::unique_ptr<SourceIPsTrie>;
-  using SourceTypesArray = std::array<std::pair<SourceIPsMap, SourceIPsTriePtr>, 3>;
+  using SourceIPsTrie = CidrRangesMatcher<SourcePortsMapSharedPtr>;
+  using SourceTypesArray = std::array<std::pair<SourceIPsMap, SourceIPsTrie>, 3>;
   using ApplicationProtocolsMap = absl::flat_hash_map<std::string, SourceTypesArray>;
   using TransportProtocolsMap = absl::flat_hash_map<std::string, ApplicationProtocolsMap>;
   // Both exact server names and wildcard domains are part of the same map, in which wildcard
@@ -213,10 +257,9 @@ private:
   using ServerNamesMap = absl::flat_hash_map<std::string, TransportProtocolsMap>;
   using ServerNamesMapSharedPtr = std::shared_ptr<ServerNamesMap>;
   using DestinationIPsMap = absl::flat_hash_map<std::string, ServerNamesMapSharedPtr>;
-  using DestinationIPsTrie = Network::LcTrie::LcTrie<ServerNamesMapSharedPtr>;
-  using DestinationIPsTriePtr = std::unique_ptr<DestinationIPsTrie>;
+  using DestinationIPsTrie = CidrRangesMatcher<ServerNamesMapSharedPtr>;
   using DestinationPortsMap =
-      absl::flat_hash_map<uint16_t, std::pair<DestinationIPsMap, DestinationIPsTriePtr>>;
+      absl::flat_hash_map<uint16_t, std::pair<DestinationIPsMap, DestinationIPsTrie>>;
 
   void addFilterChainForDestinationPorts(
       DestinationPortsMap& destination_ports_map, uint16_t destination_port,
@@ -307,6 +350,9 @@ private:
   // Caution: only during warm up could the optional have value.
   absl::optional<const FilterChainManagerImpl*> origin_{nullptr};
 
+  // Whether a connection of any address matches the catch-all CIDR ranges, computed on first use.
+  absl::optional<bool> catch_all_matches_any_address_;
+
   // For FilterChainFactoryContextCreator
   // init manager owned by the corresponding listener. The reference is valid when building the
   // filter chain.
@@ -20,6 +20,7 @@
 #include "common/common/lock_guard.h"
 
 #include "absl/strings/string_view.h"
+#include "openssl/mem.h"
 
 namespace Envoy {
 namespace Server {
@@ -62,6 +63,7 @@ SharedMemory* attachSharedMemory(const Options& options) {
     shmem->version_ = HOT_RESTART_VERSION;
     initializeMutex(shmem->log_lock_);
     initializeMutex(shmem->access_log_lock_);
+    initializeMutex(shmem->session_ticket_keys_lock_);
   } else {
     RELEASE_ASSERT(shmem->size_ == sizeof(SharedMemory),
                    "Hot restart SharedMemory size mismatch! You must have hot restarted into a "
@@ -95,11 +97,27 @@ HotRestartImpl::HotRestartImpl(const Options& options)
     : as_child_(HotRestartingChild(options.baseId(), options.restartEpoch())),
       as_parent_(HotRestartingParent(options.baseId(), options.restartEpoch())),
       shmem_(attachSharedMemory(options)), log_lock_(shmem_->log_lock_),
-      access_log_lock_(shmem_->access_log_lock_) {
+      access_log_lock_(shmem_->access_log_lock_), session_ticket_key_storage_(*shmem_) {
   // If our parent ever goes away just terminate us so that we don't have to rely on ops/launching
   // logic killing the entire process tree. We should never exist without our parent.
   int rc = prctl(PR_SET_PDEATHSIG, SIGTERM);
   RELEASE_ASSERT(rc != -1, "");
+  shmem_->attached_processes_++;
+}
+
+HotRestartImpl::~HotRestartImpl() {
+  // A child attaches before it asks its parent to terminate, so the count only drops to zero when
+  // the last Envoy process using the segment exits. If that process crashes instead, the keys stay
+  // in the segment until the next epoch 0 process unlinks it.
+  if (--shmem_->attached_processes_ == 0) {
+    session_ticket_key_storage_.clear();
+  }
+}
+
+void SharedSessionTicketKeyStorage::clear() {
+  Thread::LockGuard lock(lock_);
+  OPENSSL_cleanse(&keys_, sizeof(keys_));
+  generation_.fetch_add(1, std::memory_order_release);
 }
 
 void HotRestartImpl::drainParentListeners() {
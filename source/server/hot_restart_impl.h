@@ -10,6 +10,7 @@
 
 #include "envoy/common/platform.h"
 #include "envoy/server/hot_restart.h"
+#include "envoy/ssl/session_ticket_key_storage.h"
 
 #include "common/common/assert.h"
 #include "common/stats/allocator_impl.h"
@@ -22,7 +23,7 @@ namespace Server {
 
 // Increment this whenever there is a shared memory / RPC change that will prevent a hot restart
 // from working. Operations code can then cope with this and do a full restart.
-const uint64_t HOT_RESTART_VERSION = 11;
+const uint64_t HOT_RESTART_VERSION = 12;
 
 /**
  * Shared memory segment. This structure is laid directly into shared memory and is used amongst
@@ -34,6 +35,12 @@ struct SharedMemory {
   pthread_mutex_t log_lock_;
   pthread_mutex_t access_log_lock_;
   std::atomic<uint64_t> flags_;
+  pthread_mutex_t session_ticket_keys_lock_;
+  Ssl::RotatedSessionTicketKeys session_ticket_keys_;
+  std::atomic<uint64_t> session_ticket_keys_generation_;
+  // Number of live processes attached to the segment, so that the last one to exit can scrub the
+  // session ticket keys.
+  std::atomic<uint64_t> attached_processes_;
 };
 static const uint64_t SHMEM_FLAGS_INITIALIZING = 0x1;
 
@@ -89,6 +96,33 @@ private:
   pthread_mutex_t& mutex_;
 };
 
+/**
+ * Rotated TLS session ticket keys kept in the shared memory segment, so that they are handed over
+ * from one Envoy process to the next.
+ */
+class SharedSessionTicketKeyStorage : public Ssl::SessionTicketKeyStorage {
+public:
+  SharedSessionTicketKeyStorage(SharedMemory& shmem)
+      : lock_(shmem.session_ticket_keys_lock_), keys_(shmem.session_ticket_keys_),
+        generation_(shmem.session_ticket_keys_generation_) {}
+
+  /**
+   * Overwrite the keys with zeros, so that they do not outlive the Envoy processes in the shared
+   * memory segment, which persists until the next hot restart epoch 0 unlinks it.
+   */
+  void clear();
+
+  // Ssl::SessionTicketKeyStorage
+  Thread::BasicLockable& lock() override { return lock_; }
+  Ssl::RotatedSessionTicketKeys& keys() override { return keys_; }
+  std::atomic<uint64_t>& generation() override { return generation_; }
+
+private:
+  ProcessSharedMutex lock_;
+  Ssl::RotatedSessionTicketKeys& keys_;
+  std::atomic<uint64_t>& generation_;
+};
+
 /**
  * Implementation of HotRestart built for Linux. Most of the "protocol" type logic is split out into
  * HotRestarting{Base,Parent,Child}. This class ties all that to shared memory and version logic.
@@ -96,6 +130,7 @@ private:
 class HotRestartImpl : public HotRestart {
 public:
   HotRestartImpl(const Options& options);
+  ~HotRestartImpl() override;
 
   // Server::HotRestart
   void drainParentListeners() override;
@@ -108,6 +143,9 @@ public:
   std::string version() override;
   Thread::BasicLockable& logLock() override { return log_lock_; }
   Thread::BasicLockable& accessLogLock() override { return access_log_lock_; }
+  Ssl::SessionTicketKeyStorage* sessionTicketKeyStorage() override {
+    return &session_ticket_key_storage_;
+  }
 
   /**
    * envoy --hot_restart_version doesn't initialize Envoy, but computes the version string
@@ -123,6 +161,7 @@ private:
   SharedMemory* shmem_;
   ProcessSharedMutex log_lock_;
   ProcessSharedMutex access_log_lock_;
+  SharedSessionTicketKeyStorage session_ticket_key_storage_;
 };
 
 } // namespace Server
@@ -26,6 +26,7 @@ public:
   std::string version() override { return "disabled"; }
   Thread::BasicLockable& logLock() override { return log_lock_; }
   Thread::BasicLockable& accessLogLock() override { return access_log_lock_; }
+  Ssl::SessionTicketKeyStorage* sessionTicketKeyStorage() override { return nullptr; }
 
 private:
   Thread::MutexBasicLockable log_lock_;
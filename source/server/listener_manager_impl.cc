@@ -246,9 +246,23 @@ DrainManagerPtr ProdListenerComponentFactory::createDrainManager(
 }
 
 DrainingFilterChainsManager::DrainingFilterChainsManager(ListenerImplPtr&& draining_listener,
-                                                         uint64_t workers_pending_removal)
+                                                         uint64_t workers_pending_removal,
+                                                         std::chrono::milliseconds drain_time,
+                                                         TimeSource& time_source,
+                                                         Runtime::RandomGenerator& random)
     : draining_listener_(std::move(draining_listener)),
-      workers_pending_removal_(workers_pending_removal) {}
+      workers_pending_removal_(workers_pending_removal), drain_time_(drain_time),
+      time_source_(time_source), random_(random), drain_start_(time_source.monotonicTime()) {}
+
+bool DrainingFilterChainsManager::drainClose() const {
+  if (drain_time_.count() == 0) {
+    return true;
+  }
+  const auto drain_time_completed = std::chrono::duration_cast<std::chrono::milliseconds>(
+      time_source_.monotonicTime() - drain_start_);
+  return static_cast<uint64_t>(drain_time_completed.count()) >
+         (random_.random() % drain_time_.count());
+}
 
 ListenerManagerImpl::ListenerManagerImpl(Instance& server,
                                          ListenerComponentFactory& listener_factory,
@@ -740,11 +754,14 @@ void ListenerManagerImpl::drainFilterChains(ListenerImplPtr&& draining_listener,
                                             ListenerImpl& new_listener) {
   // First add the listener to the draining list.
   std::list<DrainingFilterChainsManager>::iterator draining_group =
-      draining_filter_chains_manager_.emplace(draining_filter_chains_manager_.begin(),
-                                              std::move(draining_listener), workers_.size());
+      draining_filter_chains_manager_.emplace(
+          draining_filter_chains_manager_.begin(), std::move(draining_listener), workers_.size(),
+          server_.options().drainTime(), server_.timeSource(), server_.random());
+  // Only the connections of the filter chains which are not in the new listener are drained, the
+  // others keep running on the shared filter chains.
   draining_group->getDrainingListener().diffFilterChain(
       new_listener, [&draining_group](Network::DrainableFilterChain& filter_chain) mutable {
-        filter_chain.startDraining();
+        filter_chain.startDraining(*draining_group);
         draining_group->addFilterChainToDrain(filter_chain);
       });
   auto filter_chain_size = draining_group->numDrainingFilterChains();
@@ -755,33 +772,31 @@ void ListenerManagerImpl::drainFilterChains(ListenerImplPtr&& draining_listener,
 
   // Start the drain sequence which completes when the listener's drain manager has completed
   // draining at whatever the server configured drain times are.
-  draining_group->startDrainSequence(
-      server_.options().drainTime(), server_.dispatcher(), [this, draining_group]() -> void {
-        draining_group->getDrainingListener().debugLog(
-            absl::StrCat("removing draining filter chains from listener ",
-                         draining_group->getDrainingListener().name()));
-        for (const auto& worker : workers_) {
-          // Once the drain time has completed via the drain manager's timer, we tell the workers
-          // to remove the filter chains.
-          worker->removeFilterChains(
-              draining_group->getDrainingListenerTag(), draining_group->getDrainingFilterChains(),
-              [this, draining_group]() -> void {
-                // The remove listener completion is called on the worker thread. We post back to
-                // the main thread to avoid locking. This makes sure that we don't destroy the
-                // listener while filters might still be using its context (stats, etc.).
-                server_.dispatcher().post([this, draining_group]() -> void {
-                  if (draining_group->decWorkersPendingRemoval() == 0) {
-                    draining_group->getDrainingListener().debugLog(
-                        absl::StrCat("draining filter chains from listener ",
-                                     draining_group->getDrainingListener().name(), " complete"));
-                    stats_.total_filter_chains_draining_.sub(
-                        draining_group->numDrainingFilterChains());
-                    draining_filter_chains_manager_.erase(draining_group);
-                  }
-                });
-              });
-        }
-      });
+  draining_group->startDrainSequence(server_.dispatcher(), [this, draining_group]() -> void {
+    draining_group->getDrainingListener().debugLog(
+        absl::StrCat("removing draining filter chains from listener ",
+                     draining_group->getDrainingListener().name()));
+    for (const auto& worker : workers_) {
+      // Once the drain time has completed via the drain manager's timer, we tell the workers
+      // to remove the filter chains.
+      worker->removeFilterChains(
+          draining_group->getDrainingListenerTag(), draining_group->getDrainingFilterChains(),
+          [this, draining_group]() -> void {
+            // The remove listener completion is called on the worker thread. We post back to
+            // the main thread to avoid locking. This makes sure that we don't destroy the
+            // listener while filters might still be using its context (stats, etc.).
+            server_.dispatcher().post([this, draining_group]() -> void {
+              if (draining_group->decWorkersPendingRemoval() == 0) {
+                draining_group->getDrainingListener().debugLog(
+                    absl::StrCat("draining filter chains from listener ",
+                                 draining_group->getDrainingListener().name(), " complete"));
+                stats_.total_filter_chains_draining_.sub(draining_group->numDrainingFilterChains());
+                draining_filter_chains_manager_.erase(draining_group);
+              }
+            });
+          });
+    }
+  });
   updateWarmingActiveGauges();
 }
 
@@ -3,13 +3,16 @@
 #include <memory>
 
 #include "envoy/admin/v3/config_dump.pb.h"
+#include "envoy/common/time.h"
 #include "envoy/config/core/v3/address.pb.h"
 #include "envoy/config/core/v3/base.pb.h"
 #include "envoy/config/core/v3/config_source.pb.h"
 #include "envoy/config/listener/v3/listener.pb.h"
 #include "envoy/config/listener/v3/listener_components.pb.h"
+#include "envoy/network/drain_decision.h"
 #include "envoy/network/filter.h"
 #include "envoy/network/listen_socket.h"
+#include "envoy/runtime/runtime.h"
 #include "envoy/server/api_listener.h"
 #include "envoy/server/filter_config.h"
 #include "envoy/server/instance.h"
@@ -130,12 +133,21 @@ struct ListenerManagerStats {
 };
 
 /**
- * Provides the draining filter chains and the functionality to schedule listener destroy.
+ * Provides the draining filter chains and the functionality to schedule listener destroy. Also
+ * decides when to close the connections of the draining filter chains: with a probability growing
+ * linearly over the drain time, as for draining listeners, so that the clients of the removed or
+ * changed filter chains don't all reconnect at once.
  */
-class DrainingFilterChainsManager {
+class DrainingFilterChainsManager : public Network::DrainDecision {
 public:
   DrainingFilterChainsManager(ListenerImplPtr&& draining_listener,
-                              uint64_t workers_pending_removal);
+                              uint64_t workers_pending_removal,
+                              std::chrono::milliseconds drain_time, TimeSource& time_source,
+                              Runtime::RandomGenerator& random);
+
+  // Network::DrainDecision
+  bool drainClose() const override;
+
   uint64_t getDrainingListenerTag() const { return draining_listener_->listenerTag(); }
   const std::list<const Network::FilterChain*>& getDrainingFilterChains() const {
     return draining_filter_chains_;
@@ -144,13 +156,12 @@ public:
   uint64_t decWorkersPendingRemoval() { return --workers_pending_removal_; }
 
   // Schedule listener destroy.
-  void startDrainSequence(std::chrono::seconds drain_time, Event::Dispatcher& dispatcher,
-                          std::function<void()> completion) {
+  void startDrainSequence(Event::Dispatcher& dispatcher, std::function<void()> completion) {
     drain_sequence_completion_ = completion;
     ASSERT(!drain_timer_);
 
     drain_timer_ = dispatcher.createTimer([this]() -> void { drain_sequence_completion_(); });
-    drain_timer_->enableTimer(drain_time);
+    drain_timer_->enableTimer(drain_time_);
   }
 
   void addFilterChainToDrain(const Network::FilterChain& filter_chain) {
@@ -164,6 +175,10 @@ private:
   std::list<const Network::FilterChain*> draining_filter_chains_;
 
   uint64_t workers_pending_removal_;
+  const std::chrono::milliseconds drain_time_;
+  TimeSource& time_source_;
+  Runtime::RandomGenerator& random_;
+  const MonotonicTime drain_start_;
   Event::TimerPtr drain_timer_;
   std::function<void()> drain_sequence_completion_;
 };
@@ -37,12 +37,13 @@ private:
   }
 };
 
-Ssl::ContextManagerPtr createContextManager(const std::string& factory_name,
-                                            TimeSource& time_source) {
+Ssl::ContextManagerPtr
+createContextManager(const std::string& factory_name, TimeSource& time_source,
+                     Ssl::SessionTicketKeyStorage* session_ticket_key_storage) {
   Ssl::ContextManagerFactory* factory =
       Registry::FactoryRegistry<Ssl::ContextManagerFactory>::getFactory(factory_name);
   if (factory != nullptr) {
-    return factory->createContextManager(time_source);
+    return factory->createContextManager(time_source, session_ticket_key_storage);
   }
 
   return std::make_unique<SslContextManagerNoTlsStub>();
@@ -580,6 +580,23 @@ TEST_F(OwnedImplTest, ToString) {
   EXPECT_EQ(absl::StrCat("Hello, world!" + long_string), buffer.toString());
 }
 
+TEST_F(OwnedImplTest, Capacity) {
+  Buffer::OwnedImpl buffer;
+  EXPECT_EQ(0, buffer.capacity());
+
+  // Drained and reservable space is still held by the slice.
+  buffer.add(std::string(100, 'a'));
+  buffer.drain(50);
+  const uint64_t owned_capacity = buffer.capacity();
+  EXPECT_GE(owned_capacity, 100);
+  EXPECT_EQ(owned_capacity, buffer.describeSlicesForTest()[0].capacity);
+
+  const std::string fragment_data(10, 'b');
+  BufferFragmentImpl fragment(fragment_data.data(), fragment_data.size(), nullptr);
+  buffer.addBufferFragment(fragment);
+  EXPECT_EQ(owned_capacity + 10, buffer.capacity());
+}
+
 TEST_F(OwnedImplTest, AppendSliceForTest) {
   static constexpr size_t NumInputs = 3;
   static constexpr const char* Inputs[] = {"one", "2", "", "four", ""};
@@ -66,6 +66,23 @@ TEST_F(WatermarkBufferTest, AddBuffer) {
   EXPECT_EQ(11, buffer_.length());
 }
 
+TEST_F(WatermarkBufferTest, AddBufferFragment) {
+  bool released = false;
+  BufferFragmentImpl fragment(TEN_BYTES, 10,
+                              [&](const void*, size_t, const BufferFragmentImpl*) {
+                                released = true;
+                              });
+  buffer_.add("a", 1);
+  EXPECT_EQ(0, times_high_watermark_called_);
+  buffer_.addBufferFragment(fragment);
+  EXPECT_EQ(1, times_high_watermark_called_);
+  EXPECT_EQ(11, buffer_.length());
+
+  buffer_.drain(buffer_.length());
+  EXPECT_EQ(1, times_low_watermark_called_);
+  EXPECT_TRUE(released);
+}
+
 TEST_F(WatermarkBufferTest, Prepend) {
   std::string suffix = "World!", prefix = "Hello, ";
 
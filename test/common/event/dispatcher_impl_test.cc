@@ -6,6 +6,7 @@
 #include "common/common/lock_guard.h"
 #include "common/event/deferred_task.h"
 #include "common/event/dispatcher_impl.h"
+#include "common/event/object_pool.h"
 #include "common/event/timer_impl.h"
 #include "common/stats/isolated_store_impl.h"
 
@@ -65,6 +66,102 @@ TEST(DeferredDeleteTest, DeferredDelete) {
   dispatcher->clearDeferredDeleteList();
 }
 
+class TestRecyclable : public DeferredDeletable {
+public:
+  TestRecyclable(ObjectPool<TestRecyclable>& pool, std::function<void()> on_destroy)
+      : pool_(pool), on_destroy_(on_destroy) {}
+  ~TestRecyclable() override { on_destroy_(); }
+
+  // DeferredDeletable
+  bool recycle() override { return pool_.recycle(this); }
+
+private:
+  ObjectPool<TestRecyclable>& pool_;
+  std::function<void()> on_destroy_;
+};
+
+TEST(DeferredDeleteTest, Recycle) {
+  Api::ApiPtr api = Api::createApiForTest();
+  DispatcherPtr dispatcher(api->allocateDispatcher("test_thread"));
+  ObjectPool<TestRecyclable> pool(1);
+  ReadyWatcher watcher1;
+  ReadyWatcher watcher2;
+
+  std::unique_ptr<TestRecyclable> object1 = pool.create(pool, [&]() -> void { watcher1.ready(); });
+  TestRecyclable* storage1 = object1.get();
+  dispatcher->deferredDelete(std::move(object1));
+  dispatcher->deferredDelete(pool.create(pool, [&]() -> void { watcher2.ready(); }));
+
+  // Both objects are destroyed, but only the first fits in the pool.
+  EXPECT_CALL(watcher1, ready());
+  EXPECT_CALL(watcher2, ready());
+  dispatcher->clearDeferredDeleteList();
+  EXPECT_EQ(1, pool.freeObjects());
+
+  // The next object reuses the recycled storage.
+  std::unique_ptr<TestRecyclable> object3 = pool.create(pool, []() -> void {});
+  EXPECT_EQ(storage1, object3.get());
+  EXPECT_EQ(0, pool.freeObjects());
+  EXPECT_EQ(1, pool.reused());
+}
+
+// Objects created or recycled by the destructor of a recycled object don't get its storage.
+TEST(DeferredDeleteTest, RecycleFromDestructor) {
+  ObjectPool<TestRecyclable> pool(2);
+  std::unique_ptr<TestRecyclable> object3;
+  std::unique_ptr<TestRecyclable> object1 = pool.create(pool, []() -> void {});
+  TestRecyclable* storage1 = object1.get();
+  std::unique_ptr<TestRecyclable> object2 =
+      pool.create(pool, [&]() -> void { object3 = pool.create(pool, []() -> void {}); });
+  TestRecyclable* storage2 = object2.get();
+  ASSERT_TRUE(pool.recycle(object1.release()));
+
+  ASSERT_TRUE(pool.recycle(object2.release()));
+  EXPECT_EQ(storage1, object3.get());
+  EXPECT_EQ(1, pool.freeObjects());
+  EXPECT_EQ(storage2, pool.create(pool, []() -> void {}).get());
+}
+
+class TestThrowingRecyclable {
+public:
+  explicit TestThrowingRecyclable(bool fail) {
+    if (fail) {
+      throw EnvoyException("construction failed");
+    }
+  }
+};
+
+// The storage of an object whose constructor throws stays in the pool.
+TEST(DeferredDeleteTest, RecycleConstructorThrows) {
+  ObjectPool<TestThrowingRecyclable> pool;
+  std::unique_ptr<TestThrowingRecyclable> object = pool.create(false);
+  TestThrowingRecyclable* storage = object.get();
+  ASSERT_TRUE(pool.recycle(object.release()));
+
+  EXPECT_THROW_WITH_MESSAGE(pool.create(true), EnvoyException, "construction failed");
+  EXPECT_EQ(1, pool.freeObjects());
+  EXPECT_EQ(storage, pool.create(false).get());
+  EXPECT_EQ(1, pool.reused());
+}
+
+// Single element allocations reuse the storage of released ones, other allocations are not pooled.
+TEST(DeferredDeleteTest, ObjectPoolAllocator) {
+  ObjectPoolAllocator<uint64_t> allocator;
+  ObjectPool<uint64_t>& pool = ObjectPoolAllocator<uint64_t>::pool();
+  uint64_t* storage = allocator.allocate(1);
+  allocator.deallocate(storage, 1);
+  EXPECT_EQ(1, pool.freeObjects());
+
+  uint64_t* array = allocator.allocate(2);
+  allocator.deallocate(array, 2);
+  EXPECT_EQ(1, pool.freeObjects());
+
+  EXPECT_EQ(storage, allocator.allocate(1));
+  EXPECT_EQ(0, pool.freeObjects());
+  EXPECT_EQ(1, pool.reused());
+  allocator.deallocate(storage, 1);
+}
+
 TEST(DeferredTaskTest, DeferredTask) {
   InSequence s;
   Api::ApiPtr api = Api::createApiForTest();
@@ -147,10 +244,20 @@ protected:
 // TODO(mergeconflict): We also need integration testing to validate that the expected histograms
 // are written when `enable_dispatcher_stats` is true. See issue #6582.
 TEST_F(DispatcherImplTest, InitializeStats) {
+  EXPECT_CALL(scope_, histogram("test.dispatcher.deferred_delete_duration_us",
+                                Stats::Histogram::Unit::Microseconds));
+  EXPECT_CALL(scope_,
+              histogram("test.dispatcher.deferred_delete_size", Stats::Histogram::Unit::Unspecified));
   EXPECT_CALL(scope_,
               histogram("test.dispatcher.loop_duration_us", Stats::Histogram::Unit::Microseconds));
   EXPECT_CALL(scope_,
               histogram("test.dispatcher.poll_delay_us", Stats::Histogram::Unit::Microseconds));
+  EXPECT_CALL(scope_,
+              histogram("test.dispatcher.poll_duration_us", Stats::Histogram::Unit::Microseconds));
+  EXPECT_CALL(scope_,
+              histogram("test.dispatcher.post_queue_depth", Stats::Histogram::Unit::Unspecified));
+  EXPECT_CALL(scope_,
+              histogram("test.dispatcher.ready_events", Stats::Histogram::Unit::Unspecified));
   dispatcher_->initializeStats(scope_, "test.");
 }
 
@@ -339,6 +446,65 @@ TEST(TimerImplTest, TimerEnabledDisabled) {
   EXPECT_FALSE(timer->enabled());
 }
 
+// Coarse timers fire no earlier than requested and no later than the next 1ms tick of the wheel.
+TEST(TimerImplTest, CoarseTimer) {
+  Event::SimulatedTimeSystem time_system;
+  Api::ApiPtr api = Api::createApiForTest(time_system);
+  DispatcherPtr dispatcher(api->allocateDispatcher("test_thread"));
+  bool fired = false;
+  Event::TimerPtr timer = dispatcher->createCoarseTimer([&fired] { fired = true; });
+  EXPECT_FALSE(timer->enabled());
+
+  const auto start = time_system.monotonicTime();
+  timer->enableTimer(std::chrono::milliseconds(50));
+  EXPECT_TRUE(timer->enabled());
+  while (!fired) {
+    dispatcher->run(Dispatcher::RunType::NonBlock);
+    if (!fired) {
+      time_system.advanceTimeAsync(std::chrono::milliseconds(1));
+    }
+  }
+  EXPECT_FALSE(timer->enabled());
+  const auto elapsed = time_system.monotonicTime() - start;
+  EXPECT_GE(elapsed, std::chrono::milliseconds(50));
+  EXPECT_LE(elapsed, std::chrono::milliseconds(51));
+
+  // A disabled coarse timer does not fire.
+  fired = false;
+  timer->enableTimer(std::chrono::milliseconds(50));
+  timer->disableTimer();
+  EXPECT_FALSE(timer->enabled());
+  time_system.advanceTimeAsync(std::chrono::milliseconds(500));
+  dispatcher->run(Dispatcher::RunType::NonBlock);
+  EXPECT_FALSE(fired);
+}
+
+// Loop times are tracked from the first call to loopTimes(), and time spent in callbacks counts as
+// busy rather than polling.
+TEST(DispatcherLoopTimesTest, LoopTimes) {
+  Api::ApiPtr api = Api::createApiForTest();
+  DispatcherPtr dispatcher(api->allocateDispatcher("test_thread"));
+  DispatcherLoopTimes times = dispatcher->loopTimes();
+  EXPECT_EQ(std::chrono::microseconds(0), times.poll_time_);
+  EXPECT_EQ(std::chrono::microseconds(0), times.busy_time_);
+
+  // The first timer keeps the loop busy for a while. The second makes sure the loop goes around
+  // once more, as processing time is accounted for when the loop next polls.
+  TimerPtr exit_timer = dispatcher->createTimer([]() {});
+  TimerPtr busy_timer = dispatcher->createTimer([&]() {
+    const MonotonicTime start = dispatcher->timeSource().monotonicTime();
+    while (dispatcher->timeSource().monotonicTime() - start < std::chrono::milliseconds(5)) {
+    }
+    exit_timer->enableTimer(std::chrono::milliseconds(1));
+  });
+  busy_timer->enableTimer(std::chrono::milliseconds(10));
+  dispatcher->run(Dispatcher::RunType::Block);
+
+  times = dispatcher->loopTimes();
+  EXPECT_GE(times.busy_time_, std::chrono::milliseconds(5));
+  EXPECT_GE(times.poll_time_, std::chrono::milliseconds(8));
+}
+
 class TimerImplTimingTest : public testing::Test {
 public:
   std::chrono::nanoseconds getTimerTiming(Event::SimulatedTimeSystem& time_system,
@@ -0,0 +1,116 @@
+// Usage: bazel run //test/common/event:post_queue_speed_test
+// Note: this should be run with --compilation_mode=opt.
+
+#include <atomic>
+#include <list>
+#include <vector>
+
+#include "common/common/lock_guard.h"
+#include "common/common/thread.h"
+#include "common/event/post_queue.h"
+
+#include "test/test_common/thread_factory_for_test.h"
+
+#include "benchmark/benchmark.h"
+
+namespace Envoy {
+namespace Event {
+namespace {
+
+// The mutex protected list that dispatchers used for posted callbacks before PostQueue, kept here
+// as a baseline.
+class MutexListQueue {
+public:
+  bool push(PostCb callback) {
+    Thread::LockGuard lock(lock_);
+    const bool wakeup = callbacks_.empty();
+    callbacks_.push_back(callback);
+    return wakeup;
+  }
+
+  uint64_t runCallbacks() {
+    uint64_t run = 0;
+    while (true) {
+      PostCb callback;
+      {
+        Thread::LockGuard lock(lock_);
+        if (callbacks_.empty()) {
+          return run;
+        }
+        callback = callbacks_.front();
+        callbacks_.pop_front();
+      }
+      callback();
+      run++;
+    }
+  }
+
+private:
+  Thread::MutexBasicLockable lock_;
+  std::list<PostCb> callbacks_ ABSL_GUARDED_BY(lock_);
+};
+
+// state.range(0) threads each post 10000 callbacks while the benchmark thread runs them, as when
+// the main thread and other workers post to a busy worker. Each callback captures a pointer, so it
+// fits in std::function's inline storage.
+template <class Queue> void postFromThreads(benchmark::State& state) {
+  const uint64_t producers = state.range(0);
+  const uint64_t callbacks = 10000;
+  uint64_t wakeups = 0;
+  for (auto _ : state) {
+    Queue queue;
+    std::atomic<uint64_t> posted_wakeups{0};
+    uint64_t counter = 0;
+    std::vector<Thread::ThreadPtr> threads;
+    for (uint64_t p = 0; p < producers; p++) {
+      threads.push_back(Thread::threadFactoryForTest().createThread([&]() {
+        for (uint64_t i = 0; i < callbacks; i++) {
+          if (queue.push([&counter]() { counter++; })) {
+            posted_wakeups++;
+          }
+        }
+      }));
+    }
+    uint64_t run = 0;
+    while (run < producers * callbacks) {
+      run += queue.runCallbacks();
+    }
+    for (auto& thread : threads) {
+      thread->join();
+    }
+    benchmark::DoNotOptimize(counter);
+    wakeups += posted_wakeups;
+  }
+  state.SetItemsProcessed(state.iterations() * producers * callbacks);
+  state.counters["wakeups"] = benchmark::Counter(wakeups, benchmark::Counter::kAvgIterations);
+}
+
+static void BM_MutexListPost(benchmark::State& state) { postFromThreads<MutexListQueue>(state); }
+BENCHMARK(BM_MutexListPost)->Arg(1)->Arg(4)->Arg(16)->Unit(benchmark::kMillisecond)->UseRealTime();
+
+static void BM_PostQueuePost(benchmark::State& state) { postFromThreads<PostQueue>(state); }
+BENCHMARK(BM_PostQueuePost)->Arg(1)->Arg(4)->Arg(16)->Unit(benchmark::kMillisecond)->UseRealTime();
+
+// A single thread posting and running small batches, which is the common uncontended case.
+template <class Queue> void postBatch(benchmark::State& state) {
+  Queue queue;
+  uint64_t counter = 0;
+  for (auto _ : state) {
+    for (int64_t i = 0; i < state.range(0); i++) {
+      queue.push([&counter]() { counter++; });
+    }
+    queue.runCallbacks();
+  }
+  benchmark::DoNotOptimize(counter);
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+static void BM_MutexListBatch(benchmark::State& state) { postBatch<MutexListQueue>(state); }
+BENCHMARK(BM_MutexListBatch)->Arg(1)->Arg(16)->Arg(256);
+
+static void BM_PostQueueBatch(benchmark::State& state) { postBatch<PostQueue>(state); }
+BENCHMARK(BM_PostQueueBatch)->Arg(1)->Arg(16)->Arg(256);
+
+} // namespace
+} // namespace Event
+} // namespace Envoy
@@ -0,0 +1,114 @@
+#include <atomic>
+#include <vector>
+
+#include "common/event/post_queue.h"
+
+#include "test/test_common/thread_factory_for_test.h"
+
+#include "gtest/gtest.h"
+
+namespace Envoy {
+namespace Event {
+namespace {
+
+TEST(PostQueueTest, RunsInOrder) {
+  PostQueue queue(4);
+  std::vector<int> order;
+  for (int i = 0; i < 10; i++) {
+    queue.push([&order, i]() { order.push_back(i); });
+  }
+  EXPECT_EQ(6, queue.overflows());
+  EXPECT_EQ(10, queue.runCallbacks());
+  EXPECT_EQ(std::vector<int>({0, 1, 2, 3, 4, 5, 6, 7, 8, 9}), order);
+  EXPECT_EQ(0, queue.runCallbacks());
+}
+
+TEST(PostQueueTest, UsesRingAgainAfterOverflowRuns) {
+  PostQueue queue(2);
+  uint64_t run = 0;
+  for (int i = 0; i < 3; i++) {
+    queue.push([&run]() { run++; });
+  }
+  EXPECT_EQ(1, queue.overflows());
+  EXPECT_EQ(3, queue.runCallbacks());
+
+  queue.push([&run]() { run++; });
+  queue.push([&run]() { run++; });
+  EXPECT_EQ(1, queue.overflows());
+  EXPECT_EQ(2, queue.runCallbacks());
+  EXPECT_EQ(5, run);
+}
+
+TEST(PostQueueTest, BatchesWakeups) {
+  PostQueue queue;
+  EXPECT_TRUE(queue.push([]() {}));
+  EXPECT_FALSE(queue.push([]() {}));
+  EXPECT_FALSE(queue.push([]() {}));
+  EXPECT_EQ(3, queue.runCallbacks());
+  EXPECT_TRUE(queue.push([]() {}));
+}
+
+TEST(PostQueueTest, RunsCallbacksPushedByCallbacks) {
+  PostQueue queue(2);
+  std::vector<int> order;
+  queue.push([&]() {
+    order.push_back(0);
+    for (int i = 2; i < 5; i++) {
+      queue.push([&order, i]() { order.push_back(i); });
+    }
+  });
+  queue.push([&order]() { order.push_back(1); });
+  EXPECT_EQ(5, queue.runCallbacks());
+  EXPECT_EQ(std::vector<int>({0, 1, 2, 3, 4}), order);
+}
+
+TEST(PostQueueTest, DestroysPendingCallbacks) {
+  auto value = std::make_shared<int>(0);
+  {
+    PostQueue queue(2);
+    for (int i = 0; i < 4; i++) {
+      queue.push([value]() {});
+    }
+    EXPECT_EQ(5, value.use_count());
+  }
+  EXPECT_EQ(1, value.use_count());
+}
+
+// Producers racing each other and the consumer, through both the ring and the overflow list, must
+// each see their callbacks run in order.
+TEST(PostQueueTest, ConcurrentProducers) {
+  const int producers = 4;
+  const int callbacks = 20000;
+  PostQueue queue(64);
+  std::vector<int> last(producers, -1);
+  std::atomic<bool> in_order{true};
+
+  std::vector<Thread::ThreadPtr> threads;
+  for (int p = 0; p < producers; p++) {
+    threads.push_back(Thread::threadFactoryForTest().createThread([&, p]() {
+      for (int i = 0; i < callbacks; i++) {
+        queue.push([&, p, i]() {
+          if (last[p] != i - 1) {
+            in_order = false;
+          }
+          last[p] = i;
+        });
+      }
+    }));
+  }
+
+  uint64_t run = 0;
+  while (run < static_cast<uint64_t>(producers * callbacks)) {
+    run += queue.runCallbacks();
+  }
+  for (auto& thread : threads) {
+    thread->join();
+  }
+  EXPECT_EQ(0, queue.runCallbacks());
+  EXPECT_TRUE(in_order);
+  EXPECT_EQ(std::vector<int>(producers, callbacks - 1), last);
+}
+
+} // namespace
+} // namespace Event
+} // namespace Envoy
@@ -0,0 +1,103 @@
+// Usage: bazel run //test/common/event:timing_wheel_speed_test
+// Note: this should be run with --compilation_mode=opt.
+
+#include <chrono>
+#include <vector>
+
+#include "envoy/api/api.h"
+#include "envoy/event/dispatcher.h"
+#include "envoy/event/timer.h"
+
+#include "test/test_common/utility.h"
+
+#include "benchmark/benchmark.h"
+
+namespace Envoy {
+namespace Event {
+namespace {
+
+// Arms state.range(0) timers with a stream idle timeout and then re-arms all of them on each
+// iteration, as happens when every stream sees activity. Regular timers are re-inserted into
+// libevent's timer heap each time.
+static void BM_RearmTimers(benchmark::State& state) {
+  Api::ApiPtr api = Api::createApiForTest();
+  DispatcherPtr dispatcher(api->allocateDispatcher("test_thread"));
+  std::vector<TimerPtr> timers;
+  for (int64_t i = 0; i < state.range(0); i++) {
+    timers.push_back(dispatcher->createTimer([] {}));
+    timers.back()->enableTimer(std::chrono::minutes(5));
+  }
+  for (auto _ : state) {
+    for (TimerPtr& timer : timers) {
+      timer->enableTimer(std::chrono::minutes(5));
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_RearmTimers)->Arg(1000)->Arg(10000)->Arg(200000)->Unit(benchmark::kMicrosecond);
+
+// The same workload with coarse timers, which are moved between slots of the dispatcher's timing
+// wheel.
+static void BM_RearmCoarseTimers(benchmark::State& state) {
+  Api::ApiPtr api = Api::createApiForTest();
+  DispatcherPtr dispatcher(api->allocateDispatcher("test_thread"));
+  std::vector<TimerPtr> timers;
+  for (int64_t i = 0; i < state.range(0); i++) {
+    timers.push_back(dispatcher->createCoarseTimer([] {}));
+    timers.back()->enableTimer(std::chrono::minutes(5));
+  }
+  for (auto _ : state) {
+    for (TimerPtr& timer : timers) {
+      timer->enableTimer(std::chrono::minutes(5));
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_RearmCoarseTimers)->Arg(1000)->Arg(10000)->Arg(200000)->Unit(benchmark::kMicrosecond);
+
+// Creates, arms and destroys a timer, as each stream does over its lifetime.
+static void BM_StreamTimerLifetime(benchmark::State& state) {
+  Api::ApiPtr api = Api::createApiForTest();
+  DispatcherPtr dispatcher(api->allocateDispatcher("test_thread"));
+  const bool coarse = state.range(0) != 0;
+  // Keep other timers armed so that the heap and the wheel are not trivially empty.
+  std::vector<TimerPtr> background;
+  for (uint32_t i = 0; i < 10000; i++) {
+    background.push_back(coarse ? dispatcher->createCoarseTimer([] {})
+                                : dispatcher->createTimer([] {}));
+    background.back()->enableTimer(std::chrono::minutes(5));
+  }
+  for (auto _ : state) {
+    TimerPtr timer =
+        coarse ? dispatcher->createCoarseTimer([] {}) : dispatcher->createTimer([] {});
+    timer->enableTimer(std::chrono::minutes(5));
+    timer->enableTimer(std::chrono::minutes(5));
+    timer->disableTimer();
+  }
+}
+BENCHMARK(BM_StreamTimerLifetime)->Arg(0)->Arg(1);
+
+/*
+clang-format off
+
+Run on (1 X 2000 MHz CPU s), median of 7 repetitions, with the dispatcher's 1ms coarse timer tick.
+Both kinds of timer read the monotonic clock on every enableTimer() call, which accounts for most of
+the cost of the wheel at low counts.
+----------------------------------------------------------------------
+Benchmark                                  Time             CPU
+----------------------------------------------------------------------
+BM_RearmTimers/1000                     58.4 us         57.5 us
+BM_RearmTimers/10000                     775 us          764 us
+BM_RearmTimers/200000                  66246 us        65250 us
+BM_RearmCoarseTimers/1000               77.6 us         76.8 us
+BM_RearmCoarseTimers/10000               747 us          738 us
+BM_RearmCoarseTimers/200000            15491 us        15254 us
+BM_StreamTimerLifetime/0                 238 ns          233 ns
+BM_StreamTimerLifetime/1                 179 ns          177 ns
+
+clang-format on
+*/
+
+} // namespace
+} // namespace Event
+} // namespace Envoy
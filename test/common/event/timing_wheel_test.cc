@@ -0,0 +1,215 @@
+#include <algorithm>
+#include <chrono>
+#include <vector>
+
+#include "common/api/api_impl.h"
+#include "common/event/dispatcher_impl.h"
+#include "common/event/timing_wheel.h"
+
+#include "test/mocks/common.h"
+#include "test/mocks/event/mocks.h"
+#include "test/test_common/simulated_time_system.h"
+#include "test/test_common/utility.h"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+namespace Envoy {
+namespace Event {
+namespace {
+
+class TimingWheelTest : public testing::Test {
+protected:
+  TimingWheelTest()
+      : api_(Api::createApiForTest(time_system_)), dispatcher_(api_->allocateDispatcher("test")),
+        wheel_(*dispatcher_, std::chrono::milliseconds(10)) {}
+
+  // Advances simulated time in steps, running the dispatcher after each step.
+  void advance(std::chrono::milliseconds duration,
+               std::chrono::milliseconds step = std::chrono::milliseconds(1)) {
+    while (duration.count() > 0) {
+      const std::chrono::milliseconds advance_by = std::min(step, duration);
+      time_system_.advanceTimeAsync(advance_by);
+      dispatcher_->run(Dispatcher::RunType::NonBlock);
+      duration -= advance_by;
+    }
+  }
+
+  Event::SimulatedTimeSystem time_system_;
+  Api::ApiPtr api_;
+  DispatcherPtr dispatcher_;
+  TimingWheel wheel_;
+};
+
+// Timers fire on the first tick at or after their deadline.
+TEST_F(TimingWheelTest, FiresOnTickBoundary) {
+  ReadyWatcher ready;
+  TimerPtr timer = wheel_.createTimer([&ready]() -> void { ready.ready(); });
+  timer->enableTimer(std::chrono::milliseconds(25));
+  EXPECT_TRUE(timer->enabled());
+  EXPECT_EQ(1, wheel_.armedTimers());
+
+  EXPECT_CALL(ready, ready()).Times(0);
+  advance(std::chrono::milliseconds(29));
+  testing::Mock::VerifyAndClearExpectations(&ready);
+
+  EXPECT_CALL(ready, ready());
+  advance(std::chrono::milliseconds(1));
+  EXPECT_FALSE(timer->enabled());
+  EXPECT_EQ(0, wheel_.armedTimers());
+}
+
+// Timers beyond the first level of the wheel move down the levels and still fire on the first tick
+// at or after their deadline.
+TEST_F(TimingWheelTest, HigherLevels) {
+  for (const auto timeout : {std::chrono::milliseconds(645), std::chrono::milliseconds(40965),
+                             std::chrono::milliseconds(2621445)}) {
+    ReadyWatcher ready;
+    TimerPtr timer = wheel_.createTimer([&ready]() -> void { ready.ready(); });
+    timer->enableTimer(timeout);
+
+    EXPECT_CALL(ready, ready()).Times(0);
+    advance(timeout - std::chrono::milliseconds(100), std::chrono::milliseconds(100));
+    advance(std::chrono::milliseconds(104));
+    testing::Mock::VerifyAndClearExpectations(&ready);
+
+    EXPECT_CALL(ready, ready());
+    advance(std::chrono::milliseconds(1));
+    EXPECT_EQ(0, wheel_.armedTimers());
+  }
+}
+
+// A zero timeout fires on the next tick.
+TEST_F(TimingWheelTest, ZeroTimeout) {
+  ReadyWatcher ready;
+  TimerPtr timer = wheel_.createTimer([&ready]() -> void { ready.ready(); });
+  timer->enableHRTimer(std::chrono::microseconds(0));
+  EXPECT_CALL(ready, ready());
+  advance(std::chrono::milliseconds(10));
+}
+
+// Disabling and destroying timers removes them from the wheel.
+TEST_F(TimingWheelTest, DisableAndDestroy) {
+  ReadyWatcher ready;
+  TimerPtr timer1 = wheel_.createTimer([&ready]() -> void { ready.ready(); });
+  TimerPtr timer2 = wheel_.createTimer([&ready]() -> void { ready.ready(); });
+  timer1->enableTimer(std::chrono::milliseconds(10));
+  timer2->enableTimer(std::chrono::milliseconds(10));
+  EXPECT_EQ(2, wheel_.armedTimers());
+
+  timer1->disableTimer();
+  EXPECT_FALSE(timer1->enabled());
+  timer2.reset();
+  EXPECT_EQ(0, wheel_.armedTimers());
+
+  EXPECT_CALL(ready, ready()).Times(0);
+  advance(std::chrono::milliseconds(50));
+}
+
+// Re-enabling a timer replaces its previous deadline.
+TEST_F(TimingWheelTest, Rearm) {
+  ReadyWatcher ready;
+  TimerPtr timer = wheel_.createTimer([&ready]() -> void { ready.ready(); });
+  timer->enableTimer(std::chrono::milliseconds(10));
+  timer->enableTimer(std::chrono::milliseconds(40));
+  EXPECT_EQ(1, wheel_.armedTimers());
+
+  EXPECT_CALL(ready, ready()).Times(0);
+  advance(std::chrono::milliseconds(39));
+  testing::Mock::VerifyAndClearExpectations(&ready);
+
+  EXPECT_CALL(ready, ready());
+  advance(std::chrono::milliseconds(1));
+}
+
+// Callbacks may disable other timers expiring in the same tick, and re-arm themselves.
+TEST_F(TimingWheelTest, CallbackModifiesTimers) {
+  ReadyWatcher ready1;
+  ReadyWatcher ready2;
+  TimerPtr timer1;
+  TimerPtr timer2;
+  timer1 = wheel_.createTimer([&]() -> void {
+    ready1.ready();
+    timer2->disableTimer();
+    timer1->enableTimer(std::chrono::milliseconds(10));
+  });
+  timer2 = wheel_.createTimer([&]() -> void {
+    ready2.ready();
+    timer1->disableTimer();
+  });
+  timer1->enableTimer(std::chrono::milliseconds(10));
+  timer2->enableTimer(std::chrono::milliseconds(10));
+
+  // Whichever fires first disables the other.
+  bool timer1_fired = false;
+  EXPECT_CALL(ready1, ready()).Times(testing::AtMost(1)).WillRepeatedly(testing::Invoke([&]() {
+    timer1_fired = true;
+  }));
+  EXPECT_CALL(ready2, ready()).Times(testing::AtMost(1));
+  advance(std::chrono::milliseconds(10));
+  testing::Mock::VerifyAndClearExpectations(&ready1);
+  testing::Mock::VerifyAndClearExpectations(&ready2);
+  EXPECT_EQ(timer1_fired ? 1 : 0, wheel_.armedTimers());
+  timer1->disableTimer();
+}
+
+// If the event loop falls behind, all overdue timers fire on the next tick.
+TEST_F(TimingWheelTest, CatchUp) {
+  std::vector<TimerPtr> timers;
+  uint32_t fired = 0;
+  for (uint32_t i = 1; i <= 20; i++) {
+    timers.push_back(wheel_.createTimer([&fired]() -> void { fired++; }));
+    timers.back()->enableTimer(std::chrono::milliseconds(i * 10));
+  }
+
+  // Jump ahead by several slots without running the loop.
+  time_system_.advanceTimeAsync(std::chrono::milliseconds(150));
+  dispatcher_->run(Dispatcher::RunType::NonBlock);
+  EXPECT_EQ(15, fired);
+
+  advance(std::chrono::milliseconds(50));
+  EXPECT_EQ(20, fired);
+  EXPECT_EQ(0, wheel_.armedTimers());
+}
+
+class TimingWheelWakeupTest : public Event::TestUsingSimulatedTime, public testing::Test {
+protected:
+  testing::NiceMock<MockDispatcher> dispatcher_;
+  MockTimer* tick_timer_{new MockTimer(&dispatcher_)};
+  TimingWheel wheel_{dispatcher_, std::chrono::milliseconds(1)};
+};
+
+// The wheel only wakes up for the earliest occupied slot, even with a 1ms tick, and re-arming a
+// timer into an occupied slot does not touch the dispatcher timer.
+TEST_F(TimingWheelWakeupTest, WakesForEarliestOccupiedSlot) {
+  ReadyWatcher ready;
+  TimerPtr timer = wheel_.createTimer([&ready]() -> void { ready.ready(); });
+
+  // Five minutes is in the fourth level, whose slots are 2^18 ticks long.
+  EXPECT_CALL(*tick_timer_, enableTimer(_, _)).Times(0);
+  EXPECT_CALL(*tick_timer_, enableTimer(std::chrono::milliseconds(262144), _));
+  timer->enableTimer(std::chrono::milliseconds(300000));
+  simTime().advanceTimeWait(std::chrono::milliseconds(1));
+  timer->enableTimer(std::chrono::milliseconds(299999));
+  testing::Mock::VerifyAndClearExpectations(tick_timer_);
+
+  // The timer moves down a level on each wakeup.
+  simTime().advanceTimeWait(std::chrono::milliseconds(262143));
+  EXPECT_CALL(*tick_timer_, enableTimer(std::chrono::milliseconds(36864), _));
+  tick_timer_->invokeCallback();
+  simTime().advanceTimeWait(std::chrono::milliseconds(36864));
+  EXPECT_CALL(*tick_timer_, enableTimer(std::chrono::milliseconds(960), _));
+  tick_timer_->invokeCallback();
+  simTime().advanceTimeWait(std::chrono::milliseconds(960));
+  EXPECT_CALL(*tick_timer_, enableTimer(std::chrono::milliseconds(32), _));
+  tick_timer_->invokeCallback();
+
+  simTime().advanceTimeWait(std::chrono::milliseconds(32));
+  EXPECT_CALL(ready, ready());
+  EXPECT_CALL(*tick_timer_, disableTimer());
+  tick_timer_->invokeCallback();
+}
+
+} // namespace
+} // namespace Event
+} // namespace Envoy
@@ -0,0 +1,312 @@
+// Usage: bazel run //test/common/http:conn_manager_impl_speed_test
+// Note: this should be run with --compilation_mode=opt.
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "common/buffer/buffer_impl.h"
+#include "common/common/empty_string.h"
+#include "common/http/conn_manager_impl.h"
+#include "common/http/context_impl.h"
+#include "common/http/date_provider_impl.h"
+#include "common/http/header_map_impl.h"
+#include "common/http/request_id_extension_impl.h"
+#include "common/memory/stats.h"
+#include "common/network/address_impl.h"
+#include "common/stats/isolated_store_impl.h"
+#include "common/stats/symbol_table_creator.h"
+
+#include "test/mocks/http/mocks.h"
+#include "test/mocks/local_info/mocks.h"
+#include "test/mocks/network/mocks.h"
+#include "test/mocks/runtime/mocks.h"
+#include "test/mocks/tracing/mocks.h"
+#include "test/mocks/upstream/mocks.h"
+#include "test/test_common/allocation_counter.h"
+#include "test/test_common/simulated_time_system.h"
+#include "test/test_common/utility.h"
+
+#include "benchmark/benchmark.h"
+
+namespace Envoy {
+namespace Http {
+namespace {
+
+// Stands in for the router filter, which is the only filter in the chain. Depending on
+// respond_, it either replies to the request as soon as the headers are received or leaves the
+// stream open.
+class BenchmarkDecoderFilter : public StreamDecoderFilter {
+public:
+  explicit BenchmarkDecoderFilter(bool respond) : respond_(respond) {}
+
+  // Http::StreamFilterBase
+  void onDestroy() override {}
+
+  // Http::StreamDecoderFilter
+  FilterHeadersStatus decodeHeaders(RequestHeaderMap&, bool) override {
+    if (respond_) {
+      decoder_callbacks_->encodeHeaders(
+          createHeaderMap<ResponseHeaderMapImpl>({{Headers::get().Status, "200"}}), true);
+    }
+    return FilterHeadersStatus::StopIteration;
+  }
+  FilterDataStatus decodeData(Buffer::Instance&, bool) override {
+    return FilterDataStatus::StopIterationNoBuffer;
+  }
+  FilterTrailersStatus decodeTrailers(RequestTrailerMap&) override {
+    return FilterTrailersStatus::StopIteration;
+  }
+  void setDecoderFilterCallbacks(StreamDecoderFilterCallbacks& callbacks) override {
+    decoder_callbacks_ = &callbacks;
+  }
+
+private:
+  const bool respond_;
+  StreamDecoderFilterCallbacks* decoder_callbacks_{};
+};
+
+class BenchmarkFilterChainFactory : public FilterChainFactory {
+public:
+  // Http::FilterChainFactory
+  void createFilterChain(FilterChainFactoryCallbacks& callbacks) override {
+    callbacks.addStreamDecoderFilter(std::make_shared<BenchmarkDecoderFilter>(respond_));
+  }
+  bool createUpgradeFilterChain(absl::string_view, const UpgradeMap*,
+                                FilterChainFactoryCallbacks&) override {
+    return false;
+  }
+
+  bool respond_{true};
+};
+
+// A response encoder which discards everything written to it.
+class BenchmarkResponseEncoder : public ResponseEncoder, public Stream {
+public:
+  // Http::StreamEncoder
+  void encodeData(Buffer::Instance& data, bool) override { data.drain(data.length()); }
+  Stream& getStream() override { return *this; }
+  void encodeMetadata(const MetadataMapVector&) override {}
+  Http1StreamEncoderOptionsOptRef http1StreamEncoderOptions() override { return absl::nullopt; }
+
+  // Http::ResponseEncoder
+  void encode100ContinueHeaders(const ResponseHeaderMap&) override {}
+  void encodeHeaders(const ResponseHeaderMap&, bool) override {}
+  void encodeTrailers(const ResponseTrailerMap&) override {}
+
+  // Http::Stream
+  void addCallbacks(StreamCallbacks&) override {}
+  void removeCallbacks(StreamCallbacks&) override {}
+  void resetStream(StreamResetReason) override {}
+  void readDisable(bool) override {}
+  uint32_t bufferLimit() override { return 0; }
+  const Network::Address::InstanceConstSharedPtr& connectionLocalAddress() override {
+    return local_address_;
+  }
+
+  Network::Address::InstanceConstSharedPtr local_address_{
+      std::make_shared<Network::Address::Ipv4Instance>("127.0.0.1")};
+};
+
+// A codec which starts one header-only request per dispatch, in place of parsing the dispatched
+// data.
+class BenchmarkServerConnection : public ServerConnection {
+public:
+  explicit BenchmarkServerConnection(ServerConnectionCallbacks& callbacks)
+      : callbacks_(callbacks) {}
+
+  // Http::Connection
+  void dispatch(Buffer::Instance& data) override {
+    data.drain(data.length());
+    RequestDecoder& decoder = callbacks_.newStream(response_encoder_);
+    decoder.decodeHeaders(createHeaderMap<RequestHeaderMapImpl>(request_headers_), true);
+  }
+  void goAway() override {}
+  Protocol protocol() override { return Protocol::Http2; }
+  void shutdownNotice() override {}
+  bool wantsToWrite() override { return false; }
+  void onUnderlyingConnectionAboveWriteBufferHighWatermark() override {}
+  void onUnderlyingConnectionBelowWriteBufferLowWatermark() override {}
+
+  ServerConnectionCallbacks& callbacks_;
+  BenchmarkResponseEncoder response_encoder_;
+  const TestRequestHeaderMapImpl request_headers_{
+      {":method", "GET"}, {":path", "/"}, {":scheme", "http"}, {":authority", "host"}};
+};
+
+class BenchmarkConfig : public ConnectionManagerConfig {
+public:
+  BenchmarkConfig()
+      : stats_({ALL_HTTP_CONN_MAN_STATS(POOL_COUNTER(fake_stats_), POOL_GAUGE(fake_stats_),
+                                        POOL_HISTOGRAM(fake_stats_))},
+               "", fake_stats_),
+        tracing_stats_{CONN_MAN_TRACING_STATS(POOL_COUNTER(fake_stats_))},
+        listener_stats_{CONN_MAN_LISTENER_STATS(POOL_COUNTER(fake_stats_))} {
+    request_id_extension_ = RequestIDExtensionFactory::defaultInstance(random_);
+  }
+
+  // Http::ConnectionManagerConfig
+  RequestIDExtensionSharedPtr requestIDExtension() override { return request_id_extension_; }
+  const std::list<AccessLog::InstanceSharedPtr>& accessLogs() override { return access_logs_; }
+  ServerConnectionPtr createCodec(Network::Connection&, const Buffer::Instance&,
+                                  ServerConnectionCallbacks& callbacks) override {
+    return std::make_unique<BenchmarkServerConnection>(callbacks);
+  }
+  DateProvider& dateProvider() override { return date_provider_; }
+  std::chrono::milliseconds drainTimeout() const override { return std::chrono::milliseconds(100); }
+  FilterChainFactory& filterFactory() override { return filter_factory_; }
+  bool generateRequestId() const override { return false; }
+  bool preserveExternalRequestId() const override { return false; }
+  bool alwaysSetRequestIdInResponse() const override { return false; }
+  uint32_t maxRequestHeadersKb() const override { return Http::DEFAULT_MAX_REQUEST_HEADERS_KB; }
+  uint32_t maxRequestHeadersCount() const override { return Http::DEFAULT_MAX_HEADERS_COUNT; }
+  absl::optional<std::chrono::milliseconds> idleTimeout() const override { return absl::nullopt; }
+  bool isRoutable() const override { return false; }
+  absl::optional<std::chrono::milliseconds> maxConnectionDuration() const override {
+    return absl::nullopt;
+  }
+  absl::optional<std::chrono::milliseconds> maxStreamDuration() const override {
+    return absl::nullopt;
+  }
+  std::chrono::milliseconds streamIdleTimeout() const override { return {}; }
+  std::chrono::milliseconds requestTimeout() const override { return {}; }
+  std::chrono::milliseconds delayedCloseTimeout() const override { return {}; }
+  Router::RouteConfigProvider* routeConfigProvider() override { return nullptr; }
+  Config::ConfigProvider* scopedRouteConfigProvider() override { return nullptr; }
+  const std::string& serverName() const override { return server_name_; }
+  HttpConnectionManagerProto::ServerHeaderTransformation
+  serverHeaderTransformation() const override {
+    return HttpConnectionManagerProto::OVERWRITE;
+  }
+  ConnectionManagerStats& stats() override { return stats_; }
+  ConnectionManagerTracingStats& tracingStats() override { return tracing_stats_; }
+  bool useRemoteAddress() const override { return true; }
+  const Http::InternalAddressConfig& internalAddressConfig() const override {
+    return internal_address_config_;
+  }
+  uint32_t xffNumTrustedHops() const override { return 0; }
+  bool skipXffAppend() const override { return false; }
+  const std::string& via() const override { return EMPTY_STRING; }
+  Http::ForwardClientCertType forwardClientCert() const override {
+    return Http::ForwardClientCertType::Sanitize;
+  }
+  const std::vector<Http::ClientCertDetailsType>& setCurrentClientCertDetails() const override {
+    return set_current_client_cert_details_;
+  }
+  const Network::Address::Instance& localAddress() override { return local_address_; }
+  const absl::optional<std::string>& userAgent() override { return user_agent_; }
+  Tracing::HttpTracerSharedPtr tracer() override { return http_tracer_; }
+  const TracingConnectionManagerConfig* tracingConfig() override { return nullptr; }
+  ConnectionManagerListenerStats& listenerStats() override { return listener_stats_; }
+  bool proxy100Continue() const override { return false; }
+  const Http::Http1Settings& http1Settings() const override { return http1_settings_; }
+  bool shouldNormalizePath() const override { return false; }
+  bool shouldMergeSlashes() const override { return false; }
+  envoy::config::core::v3::HttpProtocolOptions::HeadersWithUnderscoresAction
+  headersWithUnderscoresAction() const override {
+    return envoy::config::core::v3::HttpProtocolOptions::ALLOW;
+  }
+
+  testing::NiceMock<Runtime::MockRandomGenerator> random_;
+  RequestIDExtensionSharedPtr request_id_extension_;
+  std::list<AccessLog::InstanceSharedPtr> access_logs_;
+  BenchmarkFilterChainFactory filter_factory_;
+  Event::SimulatedTimeSystem time_system_;
+  SlowDateProviderImpl date_provider_{time_system_};
+  std::string server_name_{"envoy"};
+  Stats::IsolatedStoreImpl fake_stats_;
+  ConnectionManagerStats stats_;
+  ConnectionManagerTracingStats tracing_stats_;
+  ConnectionManagerListenerStats listener_stats_;
+  std::vector<Http::ClientCertDetailsType> set_current_client_cert_details_;
+  Network::Address::Ipv4Instance local_address_{"127.0.0.1"};
+  absl::optional<std::string> user_agent_;
+  Tracing::HttpTracerSharedPtr http_tracer_{
+      std::make_shared<testing::NiceMock<Tracing::MockHttpTracer>>()};
+  Http::Http1Settings http1_settings_;
+  Http::DefaultInternalAddressConfig internal_address_config_;
+};
+
+// Drives a connection manager whose filter chain holds a single router-like filter.
+class ConnectionManagerBenchmark {
+public:
+  ConnectionManagerBenchmark()
+      : symbol_table_(Stats::SymbolTableCreator::makeSymbolTable()),
+        http_context_(*symbol_table_),
+        conn_manager_(config_, drain_close_, random_, http_context_, runtime_, local_info_,
+                      cluster_manager_, nullptr, config_.time_system_) {
+    // The dispatcher mock is not a NiceMock, so silence the warnings about the calls made to it.
+    testing::GMOCK_FLAG(verbose) = "error";
+    filter_callbacks_.connection_.local_address_ =
+        std::make_shared<Network::Address::Ipv4Instance>("127.0.0.1");
+    filter_callbacks_.connection_.remote_address_ =
+        std::make_shared<Network::Address::Ipv4Instance>("10.0.0.1");
+    conn_manager_.initializeReadFilterCallbacks(filter_callbacks_);
+  }
+
+  // Starts a request, which is answered by the filter if it was created with respond set.
+  void newRequest() {
+    Buffer::OwnedImpl data("x");
+    conn_manager_.onData(data, false);
+  }
+
+  // Destroys the streams which have ended, as the dispatcher would at the end of a loop
+  // iteration.
+  void clearDeferredDeleteList() { filter_callbacks_.connection_.dispatcher_.to_delete_.clear(); }
+
+  BenchmarkConfig config_;
+  testing::NiceMock<Network::MockDrainDecision> drain_close_;
+  testing::NiceMock<Runtime::MockRandomGenerator> random_;
+  Stats::SymbolTablePtr symbol_table_;
+  Http::ContextImpl http_context_;
+  testing::NiceMock<Runtime::MockLoader> runtime_;
+  testing::NiceMock<LocalInfo::MockLocalInfo> local_info_;
+  testing::NiceMock<Upstream::MockClusterManager> cluster_manager_;
+  testing::NiceMock<Network::MockReadFilterCallbacks> filter_callbacks_;
+  ConnectionManagerImpl conn_manager_;
+};
+
+// Measures the time taken by a header-only request which is answered by the only filter in the
+// chain, and the heap allocations it makes when the build supports counting them.
+static void BM_HeaderOnlyRequest(benchmark::State& state) {
+  ConnectionManagerBenchmark benchmark;
+  // The first request creates the codec and fills the per-thread pools, so it is not counted.
+  benchmark.newRequest();
+  benchmark.clearDeferredDeleteList();
+  AllocationCounter counter;
+  for (auto _ : state) {
+    benchmark.newRequest();
+    benchmark.clearDeferredDeleteList();
+  }
+  if (AllocationCounter::supported()) {
+    state.counters["allocations_per_request"] =
+        static_cast<double>(counter.allocations()) / state.iterations();
+  }
+}
+BENCHMARK(BM_HeaderOnlyRequest);
+
+// Measures the memory held by each open stream. The memory counter is only reported when the
+// build supports memory accounting.
+static void BM_ActiveStreamMemory(benchmark::State& state) {
+  const uint64_t streams = state.range(0);
+  uint64_t bytes_per_stream = 0;
+  for (auto _ : state) {
+    ConnectionManagerBenchmark benchmark;
+    benchmark.config_.filter_factory_.respond_ = false;
+    // The first request creates the codec, so it is not counted.
+    benchmark.newRequest();
+    const uint64_t memory_start = Memory::Stats::totalCurrentlyAllocated();
+    for (uint64_t i = 0; i < streams; i++) {
+      benchmark.newRequest();
+    }
+    bytes_per_stream = (Memory::Stats::totalCurrentlyAllocated() - memory_start) / streams;
+    benchmark.conn_manager_.onEvent(Network::ConnectionEvent::RemoteClose);
+    benchmark.clearDeferredDeleteList();
+  }
+  state.counters["bytes_per_stream"] = bytes_per_stream;
+}
+BENCHMARK(BM_ActiveStreamMemory)->Arg(1000);
+
+} // namespace
+} // namespace Http
+} // namespace Envoy
@@ -1,5 +1,7 @@
 #include "common/http/header_map_impl.h"
 
+#include "test/test_common/allocation_counter.h"
+
 #include "benchmark/benchmark.h"
 
 namespace Envoy {
@@ -195,7 +197,8 @@ BENCHMARK(HeaderMapImplRemoveInline)->Arg(0)->Arg(1)->Arg(10)->Arg(50);
 
 /**
  * Measure the speed of creating a HeaderMapImpl and populating it with a realistic
- * set of response headers.
+ * set of response headers, and the heap allocations this makes when the build supports
+ * counting them.
  */
 static void HeaderMapImplPopulate(benchmark::State& state) {
   const std::pair<LowerCaseString, std::string> headers_to_add[] = {
@@ -210,6 +213,7 @@ static void HeaderMapImplPopulate(benchmark::State& state) {
       {LowerCaseString("set-cookie"), "_cookie1=12345678; path = /; secure"},
       {LowerCaseString("set-cookie"), "_cookie2=12345678; path = /; secure"},
   };
+  AllocationCounter counter;
   for (auto _ : state) {
     HeaderMapImpl headers;
     for (const auto& key_value : headers_to_add) {
@@ -217,6 +221,10 @@ static void HeaderMapImplPopulate(benchmark::State& state) {
     }
     benchmark::DoNotOptimize(headers.size());
   }
+  if (AllocationCounter::supported()) {
+    state.counters["allocations_per_map"] =
+        static_cast<double>(counter.allocations()) / state.iterations();
+  }
 }
 BENCHMARK(HeaderMapImplPopulate);
 
@@ -475,6 +475,16 @@ TEST(HeaderIsValidTest, IsConnect) {
   EXPECT_FALSE(HeaderUtility::isConnect(Http::TestRequestHeaderMapImpl{}));
 }
 
+TEST(HeaderIsValidTest, IsIdempotent) {
+  for (const char* method : {"GET", "HEAD", "OPTIONS", "TRACE", "PUT", "DELETE"}) {
+    EXPECT_TRUE(HeaderUtility::isIdempotent(Http::TestRequestHeaderMapImpl{{":method", method}}));
+  }
+  for (const char* method : {"POST", "PATCH", "CONNECT", "get"}) {
+    EXPECT_FALSE(HeaderUtility::isIdempotent(Http::TestRequestHeaderMapImpl{{":method", method}}));
+  }
+  EXPECT_FALSE(HeaderUtility::isIdempotent(Http::TestRequestHeaderMapImpl{}));
+}
+
 TEST(HeaderAddTest, HeaderAdd) {
   TestHeaderMapImpl headers{{"myheader1", "123value"}};
   TestHeaderMapImpl headers_to_add{{"myheader2", "456value"}};
@@ -1,4 +1,5 @@
 #include <memory>
+#include <sstream>
 #include <string>
 
 #include "envoy/buffer/buffer.h"
@@ -1698,6 +1699,174 @@ TEST_F(Http1ServerConnectionImplTest, WatermarkTest) {
       ->onUnderlyingConnectionBelowWriteBufferLowWatermark();
 }
 
+// Everything observable about dispatching a sequence of requests.
+struct DispatchResult {
+  bool operator==(const DispatchResult& other) const {
+    return decoded_ == other.decoded_ && error_ == other.error_ && output_ == other.output_ &&
+           details_ == other.details_;
+  }
+
+  // Decoded headers, body data and trailers of all of the requests.
+  std::string decoded_;
+  std::string error_;
+  std::string output_;
+  std::string details_;
+};
+
+std::ostream& operator<<(std::ostream& os, const DispatchResult& result) {
+  return os << "decoded:\n"
+            << result.decoded_ << "error: " << result.error_ << "\noutput: " << result.output_
+            << "\ndetails: " << result.details_;
+}
+
+// Runs requests through both parser backends and checks that they are decoded identically.
+class Http1ServerConnectionImplParserBackendTest : public Http1ServerConnectionImplTest {
+public:
+  static std::string toString(const HeaderMap& headers) {
+    std::ostringstream os;
+    os << headers;
+    return os.str();
+  }
+
+  DispatchResult dispatchWithBackend(Http1Settings::ParserBackend backend,
+                                     Buffer::Instance& buffer) {
+    codec_settings_.parser_backend_ = backend;
+    initialize();
+
+    DispatchResult result;
+    NiceMock<MockRequestDecoder> decoder;
+    ResponseEncoder* response_encoder = nullptr;
+    bool request_complete = false;
+    ON_CALL(connection_, write(_, _)).WillByDefault(AddBufferToString(&result.output_));
+    ON_CALL(callbacks_, newStream(_, _))
+        .WillByDefault(Invoke([&](ResponseEncoder& encoder, bool) -> RequestDecoder& {
+          response_encoder = &encoder;
+          request_complete = false;
+          return decoder;
+        }));
+    ON_CALL(decoder, decodeHeaders_(_, _))
+        .WillByDefault(Invoke([&](RequestHeaderMapPtr& headers, bool end_stream) {
+          result.decoded_ += absl::StrCat("headers:\n", toString(*headers));
+          request_complete = end_stream;
+        }));
+    ON_CALL(decoder, decodeData(_, _))
+        .WillByDefault(Invoke([&](Buffer::Instance& data, bool end_stream) {
+          result.decoded_ += absl::StrCat("data: ", data.toString(), "\n");
+          request_complete = end_stream;
+        }));
+    ON_CALL(decoder, decodeTrailers_(_)).WillByDefault(Invoke([&](RequestTrailerMapPtr& trailers) {
+      result.decoded_ += absl::StrCat("trailers:\n", toString(*trailers));
+      request_complete = true;
+    }));
+
+    try {
+      // The codec stops after each request, so keep dispatching while it makes progress and
+      // complete each request with a response.
+      uint64_t length;
+      do {
+        length = buffer.length();
+        codec_->dispatch(buffer);
+        if (request_complete) {
+          response_encoder->encodeHeaders(TestResponseHeaderMapImpl{{":status", "200"}}, true);
+          request_complete = false;
+        }
+      } while (buffer.length() > 0 && buffer.length() < length);
+    } catch (const CodecProtocolException& e) {
+      result.error_ = e.what();
+    }
+    if (response_encoder != nullptr) {
+      result.details_ = std::string(response_encoder->getStream().responseDetails());
+    }
+    return result;
+  }
+
+  void expectIdenticalResults(absl::string_view request) {
+    Buffer::OwnedImpl http_parser_buffer(request);
+    const DispatchResult http_parser_result =
+        dispatchWithBackend(Http1Settings::ParserBackend::HttpParser, http_parser_buffer);
+    Buffer::OwnedImpl head_scanner_buffer(request);
+    const DispatchResult head_scanner_result =
+        dispatchWithBackend(Http1Settings::ParserBackend::HeadScanner, head_scanner_buffer);
+    EXPECT_EQ(http_parser_result, head_scanner_result) << request;
+    EXPECT_EQ(http_parser_buffer.length(), head_scanner_buffer.length()) << request;
+  }
+};
+
+TEST_F(Http1ServerConnectionImplParserBackendTest, ValidRequests) {
+  expectIdenticalResults("GET / HTTP/1.1\r\nHost: h\r\n\r\n");
+  expectIdenticalResults("GET /search?q=a+b HTTP/1.1\r\n"
+                         "Host: www.example.com\r\n"
+                         "User-Agent: Mozilla/5.0 (X11; Linux x86_64)\r\n"
+                         "Accept: text/html,application/xhtml+xml;q=0.9\r\n"
+                         "Cookie: a=b; c=d\r\n"
+                         "Empty:\r\n"
+                         "Whitespace: \t value with trailing whitespace \t\r\n"
+                         "Obs-Text: \xc3\xa9t\xc3\xa9\r\n"
+                         "\r\n");
+  expectIdenticalResults("POST / HTTP/1.1\r\nHost: h\r\nContent-Length: 5\r\n\r\nhello");
+  expectIdenticalResults("POST / HTTP/1.1\r\nHost: h\r\nContent-Length: 0\r\n\r\n");
+  expectIdenticalResults("POST / HTTP/1.1\r\nHost: h\r\nTransfer-Encoding: chunked\r\n\r\n"
+                         "5\r\nhello\r\n0\r\n\r\n");
+  expectIdenticalResults("GET / HTTP/1.1\r\nHost: h\r\n\r\nGET /second HTTP/1.1\r\nHost: h\r\n\r\n");
+  expectIdenticalResults("POST / HTTP/1.1\r\nHost: h\r\nContent-Length: 5\r\n\r\nhello\r\n"
+                         "GET /second HTTP/1.1\r\nHost: h\r\n\r\n");
+  expectIdenticalResults("GET / HTTP/1.1\r\nHost: h\r\nConnection: Upgrade\r\n"
+                         "Upgrade: websocket\r\n\r\nupgrade payload");
+  expectIdenticalResults("CONNECT host:443 HTTP/1.1\r\n\r\nconnect payload");
+  expectIdenticalResults("OPTIONS * HTTP/1.1\r\nHost: h\r\n\r\n");
+  // Heads which are parsed by http_parser alone.
+  expectIdenticalResults("\r\nGET / HTTP/1.1\r\nHost: h\r\n\r\n");
+  expectIdenticalResults("GET / HTTP/1.1\nHost: h\n\n");
+  expectIdenticalResults("GET / HTTP/1.1\r\nHost: h\r\nx_y: z\r\n\r\n");
+  expectIdenticalResults("GET / HTTP/1.1\r\nHost: h\r\nFolded: a\r\n b\r\n\r\n");
+}
+
+TEST_F(Http1ServerConnectionImplParserBackendTest, InvalidRequests) {
+  expectIdenticalResults("GET / HTTP/1.0\r\n\r\n");
+  expectIdenticalResults("FOO / HTTP/1.1\r\nHost: h\r\n\r\n");
+  expectIdenticalResults("GET /a\x01 HTTP/1.1\r\nHost: h\r\n\r\n");
+  expectIdenticalResults("GET / HTTP/1.1\r\nHost: h\x01\r\n\r\n");
+  expectIdenticalResults("GET / HTTP/1.1\r\nHost: h\r\nContent-Length: 5\r\n"
+                         "Content-Length: 6\r\n\r\n");
+  expectIdenticalResults("GET / HTTP/1.1\r\nHost: h\r\nContent-Length: five\r\n\r\n");
+  expectIdenticalResults("GET / HTTP/1.1\r\nHost: h\r\nTransfer-Encoding: chunked\r\n"
+                         "Content-Length: 5\r\n\r\n");
+  expectIdenticalResults("GET / HTTP/1.1\r\nHost: h\r\nTransfer-Encoding: gzip\r\n\r\n");
+  expectIdenticalResults("POST / HTTP/1.1\r\nHost: h\r\nTransfer-Encoding: chunked\r\n\r\n"
+                         "zz\r\nhello\r\n");
+  expectIdenticalResults("GET / HTTP/1.1\r\nHost: h\r\nConnection: a,b,c,d,e,f,g,h,i,j,k,l,m\r\n"
+                         "\r\n");
+  expectIdenticalResults("GET / HTTP/1.1\r\nHost: h\r\nConnection: close\r\n\r\n"
+                         "GET / HTTP/1.1\r\nHost: h\r\n\r\n");
+  expectIdenticalResults("GET / HTTP/1.1\r\nHost: h\r\nbad header: v\r\n\r\n");
+}
+
+TEST_F(Http1ServerConnectionImplParserBackendTest, Limits) {
+  max_request_headers_count_ = 3;
+  expectIdenticalResults("GET / HTTP/1.1\r\nHost: h\r\na: 1\r\nb: 2\r\n\r\n");
+  expectIdenticalResults("GET / HTTP/1.1\r\nHost: h\r\na: 1\r\nb: 2\r\nc: 3\r\n\r\n");
+  max_request_headers_count_ = Http::DEFAULT_MAX_HEADERS_COUNT;
+
+  max_request_headers_kb_ = 1;
+  expectIdenticalResults(
+      absl::StrCat("GET / HTTP/1.1\r\nHost: h\r\nBig: ", std::string(900, 'a'), "\r\n\r\n"));
+  expectIdenticalResults(absl::StrCat("GET / HTTP/1.1\r\nHost: h\r\nBig: ", std::string(1024, 'a'),
+                                      "\r\nContent-Length: x\r\n\r\n"));
+}
+
+// Heads split across slices are left to http_parser.
+TEST_F(Http1ServerConnectionImplParserBackendTest, SplitHeads) {
+  const std::string request = "POST / HTTP/1.1\r\nHost: h\r\nContent-Length: 5\r\n\r\nhello"
+                              "GET /second HTTP/1.1\r\nHost: h\r\n\r\n";
+  for (size_t slice_size : {1, 7, 40, 54}) {
+    Buffer::OwnedImpl http_parser_buffer = createBufferWithNByteSlices(request, slice_size);
+    Buffer::OwnedImpl head_scanner_buffer = createBufferWithNByteSlices(request, slice_size);
+    EXPECT_EQ(dispatchWithBackend(Http1Settings::ParserBackend::HttpParser, http_parser_buffer),
+              dispatchWithBackend(Http1Settings::ParserBackend::HeadScanner, head_scanner_buffer))
+        << slice_size;
+  }
+}
+
 class Http1ClientConnectionImplTest : public testing::Test {
 public:
   void initialize() {
@@ -1771,6 +1940,99 @@ TEST_F(Http1ClientConnectionImplTest, Reset) {
   request_encoder.getStream().resetStream(StreamResetReason::LocalReset);
 }
 
+TEST_F(Http1ClientConnectionImplTest, PipelinedRequests) {
+  initialize();
+
+  InSequence s;
+
+  std::string output;
+  ON_CALL(connection_, write(_, _)).WillByDefault(AddBufferToString(&output));
+
+  TestRequestHeaderMapImpl headers{{":method", "GET"}, {":path", "/"}, {":authority", "host"}};
+  NiceMock<MockResponseDecoder> response_decoder1;
+  codec_->newStream(response_decoder1).encodeHeaders(headers, true);
+  NiceMock<MockResponseDecoder> response_decoder2;
+  codec_->newStream(response_decoder2).encodeHeaders(headers, true);
+  EXPECT_EQ("GET / HTTP/1.1\r\nhost: host\r\ncontent-length: 0\r\n\r\n"
+            "GET / HTTP/1.1\r\nhost: host\r\ncontent-length: 0\r\n\r\n",
+            output);
+
+  // Responses are delivered in the order the requests were sent, even within a single read.
+  EXPECT_CALL(response_decoder1, decodeHeaders_(HeaderHasValueRef(":status", "200"), false));
+  EXPECT_CALL(response_decoder1, decodeData(BufferStringEqual("hello"), false));
+  EXPECT_CALL(response_decoder1, decodeData(BufferStringEqual(""), true));
+  EXPECT_CALL(response_decoder2, decodeHeaders_(HeaderHasValueRef(":status", "404"), true));
+  Buffer::OwnedImpl response("HTTP/1.1 200 OK\r\nContent-Length: 5\r\n\r\nhello"
+                             "HTTP/1.1 404 Not Found\r\nContent-Length: 0\r\n\r\n");
+  codec_->dispatch(response);
+
+  // Both responses are complete, so a third one is premature.
+  Buffer::OwnedImpl response3("HTTP/1.1 400 Bad Request\r\nContent-Length: 0\r\n\r\n");
+  EXPECT_THROW(codec_->dispatch(response3), PrematureResponseException);
+}
+
+// Verify that pipelined requests which have not been answered are reset as refused streams when
+// the connection is reset.
+TEST_F(Http1ClientConnectionImplTest, PipelinedRequestsReset) {
+  initialize();
+
+  TestRequestHeaderMapImpl headers{{":method", "GET"}, {":path", "/"}, {":authority", "host"}};
+  NiceMock<MockResponseDecoder> response_decoder1;
+  Http::RequestEncoder& request_encoder1 = codec_->newStream(response_decoder1);
+  request_encoder1.encodeHeaders(headers, true);
+  NiceMock<MockResponseDecoder> response_decoder2;
+  Http::RequestEncoder& request_encoder2 = codec_->newStream(response_decoder2);
+  request_encoder2.encodeHeaders(headers, true);
+  NiceMock<MockResponseDecoder> response_decoder3;
+  Http::RequestEncoder& request_encoder3 = codec_->newStream(response_decoder3);
+  request_encoder3.encodeHeaders(headers, true);
+
+  Http::MockStreamCallbacks callbacks1;
+  request_encoder1.getStream().addCallbacks(callbacks1);
+  Http::MockStreamCallbacks callbacks2;
+  request_encoder2.getStream().addCallbacks(callbacks2);
+  Http::MockStreamCallbacks callbacks3;
+  request_encoder3.getStream().addCallbacks(callbacks3);
+
+  // The first response completes, and the connection is closed while its callbacks run. The reset
+  // reaches the remaining streams once, however many of them are reset by the closing code.
+  EXPECT_CALL(response_decoder1, decodeHeaders_(_, true))
+      .WillOnce(Invoke([&](ResponseHeaderMapPtr&, bool) {
+        EXPECT_CALL(callbacks2, onResetStream(StreamResetReason::RemoteRefusedStreamReset, _))
+            .WillOnce(Invoke([&](StreamResetReason, absl::string_view) {
+              request_encoder3.getStream().resetStream(StreamResetReason::ConnectionTermination);
+            }));
+        EXPECT_CALL(callbacks3, onResetStream(StreamResetReason::RemoteRefusedStreamReset, _));
+        request_encoder2.getStream().resetStream(StreamResetReason::ConnectionTermination);
+      }));
+  EXPECT_CALL(callbacks1, onResetStream(_, _)).Times(0);
+  Buffer::OwnedImpl response("HTTP/1.1 200 OK\r\nContent-Length: 0\r\n\r\n");
+  codec_->dispatch(response);
+}
+
+// Verify that the response being received is reset as the connection is when a pipelined request
+// is reset.
+TEST_F(Http1ClientConnectionImplTest, PipelinedRequestResetByUser) {
+  initialize();
+
+  TestRequestHeaderMapImpl headers{{":method", "GET"}, {":path", "/"}, {":authority", "host"}};
+  NiceMock<MockResponseDecoder> response_decoder1;
+  Http::RequestEncoder& request_encoder1 = codec_->newStream(response_decoder1);
+  request_encoder1.encodeHeaders(headers, true);
+  NiceMock<MockResponseDecoder> response_decoder2;
+  Http::RequestEncoder& request_encoder2 = codec_->newStream(response_decoder2);
+  request_encoder2.encodeHeaders(headers, true);
+
+  Http::MockStreamCallbacks callbacks1;
+  request_encoder1.getStream().addCallbacks(callbacks1);
+  Http::MockStreamCallbacks callbacks2;
+  request_encoder2.getStream().addCallbacks(callbacks2);
+
+  EXPECT_CALL(callbacks1, onResetStream(StreamResetReason::ConnectionTermination, _));
+  EXPECT_CALL(callbacks2, onResetStream(StreamResetReason::RemoteRefusedStreamReset, _));
+  request_encoder2.getStream().resetStream(StreamResetReason::LocalReset);
+}
+
 // Verify that we correctly enable reads on the connection when the final response is
 // received.
 TEST_F(Http1ClientConnectionImplTest, FlowControlReadDisabledReenable) {
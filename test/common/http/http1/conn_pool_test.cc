@@ -148,7 +148,8 @@ public:
 struct ActiveTestRequest {
   enum class Type { Pending, CreateConnection, Immediate };
 
-  ActiveTestRequest(Http1ConnPoolImplTest& parent, size_t client_index, Type type)
+  ActiveTestRequest(Http1ConnPoolImplTest& parent, size_t client_index, Type type,
+                    bool pipelinable = false)
       : parent_(parent), client_index_(client_index) {
     uint64_t active_rq_observed =
         parent_.cluster_->resourceManager(Upstream::ResourcePriority::Default).requests().count();
@@ -161,7 +162,8 @@ struct ActiveTestRequest {
       expectNewStream();
     }
 
-    handle_ = parent.conn_pool_.newStream(outer_decoder_, callbacks_);
+    handle_ = pipelinable ? parent.conn_pool_.newPipelinableStream(outer_decoder_, callbacks_)
+                          : parent.conn_pool_.newStream(outer_decoder_, callbacks_);
 
     if (type == Type::Immediate) {
       EXPECT_EQ(nullptr, handle_);
@@ -833,6 +835,164 @@ TEST_F(Http1ConnPoolImplTest, ConcurrentConnections) {
   EXPECT_EQ(2U, cluster_->stats_.upstream_cx_destroy_remote_.value());
 }
 
+/**
+ * Test that a preconnect ratio establishes spare connections ahead of demand and tracks whether
+ * they were used.
+ */
+TEST_F(Http1ConnPoolImplTest, Preconnect) {
+  cluster_->resetResourceManager(3, 1024, 1024, 1, 1);
+  ON_CALL(*cluster_, perUpstreamPreconnectRatio()).WillByDefault(Return(1.5));
+  InSequence s;
+
+  // The first request needs one connection and anticipates a second.
+  conn_pool_.expectClientCreate();
+  conn_pool_.expectClientCreate();
+  ActiveTestRequest r1(*this, 0, ActiveTestRequest::Type::Pending);
+  EXPECT_EQ(1U, cluster_->stats_.upstream_cx_preconnect_total_.value());
+
+  r1.expectNewStream();
+  EXPECT_CALL(*conn_pool_.test_clients_[0].connect_timer_, disableTimer());
+  conn_pool_.test_clients_[0].connection_->raiseEvent(Network::ConnectionEvent::Connected);
+  r1.startRequest();
+
+  EXPECT_CALL(*conn_pool_.test_clients_[1].connect_timer_, disableTimer());
+  conn_pool_.test_clients_[1].connection_->raiseEvent(Network::ConnectionEvent::Connected);
+  EXPECT_EQ(0U, cluster_->stats_.upstream_cx_preconnect_used_.value());
+
+  // A second request is served immediately by the warm connection, and a third connection is
+  // anticipated.
+  NiceMock<MockResponseDecoder> outer_decoder;
+  ConnPoolCallbacks callbacks;
+  NiceMock<MockRequestEncoder> request_encoder;
+  EXPECT_CALL(*conn_pool_.test_clients_[1].codec_, newStream(_))
+      .WillOnce(ReturnRef(request_encoder));
+  EXPECT_CALL(callbacks.pool_ready_, ready());
+  conn_pool_.expectClientCreate();
+  EXPECT_EQ(nullptr, conn_pool_.newStream(outer_decoder, callbacks));
+  EXPECT_EQ(1U, cluster_->stats_.upstream_cx_preconnect_used_.value());
+  EXPECT_EQ(2U, cluster_->stats_.upstream_cx_preconnect_total_.value());
+
+  // Once r1 completes its connection provides the spare capacity, so losing the still connecting
+  // spare is accounted as waste and not replaced.
+  r1.completeResponse(false);
+  EXPECT_CALL(conn_pool_, onClientDestroy());
+  conn_pool_.test_clients_[2].connection_->raiseEvent(Network::ConnectionEvent::RemoteClose);
+  dispatcher_.clearDeferredDeleteList();
+  EXPECT_EQ(1U, cluster_->stats_.upstream_cx_preconnect_unused_.value());
+}
+
+/**
+ * Test that preconnecting never exceeds the connection circuit breaker.
+ */
+TEST_F(Http1ConnPoolImplTest, PreconnectRespectsCircuitBreaker) {
+  ON_CALL(*cluster_, perUpstreamPreconnectRatio()).WillByDefault(Return(3.0));
+  InSequence s;
+
+  ActiveTestRequest r1(*this, 0, ActiveTestRequest::Type::CreateConnection);
+  r1.startRequest();
+  EXPECT_EQ(0U, cluster_->stats_.upstream_cx_preconnect_total_.value());
+  EXPECT_EQ(0U, cluster_->stats_.upstream_cx_overflow_.value());
+
+  r1.completeResponse(false);
+  EXPECT_CALL(conn_pool_, onClientDestroy());
+  conn_pool_.test_clients_[0].connection_->raiseEvent(Network::ConnectionEvent::RemoteClose);
+  dispatcher_.clearDeferredDeleteList();
+}
+
+/**
+ * Test that idempotent requests are pipelined behind each other once all connections are busy.
+ */
+TEST_F(Http1ConnPoolImplTest, PipelineRequests) {
+  cluster_->http1_settings_.max_pipeline_depth_ = 2;
+  cluster_->resetResourceManager(1, 1024, 1024, 1, 1);
+  InSequence s;
+
+  ActiveTestRequest r1(*this, 0, ActiveTestRequest::Type::CreateConnection, true);
+  r1.startRequest();
+
+  // The only connection is busy, so r2 is written behind r1.
+  ActiveTestRequest r2(*this, 0, ActiveTestRequest::Type::Immediate, true);
+  r2.startRequest();
+  EXPECT_EQ(1U, cluster_->stats_.upstream_rq_pipelined_.value());
+  EXPECT_EQ(2U, cluster_->stats_.upstream_rq_active_.value());
+
+  // The pipeline is full, so r3 waits for a connection.
+  ActiveTestRequest r3(*this, 0, ActiveTestRequest::Type::Pending, true);
+
+  // The connection stays busy until r2 is answered too.
+  conn_pool_.expectEnableUpstreamReady();
+  r1.completeResponse(false);
+  r3.expectNewStream();
+  r2.completeResponse(true);
+  conn_pool_.expectAndRunUpstreamReady();
+  r3.startRequest();
+  r3.completeResponse(false);
+  EXPECT_EQ(1U, cluster_->stats_.upstream_rq_pipelined_.value());
+
+  EXPECT_CALL(conn_pool_, onClientDestroy());
+  conn_pool_.test_clients_[0].connection_->raiseEvent(Network::ConnectionEvent::RemoteClose);
+  dispatcher_.clearDeferredDeleteList();
+}
+
+/**
+ * Test that requests are not pipelined unless enabled, and never behind requests which may not be
+ * retried.
+ */
+TEST_F(Http1ConnPoolImplTest, PipelineOnlyBehindIdempotentRequests) {
+  cluster_->resetResourceManager(1, 1024, 1024, 1, 1);
+  InSequence s;
+
+  ActiveTestRequest r1(*this, 0, ActiveTestRequest::Type::CreateConnection, true);
+  r1.startRequest();
+  // Pipelining is disabled by default.
+  ActiveTestRequest r2(*this, 0, ActiveTestRequest::Type::Pending, true);
+  r2.handle_->cancel();
+
+  cluster_->http1_settings_.max_pipeline_depth_ = 2;
+  r1.completeResponse(false);
+
+  ActiveTestRequest r3(*this, 0, ActiveTestRequest::Type::Immediate, true);
+  r3.callbacks_.outer_encoder_->encodeHeaders(
+      TestRequestHeaderMapImpl{{":path", "/"}, {":method", "POST"}}, true);
+  // r3 is not idempotent.
+  ActiveTestRequest r4(*this, 0, ActiveTestRequest::Type::Pending, true);
+  r4.handle_->cancel();
+  r3.completeResponse(false);
+  EXPECT_EQ(0U, cluster_->stats_.upstream_rq_pipelined_.value());
+
+  EXPECT_CALL(conn_pool_, onClientDestroy());
+  conn_pool_.test_clients_[0].connection_->raiseEvent(Network::ConnectionEvent::RemoteClose);
+  dispatcher_.clearDeferredDeleteList();
+}
+
+/**
+ * Test that pipelined requests are reset when the connection closes before they are answered.
+ */
+TEST_F(Http1ConnPoolImplTest, PipelinedRequestResetOnClose) {
+  cluster_->http1_settings_.max_pipeline_depth_ = 2;
+  cluster_->resetResourceManager(1, 1024, 1024, 1, 1);
+  InSequence s;
+
+  ActiveTestRequest r1(*this, 0, ActiveTestRequest::Type::CreateConnection, true);
+  r1.startRequest();
+  ActiveTestRequest r2(*this, 0, ActiveTestRequest::Type::Immediate, true);
+  r2.startRequest();
+  MockStreamCallbacks stream_callbacks;
+  r2.callbacks_.outer_encoder_->getStream().addCallbacks(stream_callbacks);
+
+  // r1 is answered with 'connection: close', so r2 is never answered.
+  EXPECT_CALL(stream_callbacks, onResetStream(_, _));
+  EXPECT_CALL(conn_pool_, onClientDestroy());
+  r1.inner_decoder_->decodeHeaders(
+      ResponseHeaderMapPtr{new TestResponseHeaderMapImpl{{":status", "200"},
+                                                         {"connection", "close"}}},
+      true);
+  dispatcher_.clearDeferredDeleteList();
+
+  EXPECT_EQ(1U, cluster_->stats_.upstream_cx_destroy_with_active_rq_.value());
+  EXPECT_EQ(0U, cluster_->stats_.upstream_rq_active_.value());
+}
+
 TEST_F(Http1ConnPoolImplTest, DrainCallback) {
   InSequence s;
   ReadyWatcher drained;
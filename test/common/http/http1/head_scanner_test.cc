@@ -0,0 +1,110 @@
+#include <string>
+
+#include "common/http/http1/head_scanner.h"
+
+#include "gtest/gtest.h"
+
+namespace Envoy {
+namespace Http {
+namespace Http1 {
+namespace {
+
+bool scan(RequestHeadScanner& scanner, absl::string_view data) {
+  return scanner.scan(data.data(), data.size());
+}
+
+TEST(RequestHeadScannerTest, Basic) {
+  RequestHeadScanner scanner;
+  const std::string request = "GET /foo HTTP/1.1\r\n"
+                              "Host: www.example.com\r\n"
+                              "Content-Length:  5 \r\n"
+                              "Empty:\r\n"
+                              "\r\n"
+                              "hello";
+  ASSERT_TRUE(scan(scanner, request));
+  EXPECT_EQ(request.size() - 5, scanner.headLength());
+  EXPECT_EQ("GET /foo HTTP/1.1\r\n", scanner.requestLine());
+
+  const auto& headers = scanner.headers();
+  ASSERT_EQ(3, headers.size());
+  EXPECT_EQ("Host", headers[0].name_);
+  EXPECT_EQ("www.example.com", headers[0].value_);
+  EXPECT_EQ("Host: www.example.com\r\n", headers[0].line_);
+  EXPECT_FALSE(headers[0].framing_);
+  EXPECT_EQ("Content-Length", headers[1].name_);
+  EXPECT_EQ("5 ", headers[1].value_);
+  EXPECT_TRUE(headers[1].framing_);
+  EXPECT_EQ("Empty", headers[2].name_);
+  EXPECT_EQ("", headers[2].value_);
+}
+
+TEST(RequestHeadScannerTest, FramingHeaders) {
+  RequestHeadScanner scanner;
+  ASSERT_TRUE(scan(scanner, "GET / HTTP/1.0\r\n"
+                            "connection: close\r\n"
+                            "PROXY-CONNECTION: keep-alive\r\n"
+                            "Transfer-Encoding: chunked\r\n"
+                            "Upgrade: websocket\r\n"
+                            "Content-Type: text/plain\r\n"
+                            "\r\n"));
+  const auto& headers = scanner.headers();
+  ASSERT_EQ(5, headers.size());
+  EXPECT_TRUE(headers[0].framing_);
+  EXPECT_TRUE(headers[1].framing_);
+  EXPECT_TRUE(headers[2].framing_);
+  EXPECT_TRUE(headers[3].framing_);
+  EXPECT_FALSE(headers[4].framing_);
+}
+
+// Heads which are not in the common form are left to http_parser.
+TEST(RequestHeadScannerTest, Rejected) {
+  RequestHeadScanner scanner;
+  // Incomplete.
+  EXPECT_FALSE(scan(scanner, ""));
+  EXPECT_FALSE(scan(scanner, "GET / HTTP/1.1\r\n"));
+  EXPECT_FALSE(scan(scanner, "GET / HTTP/1.1\r\nHost: a\r\n"));
+  EXPECT_FALSE(scan(scanner, "GET / HTTP/1.1\r\nHost: a\r\n\r"));
+  // Request line.
+  EXPECT_FALSE(scan(scanner, "\r\nGET / HTTP/1.1\r\n\r\n"));
+  EXPECT_FALSE(scan(scanner, "GET / HTTP/2.0\r\n\r\n"));
+  EXPECT_FALSE(scan(scanner, "GET /\r\n\r\n"));
+  // Bare LF line endings.
+  EXPECT_FALSE(scan(scanner, "GET / HTTP/1.1\nHost: a\r\n\r\n"));
+  EXPECT_FALSE(scan(scanner, "GET / HTTP/1.1\r\nHost: a\n\r\n"));
+  EXPECT_FALSE(scan(scanner, "GET / HTTP/1.1\r\nHost: a\r\n\n"));
+  // Obsolete line folding.
+  EXPECT_FALSE(scan(scanner, "GET / HTTP/1.1\r\nHost: a\r\n b\r\n\r\n"));
+  // Header names.
+  EXPECT_FALSE(scan(scanner, "GET / HTTP/1.1\r\n: a\r\n\r\n"));
+  EXPECT_FALSE(scan(scanner, "GET / HTTP/1.1\r\nHost : a\r\n\r\n"));
+  EXPECT_FALSE(scan(scanner, "GET / HTTP/1.1\r\nx_y: a\r\n\r\n"));
+  EXPECT_FALSE(scan(scanner, "GET / HTTP/1.1\r\nHost\r\n\r\n"));
+  // Header values.
+  EXPECT_FALSE(scan(scanner, "GET / HTTP/1.1\r\nHost: a\rb\r\n\r\n"));
+  EXPECT_FALSE(scan(scanner, std::string("GET / HTTP/1.1\r\nHost: a\0b\r\n\r\n", 29)));
+  EXPECT_FALSE(scan(scanner, "GET / HTTP/1.1\r\nHost: abcdefghijklmnop\x7fq\r\n\r\n"));
+  EXPECT_FALSE(scan(scanner, "GET / HTTP/1.1\r\nHost: abcdefghijklmnop\x01q\r\n\r\n"));
+}
+
+TEST(RequestHeadScannerTest, ValidHeaderValue) {
+  const auto valid = [](absl::string_view value) {
+    return RequestHeadScanner::validHeaderValue(value.data(), value.data() + value.size());
+  };
+  EXPECT_TRUE(valid(""));
+  EXPECT_TRUE(valid("text/html,application/xhtml+xml;q=0.9"));
+  EXPECT_TRUE(valid("tab\tseparated\tvalue"));
+  EXPECT_TRUE(valid("obs-text \x80\xff\xfe\xa0 is allowed"));
+  // Check every position within a word for each disallowed character.
+  for (const char c : {'\0', '\x01', '\n', '\r', '\x1f', '\x7f'}) {
+    for (size_t i = 0; i < 17; i++) {
+      std::string value(17, 'a');
+      value[i] = c;
+      EXPECT_FALSE(valid(value)) << static_cast<int>(c) << " at " << i;
+    }
+  }
+}
+
+} // namespace
+} // namespace Http1
+} // namespace Http
+} // namespace Envoy
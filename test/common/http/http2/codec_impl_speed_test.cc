@@ -0,0 +1,149 @@
+// Usage: bazel run //test/common/http/http2:codec_impl_speed_test
+// Note: this should be run with --compilation_mode=opt.
+
+#include <memory>
+#include <string>
+
+#include "envoy/http/codec.h"
+
+#include "common/buffer/buffer_impl.h"
+#include "common/http/header_map_impl.h"
+#include "common/http/http2/codec_impl.h"
+#include "common/http/utility.h"
+
+#include "test/common/stats/stat_test_utility.h"
+#include "test/mocks/network/mocks.h"
+#include "test/test_common/test_runtime.h"
+#include "test/test_common/utility.h"
+
+#include "benchmark/benchmark.h"
+
+namespace Envoy {
+namespace Http {
+namespace Http2 {
+namespace {
+
+// Moves received body data on as the router does when forwarding it, so that the benchmark
+// includes any copy made when the data is buffered by the codec.
+class BenchmarkRequestDecoder : public RequestDecoder {
+public:
+  // Http::StreamDecoder
+  void decodeData(Buffer::Instance& data, bool) override {
+    forwarded_.move(data);
+    forwarded_.drain(forwarded_.length());
+  }
+  void decodeMetadata(MetadataMapPtr&&) override {}
+
+  // Http::RequestDecoder
+  void decodeHeaders(RequestHeaderMapPtr&&, bool) override {}
+  void decodeTrailers(RequestTrailerMapPtr&&) override {}
+
+  Buffer::OwnedImpl forwarded_;
+};
+
+class BenchmarkResponseDecoder : public ResponseDecoder {
+public:
+  // Http::StreamDecoder
+  void decodeData(Buffer::Instance&, bool) override {}
+  void decodeMetadata(MetadataMapPtr&&) override {}
+
+  // Http::ResponseDecoder
+  void decode100ContinueHeaders(ResponseHeaderMapPtr&&) override {}
+  void decodeHeaders(ResponseHeaderMapPtr&&, bool) override {}
+  void decodeTrailers(ResponseTrailerMapPtr&&) override {}
+};
+
+class BenchmarkServerCallbacks : public ServerConnectionCallbacks {
+public:
+  // Http::ConnectionCallbacks
+  void onGoAway() override {}
+
+  // Http::ServerConnectionCallbacks
+  RequestDecoder& newStream(ResponseEncoder& response_encoder, bool) override {
+    response_encoder_ = &response_encoder;
+    return decoder_;
+  }
+
+  BenchmarkRequestDecoder decoder_;
+  ResponseEncoder* response_encoder_{};
+};
+
+class BenchmarkClientCallbacks : public ConnectionCallbacks {
+public:
+  // Http::ConnectionCallbacks
+  void onGoAway() override {}
+};
+
+// Sends a request body from a client codec to a server codec. Data written by each codec is copied
+// into fresh slices before being dispatched to its peer, as a socket read would. The arguments are
+// the body size in KiB and whether received DATA frame payloads are buffered by reference.
+void BM_ForwardRequestBody(benchmark::State& state) {
+  const std::string body_data(state.range(0) * 1024, 'a');
+  TestScopedRuntime scoped_runtime;
+  Runtime::LoaderSingleton::getExisting()->mergeValues(
+      {{"envoy.reloadable_features.http2_zero_copy_data", state.range(1) != 0 ? "true" : "false"}});
+
+  const envoy::config::core::v3::Http2ProtocolOptions http2_options =
+      ::Envoy::Http2::Utility::initializeAndValidateOptions(
+          envoy::config::core::v3::Http2ProtocolOptions());
+
+  Stats::TestUtil::TestStore store;
+  testing::NiceMock<Network::MockConnection> client_connection;
+  testing::NiceMock<Network::MockConnection> server_connection;
+  Buffer::OwnedImpl client_output;
+  Buffer::OwnedImpl server_output;
+  ON_CALL(client_connection, write(testing::_, testing::_))
+      .WillByDefault(testing::Invoke([&](Buffer::Instance& data, bool) -> void {
+        client_output.add(data);
+        data.drain(data.length());
+      }));
+  ON_CALL(server_connection, write(testing::_, testing::_))
+      .WillByDefault(testing::Invoke([&](Buffer::Instance& data, bool) -> void {
+        server_output.add(data);
+        data.drain(data.length());
+      }));
+
+  BenchmarkClientCallbacks client_callbacks;
+  BenchmarkServerCallbacks server_callbacks;
+  ClientConnectionImpl client(client_connection, client_callbacks, store, http2_options,
+                              Http::DEFAULT_MAX_REQUEST_HEADERS_KB, Http::DEFAULT_MAX_HEADERS_COUNT,
+                              ProdNghttp2SessionFactory::get());
+  ServerConnectionImpl server(server_connection, server_callbacks, store, http2_options,
+                              Http::DEFAULT_MAX_REQUEST_HEADERS_KB, Http::DEFAULT_MAX_HEADERS_COUNT,
+                              envoy::config::core::v3::HttpProtocolOptions::ALLOW);
+  const auto exchange = [&]() {
+    while (client_output.length() > 0 || server_output.length() > 0) {
+      if (client_output.length() > 0) {
+        server.dispatch(client_output);
+      }
+      if (server_output.length() > 0) {
+        client.dispatch(server_output);
+      }
+    }
+  };
+
+  BenchmarkResponseDecoder response_decoder;
+  const TestRequestHeaderMapImpl request_headers{
+      {":method", "POST"}, {":path", "/upload"}, {":scheme", "http"}, {":authority", "host"}};
+  const TestResponseHeaderMapImpl response_headers{{":status", "200"}};
+  for (auto _ : state) {
+    RequestEncoder& request_encoder = client.newStream(response_decoder);
+    request_encoder.encodeHeaders(request_headers, false);
+    Buffer::OwnedImpl body(body_data);
+    request_encoder.encodeData(body, true);
+    exchange();
+    server_callbacks.response_encoder_->encodeHeaders(response_headers, true);
+    exchange();
+  }
+  state.SetBytesProcessed(state.iterations() * body_data.size());
+}
+BENCHMARK(BM_ForwardRequestBody)
+    ->Args({64, 0})
+    ->Args({64, 1})
+    ->Args({1024, 0})
+    ->Args({1024, 1});
+
+} // namespace
+} // namespace Http2
+} // namespace Http
+} // namespace Envoy
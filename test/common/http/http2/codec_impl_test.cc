@@ -4,6 +4,7 @@
 #include "envoy/http/codec.h"
 #include "envoy/stats/scope.h"
 
+#include "common/buffer/buffer_impl.h"
 #include "common/http/exception.h"
 #include "common/http/header_map_impl.h"
 #include "common/http/http2/codec_impl.h"
@@ -124,6 +125,7 @@ public:
                          : CommonUtility::OptionsLimits::DEFAULT_INITIAL_CONNECTION_WINDOW_SIZE);
     options.set_allow_metadata(allow_metadata_);
     options.set_stream_error_on_invalid_http_messaging(stream_error_on_invalid_http_messaging_);
+    options.set_adaptive_hpack(adaptive_hpack_);
     options.mutable_max_outbound_frames()->set_value(max_outbound_frames_);
     options.mutable_max_outbound_control_frames()->set_value(max_outbound_control_frames_);
     options.mutable_max_consecutive_inbound_frames_with_empty_payload()->set_value(
@@ -165,6 +167,7 @@ public:
   absl::optional<const Http2SettingsTuple> server_settings_;
   bool allow_metadata_ = false;
   bool stream_error_on_invalid_http_messaging_ = false;
+  bool adaptive_hpack_ = false;
   Stats::TestUtil::TestStore stats_store_;
   envoy::config::core::v3::Http2ProtocolOptions client_http2_options_;
   NiceMock<Network::MockConnection> client_connection_;
@@ -572,6 +575,143 @@ TEST_P(Http2CodecImplTest, TrailingHeadersLargeBody) {
   response_encoder_->encodeTrailers(TestResponseTrailerMapImpl{{"trailing", "header"}});
 }
 
+TEST_P(Http2CodecImplTest, HeaderCompressionStats) {
+  initialize();
+
+  TestRequestHeaderMapImpl request_headers;
+  HttpTestUtility::addDefaultHeaders(request_headers);
+  request_headers.addCopy("x-request-id", "a5e5e2d8-1d0b-4b2f-9f4e-1bd3c1a2b7e4");
+  EXPECT_CALL(request_decoder_, decodeHeaders_(_, true));
+  request_encoder_->encodeHeaders(request_headers, true);
+
+  EXPECT_EQ(request_headers.byteSize(), stats_store_.counter("http2.header_bytes_tx").value());
+  EXPECT_EQ(request_headers.byteSize(), stats_store_.counter("http2.header_bytes_rx").value());
+  EXPECT_LT(0, stats_store_.counter("http2.header_block_bytes_tx").value());
+  EXPECT_EQ(stats_store_.counter("http2.header_block_bytes_tx").value(),
+            stats_store_.counter("http2.header_block_bytes_rx").value());
+  EXPECT_EQ(0, stats_store_.counter("http2.hpack_never_indexed_tx").value());
+}
+
+TEST_P(Http2CodecImplTest, AdaptiveHpackNeverIndexesRequestIds) {
+  adaptive_hpack_ = true;
+  initialize();
+
+  TestRequestHeaderMapImpl request_headers;
+  HttpTestUtility::addDefaultHeaders(request_headers);
+  request_headers.addCopy("x-request-id", "a5e5e2d8-1d0b-4b2f-9f4e-1bd3c1a2b7e4");
+  TestRequestHeaderMapImpl expected_headers(request_headers);
+  EXPECT_CALL(request_decoder_, decodeHeaders_(HeaderMapEqual(&expected_headers), true));
+  request_encoder_->encodeHeaders(request_headers, true);
+
+  EXPECT_EQ(1, stats_store_.counter("http2.hpack_never_indexed_tx").value());
+}
+
+class Http2CodecImplZeroCopyDataTest : public Http2CodecImplTest {
+protected:
+  void enableZeroCopyData() {
+    Runtime::LoaderSingleton::getExisting()->mergeValues(
+        {{"envoy.reloadable_features.http2_zero_copy_data", "true"}});
+  }
+
+  // Sends a large request body and checks that it is received intact. The received data is held
+  // beyond the dispatch which delivered it, so that payloads which refer to the read slices are
+  // used after the codec has released its own reference to them.
+  void expectLargeBodyReceived() {
+    initialize();
+
+    std::string body_data(512 * 1024, '\0');
+    for (size_t i = 0; i < body_data.size(); i++) {
+      body_data[i] = static_cast<char>(i % 251);
+    }
+
+    TestRequestHeaderMapImpl request_headers;
+    HttpTestUtility::addDefaultHeaders(request_headers);
+    EXPECT_CALL(request_decoder_, decodeHeaders_(_, false));
+    request_encoder_->encodeHeaders(request_headers, false);
+
+    Buffer::OwnedImpl received;
+    EXPECT_CALL(request_decoder_, decodeData(_, _))
+        .Times(AtLeast(1))
+        .WillRepeatedly(Invoke([&](Buffer::Instance& data, bool) { received.move(data); }));
+    Buffer::OwnedImpl body(body_data);
+    request_encoder_->encodeData(body, true);
+
+    EXPECT_EQ(body_data, received.toString());
+  }
+
+  // Sends the request headers, then encodes the supplied request body chunks and dispatches all
+  // the frames they produce to the server in a single read slice. Returns whether the read slice
+  // was released by the time the dispatch returned, while the received body is still held.
+  bool bodySliceReleasedAfterDispatch(const std::vector<uint64_t>& chunk_sizes) {
+    initialize();
+
+    TestRequestHeaderMapImpl request_headers;
+    HttpTestUtility::addDefaultHeaders(request_headers);
+    EXPECT_CALL(request_decoder_, decodeHeaders_(_, false));
+    request_encoder_->encodeHeaders(request_headers, false);
+
+    Buffer::OwnedImpl wire;
+    ON_CALL(client_connection_, write(_, _))
+        .WillByDefault(Invoke([&](Buffer::Instance& data, bool) -> void { wire.move(data); }));
+    uint64_t body_length = 0;
+    for (size_t i = 0; i < chunk_sizes.size(); i++) {
+      Buffer::OwnedImpl chunk(std::string(chunk_sizes[i], 'a'));
+      request_encoder_->encodeData(chunk, i + 1 == chunk_sizes.size());
+      body_length += chunk_sizes[i];
+    }
+
+    Buffer::OwnedImpl received;
+    EXPECT_CALL(request_decoder_, decodeData(_, _))
+        .Times(AtLeast(1))
+        .WillRepeatedly(Invoke([&](Buffer::Instance& data, bool) { received.move(data); }));
+    const std::string wire_data = wire.toString();
+    bool released = false;
+    Buffer::BufferFragmentImpl fragment(
+        wire_data.data(), wire_data.size(),
+        [&released](const void*, size_t, const Buffer::BufferFragmentImpl*) { released = true; });
+    Buffer::OwnedImpl input;
+    input.addBufferFragment(fragment);
+    server_->dispatch(input);
+    ON_CALL(client_connection_, write(_, _))
+        .WillByDefault(Invoke([&](Buffer::Instance& data, bool) -> void {
+          server_wrapper_.dispatch(data, *server_);
+        }));
+    EXPECT_EQ(body_length, received.length());
+    const bool released_after_dispatch = released;
+
+    received.drain(received.length());
+    EXPECT_TRUE(released);
+    return released_after_dispatch;
+  }
+};
+
+TEST_P(Http2CodecImplZeroCopyDataTest, LargeBody) {
+  TestScopedRuntime scoped_runtime;
+  enableZeroCopyData();
+  expectLargeBodyReceived();
+}
+
+TEST_P(Http2CodecImplZeroCopyDataTest, LargeBodyZeroCopyDisabled) { expectLargeBodyReceived(); }
+
+// A payload which covers most of its read slice keeps the slice alive while it is buffered.
+TEST_P(Http2CodecImplZeroCopyDataTest, PayloadCoveringSliceIsReferenced) {
+  TestScopedRuntime scoped_runtime;
+  enableZeroCopyData();
+  EXPECT_FALSE(bodySliceReleasedAfterDispatch({16 * 1024}));
+}
+
+// Payloads which only cover part of their read slice are copied, so that they do not keep the
+// rest of the slice alive.
+TEST_P(Http2CodecImplZeroCopyDataTest, PayloadsSharingSliceAreCopied) {
+  TestScopedRuntime scoped_runtime;
+  enableZeroCopyData();
+  EXPECT_TRUE(bodySliceReleasedAfterDispatch({8 * 1024, 8 * 1024, 8 * 1024}));
+}
+
+TEST_P(Http2CodecImplZeroCopyDataTest, PayloadCopiedZeroCopyDisabled) {
+  EXPECT_TRUE(bodySliceReleasedAfterDispatch({16 * 1024}));
+}
+
 TEST_P(Http2CodecImplTest, SmallMetadataVecTest) {
   allow_metadata_ = true;
   initialize();
@@ -1055,6 +1195,11 @@ INSTANTIATE_TEST_SUITE_P(Http2CodecImplTestDefaultSettings, Http2CodecImplTest,
                          ::testing::Combine(HTTP2SETTINGS_DEFAULT_COMBINE,
                                             HTTP2SETTINGS_DEFAULT_COMBINE));
 
+INSTANTIATE_TEST_SUITE_P(Http2CodecImplZeroCopyDataTestDefaultSettings,
+                         Http2CodecImplZeroCopyDataTest,
+                         ::testing::Combine(HTTP2SETTINGS_DEFAULT_COMBINE,
+                                            HTTP2SETTINGS_DEFAULT_COMBINE));
+
 #define HTTP2SETTINGS_EDGE_COMBINE                                                                 \
   ::testing::Combine(                                                                              \
       ::testing::Values(CommonUtility::OptionsLimits::MIN_HPACK_TABLE_SIZE,                        \
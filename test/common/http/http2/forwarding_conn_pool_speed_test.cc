@@ -0,0 +1,175 @@
+// Note: this should be run with --compilation_mode=opt, and would benefit from a
+// quiescent system with disabled cstate power management.
+
+#include <list>
+#include <memory>
+
+#include "common/http/header_map_impl.h"
+#include "common/http/http2/forwarding_conn_pool.h"
+#include "common/stream_info/stream_info_impl.h"
+
+#include "test/mocks/upstream/mocks.h"
+#include "test/test_common/utility.h"
+
+#include "benchmark/benchmark.h"
+
+namespace Envoy {
+namespace Http {
+namespace Http2 {
+namespace {
+
+/**
+ * Stands in for an upstream HTTP/2 stream. A header only request is immediately answered with a
+ * header only response.
+ */
+class FakeUpstreamStream : public RequestEncoder, public Stream {
+public:
+  explicit FakeUpstreamStream(ResponseDecoder& decoder) : decoder_(decoder) {}
+
+  // RequestEncoder
+  void encodeHeaders(const RequestHeaderMap&, bool end_stream) override {
+    if (end_stream) {
+      decoder_.decodeHeaders(std::make_unique<ResponseHeaderMapImpl>(), true);
+    }
+  }
+  void encodeData(Buffer::Instance&, bool) override {}
+  void encodeTrailers(const RequestTrailerMap&) override {}
+  void encodeMetadata(const MetadataMapVector&) override {}
+  Stream& getStream() override { return *this; }
+  Http1StreamEncoderOptionsOptRef http1StreamEncoderOptions() override { return absl::nullopt; }
+
+  // Stream
+  void addCallbacks(StreamCallbacks&) override {}
+  void removeCallbacks(StreamCallbacks&) override {}
+  void resetStream(StreamResetReason) override {}
+  void readDisable(bool) override {}
+  uint32_t bufferLimit() override { return 0; }
+  const Network::Address::InstanceConstSharedPtr& connectionLocalAddress() override {
+    return address_;
+  }
+
+private:
+  ResponseDecoder& decoder_;
+  Network::Address::InstanceConstSharedPtr address_;
+};
+
+/**
+ * Connection pool which makes every stream ready immediately.
+ */
+class FakeOwnerPool : public ConnectionPool::Instance {
+public:
+  FakeOwnerPool(Event::Dispatcher& dispatcher, Upstream::HostConstSharedPtr host)
+      : host_(std::move(host)), stream_info_(Protocol::Http2, dispatcher.timeSource()) {}
+
+  // ConnectionPool::Instance
+  Protocol protocol() const override { return Protocol::Http2; }
+  void addDrainedCallback(DrainedCb) override {}
+  void drainConnections() override {}
+  bool hasActiveConnections() const override { return false; }
+  ConnectionPool::Cancellable* newStream(ResponseDecoder& decoder,
+                                         ConnectionPool::Callbacks& callbacks) override {
+    streams_.emplace_back(decoder);
+    callbacks.onPoolReady(streams_.back(), host_, stream_info_);
+    return nullptr;
+  }
+  Upstream::HostDescriptionConstSharedPtr host() const override { return host_; }
+
+  void clear() { streams_.clear(); }
+
+private:
+  const Upstream::HostConstSharedPtr host_;
+  StreamInfo::StreamInfoImpl stream_info_;
+  std::list<FakeUpstreamStream> streams_;
+};
+
+/**
+ * Downstream side of a request: sends a header only request once the pool is ready and counts
+ * completed responses.
+ */
+class Request : public ResponseDecoder, public ConnectionPool::Callbacks {
+public:
+  explicit Request(uint64_t& completed) : completed_(completed) {}
+
+  // ConnectionPool::Callbacks
+  void onPoolFailure(ConnectionPool::PoolFailureReason, absl::string_view,
+                     Upstream::HostDescriptionConstSharedPtr) override {}
+  void onPoolReady(RequestEncoder& encoder, Upstream::HostDescriptionConstSharedPtr,
+                   const StreamInfo::StreamInfo&) override {
+    encoder.encodeHeaders(headers_, true);
+  }
+
+  // ResponseDecoder
+  void decode100ContinueHeaders(ResponseHeaderMapPtr&&) override {}
+  void decodeHeaders(ResponseHeaderMapPtr&&, bool end_stream) override {
+    if (end_stream) {
+      completed_++;
+    }
+  }
+  void decodeData(Buffer::Instance&, bool) override {}
+  void decodeTrailers(ResponseTrailerMapPtr&&) override {}
+  void decodeMetadata(MetadataMapPtr&&) override {}
+
+private:
+  uint64_t& completed_;
+  TestRequestHeaderMapImpl headers_{
+      {":method", "GET"}, {":path", "/"}, {":scheme", "http"}, {":authority", "host"}};
+};
+
+// Baseline: streams are created directly on a pool owned by the calling dispatcher. The argument
+// is the number of concurrent streams per iteration.
+static void DirectRequestResponse(benchmark::State& state) {
+  Api::ApiPtr api = Api::createApiForTest();
+  Event::DispatcherPtr dispatcher = api->allocateDispatcher("local");
+  auto host = std::make_shared<testing::NiceMock<Upstream::MockHost>>();
+  FakeOwnerPool pool(*dispatcher, host);
+  const uint64_t streams = state.range(0);
+
+  for (auto _ : state) {
+    uint64_t completed = 0;
+    std::list<Request> requests;
+    for (uint64_t i = 0; i < streams; i++) {
+      requests.emplace_back(completed);
+      pool.newStream(requests.back(), requests.back());
+    }
+    benchmark::DoNotOptimize(completed);
+    pool.clear();
+  }
+}
+BENCHMARK(DirectRequestResponse)->Arg(1)->Arg(100);
+
+// Streams are handed over to a pool owned by another dispatcher. Both dispatchers are driven
+// from the benchmark thread, so this measures the handover cost without cross-core effects.
+static void ForwardedRequestResponse(benchmark::State& state) {
+  Api::ApiPtr api = Api::createApiForTest();
+  Event::DispatcherPtr local_dispatcher = api->allocateDispatcher("local");
+  Event::DispatcherPtr owner_dispatcher = api->allocateDispatcher("owner");
+  auto host = std::make_shared<testing::NiceMock<Upstream::MockHost>>();
+  FakeOwnerPool owner_pool(*owner_dispatcher, host);
+  ForwardingConnPoolImpl pool(*local_dispatcher,
+                              std::make_shared<DispatcherHandle>(*owner_dispatcher), host,
+                              [&owner_pool]() -> ConnectionPool::Instance* { return &owner_pool; });
+  const uint64_t streams = state.range(0);
+
+  for (auto _ : state) {
+    uint64_t completed = 0;
+    std::list<Request> requests;
+    for (uint64_t i = 0; i < streams; i++) {
+      requests.emplace_back(completed);
+      pool.newStream(requests.back(), requests.back());
+    }
+    while (completed < streams) {
+      owner_dispatcher->run(Event::Dispatcher::RunType::NonBlock);
+      local_dispatcher->run(Event::Dispatcher::RunType::NonBlock);
+    }
+    // Flush deferred deletions on both sides.
+    owner_dispatcher->run(Event::Dispatcher::RunType::NonBlock);
+    local_dispatcher->run(Event::Dispatcher::RunType::NonBlock);
+    owner_pool.clear();
+  }
+}
+BENCHMARK(ForwardedRequestResponse)->Arg(1)->Arg(100);
+
+} // namespace
+} // namespace Http2
+} // namespace Http
+} // namespace Envoy
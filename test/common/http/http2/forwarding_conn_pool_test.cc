@@ -0,0 +1,240 @@
+#include <list>
+#include <memory>
+
+#include "common/buffer/buffer_impl.h"
+#include "common/http/http2/forwarding_conn_pool.h"
+
+#include "test/common/http/common.h"
+#include "test/mocks/buffer/mocks.h"
+#include "test/mocks/http/mocks.h"
+#include "test/mocks/stream_info/mocks.h"
+#include "test/mocks/upstream/mocks.h"
+#include "test/test_common/printers.h"
+#include "test/test_common/utility.h"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+using testing::_;
+using testing::Invoke;
+using testing::NiceMock;
+using testing::Return;
+
+namespace Envoy {
+namespace Http {
+namespace Http2 {
+namespace {
+
+class ForwardingConnPoolImplTest : public testing::Test {
+public:
+  ForwardingConnPoolImplTest()
+      : api_(Api::createApiForTest()), local_dispatcher_(api_->allocateDispatcher("local")),
+        owner_dispatcher_(api_->allocateDispatcher("owner")),
+        owner_handle_(std::make_shared<DispatcherHandle>(*owner_dispatcher_)),
+        host_(std::make_shared<NiceMock<Upstream::MockHost>>()),
+        pool_(std::make_unique<ForwardingConnPoolImpl>(
+            *local_dispatcher_, owner_handle_, host_,
+            [this]() -> ConnectionPool::Instance* { return owner_pool_; })) {}
+
+  void runOwner() { owner_dispatcher_->run(Event::Dispatcher::RunType::NonBlock); }
+  void runLocal() { local_dispatcher_->run(Event::Dispatcher::RunType::NonBlock); }
+
+  // Creates a stream on the forwarding pool and makes it ready on the owner side.
+  void createReadyStream() {
+    EXPECT_CALL(owner_pool_mock_, newStream(_, _))
+        .WillOnce(Invoke([this](ResponseDecoder& decoder, ConnectionPool::Callbacks& callbacks)
+                             -> ConnectionPool::Cancellable* {
+          owner_decoder_ = &decoder;
+          owner_callbacks_ = &callbacks;
+          return &owner_cancellable_;
+        }));
+    EXPECT_NE(nullptr, pool_->newStream(response_decoder_, callbacks_));
+    runOwner();
+    ASSERT_NE(nullptr, owner_callbacks_);
+
+    owner_callbacks_->onPoolReady(owner_encoder_, host_, owner_stream_info_);
+    EXPECT_CALL(callbacks_.pool_ready_, ready());
+    runLocal();
+    ASSERT_NE(nullptr, callbacks_.outer_encoder_);
+  }
+
+  // Notifies the owner stream callbacks of a reset as the codec would. The owner removes its
+  // callbacks while handling the reset, so iterate over a copy.
+  void resetOwnerStream(StreamResetReason reason) {
+    const std::list<StreamCallbacks*> callbacks = owner_encoder_.stream_.callbacks_;
+    for (StreamCallbacks* cb : callbacks) {
+      cb->onResetStream(reason, absl::string_view());
+    }
+  }
+
+  void expectOwnerReset(StreamResetReason reason) {
+    EXPECT_CALL(owner_encoder_.stream_, resetStream(reason))
+        .WillOnce(Invoke([this](StreamResetReason reason) -> void { resetOwnerStream(reason); }));
+  }
+
+  Api::ApiPtr api_;
+  Event::DispatcherPtr local_dispatcher_;
+  Event::DispatcherPtr owner_dispatcher_;
+  DispatcherHandleSharedPtr owner_handle_;
+  std::shared_ptr<NiceMock<Upstream::MockHost>> host_;
+  NiceMock<ConnectionPool::MockInstance> owner_pool_mock_;
+  ConnectionPool::Instance* owner_pool_{&owner_pool_mock_};
+  std::unique_ptr<ForwardingConnPoolImpl> pool_;
+
+  NiceMock<MockResponseDecoder> response_decoder_;
+  ConnPoolCallbacks callbacks_;
+
+  ResponseDecoder* owner_decoder_{};
+  ConnectionPool::Callbacks* owner_callbacks_{};
+  NiceMock<ConnectionPool::MockCancellable> owner_cancellable_;
+  NiceMock<MockRequestEncoder> owner_encoder_;
+  NiceMock<StreamInfo::MockStreamInfo> owner_stream_info_;
+};
+
+// A request and response are relayed between the two dispatchers.
+TEST_F(ForwardingConnPoolImplTest, RequestResponse) {
+  createReadyStream();
+  EXPECT_EQ(1U, host_->cluster_.stats_.upstream_rq_cross_worker_.value());
+  EXPECT_TRUE(pool_->hasActiveConnections());
+
+  TestRequestHeaderMapImpl request_headers{{":method", "GET"}, {":path", "/"}};
+  callbacks_.outer_encoder_->encodeHeaders(request_headers, false);
+  Buffer::OwnedImpl request_body("hello");
+  callbacks_.outer_encoder_->encodeData(request_body, true);
+  EXPECT_EQ(0, request_body.length());
+
+  EXPECT_CALL(owner_encoder_, encodeHeaders(HeaderMapEqualRef(&request_headers), false));
+  EXPECT_CALL(owner_encoder_, encodeData(BufferStringEqual("hello"), true));
+  runOwner();
+
+  owner_decoder_->decodeHeaders(
+      ResponseHeaderMapPtr{new TestResponseHeaderMapImpl{{":status", "200"}}}, false);
+  Buffer::OwnedImpl response_body("world");
+  owner_decoder_->decodeData(response_body, true);
+
+  EXPECT_CALL(response_decoder_, decodeHeaders_(_, false));
+  EXPECT_CALL(response_decoder_, decodeData(BufferStringEqual("world"), true));
+  runLocal();
+
+  EXPECT_FALSE(pool_->hasActiveConnections());
+  ReadyWatcher drained;
+  EXPECT_CALL(drained, ready());
+  pool_->addDrainedCallback([&drained]() -> void { drained.ready(); });
+}
+
+// A failure in the owner pool is reported to the local caller.
+TEST_F(ForwardingConnPoolImplTest, PoolFailure) {
+  EXPECT_CALL(owner_pool_mock_, newStream(_, _))
+      .WillOnce(Invoke([this](ResponseDecoder&, ConnectionPool::Callbacks& callbacks)
+                           -> ConnectionPool::Cancellable* {
+        owner_callbacks_ = &callbacks;
+        return &owner_cancellable_;
+      }));
+  EXPECT_NE(nullptr, pool_->newStream(response_decoder_, callbacks_));
+  runOwner();
+
+  owner_callbacks_->onPoolFailure(ConnectionPool::PoolFailureReason::Overflow, "", host_);
+  EXPECT_CALL(callbacks_.pool_failure_, ready());
+  runLocal();
+  EXPECT_EQ(ConnectionPool::PoolFailureReason::Overflow, callbacks_.reason_);
+  EXPECT_FALSE(pool_->hasActiveConnections());
+}
+
+// The stream fails if the owner no longer has a pool for the host.
+TEST_F(ForwardingConnPoolImplTest, OwnerPoolUnavailable) {
+  owner_pool_ = nullptr;
+  EXPECT_NE(nullptr, pool_->newStream(response_decoder_, callbacks_));
+  runOwner();
+
+  EXPECT_CALL(callbacks_.pool_failure_, ready());
+  runLocal();
+  EXPECT_EQ(ConnectionPool::PoolFailureReason::LocalConnectionFailure, callbacks_.reason_);
+}
+
+// New streams fail right away once the owner has shut down.
+TEST_F(ForwardingConnPoolImplTest, OwnerGone) {
+  owner_handle_->invalidate();
+  EXPECT_CALL(callbacks_.pool_failure_, ready());
+  EXPECT_EQ(nullptr, pool_->newStream(response_decoder_, callbacks_));
+  EXPECT_EQ(ConnectionPool::PoolFailureReason::LocalConnectionFailure, callbacks_.reason_);
+  EXPECT_FALSE(pool_->hasActiveConnections());
+}
+
+// A stream which the owner drops while shutting down fails instead of hanging.
+TEST_F(ForwardingConnPoolImplTest, OwnerGoneDuringHandover) {
+  EXPECT_NE(nullptr, pool_->newStream(response_decoder_, callbacks_));
+  owner_handle_->invalidate();
+  EXPECT_CALL(owner_pool_mock_, newStream(_, _)).Times(0);
+  runOwner();
+
+  EXPECT_CALL(callbacks_.pool_failure_, ready());
+  runLocal();
+  EXPECT_EQ(ConnectionPool::PoolFailureReason::LocalConnectionFailure, callbacks_.reason_);
+  EXPECT_FALSE(pool_->hasActiveConnections());
+}
+
+// Cancelling a pending stream cancels it in the owner pool.
+TEST_F(ForwardingConnPoolImplTest, CancelPending) {
+  EXPECT_CALL(owner_pool_mock_, newStream(_, _)).WillOnce(Return(&owner_cancellable_));
+  ConnectionPool::Cancellable* handle = pool_->newStream(response_decoder_, callbacks_);
+  runOwner();
+
+  handle->cancel();
+  EXPECT_FALSE(pool_->hasActiveConnections());
+  EXPECT_CALL(owner_cancellable_, cancel());
+  runOwner();
+
+  // Nothing is delivered locally after cancellation.
+  EXPECT_CALL(callbacks_.pool_ready_, ready()).Times(0);
+  runLocal();
+}
+
+// Cancelling before the owner has seen the stream never reaches the owner pool.
+TEST_F(ForwardingConnPoolImplTest, CancelBeforeHandover) {
+  ConnectionPool::Cancellable* handle = pool_->newStream(response_decoder_, callbacks_);
+  handle->cancel();
+  EXPECT_CALL(owner_pool_mock_, newStream(_, _)).Times(0);
+  runOwner();
+}
+
+// An upstream reset is delivered to the local stream callbacks.
+TEST_F(ForwardingConnPoolImplTest, UpstreamReset) {
+  createReadyStream();
+  NiceMock<MockStreamCallbacks> stream_callbacks;
+  callbacks_.outer_encoder_->getStream().addCallbacks(stream_callbacks);
+
+  resetOwnerStream(StreamResetReason::RemoteReset);
+  EXPECT_CALL(stream_callbacks, onResetStream(StreamResetReason::RemoteReset, _));
+  runLocal();
+  EXPECT_FALSE(pool_->hasActiveConnections());
+}
+
+// A local reset resets the upstream stream on the owner.
+TEST_F(ForwardingConnPoolImplTest, LocalReset) {
+  createReadyStream();
+  callbacks_.outer_encoder_->getStream().resetStream(StreamResetReason::LocalReset);
+  EXPECT_FALSE(pool_->hasActiveConnections());
+
+  expectOwnerReset(StreamResetReason::LocalReset);
+  runOwner();
+}
+
+// Destroying the pool resets in flight streams on the owner, which no longer posts back.
+TEST_F(ForwardingConnPoolImplTest, DestroyWithActiveStream) {
+  createReadyStream();
+  NiceMock<MockStreamCallbacks> stream_callbacks;
+  callbacks_.outer_encoder_->getStream().addCallbacks(stream_callbacks);
+
+  EXPECT_CALL(stream_callbacks, onResetStream(StreamResetReason::ConnectionTermination, _));
+  pool_.reset();
+
+  expectOwnerReset(StreamResetReason::ConnectionTermination);
+  runOwner();
+  EXPECT_CALL(stream_callbacks, onResetStream(_, _)).Times(0);
+  runLocal();
+}
+
+} // namespace
+} // namespace Http2
+} // namespace Http
+} // namespace Envoy
@@ -0,0 +1,85 @@
+#include <string>
+
+#include "common/http/http2/hpack_tuner.h"
+
+#include "gtest/gtest.h"
+
+namespace Envoy {
+namespace Http {
+namespace Http2 {
+namespace {
+
+TEST(HpackTunerTest, PerRequestHeadersNeverIndexed) {
+  HpackTuner tuner(65536);
+  EXPECT_TRUE(tuner.neverIndex("x-request-id", "a5e5e2d8-1d0b-4b2f-9f4e-1bd3c1a2b7e4"));
+  EXPECT_TRUE(tuner.neverIndex("traceparent", "00-4bf92f3577b34da6-00f067aa0ba902b7-01"));
+  EXPECT_FALSE(tuner.neverIndex("user-agent", "curl/7.68.0"));
+}
+
+TEST(HpackTunerTest, ChangingValuesNeverIndexed) {
+  HpackTuner tuner(65536);
+  // Not judged until the header has been sent enough times.
+  for (uint32_t i = 0; i < HpackTuner::MinSendsToJudge - 1; i++) {
+    EXPECT_FALSE(tuner.neverIndex("x-session-nonce", std::to_string(i)));
+    EXPECT_FALSE(tuner.neverIndex("content-type", "application/grpc"));
+  }
+  EXPECT_TRUE(tuner.neverIndex("x-session-nonce", "last"));
+  EXPECT_FALSE(tuner.neverIndex("content-type", "application/grpc"));
+
+  // Once the values settle down the header is indexed again.
+  bool never_index = true;
+  for (uint32_t i = 0; i < 512 && never_index; i++) {
+    never_index = tuner.neverIndex("x-session-nonce", "fixed");
+  }
+  EXPECT_FALSE(never_index);
+}
+
+TEST(HpackTunerTest, TrackedNamesBounded) {
+  HpackTuner tuner(65536);
+  for (uint32_t i = 0; i < HpackTuner::MaxTrackedNames; i++) {
+    tuner.neverIndex("x-header-" + std::to_string(i), "value");
+  }
+  // Headers beyond the limit are indexed as usual.
+  for (uint32_t i = 0; i < HpackTuner::MinSendsToJudge * 2; i++) {
+    EXPECT_FALSE(tuner.neverIndex("x-untracked", std::to_string(i)));
+  }
+}
+
+TEST(HpackTunerTest, TableSizeGrowsWhenFull) {
+  HpackTuner tuner(16384);
+  EXPECT_EQ(4096, tuner.advertisedTableSize());
+
+  const auto receive_blocks = [&tuner](size_t table_size) {
+    absl::optional<uint32_t> result;
+    for (uint32_t i = 0; i < HpackTuner::TableSizeSampleBlocks; i++) {
+      result = tuner.onHeaderBlockReceived(table_size);
+      if (i + 1 < HpackTuner::TableSizeSampleBlocks) {
+        EXPECT_FALSE(result.has_value());
+      }
+    }
+    return result;
+  };
+
+  // A table which is not close to full is left as is.
+  EXPECT_FALSE(receive_blocks(1000).has_value());
+  EXPECT_EQ(4096, tuner.advertisedTableSize());
+
+  EXPECT_EQ(8192, receive_blocks(4000));
+  EXPECT_EQ(16384, receive_blocks(8000));
+  // The configured maximum is never exceeded.
+  EXPECT_FALSE(receive_blocks(16000).has_value());
+  EXPECT_EQ(16384, tuner.advertisedTableSize());
+}
+
+TEST(HpackTunerTest, SmallMaximumTableSize) {
+  HpackTuner tuner(1024);
+  EXPECT_EQ(1024, tuner.advertisedTableSize());
+  for (uint32_t i = 0; i < HpackTuner::TableSizeSampleBlocks; i++) {
+    EXPECT_FALSE(tuner.onHeaderBlockReceived(1024).has_value());
+  }
+}
+
+} // namespace
+} // namespace Http2
+} // namespace Http
+} // namespace Envoy
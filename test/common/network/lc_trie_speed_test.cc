@@ -1,3 +1,5 @@
+#include <random>
+
 #include "common/network/lc_trie.h"
 #include "common/network/utility.h"
 
@@ -21,6 +23,26 @@ std::unique_ptr<Envoy::Network::LcTrie::LcTrie<std::string>> lc_trie_nested_pref
 
 std::unique_ptr<Envoy::Network::LcTrie::LcTrie<std::string>> lc_trie_minimal;
 
+// Addresses within the ranges of the large tables below.
+std::vector<Envoy::Network::Address::InstanceConstSharedPtr> large_ipv4_addresses;
+
+std::vector<Envoy::Network::Address::InstanceConstSharedPtr> large_ipv6_addresses;
+
+std::vector<std::pair<std::string, std::vector<Envoy::Network::Address::CidrRange>>>
+    tag_data_large_ipv4;
+
+std::vector<std::pair<std::string, std::vector<Envoy::Network::Address::CidrRange>>>
+    tag_data_large_ipv6;
+
+std::unique_ptr<Envoy::Network::LcTrie::LcTrie<std::string>> lc_trie_large_ipv4;
+
+std::unique_ptr<Envoy::Network::LcTrie::LcTrie<std::string>> lc_trie_large_ipv6;
+
+// Snapshots of the large tables.
+std::string large_ipv4_snapshot;
+
+std::string large_ipv6_snapshot;
+
 } // namespace
 
 namespace Envoy {
@@ -95,6 +117,119 @@ static void BM_LcTrieLookupMinimal(benchmark::State& state) {
 
 BENCHMARK(BM_LcTrieLookupMinimal);
 
+// Looks up each address in turn.
+static void lookupEach(benchmark::State& state,
+                       const Envoy::Network::LcTrie::LcTrie<std::string>& trie,
+                       const std::vector<Envoy::Network::Address::InstanceConstSharedPtr>& addrs) {
+  size_t output_tags = 0;
+  for (auto _ : state) {
+    for (const auto& address : addrs) {
+      output_tags += trie.getData(address).size();
+    }
+  }
+  benchmark::DoNotOptimize(output_tags);
+  state.SetItemsProcessed(state.iterations() * addrs.size());
+}
+
+// Looks up all the addresses in one batch.
+static void lookupBatch(benchmark::State& state,
+                        const Envoy::Network::LcTrie::LcTrie<std::string>& trie,
+                        const std::vector<Envoy::Network::Address::InstanceConstSharedPtr>& addrs) {
+  size_t output_tags = 0;
+  for (auto _ : state) {
+    for (const std::vector<std::string>* data : trie.getData(addrs)) {
+      output_tags += data->size();
+    }
+  }
+  benchmark::DoNotOptimize(output_tags);
+  state.SetItemsProcessed(state.iterations() * addrs.size());
+}
+
+static void BM_LcTrieLookupLargeIpv4(benchmark::State& state) {
+  lookupEach(state, *lc_trie_large_ipv4, large_ipv4_addresses);
+}
+
+BENCHMARK(BM_LcTrieLookupLargeIpv4);
+
+static void BM_LcTrieBatchLookupLargeIpv4(benchmark::State& state) {
+  lookupBatch(state, *lc_trie_large_ipv4, large_ipv4_addresses);
+}
+
+BENCHMARK(BM_LcTrieBatchLookupLargeIpv4);
+
+static void BM_LcTrieLookupLargeIpv6(benchmark::State& state) {
+  lookupEach(state, *lc_trie_large_ipv6, large_ipv6_addresses);
+}
+
+BENCHMARK(BM_LcTrieLookupLargeIpv6);
+
+static void BM_LcTrieBatchLookupLargeIpv6(benchmark::State& state) {
+  lookupBatch(state, *lc_trie_large_ipv6, large_ipv6_addresses);
+}
+
+BENCHMARK(BM_LcTrieBatchLookupLargeIpv6);
+
+static void BM_LcTrieSnapshotLargeIpv4(benchmark::State& state) {
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(lc_trie_large_ipv4->snapshot());
+  }
+}
+
+BENCHMARK(BM_LcTrieSnapshotLargeIpv4)->Unit(benchmark::kMillisecond);
+
+// Loading a snapshot validates it, but copies nothing but the data of the ranges, as a memory
+// mapped snapshot is used in place.
+static void BM_LcTrieLoadSnapshotLargeIpv4(benchmark::State& state) {
+  std::unique_ptr<Envoy::Network::LcTrie::LcTrie<std::string>> trie;
+  for (auto _ : state) {
+    trie = std::make_unique<Envoy::Network::LcTrie::LcTrie<std::string>>(large_ipv4_snapshot);
+  }
+  benchmark::DoNotOptimize(trie);
+}
+
+BENCHMARK(BM_LcTrieLoadSnapshotLargeIpv4)->Unit(benchmark::kMillisecond);
+
+static void BM_LcTrieLoadSnapshotLargeIpv6(benchmark::State& state) {
+  std::unique_ptr<Envoy::Network::LcTrie::LcTrie<std::string>> trie;
+  for (auto _ : state) {
+    trie = std::make_unique<Envoy::Network::LcTrie::LcTrie<std::string>>(large_ipv6_snapshot);
+  }
+  benchmark::DoNotOptimize(trie);
+}
+
+BENCHMARK(BM_LcTrieLoadSnapshotLargeIpv6)->Unit(benchmark::kMillisecond);
+
+static void BM_LcTrieLookupSnapshotLargeIpv6(benchmark::State& state) {
+  const Envoy::Network::LcTrie::LcTrie<std::string> trie(large_ipv6_snapshot);
+  lookupEach(state, trie, large_ipv6_addresses);
+}
+
+BENCHMARK(BM_LcTrieLookupSnapshotLargeIpv6);
+
+// Registered last, as freeing the temporary structures of the construction slows down the next
+// allocations.
+static void BM_LcTrieConstructLargeIpv4(benchmark::State& state) {
+  std::unique_ptr<Envoy::Network::LcTrie::LcTrie<std::string>> trie;
+  for (auto _ : state) {
+    trie = std::make_unique<Envoy::Network::LcTrie::LcTrie<std::string>>(
+        tag_data_large_ipv4, /*exclusive=*/false, /*fill_factor=*/0.5, /*root_branching_factor=*/0,
+        /*ipv4_direct_table=*/true);
+  }
+  benchmark::DoNotOptimize(trie);
+}
+
+BENCHMARK(BM_LcTrieConstructLargeIpv4)->Unit(benchmark::kMillisecond);
+
+static void BM_LcTrieConstructLargeIpv6(benchmark::State& state) {
+  std::unique_ptr<Envoy::Network::LcTrie::LcTrie<std::string>> trie;
+  for (auto _ : state) {
+    trie = std::make_unique<Envoy::Network::LcTrie::LcTrie<std::string>>(tag_data_large_ipv6);
+  }
+  benchmark::DoNotOptimize(trie);
+}
+
+BENCHMARK(BM_LcTrieConstructLargeIpv6)->Unit(benchmark::kMillisecond);
+
 } // namespace Envoy
 
 // Boilerplate main(), which discovers benchmarks in the same file and runs them.
@@ -127,10 +262,53 @@ int main(int argc, char** argv) {
       std::pair<std::string, std::vector<Envoy::Network::Address::CidrRange>>(
           {"tag_1", {Envoy::Network::Address::CidrRange::create("0.0.0.0/0")}}));
 
+  // Construct the large tables: 2^20 IPv4 ranges, which are held in a DIR-24-8 table, and 2^17
+  // IPv6 ranges, close to the maximum number of ranges of an LC trie with the default fill
+  // factor. Most IPv4 ranges are /24s, every 16th is a /30 to exercise longer prefixes. The data
+  // of the ranges is one of 64 tags.
+  static const size_t num_tags = 64;
+  tag_data_large_ipv4.resize(num_tags);
+  tag_data_large_ipv6.resize(num_tags);
+  for (size_t i = 0; i < num_tags; i++) {
+    tag_data_large_ipv4[i].first = fmt::format("tag_{}", i);
+    tag_data_large_ipv6[i].first = fmt::format("tag_{}", i);
+  }
+  static const size_t num_ipv4_ranges = 1 << 20;
+  for (size_t i = 0; i < num_ipv4_ranges; i++) {
+    // The ranges cover 64.0.0.0/4.
+    const uint32_t block = 64 * (1 << 16) + i;
+    tag_data_large_ipv4[i % num_tags].second.push_back(Envoy::Network::Address::CidrRange::create(
+        fmt::format("{}.{}.{}.0/{}", block >> 16, (block >> 8) & 0xff, block & 0xff,
+                    i % 16 == 0 ? 30 : 24)));
+  }
+  static const size_t num_ipv6_ranges = 1 << 17;
+  for (size_t i = 0; i < num_ipv6_ranges; i++) {
+    tag_data_large_ipv6[i % num_tags].second.push_back(Envoy::Network::Address::CidrRange::create(
+        fmt::format("2001:db8:{:x}:{:x}::/64", i >> 16, i & 0xffff)));
+  }
+
+  std::mt19937 random(0);
+  for (size_t i = 0; i < 1024; i++) {
+    const uint32_t ipv4 = random();
+    large_ipv4_addresses.push_back(Envoy::Network::Utility::parseInternetAddress(
+        fmt::format("{}.{}.{}.{}", 64 + ((ipv4 >> 24) & 0xf), (ipv4 >> 16) & 0xff,
+                    (ipv4 >> 8) & 0xff, ipv4 & 0xff)));
+    const uint32_t ipv6 = random();
+    large_ipv6_addresses.push_back(Envoy::Network::Utility::parseInternetAddress(fmt::format(
+        "2001:db8:{:x}:{:x}::{:x}", (ipv6 >> 16) & 1, ipv6 & 0xffff, random() & 0xffff)));
+  }
+
   lc_trie = std::make_unique<Envoy::Network::LcTrie::LcTrie<std::string>>(tag_data);
   lc_trie_nested_prefixes =
       std::make_unique<Envoy::Network::LcTrie::LcTrie<std::string>>(tag_data_nested_prefixes);
   lc_trie_minimal = std::make_unique<Envoy::Network::LcTrie::LcTrie<std::string>>(tag_data_minimal);
+  lc_trie_large_ipv4 = std::make_unique<Envoy::Network::LcTrie::LcTrie<std::string>>(
+      tag_data_large_ipv4, /*exclusive=*/false, /*fill_factor=*/0.5, /*root_branching_factor=*/0,
+      /*ipv4_direct_table=*/true);
+  lc_trie_large_ipv6 =
+      std::make_unique<Envoy::Network::LcTrie::LcTrie<std::string>>(tag_data_large_ipv6);
+  large_ipv4_snapshot = lc_trie_large_ipv4->snapshot();
+  large_ipv6_snapshot = lc_trie_large_ipv6->snapshot();
 
   benchmark::Initialize(&argc, argv);
   if (benchmark::ReportUnrecognizedArguments(argc, argv)) {
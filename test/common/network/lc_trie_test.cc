@@ -16,7 +16,8 @@ namespace LcTrie {
 class LcTrieTest : public testing::Test {
 public:
   void setup(const std::vector<std::vector<std::string>>& cidr_range_strings,
-             bool exclusive = false, double fill_factor = 0, uint32_t root_branch_factor = 0) {
+             bool exclusive = false, double fill_factor = 0, uint32_t root_branch_factor = 0,
+             bool ipv4_direct_table = false) {
     std::vector<std::pair<std::string, std::vector<Address::CidrRange>>> output;
     for (size_t i = 0; i < cidr_range_strings.size(); i++) {
       std::pair<std::string, std::vector<Address::CidrRange>> ip_tags;
@@ -28,24 +29,44 @@ public:
     }
     // Use custom fill factors and root branch factors if they are in the valid range.
     if ((fill_factor > 0) && (fill_factor <= 1) && (root_branch_factor > 0)) {
-      trie_ =
-          std::make_unique<LcTrie<std::string>>(output, exclusive, fill_factor, root_branch_factor);
+      trie_ = std::make_unique<LcTrie<std::string>>(output, exclusive, fill_factor,
+                                                    root_branch_factor, ipv4_direct_table);
     } else {
-      trie_ = std::make_unique<LcTrie<std::string>>(output, exclusive);
+      trie_ = std::make_unique<LcTrie<std::string>>(output, exclusive, 0.5, 0, ipv4_direct_table);
     }
   }
 
   void expectIPAndTags(
       const std::vector<std::pair<std::string, std::vector<std::string>>>& test_output) {
+    std::vector<Address::InstanceConstSharedPtr> addresses;
     for (const auto& kv : test_output) {
       std::vector<std::string> expected(kv.second);
       std::sort(expected.begin(), expected.end());
-      std::vector<std::string> actual(trie_->getData(Utility::parseInternetAddress(kv.first)));
+      addresses.push_back(Utility::parseInternetAddress(kv.first));
+      std::vector<std::string> actual(trie_->getData(addresses.back()));
       std::sort(actual.begin(), actual.end());
       EXPECT_EQ(expected, actual);
     }
+
+    // Batch lookups return the same data.
+    std::vector<const std::vector<std::string>*> batch = trie_->getData(addresses);
+    ASSERT_EQ(test_output.size(), batch.size());
+    for (size_t i = 0; i < batch.size(); i++) {
+      std::vector<std::string> expected(test_output[i].second);
+      std::sort(expected.begin(), expected.end());
+      std::vector<std::string> actual(*batch[i]);
+      std::sort(actual.begin(), actual.end());
+      EXPECT_EQ(expected, actual) << test_output[i].first;
+    }
   }
 
+  // Replace the trie with one loaded from its snapshot.
+  void reloadFromSnapshot() {
+    snapshot_ = trie_->snapshot();
+    trie_ = std::make_unique<LcTrie<std::string>>(snapshot_);
+  }
+
+  std::string snapshot_;
   std::unique_ptr<LcTrie<std::string>> trie_;
 };
 
@@ -325,11 +346,176 @@ TEST_F(LcTrieTest, ExclusiveNestedPrefixesWithCatchAll) {
   expectIPAndTags(test_case);
 }
 
+// Large IPv4 tables are held in a DIR-24-8 table rather than an LC trie if asked to.
+TEST_F(LcTrieTest, Ipv4DirectTable) {
+  std::vector<std::vector<std::string>> cidr_range_strings = {
+      {},                                   // tag_0
+      {"0.0.0.0/0"},                        // tag_1
+      {"10.1.2.128/25"},                    // tag_2
+      {"10.1.2.255/32", "10.255.255.0/32"}, // tag_3
+      {"::/0"},                             // tag_4
+      {"11.0.0.0/8"},                       // tag_5
+  };
+  for (size_t i = 0; i < 256; i++) {
+    for (size_t j = 0; j < 256; j++) {
+      cidr_range_strings[0].push_back(fmt::format("10.{}.{}.0/24", i, j));
+    }
+  }
+  ASSERT_LE(MinIpv4DirectTableRanges, cidr_range_strings[0].size());
+  setup(cidr_range_strings, false, 0, 0, true);
+
+  std::vector<std::pair<std::string, std::vector<std::string>>> test_case = {
+      {"10.1.2.3", {"tag_0", "tag_1"}},
+      {"10.1.2.200", {"tag_0", "tag_1", "tag_2"}},
+      {"10.1.2.255", {"tag_0", "tag_1", "tag_2", "tag_3"}},
+      {"10.255.255.0", {"tag_0", "tag_1", "tag_3"}},
+      {"10.255.255.1", {"tag_0", "tag_1"}},
+      {"11.2.3.4", {"tag_1", "tag_5"}},
+      {"255.255.255.255", {"tag_1"}},
+      {"::1", {"tag_4"}}};
+  expectIPAndTags(test_case);
+  // The snapshot holds the 64 MiB table.
+  EXPECT_LT(64 << 20, trie_->snapshot().size());
+
+  setup(cidr_range_strings, true, 0, 0, true);
+  test_case = {{"10.1.2.3", {"tag_0"}},        {"10.1.2.200", {"tag_2"}},
+               {"10.1.2.255", {"tag_3"}},      {"10.255.255.0", {"tag_3"}},
+               {"10.255.255.1", {"tag_0"}},    {"11.2.3.4", {"tag_5"}},
+               {"255.255.255.255", {"tag_1"}}, {"::1", {"tag_4"}}};
+  expectIPAndTags(test_case);
+}
+
+// Without the option, large IPv4 tables are held in an LC trie, e.g. for filter chain matching.
+TEST_F(LcTrieTest, Ipv4DirectTableNotRequested) {
+  std::vector<std::vector<std::string>> cidr_range_strings = {{}, {"10.1.2.128/25"}};
+  for (size_t i = 0; i < 256; i++) {
+    for (size_t j = 0; j < 256; j++) {
+      cidr_range_strings[0].push_back(fmt::format("10.{}.{}.0/24", i, j));
+    }
+  }
+  setup(cidr_range_strings);
+  expectIPAndTags({{"10.1.2.3", {"tag_0"}},
+                   {"10.1.2.200", {"tag_0", "tag_1"}},
+                   {"10.255.255.1", {"tag_0"}},
+                   {"11.0.0.1", {}}});
+  EXPECT_GT(64 << 20, trie_->snapshot().size());
+}
+
+TEST_F(LcTrieTest, Snapshot) {
+  const std::vector<std::vector<std::string>> cidr_range_strings = {
+      {"0.0.0.0/0"},                          // tag_0
+      {"203.0.113.0/24"},                     // tag_1
+      {"203.0.113.128/25"},                   // tag_2
+      {"198.51.100.0/24"},                    // tag_3
+      {"::0/0"},                              // tag_4
+      {"2001:db8::/96", "2001:db8::8000/97"}, // tag_5
+      {"2001:db8::ffff/128"},                 // tag_6
+      {},                                     // tag_7
+  };
+  setup(cidr_range_strings);
+  reloadFromSnapshot();
+
+  const std::vector<std::pair<std::string, std::vector<std::string>>> test_case = {
+      {"203.0.0.0", {"tag_0"}},
+      {"203.0.113.192", {"tag_0", "tag_1", "tag_2"}},
+      {"198.51.100.1", {"tag_0", "tag_3"}},
+      {"2001:db8::ffff", {"tag_4", "tag_5", "tag_6"}},
+      {"2001:db8:1::ffff", {"tag_4"}}};
+  expectIPAndTags(test_case);
+
+  std::vector<std::string> values = trie_->values();
+  std::sort(values.begin(), values.end());
+  EXPECT_EQ(std::vector<std::string>({"tag_0", "tag_1", "tag_2", "tag_3", "tag_4", "tag_5",
+                                      "tag_6"}),
+            values);
+
+  // A snapshot of a loaded trie is the snapshot it was loaded from.
+  EXPECT_EQ(snapshot_, trie_->snapshot());
+}
+
+TEST_F(LcTrieTest, EmptySnapshot) {
+  setup({});
+  reloadFromSnapshot();
+  expectIPAndTags({{"10.0.0.1", {}}, {"::1", {}}});
+  EXPECT_TRUE(trie_->values().empty());
+}
+
+TEST_F(LcTrieTest, Ipv4DirectTableSnapshot) {
+  std::vector<std::vector<std::string>> cidr_range_strings = {
+      {},                                   // tag_0
+      {"10.1.2.128/25"},                    // tag_1
+      {"10.1.2.255/32", "2001:db8::1/128"}, // tag_2
+  };
+  for (size_t i = 0; i < 256; i++) {
+    for (size_t j = 0; j < 256; j++) {
+      cidr_range_strings[0].push_back(fmt::format("10.{}.{}.0/24", i, j));
+    }
+  }
+  setup(cidr_range_strings, false, 0, 0, true);
+  reloadFromSnapshot();
+
+  const std::vector<std::pair<std::string, std::vector<std::string>>> test_case = {
+      {"10.1.2.3", {"tag_0"}},
+      {"10.1.2.200", {"tag_0", "tag_1"}},
+      {"10.1.2.255", {"tag_0", "tag_1", "tag_2"}},
+      {"11.0.0.1", {}},
+      {"2001:db8::1", {"tag_2"}}};
+  expectIPAndTags(test_case);
+}
+
+// Snapshots that aren't 16 byte aligned are copied before being used.
+TEST_F(LcTrieTest, UnalignedSnapshot) {
+  setup({{"10.0.0.0/8", "2001:db8::/32"}});
+  const std::string unaligned = " " + trie_->snapshot();
+  trie_ = std::make_unique<LcTrie<std::string>>(absl::string_view(unaligned).substr(1));
+  expectIPAndTags({{"10.0.0.1", {"tag_0"}}, {"2001:db8::1", {"tag_0"}}, {"11.0.0.1", {}}});
+}
+
+TEST_F(LcTrieTest, InvalidSnapshot) {
+  setup({{"10.0.0.0/8", "10.1.0.0/16", "2001:db8::/32"}, {"10.2.0.0/16"}});
+  const std::string snapshot = trie_->snapshot();
+
+  EXPECT_THROW_WITH_MESSAGE(std::make_unique<LcTrie<std::string>>(std::string("LCTR")),
+                            EnvoyException,
+                            "Invalid LC-Trie snapshot: truncated header.");
+
+  std::string corrupted = snapshot;
+  corrupted[0] ^= 1;
+  EXPECT_THROW_WITH_MESSAGE(std::make_unique<LcTrie<std::string>>(corrupted), EnvoyException,
+                            "Invalid LC-Trie snapshot: bad magic number.");
+
+  corrupted = snapshot;
+  corrupted[4] = 2;
+  EXPECT_THROW_WITH_MESSAGE(std::make_unique<LcTrie<std::string>>(corrupted), EnvoyException,
+                            "Invalid LC-Trie snapshot: unsupported version 2.");
+
+  EXPECT_THROW_WITH_MESSAGE(
+      std::make_unique<LcTrie<std::string>>(snapshot.substr(0, snapshot.size() - 1)),
+      EnvoyException, "Invalid LC-Trie snapshot: section out of bounds.");
+
+  // Snapshots may come from untrusted files, so any corruption either makes the snapshot fail to
+  // load or results in a trie whose lookups stay within the bounds of the snapshot.
+  for (size_t i = 0; i < snapshot.size(); i++) {
+    for (const uint8_t flip : {0x01, 0x10, 0xff}) {
+      corrupted = snapshot;
+      corrupted[i] ^= flip;
+      try {
+        trie_ = std::make_unique<LcTrie<std::string>>(corrupted);
+        for (const char* address : {"10.1.2.3", "10.2.0.1", "11.0.0.1", "2001:db8::1", "::1"}) {
+          trie_->getData(Utility::parseInternetAddress(address));
+        }
+      } catch (const EnvoyException&) {
+      }
+    }
+  }
+}
+
 // Ensure the trie will reject inputs that would cause it to exceed the maximum 2^20 nodes
-// when using the default fill factor.
+// when using the default fill factor. This takes IPv6 ranges, which are never held in a DIR-24-8
+// table.
 TEST_F(LcTrieTest, MaximumEntriesExceptionDefault) {
   static const size_t num_prefixes = 1 << 19;
-  Address::CidrRange address = Address::CidrRange::create("10.0.0.1/8");
+  Address::CidrRange address = Address::CidrRange::create("2001:db8::1/32");
   std::vector<Address::CidrRange> prefixes;
   prefixes.reserve(num_prefixes);
   for (size_t i = 0; i < num_prefixes; i++) {
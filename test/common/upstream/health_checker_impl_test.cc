@@ -40,6 +40,7 @@ using testing::InSequence;
 using testing::Invoke;
 using testing::InvokeWithoutArgs;
 using testing::NiceMock;
+using testing::Property;
 using testing::Return;
 using testing::ReturnRef;
 using testing::SaveArg;
@@ -766,6 +767,65 @@ TEST_F(HttpHealthCheckerImplTest, Degraded) {
   EXPECT_EQ(Host::Health::Healthy, cluster_->prioritySet().getMockHostSet(0)->hosts_[0]->health());
 }
 
+class HttpHealthCheckerImplBatchedSchedulingTest : public Event::TestUsingSimulatedTime,
+                                                   public HttpHealthCheckerImplTest {};
+
+// With batched scheduling the interval timers of all sessions are driven by a single timing wheel,
+// and the first check is spread across the first interval.
+TEST_F(HttpHealthCheckerImplBatchedSchedulingTest, TimingWheel) {
+  const std::string yaml = R"EOF(
+    timeout: 1s
+    interval: 1s
+    unhealthy_threshold: 2
+    healthy_threshold: 2
+    batched_scheduling:
+      granularity: 0.1s
+    http_health_check:
+      path: /healthcheck
+    )EOF";
+
+  // The only dispatcher timer created for intervals is the wheel's tick timer.
+  Event::MockTimer* wheel_timer = new Event::MockTimer(&dispatcher_);
+  health_checker_ = std::make_shared<TestHttpHealthCheckerImpl>(
+      *cluster_, parseHealthCheckFromV2Yaml(yaml), dispatcher_, runtime_, random_,
+      HealthCheckEventLoggerPtr(event_logger_));
+  health_checker_->addHostCheckCompleteCb(
+      [this](HostSharedPtr host, HealthTransition changed_state) -> void {
+        onHostStatus(host, changed_state);
+      });
+
+  cluster_->prioritySet().getMockHostSet(0)->hosts_ = {
+      makeTestHost(cluster_->info_, "tcp://127.0.0.1:80")};
+  cluster_->info_->stats().upstream_cx_total_.inc();
+  test_sessions_.emplace_back(new TestSession());
+  test_sessions_[0]->timeout_timer_ = new Event::MockTimer(&dispatcher_);
+  expectClientCreate(0);
+
+  // The first check is delayed by a random fraction of the interval: 450ms, which rounds up to the
+  // fifth tick of the wheel. The wheel sleeps until then rather than waking up on every tick.
+  EXPECT_CALL(random_, random()).WillRepeatedly(Return(450));
+  EXPECT_CALL(*wheel_timer, enableTimer(std::chrono::milliseconds(500), _));
+  health_checker_->start();
+
+  // Running late by 50ms.
+  simTime().advanceTimeWait(std::chrono::milliseconds(500));
+  expectStreamCreate(0);
+  EXPECT_CALL(*test_sessions_[0]->timeout_timer_, enableTimer(_, _));
+  EXPECT_CALL(*wheel_timer, disableTimer());
+  EXPECT_CALL(cluster_->info_->stats_store_,
+              deliverHistogramToSinks(
+                  Property(&Stats::Metric::name, "health_check.scheduling_lag_ms"), 50));
+  wheel_timer->invokeCallback();
+  EXPECT_EQ(1UL, cluster_->info_->stats_store_.counter("health_check.attempt").value());
+
+  // The next check goes back onto the wheel.
+  EXPECT_CALL(*this, onHostStatus(_, HealthTransition::Unchanged));
+  EXPECT_CALL(*test_sessions_[0]->timeout_timer_, disableTimer());
+  EXPECT_CALL(*wheel_timer, enableTimer(std::chrono::milliseconds(1000), _));
+  respond(0, "200", false, false, true);
+  EXPECT_EQ(Host::Health::Healthy, cluster_->prioritySet().getMockHostSet(0)->hosts_[0]->health());
+}
+
 TEST_F(HttpHealthCheckerImplTest, SuccessIntervalJitter) {
   setupNoServiceValidationHC();
   EXPECT_CALL(*this, onHostStatus(_, HealthTransition::Unchanged)).Times(testing::AnyNumber());
@@ -0,0 +1,95 @@
+// Usage: bazel run //test/common/upstream:host_memory_benchmark
+// Memory counters are only reported when built with tcmalloc.
+
+#include <memory>
+#include <vector>
+
+#include "envoy/config/core/v3/base.pb.h"
+#include "envoy/config/endpoint/v3/endpoint_components.pb.h"
+
+#include "common/common/fmt.h"
+#include "common/memory/stats.h"
+#include "common/network/utility.h"
+#include "common/upstream/shared_host_data.h"
+#include "common/upstream/upstream_impl.h"
+
+#include "test/mocks/upstream/mocks.h"
+
+#include "benchmark/benchmark.h"
+
+namespace Envoy {
+namespace Upstream {
+namespace {
+
+// Builds the same endpoints in two clusters, as happens when several clusters route to subsets of
+// one service, and reports the memory used per host. The arguments are the number of endpoints,
+// whether the compact host representation is used, and the percentage of hosts which have served
+// traffic.
+void BM_HostMemory(benchmark::State& state) {
+  const uint64_t num_endpoints = state.range(0);
+  const bool compact = state.range(1) != 0;
+  const uint64_t used_percent = state.range(2);
+  constexpr uint32_t NumClusters = 2;
+  constexpr uint32_t NumZones = 8;
+
+  std::vector<std::shared_ptr<testing::NiceMock<MockClusterInfo>>> infos;
+  for (uint32_t i = 0; i < NumClusters; i++) {
+    infos.push_back(std::make_shared<testing::NiceMock<MockClusterInfo>>());
+  }
+  std::vector<envoy::config::core::v3::Locality> localities(NumZones);
+  for (uint32_t i = 0; i < NumZones; i++) {
+    localities[i].set_region("us-east-1");
+    localities[i].set_zone(fmt::format("us-east-1{}", static_cast<char>('a' + i)));
+  }
+
+  for (auto _ : state) {
+    state.PauseTiming();
+    const size_t start_mem = Memory::Stats::totalCurrentlyAllocated();
+    {
+      SharedAddressPool address_pool;
+      std::vector<std::unique_ptr<HostLocalityPool>> locality_pools;
+      HostVector hosts;
+      hosts.reserve(num_endpoints * NumClusters);
+      for (uint32_t cluster = 0; cluster < NumClusters; cluster++) {
+        locality_pools.push_back(
+            std::make_unique<HostLocalityPool>(infos[cluster]->statsScope().symbolTable()));
+        for (uint64_t i = 0; i < num_endpoints; i++) {
+          Network::Address::InstanceConstSharedPtr address = Network::Utility::resolveUrl(
+              fmt::format("tcp://10.{}.{}.{}:8080", i / 65536, i / 256 % 256, i % 256));
+          const envoy::config::core::v3::Locality& locality = localities[i % NumZones];
+          if (compact) {
+            hosts.emplace_back(new CompactHostImpl(
+                infos[cluster], "", address_pool.getAddress(address), nullptr, 1,
+                locality_pools.back()->getLocality(locality),
+                envoy::config::endpoint::v3::Endpoint::HealthCheckConfig::default_instance(), 0,
+                envoy::config::core::v3::UNKNOWN));
+          } else {
+            hosts.emplace_back(new HostImpl(
+                infos[cluster], "", address, nullptr, 1, locality,
+                envoy::config::endpoint::v3::Endpoint::HealthCheckConfig::default_instance(), 0,
+                envoy::config::core::v3::UNKNOWN));
+          }
+          if (i * 100 < used_percent * num_endpoints) {
+            hosts.back()->stats().rq_total_.inc();
+          }
+        }
+      }
+      const size_t end_mem = Memory::Stats::totalCurrentlyAllocated();
+      state.counters["memory"] = end_mem - start_mem;
+      state.counters["memory_per_host"] = (end_mem - start_mem) / hosts.size();
+    }
+    state.ResumeTiming();
+  }
+}
+BENCHMARK(BM_HostMemory)
+    ->Args({10000, 0, 100})
+    ->Args({10000, 1, 100})
+    ->Args({10000, 0, 10})
+    ->Args({10000, 1, 10})
+    ->Args({100000, 0, 10})
+    ->Args({100000, 1, 10})
+    ->Unit(benchmark::kMillisecond);
+
+} // namespace
+} // namespace Upstream
+} // namespace Envoy
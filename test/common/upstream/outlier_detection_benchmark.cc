@@ -0,0 +1,124 @@
+// Usage: bazel run //test/common/upstream:outlier_detection_benchmark
+// Note: this should be run with --compilation_mode=opt.
+
+#include <memory>
+#include <string>
+
+#include "envoy/config/cluster/v3/outlier_detection.pb.h"
+
+#include "common/common/fmt.h"
+#include "common/upstream/outlier_detection_impl.h"
+#include "common/upstream/upstream_impl.h"
+
+#include "test/common/upstream/utility.h"
+#include "test/mocks/event/mocks.h"
+#include "test/mocks/runtime/mocks.h"
+#include "test/mocks/upstream/mocks.h"
+#include "test/test_common/simulated_time_system.h"
+
+#include "benchmark/benchmark.h"
+
+namespace Envoy {
+namespace Upstream {
+namespace Outlier {
+namespace {
+
+/**
+ * A cluster with outlier detection enabled on all of its hosts.
+ */
+class DetectorTester {
+public:
+  explicit DetectorTester(uint64_t num_hosts) {
+    for (uint64_t i = 0; i < num_hosts; i++) {
+      hosts_.push_back(makeTestHost(
+          cluster_.info_, fmt::format("tcp://10.{}.{}.{}:80", i / 65536, i / 256 % 256, i % 256)));
+    }
+    // The detector creates its interval timer first.
+    interval_timer_ = new testing::NiceMock<Event::MockTimer>(&dispatcher_);
+    detector_ = DetectorImpl::create(cluster_, envoy::config::cluster::v3::OutlierDetection(),
+                                     dispatcher_, runtime_, time_system_, nullptr);
+  }
+
+  // Runs one outlier detection interval.
+  void runInterval() { interval_timer_->invokeCallback(); }
+
+  testing::NiceMock<MockClusterMockPrioritySet> cluster_;
+  HostVector& hosts_ = cluster_.prioritySet().getMockHostSet(0)->hosts_;
+  testing::NiceMock<Event::MockDispatcher> dispatcher_;
+  testing::NiceMock<Runtime::MockLoader> runtime_;
+  Event::SimulatedTimeSystem time_system_;
+  Event::MockTimer* interval_timer_;
+  std::shared_ptr<DetectorImpl> detector_;
+};
+
+// Records results into a single success rate bucket from many threads. The argument is the number
+// of shards, so that 1 shows the cost of all workers sharing one cache line.
+SuccessRateAccumulatorBucket* bucket;
+
+void BM_SuccessRateBucketPut(benchmark::State& state) {
+  if (state.thread_index == 0) {
+    bucket = new SuccessRateAccumulatorBucket(state.range(0));
+  }
+  for (auto _ : state) {
+    bucket->put(true);
+  }
+  if (state.thread_index == 0) {
+    benchmark::DoNotOptimize(bucket->successAndTotal());
+    delete bucket;
+  }
+}
+BENCHMARK(BM_SuccessRateBucketPut)
+    ->Arg(1)
+    ->Arg(SuccessRateAccumulatorBucket::MaxShards)
+    ->Threads(1)
+    ->Threads(8)
+    ->Threads(64)
+    ->UseRealTime();
+
+// Reports successful responses through the host monitors of one host set from many threads, as
+// workers do for requests routed to the same cluster. The argument is the number of hosts.
+DetectorTester* tester;
+
+void BM_PutHttpResponseCode(benchmark::State& state) {
+  if (state.thread_index == 0) {
+    tester = new DetectorTester(state.range(0));
+  }
+  // Every thread walks the hosts from a different offset, as a load balancer would.
+  uint64_t index = state.thread_index;
+  for (auto _ : state) {
+    const HostVector& hosts = tester->hosts_;
+    hosts[index++ % hosts.size()]->outlierDetector().putHttpResponseCode(200);
+  }
+  if (state.thread_index == 0) {
+    delete tester;
+  }
+}
+BENCHMARK(BM_PutHttpResponseCode)
+    ->Arg(1)
+    ->Arg(100)
+    ->Threads(1)
+    ->Threads(8)
+    ->Threads(64)
+    ->UseRealTime();
+
+// Runs the success rate and failure percentage computation over a large cluster in which every
+// host has enough request volume. The argument is the number of hosts.
+void BM_SuccessRateEjections(benchmark::State& state) {
+  DetectorTester tester(state.range(0));
+  for (auto _ : state) {
+    state.PauseTiming();
+    for (const HostSharedPtr& host : tester.hosts_) {
+      for (uint32_t i = 0; i < 100; i++) {
+        host->outlierDetector().putHttpResponseCode(200);
+      }
+    }
+    state.ResumeTiming();
+    tester.runInterval();
+  }
+}
+BENCHMARK(BM_SuccessRateEjections)->Arg(100)->Arg(10000)->Unit(benchmark::kMicrosecond);
+
+} // namespace
+} // namespace Outlier
+} // namespace Upstream
+} // namespace Envoy
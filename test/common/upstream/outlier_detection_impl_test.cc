@@ -1,3 +1,4 @@
+#include <cmath>
 #include <chrono>
 #include <cstdint>
 #include <memory>
@@ -18,6 +19,7 @@
 #include "test/mocks/runtime/mocks.h"
 #include "test/mocks/upstream/mocks.h"
 #include "test/test_common/simulated_time_system.h"
+#include "test/test_common/thread_factory_for_test.h"
 #include "test/test_common/utility.h"
 
 #include "absl/types/optional.h"
@@ -1564,17 +1566,76 @@ TEST(OutlierDetectionEventLoggerImplTest, All) {
 }
 
 TEST(OutlierUtility, SRThreshold) {
-  std::vector<HostSuccessRatePair> data = {
-      HostSuccessRatePair(nullptr, 50),  HostSuccessRatePair(nullptr, 100),
-      HostSuccessRatePair(nullptr, 100), HostSuccessRatePair(nullptr, 100),
-      HostSuccessRatePair(nullptr, 100),
-  };
-  double sum = 450;
-
+  std::vector<double> data = {50, 100, 100, 100, 100};
   DetectorImpl::EjectionPair success_rate_nums =
-      DetectorImpl::successRateEjectionThreshold(sum, data, 1.9);
+      DetectorImpl::successRateEjectionThreshold(data, 1.9);
   EXPECT_EQ(90.0, success_rate_nums.success_rate_average_); // average success rate
-  EXPECT_EQ(52.0, success_rate_nums.ejection_threshold_);   // ejection threshold
+  EXPECT_EQ(52.0, success_rate_nums.ejection_threshold_);   // ejection threshold
+}
+
+// Sizes which do not divide evenly into vector lanes match a straightforward computation.
+TEST(OutlierUtility, SRThresholdUnevenSize) {
+  std::vector<double> data;
+  double sum = 0;
+  for (uint32_t i = 0; i < 11; i++) {
+    const double success_rate = 100 - i * 3.5;
+    data.push_back(success_rate);
+    sum += success_rate;
+  }
+  const double mean = sum / data.size();
+  double variance = 0;
+  for (const double success_rate : data) {
+    variance += std::pow(success_rate - mean, 2);
+  }
+  variance /= data.size();
+
+  const DetectorImpl::EjectionPair success_rate_nums =
+      DetectorImpl::successRateEjectionThreshold(data, 1.9);
+  EXPECT_DOUBLE_EQ(mean, success_rate_nums.success_rate_average_);
+  EXPECT_DOUBLE_EQ(mean - 1.9 * std::sqrt(variance), success_rate_nums.ejection_threshold_);
+}
+
+TEST(SuccessRateAccumulatorBucketTest, ShardCount) {
+  // Shard counts are rounded up to a power of two and capped, and results are counted whatever
+  // shard the calling thread lands on.
+  for (const auto& shards : std::vector<std::pair<uint32_t, uint32_t>>{
+           {0, 1}, {1, 1}, {3, 4}, {16, 16}, {1000, 16}}) {
+    SuccessRateAccumulatorBucket bucket(shards.first);
+    EXPECT_EQ(shards.second, bucket.shards());
+    bucket.put(true);
+    bucket.put(false);
+    EXPECT_EQ(std::make_pair(uint64_t(1), uint64_t(2)), bucket.successAndTotal());
+    bucket.reset();
+    EXPECT_EQ(std::make_pair(uint64_t(0), uint64_t(0)), bucket.successAndTotal());
+  }
+}
+
+// Results reported concurrently from many threads are all accounted for.
+TEST(SuccessRateAccumulatorBucketTest, ConcurrentWriters) {
+  SuccessRateAccumulator accumulator(SuccessRateAccumulatorBucket::MaxShards);
+  SuccessRateAccumulatorBucket* bucket = accumulator.updateCurrentWriter();
+  constexpr uint32_t NumThreads = 8;
+  constexpr uint32_t ResultsPerThread = 10000;
+
+  std::vector<Thread::ThreadPtr> threads;
+  for (uint32_t i = 0; i < NumThreads; i++) {
+    threads.push_back(Thread::threadFactoryForTest().createThread([bucket]() {
+      for (uint32_t j = 0; j < ResultsPerThread; j++) {
+        // One in four requests fails.
+        bucket->put(j % 4 != 0);
+      }
+    }));
+  }
+  for (auto& thread : threads) {
+    thread->join();
+  }
+
+  accumulator.updateCurrentWriter();
+  absl::optional<std::pair<double, uint64_t>> success_rate_and_volume =
+      accumulator.getSuccessRateAndVolume();
+  ASSERT_TRUE(success_rate_and_volume.has_value());
+  EXPECT_EQ(75.0, success_rate_and_volume->first);
+  EXPECT_EQ(NumThreads * ResultsPerThread, success_rate_and_volume->second);
 }
 
 } // namespace
@@ -0,0 +1,86 @@
+#include <memory>
+#include <vector>
+
+#include "envoy/config/core/v3/base.pb.h"
+
+#include "common/common/fmt.h"
+#include "common/network/utility.h"
+#include "common/stats/symbol_table_impl.h"
+#include "common/upstream/shared_host_data.h"
+
+#include "gtest/gtest.h"
+
+namespace Envoy {
+namespace Upstream {
+namespace {
+
+TEST(HostLocalityPoolTest, SharesEqualLocalities) {
+  Stats::SymbolTableImpl symbol_table;
+  HostLocalityPool pool(symbol_table);
+
+  envoy::config::core::v3::Locality locality;
+  locality.set_region("region");
+  locality.set_zone("zone");
+  HostLocalityConstSharedPtr first = pool.getLocality(locality);
+  HostLocalityConstSharedPtr second = pool.getLocality(locality);
+  EXPECT_EQ(first, second);
+  EXPECT_EQ("zone", first->locality().zone());
+  EXPECT_EQ("zone", symbol_table.toString(first->zoneStatName()));
+
+  locality.set_sub_zone("sub_zone");
+  HostLocalityConstSharedPtr third = pool.getLocality(locality);
+  EXPECT_NE(first, third);
+  EXPECT_EQ("sub_zone", third->locality().sub_zone());
+  EXPECT_EQ(2, pool.size());
+}
+
+TEST(SharedAddressPoolTest, SharesEqualAddresses) {
+  SharedAddressPool pool;
+  Network::Address::InstanceConstSharedPtr first =
+      pool.getAddress(Network::Utility::resolveUrl("tcp://10.0.0.1:80"));
+  Network::Address::InstanceConstSharedPtr second =
+      pool.getAddress(Network::Utility::resolveUrl("tcp://10.0.0.1:80"));
+  Network::Address::InstanceConstSharedPtr other =
+      pool.getAddress(Network::Utility::resolveUrl("tcp://10.0.0.1:81"));
+  EXPECT_EQ(first, second);
+  EXPECT_NE(first, other);
+  EXPECT_EQ("10.0.0.1:81", other->asString());
+}
+
+// Once no host uses an address any more it is released, and a new address takes its place.
+TEST(SharedAddressPoolTest, ReleasedAddress) {
+  SharedAddressPool pool;
+  Network::Address::InstanceConstSharedPtr first =
+      pool.getAddress(Network::Utility::resolveUrl("tcp://10.0.0.1:80"));
+  std::weak_ptr<const Network::Address::Instance> weak_first = first;
+  first.reset();
+  EXPECT_TRUE(weak_first.expired());
+
+  Network::Address::InstanceConstSharedPtr replacement =
+      Network::Utility::resolveUrl("tcp://10.0.0.1:80");
+  EXPECT_EQ(replacement, pool.getAddress(replacement));
+  EXPECT_EQ(replacement, pool.getAddress(Network::Utility::resolveUrl("tcp://10.0.0.1:80")));
+}
+
+// Expired entries are purged as the pool grows.
+TEST(SharedAddressPoolTest, PurgeExpired) {
+  SharedAddressPool pool;
+  std::vector<Network::Address::InstanceConstSharedPtr> kept;
+  for (uint32_t i = 0; i < 4096; i++) {
+    Network::Address::InstanceConstSharedPtr address = pool.getAddress(
+        Network::Utility::resolveUrl(fmt::format("tcp://10.0.{}.{}:80", i / 256, i % 256)));
+    // Only keep one address in 16 alive.
+    if (i % 16 == 0) {
+      kept.push_back(address);
+    }
+  }
+  EXPECT_LT(pool.size(), 2048);
+  for (const auto& address : kept) {
+    EXPECT_EQ(address,
+              pool.getAddress(Network::Utility::resolveUrl("tcp://" + address->asString())));
+  }
+}
+
+} // namespace
+} // namespace Upstream
+} // namespace Envoy
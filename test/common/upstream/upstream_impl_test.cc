@@ -1227,6 +1227,47 @@ TEST(HostImplTest, HealthcheckHostname) {
   EXPECT_EQ("foo", descr.hostnameForHealthChecks());
 }
 
+// With the compact host representation, stats are only allocated once a host is used, and read
+// as zero before that.
+TEST(HostImplTest, CompactHostLazyStats) {
+  MockClusterMockPrioritySet cluster;
+  HostLocalityPool locality_pool(cluster.info_->statsScope().symbolTable());
+  envoy::config::core::v3::Locality locality;
+  locality.set_zone("us-east-1a");
+  auto make_host = [&](const std::string& url) {
+    return HostSharedPtr{new CompactHostImpl(
+        cluster.info_, "", Network::Utility::resolveUrl(url), nullptr, 1,
+        locality_pool.getLocality(locality),
+        envoy::config::endpoint::v3::Endpoint::HealthCheckConfig::default_instance(), 0,
+        envoy::config::core::v3::UNKNOWN)};
+  };
+  HostSharedPtr host = make_host("tcp://10.0.0.1:1234");
+  HostSharedPtr other_host = make_host("tcp://10.0.0.2:1234");
+  EXPECT_EQ("us-east-1a", host->locality().zone());
+
+  for (const auto& counter : host->counters()) {
+    EXPECT_EQ(0, counter.second.get().value());
+  }
+  for (const auto& gauge : host->gauges()) {
+    EXPECT_EQ(0, gauge.second.get().value());
+  }
+
+  host->stats().rq_total_.inc();
+  host->stats().cx_active_.inc();
+  EXPECT_EQ(&host->stats(), &host->stats());
+  for (const auto& counter : host->counters()) {
+    EXPECT_EQ(counter.first == "rq_total" ? 1 : 0, counter.second.get().value());
+  }
+  for (const auto& gauge : host->gauges()) {
+    EXPECT_EQ(gauge.first == "cx_active" ? 1 : 0, gauge.second.get().value());
+  }
+
+  // Other hosts are unaffected.
+  for (const auto& counter : other_host->counters()) {
+    EXPECT_EQ(0, counter.second.get().value());
+  }
+}
+
 class StaticClusterImplTest : public testing::Test, public UpstreamImplTestBase {};
 
 TEST_F(StaticClusterImplTest, InitialHosts) {
@@ -1256,6 +1297,61 @@ TEST_F(StaticClusterImplTest, InitialHosts) {
   EXPECT_FALSE(cluster.info()->addedViaApi());
 }
 
+// With the compact host representation hosts share their locality with other hosts of the
+// cluster, and their address with identical hosts of other clusters.
+TEST_F(StaticClusterImplTest, CompactHostRepresentation) {
+  const std::string yaml = R"EOF(
+    name: {}
+    connect_timeout: 0.25s
+    type: STATIC
+    lb_policy: ROUND_ROBIN
+    compact_host_representation: true
+    load_assignment:
+      endpoints:
+      - locality:
+          zone: us-east-1a
+        lb_endpoints:
+        - endpoint:
+            address:
+              socket_address:
+                address: 10.0.0.1
+                port_value: 443
+        - endpoint:
+            address:
+              socket_address:
+                address: 10.0.0.2
+                port_value: 443
+  )EOF";
+
+  std::vector<std::unique_ptr<StaticClusterImpl>> clusters;
+  for (const std::string name : {"cluster_a", "cluster_b"}) {
+    envoy::config::cluster::v3::Cluster cluster_config =
+        parseClusterFromV2Yaml(fmt::format(yaml, name));
+    Envoy::Stats::ScopePtr scope = stats_.createScope(fmt::format("cluster.{}.", name));
+    Envoy::Server::Configuration::TransportSocketFactoryContextImpl factory_context(
+        admin_, ssl_context_manager_, *scope, cm_, local_info_, dispatcher_, random_, stats_,
+        singleton_manager_, tls_, validation_visitor_, *api_);
+    clusters.push_back(std::make_unique<StaticClusterImpl>(cluster_config, runtime_,
+                                                           factory_context, std::move(scope), false));
+    clusters.back()->initialize([] {});
+  }
+
+  const HostVector& hosts_a = clusters[0]->prioritySet().hostSetsPerPriority()[0]->hosts();
+  const HostVector& hosts_b = clusters[1]->prioritySet().hostSetsPerPriority()[0]->hosts();
+  ASSERT_EQ(2, hosts_a.size());
+  ASSERT_EQ(2, hosts_b.size());
+  EXPECT_TRUE(clusters[0]->info()->compactHostRepresentation());
+  EXPECT_NE(nullptr, dynamic_cast<const CompactHostImpl*>(hosts_a[0].get()));
+
+  EXPECT_EQ("us-east-1a", hosts_a[0]->locality().zone());
+  EXPECT_EQ(&hosts_a[0]->locality(), &hosts_a[1]->locality());
+  EXPECT_EQ(hosts_a[0]->localityZoneStatName(), hosts_a[1]->localityZoneStatName());
+
+  EXPECT_EQ(hosts_a[0]->address(), hosts_b[0]->address());
+  EXPECT_EQ(hosts_a[1]->address(), hosts_b[1]->address());
+  EXPECT_NE(hosts_a[0]->address(), hosts_a[1]->address());
+}
+
 TEST_F(StaticClusterImplTest, LoadAssignmentEmptyHostname) {
   const std::string yaml = R"EOF(
     name: staticcluster
@@ -2348,6 +2444,26 @@ TEST_F(ClusterInfoImplTest, TestTrackTimeoutBudgets) {
             cluster->info()->timeoutBudgetStats()->upstream_rq_timeout_budget_percent_used_.unit());
 }
 
+TEST_F(ClusterInfoImplTest, PreconnectPolicy) {
+  const std::string yaml = R"EOF(
+    name: name
+    connect_timeout: 0.25s
+    type: STRICT_DNS
+    lb_policy: ROUND_ROBIN
+  )EOF";
+
+  auto cluster = makeCluster(yaml);
+  EXPECT_EQ(1.0, cluster->info()->perUpstreamPreconnectRatio());
+
+  const std::string preconnect = R"EOF(
+    preconnect_policy:
+      per_upstream_preconnect_ratio: 1.5
+  )EOF";
+
+  cluster = makeCluster(yaml + preconnect);
+  EXPECT_EQ(1.5, cluster->info()->perUpstreamPreconnectRatio());
+}
+
 // Validates HTTP2 SETTINGS config.
 TEST_F(ClusterInfoImplTest, Http2ProtocolOptions) {
   const std::string yaml = R"EOF(
@@ -0,0 +1,133 @@
+// Usage: bazel run //test/extensions/filters/common/rbac:engine_impl_speed_test
+// Note: this should be run with --compilation_mode=opt.
+
+#include <map>
+#include <memory>
+#include <string>
+
+#include "envoy/config/rbac/v3/rbac.pb.h"
+
+#include "common/common/assert.h"
+#include "common/network/utility.h"
+
+#include "extensions/filters/common/rbac/engine_impl.h"
+#include "extensions/filters/common/rbac/matchers.h"
+
+#include "test/mocks/network/mocks.h"
+#include "test/mocks/ssl/mocks.h"
+#include "test/mocks/stream_info/mocks.h"
+#include "test/test_common/utility.h"
+
+#include "absl/strings/str_cat.h"
+#include "benchmark/benchmark.h"
+#include "gmock/gmock.h"
+
+using testing::Const;
+using testing::NiceMock;
+using testing::Return;
+using testing::ReturnRef;
+
+namespace Envoy {
+namespace Extensions {
+namespace Filters {
+namespace Common {
+namespace RBAC {
+namespace {
+
+std::string serviceName(int64_t service) {
+  return absl::StrCat("spiffe://cluster.local/ns/default/sa/service", service);
+}
+
+// A policy per service allowing GET requests under /api/ to the peer authenticated with the
+// SPIFFE ID of the service. The principal name is matched exactly if exact is set, otherwise by
+// suffix.
+envoy::config::rbac::v3::RBAC servicePolicies(int64_t services, bool exact) {
+  envoy::config::rbac::v3::RBAC rbac;
+  rbac.set_action(envoy::config::rbac::v3::RBAC::ALLOW);
+  for (int64_t i = 0; i < services; i++) {
+    envoy::config::rbac::v3::Policy policy;
+    auto* rules = policy.add_permissions()->mutable_and_rules();
+    auto* method = rules->add_rules()->mutable_header();
+    method->set_name(":method");
+    method->set_exact_match("GET");
+    rules->add_rules()->mutable_url_path()->mutable_path()->set_prefix("/api/");
+    auto* principal_name =
+        policy.add_principals()->mutable_authenticated()->mutable_principal_name();
+    if (exact) {
+      principal_name->set_exact(serviceName(i));
+    } else {
+      principal_name->set_suffix(absl::StrCat("/sa/service", i));
+    }
+    (*rbac.mutable_policies())[absl::StrCat("service", i)] = policy;
+  }
+  return rbac;
+}
+
+// A request of the last service in the order of the policy names, which is the worst case.
+class ServiceRequest {
+public:
+  explicit ServiceRequest(int64_t services)
+      : uri_sans_{serviceName(services - 1)},
+        address_(Network::Utility::parseInternetAddress("1.2.3.4", 443, false)) {
+    ON_CALL(*ssl_, uriSanPeerCertificate()).WillByDefault(Return(uri_sans_));
+    ON_CALL(*ssl_, dnsSansPeerCertificate()).WillByDefault(Return(dns_sans_));
+    ON_CALL(*ssl_, subjectPeerCertificate()).WillByDefault(ReturnRef(subject_));
+    ON_CALL(Const(connection_), ssl()).WillByDefault(Return(ssl_));
+    ON_CALL(Const(info_), downstreamLocalAddress()).WillByDefault(ReturnRef(address_));
+  }
+
+  const std::vector<std::string> uri_sans_;
+  const std::vector<std::string> dns_sans_;
+  const std::string subject_;
+  const Network::Address::InstanceConstSharedPtr address_;
+  std::shared_ptr<NiceMock<Ssl::MockConnectionInfo>> ssl_{
+      std::make_shared<NiceMock<Ssl::MockConnectionInfo>>()};
+  NiceMock<Network::MockConnection> connection_;
+  NiceMock<StreamInfo::MockStreamInfo> info_;
+  Http::TestRequestHeaderMapImpl headers_{{":method", "GET"}, {":path", "/api/v1/resource"}};
+};
+
+// Evaluates the policies one after the other, each with its own matchers.
+// state.range(0) supplies the number of services, state.range(1) whether the principal names are
+// matched exactly.
+static void BM_PolicyMatchers(benchmark::State& state) {
+  const envoy::config::rbac::v3::RBAC rbac = servicePolicies(state.range(0), state.range(1));
+  std::map<std::string, std::unique_ptr<PolicyMatcher>> policies;
+  for (const auto& policy : rbac.policies()) {
+    policies.emplace(policy.first, std::make_unique<PolicyMatcher>(policy.second, nullptr));
+  }
+  ServiceRequest request(state.range(0));
+  for (auto _ : state) {
+    bool matched = false;
+    for (const auto& policy : policies) {
+      if (policy.second->matches(request.connection_, request.headers_, request.info_)) {
+        matched = true;
+        break;
+      }
+    }
+    RELEASE_ASSERT(matched, "");
+  }
+}
+BENCHMARK(BM_PolicyMatchers)->Args({10, 0})->Args({2000, 0})->Args({10, 1})->Args({2000, 1});
+
+// Evaluates the policies with the engine, which shares the identical permissions of the policies
+// and indexes the exact principal names.
+// state.range(0) supplies the number of services, state.range(1) whether the principal names are
+// matched exactly.
+static void BM_Engine(benchmark::State& state) {
+  const RoleBasedAccessControlEngineImpl engine(
+      servicePolicies(state.range(0), state.range(1)));
+  ServiceRequest request(state.range(0));
+  for (auto _ : state) {
+    RELEASE_ASSERT(engine.allowed(request.connection_, request.headers_, request.info_, nullptr),
+                   "");
+  }
+}
+BENCHMARK(BM_Engine)->Args({10, 0})->Args({2000, 0})->Args({10, 1})->Args({2000, 1});
+
+} // namespace
+} // namespace RBAC
+} // namespace Common
+} // namespace Filters
+} // namespace Extensions
+} // namespace Envoy
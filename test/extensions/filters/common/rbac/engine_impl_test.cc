@@ -15,6 +15,7 @@
 #include "gtest/gtest.h"
 
 using testing::Const;
+using testing::Return;
 using testing::ReturnRef;
 
 namespace Envoy {
@@ -357,6 +358,103 @@ TEST(RoleBasedAccessControlEngineImpl, ConjunctiveCondition) {
   checkEngine(engine, false, conn, headers, info);
 }
 
+// Identical rules of different policies are evaluated once per request.
+TEST(RoleBasedAccessControlEngineImpl, SharedRules) {
+  envoy::config::rbac::v3::Policy policy_a;
+  policy_a.add_permissions()->set_destination_port(123);
+  policy_a.add_principals()->mutable_header()->set_name("x-principal");
+  envoy::config::rbac::v3::Policy policy_b;
+  policy_b.add_permissions()->set_destination_port(123);
+  policy_b.add_principals()->set_any(true);
+
+  envoy::config::rbac::v3::RBAC rbac;
+  rbac.set_action(envoy::config::rbac::v3::RBAC::ALLOW);
+  (*rbac.mutable_policies())["b"] = policy_b;
+  (*rbac.mutable_policies())["a"] = policy_a;
+  RBAC::RoleBasedAccessControlEngineImpl engine(rbac);
+
+  Envoy::Network::MockConnection conn;
+  NiceMock<StreamInfo::MockStreamInfo> info;
+  Envoy::Network::Address::InstanceConstSharedPtr addr =
+      Envoy::Network::Utility::parseInternetAddress("1.2.3.4", 123, false);
+  EXPECT_CALL(Const(info), downstreamLocalAddress()).WillOnce(ReturnRef(addr));
+  std::string effective_policy_id;
+  EXPECT_TRUE(engine.allowed(conn, Envoy::Http::RequestHeaderMapImpl(), info,
+                             &effective_policy_id));
+  EXPECT_EQ("b", effective_policy_id);
+
+  Envoy::Http::TestRequestHeaderMapImpl headers{{"x-principal", "foo"}};
+  EXPECT_CALL(Const(info), downstreamLocalAddress()).WillOnce(ReturnRef(addr));
+  EXPECT_TRUE(engine.allowed(conn, headers, info, &effective_policy_id));
+  EXPECT_EQ("a", effective_policy_id);
+}
+
+// Policies of exact principal names are only evaluated for the peers presenting them, still in the
+// order of the policy names.
+TEST(RoleBasedAccessControlEngineImpl, IndexedPrincipals) {
+  envoy::config::rbac::v3::Policy not_matched;
+  not_matched.add_permissions()->set_destination_port(456);
+  not_matched.add_principals()->set_any(true);
+  envoy::config::rbac::v3::Policy foo;
+  foo.add_permissions()->set_any(true);
+  foo.add_principals()->mutable_authenticated()->mutable_principal_name()->set_exact(
+      "spiffe://cluster.local/ns/default/sa/foo");
+  envoy::config::rbac::v3::Policy bar;
+  bar.add_permissions()->set_any(true);
+  auto* or_ids = bar.add_principals()->mutable_or_ids();
+  or_ids->add_ids()->mutable_authenticated()->mutable_principal_name()->set_exact("bar");
+  or_ids->add_ids()->mutable_authenticated()->mutable_principal_name()->set_exact(
+      "spiffe://cluster.local/ns/default/sa/foo");
+  envoy::config::rbac::v3::Policy baz_prefix;
+  baz_prefix.add_permissions()->set_any(true);
+  baz_prefix.add_principals()->mutable_authenticated()->mutable_principal_name()->set_prefix(
+      "baz");
+
+  envoy::config::rbac::v3::RBAC rbac;
+  rbac.set_action(envoy::config::rbac::v3::RBAC::ALLOW);
+  (*rbac.mutable_policies())["a"] = not_matched;
+  (*rbac.mutable_policies())["b"] = bar;
+  (*rbac.mutable_policies())["c"] = foo;
+  (*rbac.mutable_policies())["d"] = baz_prefix;
+  RBAC::RoleBasedAccessControlEngineImpl engine(rbac);
+
+  NiceMock<Envoy::Network::MockConnection> conn;
+  Envoy::Http::RequestHeaderMapImpl headers;
+  NiceMock<StreamInfo::MockStreamInfo> info;
+  Envoy::Network::Address::InstanceConstSharedPtr addr =
+      Envoy::Network::Utility::parseInternetAddress("1.2.3.4", 123, false);
+  ON_CALL(Const(info), downstreamLocalAddress()).WillByDefault(ReturnRef(addr));
+
+  auto ssl = std::make_shared<NiceMock<Ssl::MockConnectionInfo>>();
+  std::vector<std::string> uri_sans;
+  const std::vector<std::string> dns_sans;
+  std::string subject;
+  ON_CALL(*ssl, uriSanPeerCertificate()).WillByDefault(testing::ReturnPointee(&uri_sans));
+  ON_CALL(*ssl, dnsSansPeerCertificate()).WillByDefault(Return(dns_sans));
+  ON_CALL(*ssl, subjectPeerCertificate()).WillByDefault(ReturnRef(subject));
+  ON_CALL(Const(conn), ssl()).WillByDefault(Return(ssl));
+
+  std::string effective_policy_id;
+  uri_sans = {"spiffe://cluster.local/ns/default/sa/foo"};
+  EXPECT_TRUE(engine.allowed(conn, headers, info, &effective_policy_id));
+  EXPECT_EQ("b", effective_policy_id);
+
+  uri_sans = {"spiffe://cluster.local/ns/default/sa/qux"};
+  subject = "bar";
+  EXPECT_TRUE(engine.allowed(conn, headers, info, &effective_policy_id));
+  EXPECT_EQ("b", effective_policy_id);
+
+  subject = "baz.example.com";
+  EXPECT_TRUE(engine.allowed(conn, headers, info, &effective_policy_id));
+  EXPECT_EQ("d", effective_policy_id);
+
+  subject = "qux";
+  EXPECT_FALSE(engine.allowed(conn, headers, info, nullptr));
+
+  ON_CALL(Const(conn), ssl()).WillByDefault(Return(nullptr));
+  EXPECT_FALSE(engine.allowed(conn, headers, info, nullptr));
+}
+
 } // namespace
 } // namespace RBAC
 } // namespace Common
@@ -1,3 +1,4 @@
+#include <fstream>
 #include <memory>
 
 #include "envoy/extensions/filters/http/ip_tagging/v3/ip_tagging.pb.h"
@@ -12,6 +13,7 @@
 #include "test/mocks/http/mocks.h"
 #include "test/mocks/runtime/mocks.h"
 #include "test/mocks/stats/mocks.h"
+#include "test/test_common/environment.h"
 #include "test/test_common/utility.h"
 
 #include "gmock/gmock.h"
@@ -45,7 +47,12 @@ ip_tags:
   void initializeFilter(const std::string& yaml) {
     envoy::extensions::filters::http::ip_tagging::v3::IPTagging config;
     TestUtility::loadFromYaml(yaml, config);
-    config_ = std::make_shared<IpTaggingFilterConfig>(config, "prefix.", stats_, runtime_);
+    initializeFilter(config);
+  }
+
+  void initializeFilter(const envoy::extensions::filters::http::ip_tagging::v3::IPTagging& config) {
+    config_ =
+        std::make_shared<IpTaggingFilterConfig>(config, "prefix.", stats_, runtime_, *api_);
     filter_ = std::make_unique<IpTaggingFilter>(config_);
     filter_->setDecoderFilterCallbacks(filter_callbacks_);
   }
@@ -53,6 +60,7 @@ ip_tags:
   ~IpTaggingFilterTest() override { filter_->onDestroy(); }
 
   NiceMock<Stats::MockStore> stats_;
+  Api::ApiPtr api_{Api::createApiForTest()};
   IpTaggingFilterConfigSharedPtr config_;
   std::unique_ptr<IpTaggingFilter> filter_;
   NiceMock<Http::MockStreamDecoderFilterCallbacks> filter_callbacks_;
@@ -288,6 +296,151 @@ TEST_F(IpTaggingFilterTest, ClearRouteCache) {
   EXPECT_FALSE(request_headers.has(Http::Headers::get().EnvoyIpTags));
 }
 
+// Compiles the IP tags of a configuration, as the ip_tags_compiler tool does.
+std::string compileIpTags(const std::string& yaml) {
+  envoy::extensions::filters::http::ip_tagging::v3::IPTagging config;
+  TestUtility::loadFromYaml(yaml, config);
+  return IpTaggingFilterConfig::buildTrie(config)->snapshot();
+}
+
+TEST_F(IpTaggingFilterTest, CompiledIpTagsFile) {
+  const std::string file_path = TestEnvironment::writeStringToFileForTest(
+      "compiled_ip_tags", compileIpTags(internal_request_yaml));
+  initializeFilter(fmt::format(R"EOF(
+request_type: internal
+compiled_ip_tags:
+  filename: {}
+)EOF",
+                               file_path));
+  Http::TestRequestHeaderMapImpl request_headers{{"x-envoy-internal", "true"}};
+
+  Network::Address::InstanceConstSharedPtr remote_address =
+      Network::Utility::parseInternetAddress("1.2.3.5");
+  EXPECT_CALL(filter_callbacks_.stream_info_, downstreamRemoteAddress())
+      .WillOnce(ReturnRef(remote_address));
+
+  EXPECT_CALL(stats_, counter("prefix.ip_tagging.internal_request.hit")).Times(1);
+  EXPECT_CALL(stats_, counter("prefix.ip_tagging.total")).Times(1);
+
+  EXPECT_EQ(Http::FilterHeadersStatus::Continue, filter_->decodeHeaders(request_headers, false));
+  EXPECT_EQ("internal_request", request_headers.get_(Http::Headers::get().EnvoyIpTags));
+}
+
+// A compiled IP tags file which is replaced by renaming a new file over it keeps the tags it was
+// loaded with.
+TEST_F(IpTaggingFilterTest, CompiledIpTagsFileReplaced) {
+  const std::string file_path = TestEnvironment::writeStringToFileForTest(
+      "compiled_ip_tags", compileIpTags(internal_request_yaml));
+  envoy::extensions::filters::http::ip_tagging::v3::IPTagging config;
+  config.mutable_compiled_ip_tags()->set_filename(file_path);
+  initializeFilter(config);
+
+  const std::string new_file_path = TestEnvironment::writeStringToFileForTest(
+      "compiled_ip_tags_new", compileIpTags(R"EOF(
+ip_tags:
+  - ip_tag_name: replaced
+    ip_list:
+      - {address_prefix: 1.2.3.4, prefix_len: 32}
+)EOF"));
+  TestEnvironment::renameFile(new_file_path, file_path);
+
+  EXPECT_EQ(std::vector<std::string>{"internal_request"},
+            config_->trie().getData(Network::Utility::parseInternetAddress("1.2.3.5")));
+  EXPECT_TRUE(config_->trie().getData(Network::Utility::parseInternetAddress("1.2.3.4")).empty());
+}
+
+// A compiled IP tags file which is truncated or rewritten in place keeps the tags it was loaded
+// with, as the filter does not use the file once it is read.
+TEST_F(IpTaggingFilterTest, CompiledIpTagsFileRewritten) {
+  const std::string file_path = TestEnvironment::writeStringToFileForTest(
+      "compiled_ip_tags", compileIpTags(internal_request_yaml));
+  envoy::extensions::filters::http::ip_tagging::v3::IPTagging config;
+  config.mutable_compiled_ip_tags()->set_filename(file_path);
+  initializeFilter(config);
+
+  std::ofstream(file_path, std::ios_base::binary | std::ios_base::trunc).flush();
+  EXPECT_EQ(std::vector<std::string>{"internal_request"},
+            config_->trie().getData(Network::Utility::parseInternetAddress("1.2.3.5")));
+
+  std::ofstream(file_path, std::ios_base::binary | std::ios_base::trunc) << compileIpTags(R"EOF(
+ip_tags:
+  - ip_tag_name: rewritten
+    ip_list:
+      - {address_prefix: 1.2.3.4, prefix_len: 32}
+)EOF");
+  EXPECT_EQ(std::vector<std::string>{"internal_request"},
+            config_->trie().getData(Network::Utility::parseInternetAddress("1.2.3.5")));
+  EXPECT_TRUE(config_->trie().getData(Network::Utility::parseInternetAddress("1.2.3.4")).empty());
+}
+
+TEST_F(IpTaggingFilterTest, CompiledIpTagsInlineBytes) {
+  envoy::extensions::filters::http::ip_tagging::v3::IPTagging config;
+  config.mutable_compiled_ip_tags()->set_inline_bytes(compileIpTags(internal_request_yaml));
+  initializeFilter(config);
+
+  EXPECT_EQ(std::vector<std::string>{"internal_request"},
+            config_->trie().getData(Network::Utility::parseInternetAddress("1.2.3.5")));
+  EXPECT_TRUE(config_->trie().getData(Network::Utility::parseInternetAddress("1.2.3.4")).empty());
+}
+
+TEST(IpTaggingFilterConfigTest, InvalidCompiledIpTags) {
+  NiceMock<Stats::MockStore> stats;
+  NiceMock<Runtime::MockLoader> runtime;
+  Api::ApiPtr api = Api::createApiForTest();
+  envoy::extensions::filters::http::ip_tagging::v3::IPTagging config;
+  config.mutable_compiled_ip_tags()->set_inline_string("not compiled");
+  EXPECT_THROW_WITH_MESSAGE(IpTaggingFilterConfig(config, "prefix.", stats, runtime, *api),
+                            EnvoyException, "Invalid LC-Trie snapshot: truncated header.");
+
+  const std::string file_path = TestEnvironment::temporaryPath("missing_compiled_ip_tags");
+  config.mutable_compiled_ip_tags()->set_filename(file_path);
+  EXPECT_THROW_WITH_MESSAGE(IpTaggingFilterConfig(config, "prefix.", stats, runtime, *api),
+                            EnvoyException, "unable to read file: " + file_path);
+}
+
+// Large IPv4 tables are only held in a DIR-24-8 table, which takes at least 64 MiB, when
+// ipv4_direct_table is set.
+TEST(IpTaggingFilterConfigTest, Ipv4DirectTable) {
+  envoy::extensions::filters::http::ip_tagging::v3::IPTagging config;
+  auto* ip_tag = config.add_ip_tags();
+  ip_tag->set_ip_tag_name("tag");
+  for (size_t i = 0; i < Network::LcTrie::MinIpv4DirectTableRanges; i++) {
+    auto* cidr_range = ip_tag->add_ip_list();
+    cidr_range->set_address_prefix(fmt::format("10.{}.{}.0", i >> 8, i & 0xff));
+    cidr_range->mutable_prefix_len()->set_value(24);
+  }
+  const size_t direct_table_size = sizeof(uint32_t) << 24;
+
+  std::unique_ptr<Network::LcTrie::LcTrie<std::string>> trie =
+      IpTaggingFilterConfig::buildTrie(config);
+  EXPECT_LT(trie->snapshot().size(), direct_table_size);
+  EXPECT_EQ(std::vector<std::string>{"tag"},
+            trie->getData(Network::Utility::parseInternetAddress("10.1.2.3")));
+
+  config.set_ipv4_direct_table(true);
+  trie = IpTaggingFilterConfig::buildTrie(config);
+  EXPECT_GE(trie->snapshot().size(), direct_table_size);
+  EXPECT_EQ(std::vector<std::string>{"tag"},
+            trie->getData(Network::Utility::parseInternetAddress("10.1.2.3")));
+}
+
+TEST(IpTaggingFilterConfigTest, IpTagsOrCompiledIpTags) {
+  NiceMock<Stats::MockStore> stats;
+  NiceMock<Runtime::MockLoader> runtime;
+  Api::ApiPtr api = Api::createApiForTest();
+  envoy::extensions::filters::http::ip_tagging::v3::IPTagging config;
+  EXPECT_THROW_WITH_MESSAGE(
+      IpTaggingFilterConfig(config, "prefix.", stats, runtime, *api), EnvoyException,
+      "HTTP IP Tagging Filter requires ip_tags or compiled_ip_tags to be specified.");
+
+  config.add_ip_tags()->set_ip_tag_name("tag");
+  config.mutable_compiled_ip_tags()->set_inline_bytes("compiled");
+  EXPECT_THROW_WITH_MESSAGE(IpTaggingFilterConfig(config, "prefix.", stats, runtime, *api),
+                            EnvoyException,
+                            "HTTP IP Tagging Filter requires only one of ip_tags and "
+                            "compiled_ip_tags to be specified.");
+}
+
 // Test that the deprecated extension name still functions.
 TEST(IpTaggingFilterConfigTest, DEPRECATED_FEATURE_TEST(DeprecatedExtensionFilterName)) {
   const std::string deprecated_name = "envoy.ip_tagging";
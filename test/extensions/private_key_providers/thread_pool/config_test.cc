@@ -0,0 +1,87 @@
+#include "envoy/extensions/private_key_providers/thread_pool/v3/thread_pool.pb.h"
+#include "envoy/extensions/transport_sockets/tls/v3/cert.pb.h"
+#include "envoy/registry/registry.h"
+#include "envoy/ssl/private_key/private_key_config.h"
+
+#include "extensions/private_key_providers/thread_pool/config.h"
+
+#include "test/mocks/server/mocks.h"
+#include "test/test_common/environment.h"
+#include "test/test_common/utility.h"
+
+#include "gtest/gtest.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace PrivateKeyMethodProvider {
+namespace ThreadPool {
+namespace {
+
+using testing::NiceMock;
+using testing::ReturnRef;
+
+class ThreadPoolPrivateKeyMethodFactoryTest : public testing::Test {
+protected:
+  ThreadPoolPrivateKeyMethodFactoryTest() : api_(Api::createApiForTest(store_)) {
+    ON_CALL(factory_context_, api()).WillByDefault(ReturnRef(*api_));
+    ON_CALL(factory_context_, scope()).WillByDefault(ReturnRef(store_));
+  }
+
+  Ssl::PrivateKeyMethodProviderSharedPtr createProvider(const std::string& yaml) {
+    envoy::extensions::transport_sockets::tls::v3::PrivateKeyProvider config;
+    TestUtility::loadFromYaml(TestEnvironment::substitute(yaml), config);
+    auto* factory =
+        Registry::FactoryRegistry<Ssl::PrivateKeyMethodProviderInstanceFactory>::getFactory(
+            "envoy.tls.key_providers.thread_pool");
+    EXPECT_NE(factory, nullptr);
+    return factory->createPrivateKeyMethodProviderInstance(config, factory_context_);
+  }
+
+  Stats::IsolatedStoreImpl store_;
+  Api::ApiPtr api_;
+  NiceMock<Server::Configuration::MockTransportSocketFactoryContext> factory_context_;
+};
+
+TEST_F(ThreadPoolPrivateKeyMethodFactoryTest, CreateProvider) {
+  const std::string yaml = R"EOF(
+    provider_name: envoy.tls.key_providers.thread_pool
+    typed_config:
+      "@type": type.googleapis.com/envoy.extensions.private_key_providers.thread_pool.v3.ThreadPoolPrivateKeyMethodConfig
+      private_key:
+        filename: "{{ test_rundir }}/test/extensions/transport_sockets/tls/test_data/selfsigned_key.pem"
+      threads: 1
+      max_queued_operations: 16
+  )EOF";
+  Ssl::PrivateKeyMethodProviderSharedPtr provider = createProvider(yaml);
+  ASSERT_NE(provider, nullptr);
+  EXPECT_NE(provider->getBoringSslPrivateKeyMethod(), nullptr);
+}
+
+TEST_F(ThreadPoolPrivateKeyMethodFactoryTest, MissingPrivateKey) {
+  const std::string yaml = R"EOF(
+    provider_name: envoy.tls.key_providers.thread_pool
+    typed_config:
+      "@type": type.googleapis.com/envoy.extensions.private_key_providers.thread_pool.v3.ThreadPoolPrivateKeyMethodConfig
+      threads: 1
+  )EOF";
+  EXPECT_THROW_WITH_REGEX(createProvider(yaml), EnvoyException, "value is required");
+}
+
+TEST_F(ThreadPoolPrivateKeyMethodFactoryTest, TooManyThreads) {
+  const std::string yaml = R"EOF(
+    provider_name: envoy.tls.key_providers.thread_pool
+    typed_config:
+      "@type": type.googleapis.com/envoy.extensions.private_key_providers.thread_pool.v3.ThreadPoolPrivateKeyMethodConfig
+      private_key:
+        filename: "{{ test_rundir }}/test/extensions/transport_sockets/tls/test_data/selfsigned_key.pem"
+      threads: 65
+  )EOF";
+  EXPECT_THROW_WITH_REGEX(createProvider(yaml), EnvoyException,
+                          "value must be less than or equal to 64");
+}
+
+} // namespace
+} // namespace ThreadPool
+} // namespace PrivateKeyMethodProvider
+} // namespace Extensions
+} // namespace Envoy
@@ -0,0 +1,278 @@
+#include <string>
+#include <vector>
+
+#include "envoy/extensions/private_key_providers/thread_pool/v3/thread_pool.pb.h"
+#include "envoy/ssl/private_key/private_key_callbacks.h"
+
+#include "common/stats/isolated_store_impl.h"
+
+#include "extensions/private_key_providers/thread_pool/thread_pool_private_key_provider.h"
+
+#include "test/mocks/server/mocks.h"
+#include "test/test_common/environment.h"
+#include "test/test_common/utility.h"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "openssl/evp.h"
+#include "openssl/pem.h"
+#include "openssl/ssl.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace PrivateKeyMethodProvider {
+namespace ThreadPool {
+namespace {
+
+using testing::Invoke;
+using testing::NiceMock;
+using testing::ReturnRef;
+
+class MockPrivateKeyConnectionCallbacks : public Ssl::PrivateKeyConnectionCallbacks {
+public:
+  MOCK_METHOD(void, onPrivateKeyMethodComplete, ());
+};
+
+const std::string& testData() {
+  CONSTRUCT_ON_FIRST_USE(std::string, TestEnvironment::substitute(
+                                          "{{ test_rundir }}/test/extensions/transport_sockets/"
+                                          "tls/test_data/"));
+}
+
+class ThreadPoolPrivateKeyProviderTest : public testing::Test {
+protected:
+  ThreadPoolPrivateKeyProviderTest()
+      : api_(Api::createApiForTest(store_)), dispatcher_(api_->allocateDispatcher("test_thread")),
+        ssl_ctx_(SSL_CTX_new(TLS_method())), ssl_(SSL_new(ssl_ctx_.get())) {
+    ON_CALL(factory_context_, api()).WillByDefault(ReturnRef(*api_));
+    ON_CALL(factory_context_, scope()).WillByDefault(ReturnRef(store_));
+  }
+
+  std::unique_ptr<ThreadPoolPrivateKeyMethodProvider> makeProvider(const std::string& key_file) {
+    envoy::extensions::private_key_providers::thread_pool::v3::ThreadPoolPrivateKeyMethodConfig
+        config;
+    config.mutable_private_key()->set_filename(testData() + key_file);
+    config.mutable_threads()->set_value(1);
+    return std::make_unique<ThreadPoolPrivateKeyMethodProvider>(config, factory_context_);
+  }
+
+  void createProvider(const std::string& key_file) {
+    provider_ = makeProvider(key_file);
+    provider_->registerPrivateKeyMethod(ssl_.get(), callbacks_, *dispatcher_);
+    method_ = provider_->getBoringSslPrivateKeyMethod();
+    loadKey(key_file);
+  }
+
+  // Loads the key which signatures are verified with.
+  void loadKey(const std::string& key_file) {
+    const std::string key = api_->fileSystem().fileReadToEnd(testData() + key_file);
+    bssl::UniquePtr<BIO> bio(BIO_new_mem_buf(key.data(), key.size()));
+    pkey_.reset(PEM_read_bio_PrivateKey(bio.get(), nullptr, nullptr, nullptr));
+  }
+
+  // Selects the certificate for the handshake, as the server context does by server name.
+  void useCertificate(const std::string& cert_file) {
+    const std::string cert = api_->fileSystem().fileReadToEnd(testData() + cert_file);
+    bssl::UniquePtr<BIO> bio(BIO_new_mem_buf(cert.data(), cert.size()));
+    bssl::UniquePtr<X509> x509(PEM_read_bio_X509(bio.get(), nullptr, nullptr, nullptr));
+    ASSERT_TRUE(SSL_use_certificate(ssl_.get(), x509.get()));
+  }
+
+  // Runs the dispatcher until the provider resumes the handshake.
+  void waitForCompletion() {
+    EXPECT_CALL(callbacks_, onPrivateKeyMethodComplete()).WillOnce(Invoke([this]() -> void {
+      dispatcher_->exit();
+    }));
+    dispatcher_->run(Event::Dispatcher::RunType::RunUntilExit);
+  }
+
+  bool verify(uint16_t signature_algorithm, const std::vector<uint8_t>& signature) {
+    bssl::ScopedEVP_MD_CTX ctx;
+    EVP_PKEY_CTX* pkey_ctx;
+    const EVP_MD* md = SSL_get_signature_algorithm_digest(signature_algorithm);
+    if (!EVP_DigestVerifyInit(ctx.get(), &pkey_ctx, md, nullptr, pkey_.get())) {
+      return false;
+    }
+    if (SSL_is_signature_algorithm_rsa_pss(signature_algorithm) &&
+        (!EVP_PKEY_CTX_set_rsa_padding(pkey_ctx, RSA_PKCS1_PSS_PADDING) ||
+         !EVP_PKEY_CTX_set_rsa_pss_saltlen(pkey_ctx, -1))) {
+      return false;
+    }
+    return EVP_DigestVerify(ctx.get(), signature.data(), signature.size(), input_.data(),
+                            input_.size()) == 1;
+  }
+
+  std::vector<uint8_t> signAsync(uint16_t signature_algorithm) {
+    std::vector<uint8_t> out(MaxOut);
+    size_t out_len = 0;
+    EXPECT_EQ(ssl_private_key_retry, method_->sign(ssl_.get(), out.data(), &out_len, out.size(),
+                                                   signature_algorithm, input_.data(),
+                                                   input_.size()));
+    waitForCompletion();
+    EXPECT_EQ(ssl_private_key_success,
+              method_->complete(ssl_.get(), out.data(), &out_len, out.size()));
+    out.resize(out_len);
+    return out;
+  }
+
+  uint64_t counter(const std::string& name) {
+    return TestUtility::findCounter(store_, "private_key_provider.thread_pool." + name)->value();
+  }
+
+  uint64_t gauge(const std::string& name) {
+    return TestUtility::findGauge(store_, "private_key_provider.thread_pool." + name)->value();
+  }
+
+  static constexpr size_t MaxOut = 1024;
+  const std::vector<uint8_t> input_{'h', 'a', 'n', 'd', 's', 'h', 'a', 'k', 'e'};
+  Stats::IsolatedStoreImpl store_;
+  Api::ApiPtr api_;
+  Event::DispatcherPtr dispatcher_;
+  NiceMock<Server::Configuration::MockTransportSocketFactoryContext> factory_context_;
+  bssl::UniquePtr<SSL_CTX> ssl_ctx_;
+  bssl::UniquePtr<SSL> ssl_;
+  MockPrivateKeyConnectionCallbacks callbacks_;
+  std::unique_ptr<ThreadPoolPrivateKeyMethodProvider> provider_;
+  Ssl::BoringSslPrivateKeyMethodSharedPtr method_;
+  bssl::UniquePtr<EVP_PKEY> pkey_;
+};
+
+TEST_F(ThreadPoolPrivateKeyProviderTest, RsaSign) {
+  createProvider("selfsigned_key.pem");
+  EXPECT_TRUE(verify(SSL_SIGN_RSA_PKCS1_SHA256, signAsync(SSL_SIGN_RSA_PKCS1_SHA256)));
+  EXPECT_TRUE(verify(SSL_SIGN_RSA_PSS_RSAE_SHA256, signAsync(SSL_SIGN_RSA_PSS_RSAE_SHA256)));
+  EXPECT_EQ(2, counter("operations"));
+  EXPECT_EQ(0, counter("operation_failed"));
+  EXPECT_EQ(0, counter("queue_full"));
+  EXPECT_EQ(0, gauge("queue_depth"));
+  provider_->unregisterPrivateKeyMethod(ssl_.get());
+}
+
+TEST_F(ThreadPoolPrivateKeyProviderTest, EcdsaSign) {
+  createProvider("selfsigned_ecdsa_p256_key.pem");
+  EXPECT_TRUE(
+      verify(SSL_SIGN_ECDSA_SECP256R1_SHA256, signAsync(SSL_SIGN_ECDSA_SECP256R1_SHA256)));
+
+  // ECDSA keys can't decrypt.
+  std::vector<uint8_t> out(MaxOut);
+  size_t out_len = 0;
+  EXPECT_EQ(ssl_private_key_failure, method_->decrypt(ssl_.get(), out.data(), &out_len,
+                                                      out.size(), input_.data(), input_.size()));
+  provider_->unregisterPrivateKeyMethod(ssl_.get());
+}
+
+TEST_F(ThreadPoolPrivateKeyProviderTest, RetryUntilComplete) {
+  createProvider("selfsigned_key.pem");
+  std::vector<uint8_t> out(MaxOut);
+  size_t out_len = 0;
+  EXPECT_EQ(ssl_private_key_retry,
+            method_->sign(ssl_.get(), out.data(), &out_len, out.size(), SSL_SIGN_RSA_PKCS1_SHA256,
+                          input_.data(), input_.size()));
+  // The completion is only seen once the worker has run the posted callback.
+  EXPECT_EQ(ssl_private_key_retry,
+            method_->complete(ssl_.get(), out.data(), &out_len, out.size()));
+  waitForCompletion();
+  EXPECT_EQ(ssl_private_key_success,
+            method_->complete(ssl_.get(), out.data(), &out_len, out.size()));
+  provider_->unregisterPrivateKeyMethod(ssl_.get());
+}
+
+TEST_F(ThreadPoolPrivateKeyProviderTest, OutputTooLarge) {
+  createProvider("selfsigned_key.pem");
+  std::vector<uint8_t> out(MaxOut);
+  size_t out_len = 0;
+  EXPECT_EQ(ssl_private_key_retry,
+            method_->sign(ssl_.get(), out.data(), &out_len, out.size(), SSL_SIGN_RSA_PKCS1_SHA256,
+                          input_.data(), input_.size()));
+  waitForCompletion();
+  EXPECT_EQ(ssl_private_key_failure, method_->complete(ssl_.get(), out.data(), &out_len, 16));
+  provider_->unregisterPrivateKeyMethod(ssl_.get());
+}
+
+TEST_F(ThreadPoolPrivateKeyProviderTest, UnknownSignatureAlgorithm) {
+  createProvider("selfsigned_key.pem");
+  std::vector<uint8_t> out(MaxOut);
+  size_t out_len = 0;
+  EXPECT_EQ(ssl_private_key_retry, method_->sign(ssl_.get(), out.data(), &out_len, out.size(),
+                                                 0xffff, input_.data(), input_.size()));
+  waitForCompletion();
+  EXPECT_EQ(ssl_private_key_failure,
+            method_->complete(ssl_.get(), out.data(), &out_len, out.size()));
+  EXPECT_EQ(1, counter("operation_failed"));
+  provider_->unregisterPrivateKeyMethod(ssl_.get());
+}
+
+// Once the connection is closed the provider never calls back into it.
+TEST_F(ThreadPoolPrivateKeyProviderTest, UnregisterCancelsOperation) {
+  createProvider("selfsigned_key.pem");
+  std::vector<uint8_t> out(MaxOut);
+  size_t out_len = 0;
+  EXPECT_EQ(ssl_private_key_retry,
+            method_->sign(ssl_.get(), out.data(), &out_len, out.size(), SSL_SIGN_RSA_PKCS1_SHA256,
+                          input_.data(), input_.size()));
+  provider_->unregisterPrivateKeyMethod(ssl_.get());
+
+  EXPECT_CALL(callbacks_, onPrivateKeyMethodComplete()).Times(0);
+  // Joins the pool thread, so the operation has either been performed or dropped.
+  provider_.reset();
+  dispatcher_->run(Event::Dispatcher::RunType::NonBlock);
+  EXPECT_EQ(0, gauge("queue_depth"));
+}
+
+TEST_F(ThreadPoolPrivateKeyProviderTest, RegisterTwice) {
+  createProvider("selfsigned_key.pem");
+  EXPECT_THROW_WITH_MESSAGE(
+      provider_->registerPrivateKeyMethod(ssl_.get(), callbacks_, *dispatcher_), EnvoyException,
+      "The thread pool private key provider is already registered for the same SSL object.");
+  provider_->unregisterPrivateKeyMethod(ssl_.get());
+}
+
+// A context may have several certificates of the same key type for different server names, each
+// with its own provider. Every provider is registered for each connection, and the handshake uses
+// the provider with the key of the selected certificate.
+TEST_F(ThreadPoolPrivateKeyProviderTest, SameKeyTypeCertificates) {
+  createProvider("san_dns_key.pem");
+  auto other_provider = makeProvider("san_dns2_key.pem");
+  other_provider->registerPrivateKeyMethod(ssl_.get(), callbacks_, *dispatcher_);
+
+  useCertificate("san_dns2_cert.pem");
+  loadKey("san_dns2_key.pem");
+  EXPECT_TRUE(verify(SSL_SIGN_RSA_PKCS1_SHA256, signAsync(SSL_SIGN_RSA_PKCS1_SHA256)));
+
+  useCertificate("san_dns_cert.pem");
+  loadKey("san_dns_key.pem");
+  EXPECT_TRUE(verify(SSL_SIGN_RSA_PKCS1_SHA256, signAsync(SSL_SIGN_RSA_PKCS1_SHA256)));
+
+  // Without the other provider the first one is used directly.
+  other_provider->unregisterPrivateKeyMethod(ssl_.get());
+  EXPECT_TRUE(verify(SSL_SIGN_RSA_PKCS1_SHA256, signAsync(SSL_SIGN_RSA_PKCS1_SHA256)));
+  provider_->unregisterPrivateKeyMethod(ssl_.get());
+}
+
+// The handshake fails if no provider has the key of the selected certificate.
+TEST_F(ThreadPoolPrivateKeyProviderTest, SameKeyTypeCertificatesNoMatch) {
+  createProvider("san_dns_key.pem");
+  auto other_provider = makeProvider("san_dns2_key.pem");
+  other_provider->registerPrivateKeyMethod(ssl_.get(), callbacks_, *dispatcher_);
+
+  useCertificate("san_dns3_cert.pem");
+  std::vector<uint8_t> out(MaxOut);
+  size_t out_len = 0;
+  EXPECT_EQ(ssl_private_key_failure,
+            method_->sign(ssl_.get(), out.data(), &out_len, out.size(), SSL_SIGN_RSA_PKCS1_SHA256,
+                          input_.data(), input_.size()));
+  other_provider->unregisterPrivateKeyMethod(ssl_.get());
+  provider_->unregisterPrivateKeyMethod(ssl_.get());
+}
+
+TEST_F(ThreadPoolPrivateKeyProviderTest, InvalidPrivateKey) {
+  EXPECT_THROW_WITH_MESSAGE(
+      createProvider("selfsigned_cert.pem"), EnvoyException,
+      "Failed to load private key for the thread pool private key provider");
+}
+
+} // namespace
+} // namespace ThreadPool
+} // namespace PrivateKeyMethodProvider
+} // namespace Extensions
+} // namespace Envoy
@@ -0,0 +1,40 @@
+#include "envoy/config/resource_monitor/event_loop/v2alpha/event_loop.pb.h"
+#include "envoy/config/resource_monitor/event_loop/v2alpha/event_loop.pb.validate.h"
+#include "envoy/registry/registry.h"
+
+#include "server/resource_monitor_config_impl.h"
+
+#include "extensions/resource_monitors/event_loop/config.h"
+
+#include "test/mocks/event/mocks.h"
+#include "test/mocks/thread_local/mocks.h"
+
+#include "gtest/gtest.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace ResourceMonitors {
+namespace EventLoopMonitor {
+namespace {
+
+TEST(EventLoopMonitorFactoryTest, CreateMonitor) {
+  auto factory =
+      Registry::FactoryRegistry<Server::Configuration::ResourceMonitorFactory>::getFactory(
+          "envoy.resource_monitors.event_loop");
+  EXPECT_NE(factory, nullptr);
+
+  envoy::config::resource_monitor::event_loop::v2alpha::EventLoopConfig config;
+  Event::MockDispatcher dispatcher;
+  Api::ApiPtr api = Api::createApiForTest();
+  testing::NiceMock<ThreadLocal::MockInstance> tls;
+  Server::Configuration::ResourceMonitorFactoryContextImpl context(
+      dispatcher, *api, ProtobufMessage::getStrictValidationVisitor(), tls);
+  auto monitor = factory->createResourceMonitor(config, context);
+  EXPECT_NE(monitor, nullptr);
+}
+
+} // namespace
+} // namespace EventLoopMonitor
+} // namespace ResourceMonitors
+} // namespace Extensions
+} // namespace Envoy
@@ -0,0 +1,98 @@
+#include <chrono>
+
+#include "envoy/config/resource_monitor/event_loop/v2alpha/event_loop.pb.h"
+
+#include "extensions/resource_monitors/event_loop/event_loop_monitor.h"
+
+#include "test/mocks/event/mocks.h"
+#include "test/mocks/thread_local/mocks.h"
+
+#include "absl/types/optional.h"
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+using testing::NiceMock;
+using testing::Return;
+
+namespace Envoy {
+namespace Extensions {
+namespace ResourceMonitors {
+namespace EventLoopMonitor {
+namespace {
+
+class ResourcePressure : public Server::ResourceMonitor::Callbacks {
+public:
+  void onSuccess(const Server::ResourceUsage& usage) override {
+    pressure_ = usage.resource_pressure_;
+  }
+
+  void onFailure(const EnvoyException& error) override { error_ = error; }
+
+  bool hasPressure() const { return pressure_.has_value(); }
+  bool hasError() const { return error_.has_value(); }
+
+  double pressure() const { return *pressure_; }
+
+private:
+  absl::optional<double> pressure_;
+  absl::optional<EnvoyException> error_;
+};
+
+Event::DispatcherLoopTimes loopTimes(uint64_t poll_ms, uint64_t busy_ms) {
+  Event::DispatcherLoopTimes times;
+  times.poll_time_ = std::chrono::milliseconds(poll_ms);
+  times.busy_time_ = std::chrono::milliseconds(busy_ms);
+  return times;
+}
+
+TEST(EventLoopMonitorTest, ComputesUtilizationSinceLastUpdate) {
+  NiceMock<ThreadLocal::MockInstance> tls;
+  envoy::config::resource_monitor::event_loop::v2alpha::EventLoopConfig config;
+  EventLoopMonitor monitor(config, tls);
+
+  // The first sample is taken when the thread local state is created on the first update.
+  EXPECT_CALL(tls.dispatcher_, loopTimes())
+      .WillOnce(Return(loopTimes(0, 0)))
+      .WillOnce(Return(loopTimes(300, 100)))
+      .WillOnce(Return(loopTimes(300, 200)))
+      .WillOnce(Return(loopTimes(300, 200)));
+
+  ResourcePressure resource;
+  monitor.updateResourceUsage(resource);
+  ASSERT_TRUE(resource.hasPressure());
+  ASSERT_FALSE(resource.hasError());
+  EXPECT_DOUBLE_EQ(resource.pressure(), 0.25);
+
+  monitor.updateResourceUsage(resource);
+  EXPECT_DOUBLE_EQ(resource.pressure(), 1.0);
+
+  // No time passed on the loop at all.
+  monitor.updateResourceUsage(resource);
+  EXPECT_DOUBLE_EQ(resource.pressure(), 0.0);
+}
+
+TEST(EventLoopMonitorTest, NoUpdateAfterMonitorDestroyed) {
+  NiceMock<ThreadLocal::MockInstance> tls;
+  envoy::config::resource_monitor::event_loop::v2alpha::EventLoopConfig config;
+  auto monitor = std::make_unique<EventLoopMonitor>(config, tls);
+
+  // Hold back the completion callback until the monitor is gone.
+  Event::PostCb complete;
+  EXPECT_CALL(tls, runOnAllThreads(testing::_, testing::_))
+      .WillOnce(testing::Invoke([&complete](Event::PostCb cb, Event::PostCb main_callback) {
+        cb();
+        complete = main_callback;
+      }));
+
+  ResourcePressure resource;
+  monitor->updateResourceUsage(resource);
+  monitor.reset();
+  complete();
+  EXPECT_FALSE(resource.hasPressure());
+}
+
+} // namespace
+} // namespace EventLoopMonitor
+} // namespace ResourceMonitors
+} // namespace Extensions
+} // namespace Envoy
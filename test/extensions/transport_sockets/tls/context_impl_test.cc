@@ -437,6 +437,26 @@ TEST_F(SslContextImplTest, AtMostOneEcdsaCert) {
                           "at most one certificate of a given type may be specified");
 }
 
+// Several certificates of the same type are accepted when they cover different server names.
+TEST_F(SslContextImplTest, MultipleRsaCertsWithDifferentNames) {
+  envoy::extensions::transport_sockets::tls::v3::DownstreamTlsContext tls_context;
+  const std::string tls_context_yaml = R"EOF(
+  common_tls_context:
+    tls_certificates:
+    - certificate_chain:
+        filename: "{{ test_rundir }}/test/extensions/transport_sockets/tls/test_data/san_dns_cert.pem"
+      private_key:
+        filename: "{{ test_rundir }}/test/extensions/transport_sockets/tls/test_data/san_dns_key.pem"
+    - certificate_chain:
+        filename: "{{ test_rundir }}/test/extensions/transport_sockets/tls/test_data/san_multiple_dns_cert.pem"
+      private_key:
+        filename: "{{ test_rundir }}/test/extensions/transport_sockets/tls/test_data/san_multiple_dns_key.pem"
+  )EOF";
+  TestUtility::loadFromYaml(TestEnvironment::substitute(tls_context_yaml), tls_context);
+  ServerContextConfigImpl server_context_config(tls_context, factory_context_);
+  EXPECT_NO_THROW(manager_.createSslServerContext(store_, server_context_config, {}));
+}
+
 // Certificates with no subject CN and no SANs are rejected.
 TEST_F(SslContextImplTest, MustHaveSubjectOrSAN) {
   envoy::extensions::transport_sockets::tls::v3::DownstreamTlsContext tls_context;
@@ -774,6 +794,48 @@ TEST_F(SslServerContextImplTicketTest, StatelessSessionResumptionEnabledWhenKeyI
   EXPECT_FALSE(server_context_config.disableStatelessSessionResumption());
 }
 
+TEST_F(SslServerContextImplTicketTest, SessionTicketKeyRotation) {
+  envoy::extensions::transport_sockets::tls::v3::DownstreamTlsContext tls_context;
+  const std::string tls_context_yaml = R"EOF(
+  common_tls_context:
+    tls_certificates:
+      certificate_chain:
+        filename: "{{ test_tmpdir }}/unittestcert.pem"
+      private_key:
+        filename: "{{ test_tmpdir }}/unittestkey.pem"
+  session_ticket_key_rotation:
+    decryption_keys: 3
+  shared_session_cache: true
+)EOF";
+  TestUtility::loadFromYaml(TestEnvironment::substitute(tls_context_yaml), tls_context);
+
+  ServerContextConfigImpl server_context_config(tls_context, factory_context_);
+  EXPECT_FALSE(server_context_config.disableStatelessSessionResumption());
+  EXPECT_TRUE(server_context_config.sessionTicketKeys().empty());
+  ASSERT_TRUE(server_context_config.sessionTicketKeyRotation().has_value());
+  EXPECT_EQ(std::chrono::hours(1),
+            server_context_config.sessionTicketKeyRotation()->rotation_interval_);
+  EXPECT_EQ(3, server_context_config.sessionTicketKeyRotation()->decryption_keys_);
+  EXPECT_TRUE(server_context_config.sharedSessionCache());
+}
+
+TEST_F(SslServerContextImplTicketTest, SessionTicketKeyRotationDisabledByDefault) {
+  envoy::extensions::transport_sockets::tls::v3::DownstreamTlsContext tls_context;
+  const std::string tls_context_yaml = R"EOF(
+  common_tls_context:
+    tls_certificates:
+      certificate_chain:
+        filename: "{{ test_tmpdir }}/unittestcert.pem"
+      private_key:
+        filename: "{{ test_tmpdir }}/unittestkey.pem"
+  )EOF";
+  TestUtility::loadFromYaml(TestEnvironment::substitute(tls_context_yaml), tls_context);
+
+  ServerContextConfigImpl server_context_config(tls_context, factory_context_);
+  EXPECT_FALSE(server_context_config.sessionTicketKeyRotation().has_value());
+  EXPECT_FALSE(server_context_config.sharedSessionCache());
+}
+
 class ClientContextConfigImplTest : public SslCertsTest {};
 
 // Validate that empty SNI (according to C string rules) fails config validation.
@@ -791,6 +853,38 @@ TEST_F(ClientContextConfigImplTest, EmptyServerNameIndication) {
       "SNI names containing NULL-byte are not allowed");
 }
 
+// Validate the record sizing defaults.
+TEST_F(ClientContextConfigImplTest, RecordSizing) {
+  envoy::extensions::transport_sockets::tls::v3::UpstreamTlsContext tls_context;
+  NiceMock<Server::Configuration::MockTransportSocketFactoryContext> factory_context;
+  {
+    ClientContextConfigImpl client_context_config(tls_context, factory_context);
+    EXPECT_EQ(0, client_context_config.initialRecordSize());
+    EXPECT_EQ(0, client_context_config.initialRecordBytes());
+  }
+
+  tls_context.mutable_common_tls_context()->mutable_record_sizing();
+  {
+    ClientContextConfigImpl client_context_config(tls_context, factory_context);
+    EXPECT_EQ(1400, client_context_config.initialRecordSize());
+    EXPECT_EQ(16384, client_context_config.initialRecordBytes());
+  }
+
+  tls_context.mutable_common_tls_context()
+      ->mutable_record_sizing()
+      ->mutable_initial_record_size()
+      ->set_value(4000);
+  tls_context.mutable_common_tls_context()
+      ->mutable_record_sizing()
+      ->mutable_initial_record_bytes()
+      ->set_value(1024 * 1024);
+  {
+    ClientContextConfigImpl client_context_config(tls_context, factory_context);
+    EXPECT_EQ(4000, client_context_config.initialRecordSize());
+    EXPECT_EQ(1024 * 1024, client_context_config.initialRecordBytes());
+  }
+}
+
 // Validate that values other than a hex-encoded SHA-256 fail config validation.
 TEST_F(ClientContextConfigImplTest, InvalidCertificateHash) {
   envoy::extensions::transport_sockets::tls::v3::UpstreamTlsContext tls_context;
@@ -0,0 +1,144 @@
+// Usage: bazel run //test/extensions/transport_sockets/tls:handshake_speed_test
+// Note: this should be run with --compilation_mode=opt.
+
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "common/common/assert.h"
+
+#include "extensions/transport_sockets/tls/server_name_index.h"
+
+#include "test/extensions/transport_sockets/tls/speed_test_utility.h"
+
+#include "absl/strings/str_cat.h"
+#include "benchmark/benchmark.h"
+#include "openssl/bio.h"
+#include "openssl/ssl.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace TransportSockets {
+namespace Tls {
+namespace {
+
+constexpr size_t BioBufferSize = 64 * 1024;
+
+// Client and server contexts limited to a single TLS version.
+class HandshakeContexts {
+public:
+  explicit HandshakeContexts(uint16_t version) {
+    useSelfSignedCertificate(server_ctx_.get());
+    for (SSL_CTX* ctx : {client_ctx_.get(), server_ctx_.get()}) {
+      SSL_CTX_set_min_proto_version(ctx, version);
+      SSL_CTX_set_max_proto_version(ctx, version);
+    }
+  }
+
+  // Performs a handshake over an in-memory transport, resuming the given session if any.
+  // @return the session the client can resume next.
+  bssl::UniquePtr<SSL_SESSION> handshake(SSL_SESSION* session) {
+    bssl::UniquePtr<SSL> client(SSL_new(client_ctx_.get()));
+    bssl::UniquePtr<SSL> server(SSL_new(server_ctx_.get()));
+    BIO* client_bio;
+    BIO* server_bio;
+    RELEASE_ASSERT(BIO_new_bio_pair(&client_bio, BioBufferSize, &server_bio, BioBufferSize) == 1,
+                   "");
+    SSL_set_bio(client.get(), client_bio, client_bio);
+    SSL_set_bio(server.get(), server_bio, server_bio);
+    SSL_set_connect_state(client.get());
+    SSL_set_accept_state(server.get());
+    if (session != nullptr) {
+      SSL_set_session(client.get(), session);
+    }
+    runHandshake(client.get(), server.get());
+    RELEASE_ASSERT((session != nullptr) == (SSL_session_reused(client.get()) == 1), "");
+
+    // TLS 1.3 tickets follow the handshake, so have the client read them before taking its
+    // session, and close cleanly so that the session stays resumable.
+    uint8_t byte;
+    RELEASE_ASSERT(SSL_read(client.get(), &byte, 1) <= 0, "");
+    SSL_set_quiet_shutdown(client.get(), 1);
+    SSL_shutdown(client.get());
+    return bssl::UniquePtr<SSL_SESSION>(SSL_get1_session(client.get()));
+  }
+
+private:
+  bssl::UniquePtr<SSL_CTX> client_ctx_{SSL_CTX_new(TLS_method())};
+  bssl::UniquePtr<SSL_CTX> server_ctx_{SSL_CTX_new(TLS_method())};
+};
+
+// Full handshakes, dominated by the ECDHE key exchange and the ECDSA signature of the server.
+// state.range(0) supplies the TLS version.
+static void BM_FullHandshake(benchmark::State& state) {
+  HandshakeContexts contexts(state.range(0));
+  for (auto _ : state) {
+    contexts.handshake(nullptr);
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_FullHandshake)->Arg(TLS1_2_VERSION)->Arg(TLS1_3_VERSION);
+
+// Handshakes resuming a session from a ticket, which skip the certificate and its signature.
+// state.range(0) supplies the TLS version.
+static void BM_ResumedHandshake(benchmark::State& state) {
+  HandshakeContexts contexts(state.range(0));
+  bssl::UniquePtr<SSL_SESSION> session = contexts.handshake(nullptr);
+  for (auto _ : state) {
+    bssl::UniquePtr<SSL_SESSION> next = contexts.handshake(session.get());
+    // TLS 1.3 tickets are single use.
+    if (next != nullptr) {
+      session = std::move(next);
+    }
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_ResumedHandshake)->Arg(TLS1_2_VERSION)->Arg(TLS1_3_VERSION);
+
+std::vector<std::string> serverNames(int64_t count) {
+  std::vector<std::string> names;
+  names.reserve(count);
+  for (int64_t i = 0; i < count; i++) {
+    names.push_back(absl::StrCat("server", i, ".example.com"));
+  }
+  return names;
+}
+
+// Selects the certificate for a server name among state.range(0) certificates by comparing the
+// name with the names of every certificate in turn.
+static void BM_SelectCertificateLinear(benchmark::State& state) {
+  const std::vector<std::string> names = serverNames(state.range(0));
+  // The last certificate is the worst case.
+  const std::string& server_name = names.back();
+  for (auto _ : state) {
+    for (const std::string& name : names) {
+      if (name == server_name) {
+        benchmark::DoNotOptimize(&name);
+        break;
+      }
+    }
+  }
+}
+BENCHMARK(BM_SelectCertificateLinear)->Arg(10)->Arg(1000)->Arg(20000);
+
+// Selects the certificate for a server name among state.range(0) certificates with the index
+// used by server contexts.
+static void BM_SelectCertificateIndexed(benchmark::State& state) {
+  const std::vector<std::string> names = serverNames(state.range(0));
+  ServerNameIndex index;
+  for (uint32_t i = 0; i < names.size(); i++) {
+    RELEASE_ASSERT(index.add(names[i], i, true), "");
+  }
+  const std::string& server_name = names.back();
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(index.find(server_name));
+  }
+}
+BENCHMARK(BM_SelectCertificateIndexed)->Arg(10)->Arg(1000)->Arg(20000);
+
+} // namespace
+} // namespace Tls
+} // namespace TransportSockets
+} // namespace Extensions
+} // namespace Envoy
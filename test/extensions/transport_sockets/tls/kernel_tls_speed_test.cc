@@ -0,0 +1,162 @@
+// Usage: bazel run //test/extensions/transport_sockets/tls:kernel_tls_speed_test
+// Note: this should be run with --compilation_mode=opt. The kernel TLS benchmark is skipped when
+// the kernel does not support TLS, e.g. when the tls module is not loaded.
+
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+#include "common/common/assert.h"
+
+#include "extensions/transport_sockets/tls/kernel_tls.h"
+
+#include "test/extensions/transport_sockets/tls/speed_test_utility.h"
+
+#include "benchmark/benchmark.h"
+#include "openssl/ssl.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace TransportSockets {
+namespace Tls {
+namespace {
+
+// A TLS 1.2 AES-128-GCM connection over loopback TCP, since the kernel only implements TLS for TCP
+// sockets. Both ends are driven from the benchmark thread.
+class TlsConnection {
+public:
+  TlsConnection() {
+    const int listen_fd = socket(AF_INET, SOCK_STREAM, 0);
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    socklen_t address_len = sizeof(address);
+    RELEASE_ASSERT(bind(listen_fd, reinterpret_cast<sockaddr*>(&address), address_len) == 0, "");
+    RELEASE_ASSERT(listen(listen_fd, 1) == 0, "");
+    RELEASE_ASSERT(
+        getsockname(listen_fd, reinterpret_cast<sockaddr*>(&address), &address_len) == 0, "");
+    client_fd_ = socket(AF_INET, SOCK_STREAM, 0);
+    RELEASE_ASSERT(connect(client_fd_, reinterpret_cast<sockaddr*>(&address), address_len) == 0,
+                   "");
+    server_fd_ = accept(listen_fd, nullptr, nullptr);
+    RELEASE_ASSERT(server_fd_ >= 0, "");
+    close(listen_fd);
+    fcntl(client_fd_, F_SETFL, O_NONBLOCK);
+    fcntl(server_fd_, F_SETFL, O_NONBLOCK);
+
+    bssl::UniquePtr<SSL_CTX> server_ctx(SSL_CTX_new(TLS_method()));
+    useSelfSignedCertificate(server_ctx.get());
+    bssl::UniquePtr<SSL_CTX> client_ctx(SSL_CTX_new(TLS_method()));
+    for (SSL_CTX* ctx : {server_ctx.get(), client_ctx.get()}) {
+      SSL_CTX_set_max_proto_version(ctx, TLS1_2_VERSION);
+      RELEASE_ASSERT(SSL_CTX_set_strict_cipher_list(ctx, "ECDHE-ECDSA-AES128-GCM-SHA256") == 1,
+                     "");
+    }
+    server_.reset(SSL_new(server_ctx.get()));
+    SSL_set_fd(server_.get(), server_fd_);
+    SSL_set_accept_state(server_.get());
+    client_.reset(SSL_new(client_ctx.get()));
+    SSL_set_fd(client_.get(), client_fd_);
+    SSL_set_connect_state(client_.get());
+
+    runHandshake(client_.get(), server_.get());
+  }
+
+  ~TlsConnection() {
+    client_.reset();
+    server_.reset();
+    close(client_fd_);
+    close(server_fd_);
+  }
+
+  // Moves data from the client to the server, interleaving writes and reads so that
+  // neither end blocks on a full socket buffer.
+  void transfer(const std::vector<uint8_t>& data, std::vector<uint8_t>& read_buffer,
+                const std::function<int(const uint8_t*, size_t)>& write_fn,
+                const std::function<int(uint8_t*, size_t)>& read_fn) {
+    size_t written = 0;
+    size_t read = 0;
+    while (read < data.size()) {
+      if (written < data.size()) {
+        const int rc = write_fn(data.data() + written, data.size() - written);
+        if (rc > 0) {
+          written += rc;
+        }
+      }
+      const int rc = read_fn(read_buffer.data(), read_buffer.size());
+      if (rc > 0) {
+        read += rc;
+      }
+    }
+  }
+
+  SSL* client() { return client_.get(); }
+  SSL* server() { return server_.get(); }
+  int clientFd() const { return client_fd_; }
+  int serverFd() const { return server_fd_; }
+
+private:
+  int client_fd_;
+  int server_fd_;
+  bssl::UniquePtr<SSL> client_;
+  bssl::UniquePtr<SSL> server_;
+};
+
+// Encrypts and decrypts in userspace with SSL_write() and SSL_read(), as the tls transport socket
+// does by default.
+static void BM_UserspaceTls(benchmark::State& state) {
+  TlsConnection connection;
+  std::vector<uint8_t> data(state.range(0), 'a');
+  std::vector<uint8_t> read_buffer(16384);
+  for (auto _ : state) {
+    connection.transfer(
+        data, read_buffer,
+        [&](const uint8_t* buf, size_t len) {
+          return SSL_write(connection.client(), buf, static_cast<int>(len));
+        },
+        [&](uint8_t* buf, size_t len) {
+          return SSL_read(connection.server(), buf, static_cast<int>(len));
+        });
+  }
+  state.SetBytesProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_UserspaceTls)->Arg(16384)->Arg(1024 * 1024);
+
+// Hands the record layer over to the kernel after the handshake, so that plaintext is moved with
+// plain write() and read() calls, as the tls transport socket does with kernel_tls_offload set.
+static void BM_KernelTls(benchmark::State& state) {
+  TlsConnection connection;
+  if (!KernelTls::supported(connection.client()) || !KernelTls::attach(connection.clientFd()) ||
+      !KernelTls::attach(connection.serverFd()) ||
+      !KernelTls::enableTx(connection.client(), connection.clientFd()) ||
+      SSL_has_pending(connection.server()) ||
+      !KernelTls::enableRx(connection.server(), connection.serverFd())) {
+    state.SkipWithError("kernel TLS is not supported");
+    return;
+  }
+  std::vector<uint8_t> data(state.range(0), 'a');
+  std::vector<uint8_t> read_buffer(16384);
+  for (auto _ : state) {
+    connection.transfer(
+        data, read_buffer,
+        [&](const uint8_t* buf, size_t len) {
+          return static_cast<int>(::write(connection.clientFd(), buf, len));
+        },
+        [&](uint8_t* buf, size_t len) {
+          return static_cast<int>(::read(connection.serverFd(), buf, len));
+        });
+  }
+  state.SetBytesProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_KernelTls)->Arg(16384)->Arg(1024 * 1024);
+
+} // namespace
+} // namespace Tls
+} // namespace TransportSockets
+} // namespace Extensions
+} // namespace Envoy
@@ -0,0 +1,121 @@
+// Usage: bazel run //test/extensions/transport_sockets/tls:record_write_speed_test
+// Note: this should be run with --compilation_mode=opt.
+
+#include <algorithm>
+#include <cstdint>
+#include <string>
+
+#include "common/buffer/buffer_impl.h"
+#include "common/common/assert.h"
+
+#include "extensions/transport_sockets/tls/utility.h"
+
+#include "test/extensions/transport_sockets/tls/speed_test_utility.h"
+
+#include "benchmark/benchmark.h"
+#include "openssl/bio.h"
+#include "openssl/ssl.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace TransportSockets {
+namespace Tls {
+namespace {
+
+constexpr uint64_t BodySize = 256 * 1024;
+
+// A TLS connection over an in-memory transport. Only the client writes after the handshake, and
+// its records are discarded without being decrypted, so that the benchmarks measure the write
+// path alone.
+class MemoryTlsConnection {
+public:
+  MemoryTlsConnection() {
+    bssl::UniquePtr<SSL_CTX> server_ctx(SSL_CTX_new(TLS_method()));
+    useSelfSignedCertificate(server_ctx.get());
+    bssl::UniquePtr<SSL_CTX> client_ctx(SSL_CTX_new(TLS_method()));
+    server_.reset(SSL_new(server_ctx.get()));
+    client_.reset(SSL_new(client_ctx.get()));
+    BIO* client_bio;
+    BIO* server_bio;
+    RELEASE_ASSERT(BIO_new_bio_pair(&client_bio, 2 * Utility::MaxRecordSize, &server_bio,
+                                    2 * Utility::MaxRecordSize) == 1,
+                   "");
+    SSL_set_bio(client_.get(), client_bio, client_bio);
+    SSL_set_bio(server_.get(), server_bio, server_bio);
+    SSL_set_connect_state(client_.get());
+    SSL_set_accept_state(server_.get());
+    runHandshake(client_.get(), server_.get());
+  }
+
+  // Writes one record, then discards the ciphertext.
+  void writeRecord(const void* data, uint64_t size) {
+    RELEASE_ASSERT(SSL_write(client_.get(), data, size) == static_cast<int>(size), "");
+    BIO* server_bio = SSL_get_rbio(server_.get());
+    while (BIO_read(server_bio, discard_, sizeof(discard_)) > 0) {
+    }
+  }
+
+private:
+  bssl::UniquePtr<SSL> client_;
+  bssl::UniquePtr<SSL> server_;
+  uint8_t discard_[2 * Utility::MaxRecordSize];
+};
+
+// Fills a buffer with a proxied body made of slices of the given size, as it arrives from the
+// upstream.
+void fillBody(Buffer::OwnedImpl& body, uint64_t slice_size) {
+  for (uint64_t size = 0; size < BodySize; size += slice_size) {
+    body.appendSliceForTest(std::string(std::min(slice_size, BodySize - size), 'a'));
+  }
+}
+
+// Writes full size records from contiguous memory obtained with linearize(), which copies
+// whenever a record spans slices, and moves the copy into a new slice of the buffer.
+static void BM_WriteLinearized(benchmark::State& state) {
+  MemoryTlsConnection connection;
+  for (auto _ : state) {
+    state.PauseTiming();
+    Buffer::OwnedImpl body;
+    fillBody(body, state.range(0));
+    state.ResumeTiming();
+    while (body.length() > 0) {
+      const uint64_t size = std::min(body.length(), Utility::MaxRecordSize);
+      connection.writeRecord(body.linearize(size), size);
+      body.drain(size);
+    }
+  }
+  state.SetBytesProcessed(state.iterations() * BodySize);
+}
+BENCHMARK(BM_WriteLinearized)->Arg(1024)->Arg(4096)->Arg(16384)->Arg(20000);
+
+// Writes records cut at slice boundaries where that avoids a copy, as SslSocket::doWrite() does.
+// state.range(1) supplies the maximum record size.
+static void BM_WriteSlices(benchmark::State& state) {
+  MemoryTlsConnection connection;
+  for (auto _ : state) {
+    state.PauseTiming();
+    Buffer::OwnedImpl body;
+    fillBody(body, state.range(0));
+    state.ResumeTiming();
+    while (body.length() > 0) {
+      const uint64_t size = Utility::nextRecordSize(body, state.range(1));
+      connection.writeRecord(Utility::recordData(body, size), size);
+      body.drain(size);
+    }
+  }
+  state.SetBytesProcessed(state.iterations() * BodySize);
+}
+BENCHMARK(BM_WriteSlices)
+    ->Args({1024, Utility::MaxRecordSize})
+    ->Args({4096, Utility::MaxRecordSize})
+    ->Args({16384, Utility::MaxRecordSize})
+    ->Args({20000, Utility::MaxRecordSize})
+    // The cost of writing small records throughout, which record sizing limits to the start of a
+    // connection.
+    ->Args({16384, 1400});
+
+} // namespace
+} // namespace Tls
+} // namespace TransportSockets
+} // namespace Extensions
+} // namespace Envoy
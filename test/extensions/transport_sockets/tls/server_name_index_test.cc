@@ -0,0 +1,92 @@
+#include <string>
+#include <vector>
+
+#include "extensions/transport_sockets/tls/server_name_index.h"
+
+#include "test/extensions/transport_sockets/tls/ssl_test_utility.h"
+#include "test/test_common/environment.h"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace TransportSockets {
+namespace Tls {
+namespace {
+
+using testing::ElementsAre;
+
+TEST(ServerNameIndexTest, ExactName) {
+  ServerNameIndex index;
+  EXPECT_TRUE(index.empty());
+  EXPECT_TRUE(index.add("server1.example.com", 0, false));
+  EXPECT_TRUE(index.add("server1.example.com", 1, true));
+  EXPECT_FALSE(index.empty());
+
+  const ServerNameIndex::Certificates* certificates = index.find("server1.example.com");
+  ASSERT_NE(nullptr, certificates);
+  EXPECT_EQ(0, certificates->other_);
+  EXPECT_EQ(1, certificates->ecdsa_);
+
+  EXPECT_EQ(nullptr, index.find("server2.example.com"));
+  EXPECT_EQ(nullptr, index.find(""));
+}
+
+TEST(ServerNameIndexTest, CaseInsensitive) {
+  ServerNameIndex index;
+  EXPECT_TRUE(index.add("Server1.Example.com", 0, false));
+  EXPECT_TRUE(index.add("*.Example.org", 1, false));
+  EXPECT_NE(nullptr, index.find("SERVER1.example.COM"));
+  EXPECT_NE(nullptr, index.find("WWW.example.ORG"));
+}
+
+TEST(ServerNameIndexTest, WildcardMatchesSingleLabel) {
+  ServerNameIndex index;
+  EXPECT_TRUE(index.add("*.example.com", 0, false));
+
+  const ServerNameIndex::Certificates* certificates = index.find("www.example.com");
+  ASSERT_NE(nullptr, certificates);
+  EXPECT_EQ(0, certificates->other_);
+  EXPECT_EQ(ServerNameIndex::Certificates::None, certificates->ecdsa_);
+
+  EXPECT_EQ(nullptr, index.find("example.com"));
+  EXPECT_EQ(nullptr, index.find(".example.com"));
+  EXPECT_EQ(nullptr, index.find("a.www.example.com"));
+}
+
+TEST(ServerNameIndexTest, ExactTakesPrecedence) {
+  ServerNameIndex index;
+  EXPECT_TRUE(index.add("*.example.com", 0, false));
+  EXPECT_TRUE(index.add("www.example.com", 1, false));
+  EXPECT_EQ(1, index.find("www.example.com")->other_);
+  EXPECT_EQ(0, index.find("api.example.com")->other_);
+}
+
+TEST(ServerNameIndexTest, DuplicateName) {
+  ServerNameIndex index;
+  EXPECT_TRUE(index.add("*.example.com", 0, true));
+  EXPECT_FALSE(index.add("*.EXAMPLE.com", 1, true));
+  // The exact name is a different entry than the wildcard.
+  EXPECT_TRUE(index.add("www.example.com", 1, true));
+  EXPECT_EQ(0, index.find("api.example.com")->ecdsa_);
+}
+
+TEST(ServerNameIndexTest, CertificateNames) {
+  bssl::UniquePtr<X509> cert = readCertFromFile(TestEnvironment::substitute(
+      "{{ test_rundir }}/test/extensions/transport_sockets/tls/test_data/"
+      "san_multiple_dns_cert.pem"));
+  EXPECT_THAT(ServerNameIndex::certificateNames(*cert),
+              ElementsAre("*.example.com", "server2.example.com"));
+
+  // Without DNS SANs the subject CN is used.
+  cert = readCertFromFile(TestEnvironment::substitute(
+      "{{ test_rundir }}/test/extensions/transport_sockets/tls/test_data/no_san_cert.pem"));
+  EXPECT_THAT(ServerNameIndex::certificateNames(*cert), ElementsAre("Test Server"));
+}
+
+} // namespace
+} // namespace Tls
+} // namespace TransportSockets
+} // namespace Extensions
+} // namespace Envoy
@@ -0,0 +1,86 @@
+#include <string>
+
+#include "extensions/transport_sockets/tls/session_cache.h"
+
+#include "gtest/gtest.h"
+#include "openssl/ssl.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace TransportSockets {
+namespace Tls {
+namespace {
+
+class SessionCacheTest : public testing::Test {
+protected:
+  // Creates a session whose 32 byte ID starts with the given byte, which selects its shard, and
+  // ends with the given index.
+  bssl::UniquePtr<SSL_SESSION> newSession(uint8_t shard, uint8_t index) {
+    bssl::UniquePtr<SSL_SESSION> session(SSL_SESSION_new(ctx_.get()));
+    const std::string id = sessionId(shard, index);
+    EXPECT_EQ(1, SSL_SESSION_set1_id(session.get(), reinterpret_cast<const uint8_t*>(id.data()),
+                                     id.size()));
+    return session;
+  }
+
+  static std::string sessionId(uint8_t shard, uint8_t index) {
+    std::string id(SSL_MAX_SSL_SESSION_ID_LENGTH, '\0');
+    id.front() = shard;
+    id.back() = index;
+    return id;
+  }
+
+  bssl::UniquePtr<SSL_CTX> ctx_{SSL_CTX_new(TLS_method())};
+};
+
+TEST_F(SessionCacheTest, InsertAndLookup) {
+  SessionCache cache;
+  bssl::UniquePtr<SSL_SESSION> session = newSession(0, 1);
+  SSL_SESSION* raw_session = session.get();
+  cache.insert(std::move(session));
+  EXPECT_EQ(1, cache.size());
+
+  bssl::UniquePtr<SSL_SESSION> found = cache.lookup(sessionId(0, 1));
+  EXPECT_EQ(raw_session, found.get());
+  // The cache keeps its own reference.
+  EXPECT_EQ(raw_session, cache.lookup(sessionId(0, 1)).get());
+
+  EXPECT_EQ(nullptr, cache.lookup(sessionId(0, 2)));
+  EXPECT_EQ(nullptr, cache.lookup(""));
+}
+
+TEST_F(SessionCacheTest, ReplaceSameId) {
+  SessionCache cache;
+  cache.insert(newSession(0, 1));
+  bssl::UniquePtr<SSL_SESSION> session = newSession(0, 1);
+  SSL_SESSION* raw_session = session.get();
+  cache.insert(std::move(session));
+  EXPECT_EQ(1, cache.size());
+  EXPECT_EQ(raw_session, cache.lookup(sessionId(0, 1)).get());
+}
+
+// Each of the 16 shards holds capacity / 16 sessions and evicts its least recently used session.
+TEST_F(SessionCacheTest, EvictsLeastRecentlyUsed) {
+  SessionCache cache(32);
+  cache.insert(newSession(0, 1));
+  cache.insert(newSession(0, 2));
+  // Sessions in other shards don't count against shard 0.
+  cache.insert(newSession(1, 1));
+  cache.insert(newSession(1, 2));
+
+  EXPECT_NE(nullptr, cache.lookup(sessionId(0, 1)));
+  cache.insert(newSession(0, 3));
+
+  EXPECT_EQ(4, cache.size());
+  EXPECT_NE(nullptr, cache.lookup(sessionId(0, 1)));
+  EXPECT_EQ(nullptr, cache.lookup(sessionId(0, 2)));
+  EXPECT_NE(nullptr, cache.lookup(sessionId(0, 3)));
+  EXPECT_NE(nullptr, cache.lookup(sessionId(1, 1)));
+  EXPECT_NE(nullptr, cache.lookup(sessionId(1, 2)));
+}
+
+} // namespace
+} // namespace Tls
+} // namespace TransportSockets
+} // namespace Extensions
+} // namespace Envoy
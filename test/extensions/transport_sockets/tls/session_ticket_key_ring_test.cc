@@ -0,0 +1,188 @@
+#include <atomic>
+#include <chrono>
+#include <cstring>
+
+#include "common/common/thread.h"
+
+#include "extensions/transport_sockets/tls/session_ticket_key_ring.h"
+
+#include "test/test_common/simulated_time_system.h"
+
+#include "gtest/gtest.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace TransportSockets {
+namespace Tls {
+namespace {
+
+// Stands in for the hot restart shared memory segment.
+class TestStorage : public Ssl::SessionTicketKeyStorage {
+public:
+  // Ssl::SessionTicketKeyStorage
+  Thread::BasicLockable& lock() override {
+    locks_++;
+    return lock_;
+  }
+  Ssl::RotatedSessionTicketKeys& keys() override { return keys_; }
+  std::atomic<uint64_t>& generation() override { return generation_; }
+
+  // Number of times the lock has been requested.
+  uint64_t locks_{0};
+
+private:
+  Thread::MutexBasicLockable lock_;
+  Ssl::RotatedSessionTicketKeys keys_{};
+  std::atomic<uint64_t> generation_{0};
+};
+
+bool sameKey(const SessionTicketKeyRing::Key& a, const SessionTicketKeyRing::Key& b) {
+  return std::memcmp(&a, &b, sizeof(a)) == 0;
+}
+
+class SessionTicketKeyRingTest : public testing::Test {
+protected:
+  const std::chrono::milliseconds interval_{std::chrono::hours(1)};
+  Event::SimulatedTimeSystem time_system_;
+  TestStorage storage_;
+};
+
+TEST_F(SessionTicketKeyRingTest, RotatesAfterInterval) {
+  SessionTicketKeyRing ring(&storage_, time_system_);
+  SessionTicketKeyRing::Key first;
+  EXPECT_TRUE(ring.encryptionKey(interval_, first));
+  EXPECT_EQ(1, storage_.keys().num_keys_);
+
+  SessionTicketKeyRing::Key key;
+  time_system_.advanceTimeWait(interval_ - std::chrono::milliseconds(1));
+  EXPECT_FALSE(ring.encryptionKey(interval_, key));
+  EXPECT_TRUE(sameKey(first, key));
+
+  time_system_.advanceTimeWait(std::chrono::milliseconds(1));
+  SessionTicketKeyRing::Key second;
+  EXPECT_TRUE(ring.encryptionKey(interval_, second));
+  EXPECT_FALSE(sameKey(first, second));
+  EXPECT_EQ(2, storage_.keys().num_keys_);
+  EXPECT_TRUE(sameKey(second, storage_.keys().keys_[0]));
+  EXPECT_TRUE(sameKey(first, storage_.keys().keys_[1]));
+}
+
+TEST_F(SessionTicketKeyRingTest, DecryptionKeys) {
+  SessionTicketKeyRing ring(&storage_, time_system_);
+  SessionTicketKeyRing::Key first;
+  SessionTicketKeyRing::Key second;
+  ring.encryptionKey(interval_, first);
+  time_system_.advanceTimeWait(interval_);
+  ring.encryptionKey(interval_, second);
+
+  SessionTicketKeyRing::Key key;
+  bool newest;
+  EXPECT_TRUE(ring.decryptionKey(second.name_, 2, key, newest));
+  EXPECT_TRUE(sameKey(second, key));
+  EXPECT_TRUE(newest);
+
+  // Tickets encrypted with the previous key are accepted and renewed.
+  EXPECT_TRUE(ring.decryptionKey(first.name_, 2, key, newest));
+  EXPECT_TRUE(sameKey(first, key));
+  EXPECT_FALSE(newest);
+
+  // Unless only the newest key may decrypt.
+  EXPECT_FALSE(ring.decryptionKey(first.name_, 1, key, newest));
+
+  const uint8_t unknown[16] = {};
+  EXPECT_FALSE(ring.decryptionKey(unknown, 2, key, newest));
+}
+
+TEST_F(SessionTicketKeyRingTest, KeepsAtMostMaxKeys) {
+  SessionTicketKeyRing ring(&storage_, time_system_);
+  SessionTicketKeyRing::Key oldest;
+  ring.encryptionKey(interval_, oldest);
+  SessionTicketKeyRing::Key key;
+  for (uint32_t i = 1; i < Ssl::RotatedSessionTicketKeys::MaxKeys; i++) {
+    time_system_.advanceTimeWait(interval_);
+    ring.encryptionKey(interval_, key);
+  }
+  bool newest;
+  EXPECT_TRUE(
+      ring.decryptionKey(oldest.name_, Ssl::RotatedSessionTicketKeys::MaxKeys, key, newest));
+
+  time_system_.advanceTimeWait(interval_);
+  ring.encryptionKey(interval_, key);
+  EXPECT_EQ(static_cast<uint32_t>(Ssl::RotatedSessionTicketKeys::MaxKeys),
+            storage_.keys().num_keys_);
+  EXPECT_FALSE(
+      ring.decryptionKey(oldest.name_, Ssl::RotatedSessionTicketKeys::MaxKeys, key, newest));
+}
+
+// Rings over the same storage, as in the parent and child processes of a hot restart, agree on the
+// keys.
+TEST_F(SessionTicketKeyRingTest, SharedStorage) {
+  SessionTicketKeyRing parent(&storage_, time_system_);
+  SessionTicketKeyRing::Key parent_key;
+  EXPECT_TRUE(parent.encryptionKey(interval_, parent_key));
+
+  SessionTicketKeyRing child(&storage_, time_system_);
+  SessionTicketKeyRing::Key child_key;
+  EXPECT_FALSE(child.encryptionKey(interval_, child_key));
+  EXPECT_TRUE(sameKey(parent_key, child_key));
+
+  // A key generated by the child is found by the parent the first time it sees a ticket encrypted
+  // with it.
+  time_system_.advanceTimeWait(interval_);
+  EXPECT_TRUE(child.encryptionKey(interval_, child_key));
+  SessionTicketKeyRing::Key key;
+  bool newest;
+  EXPECT_TRUE(parent.decryptionKey(child_key.name_, 2, key, newest));
+  EXPECT_TRUE(sameKey(child_key, key));
+  EXPECT_TRUE(newest);
+
+  // The parent then encrypts with the child's key rather than generating another one.
+  EXPECT_FALSE(parent.encryptionKey(interval_, key));
+  EXPECT_TRUE(sameKey(child_key, key));
+}
+
+// Tickets with unknown key names do not take the shared lock unless the keys have changed since
+// the snapshot was taken.
+TEST_F(SessionTicketKeyRingTest, UnknownKeyNameWithoutLocking) {
+  SessionTicketKeyRing ring(&storage_, time_system_);
+  SessionTicketKeyRing::Key key;
+  ring.encryptionKey(interval_, key);
+  const uint64_t locks = storage_.locks_;
+
+  const uint8_t unknown[16] = {};
+  bool newest;
+  EXPECT_FALSE(ring.decryptionKey(unknown, 2, key, newest));
+  EXPECT_FALSE(ring.decryptionKey(unknown, 2, key, newest));
+  EXPECT_EQ(locks, storage_.locks_);
+
+  // Another process rotates the keys.
+  SessionTicketKeyRing other(&storage_, time_system_);
+  time_system_.advanceTimeWait(interval_);
+  SessionTicketKeyRing::Key other_key;
+  EXPECT_TRUE(other.encryptionKey(interval_, other_key));
+
+  // The first unknown name refreshes the snapshot, which then knows the new key.
+  EXPECT_FALSE(ring.decryptionKey(unknown, 2, key, newest));
+  EXPECT_EQ(locks + 2, storage_.locks_);
+  EXPECT_FALSE(ring.decryptionKey(unknown, 2, key, newest));
+  EXPECT_TRUE(ring.decryptionKey(other_key.name_, 2, key, newest));
+  EXPECT_TRUE(sameKey(other_key, key));
+  EXPECT_EQ(locks + 2, storage_.locks_);
+}
+
+TEST_F(SessionTicketKeyRingTest, LocalStorage) {
+  SessionTicketKeyRing ring(nullptr, time_system_);
+  SessionTicketKeyRing::Key key;
+  EXPECT_TRUE(ring.encryptionKey(interval_, key));
+  SessionTicketKeyRing::Key found;
+  bool newest;
+  EXPECT_TRUE(ring.decryptionKey(key.name_, 1, found, newest));
+  EXPECT_TRUE(sameKey(key, found));
+  EXPECT_EQ(0, storage_.keys().num_keys_);
+}
+
+} // namespace
+} // namespace Tls
+} // namespace TransportSockets
+} // namespace Extensions
+} // namespace Envoy
@@ -0,0 +1,70 @@
+#pragma once
+
+#include "common/common/assert.h"
+
+#include "openssl/evp.h"
+#include "openssl/ssl.h"
+#include "openssl/x509.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace TransportSockets {
+namespace Tls {
+
+/**
+ * Configures a context with a self-signed ECDSA certificate generated on the fly, so that
+ * benchmarks need no data files.
+ * @param ctx supplies the context.
+ */
+inline void useSelfSignedCertificate(SSL_CTX* ctx) {
+  bssl::UniquePtr<EC_KEY> ec_key(EC_KEY_new_by_curve_name(NID_X9_62_prime256v1));
+  RELEASE_ASSERT(EC_KEY_generate_key(ec_key.get()) == 1, "");
+  bssl::UniquePtr<EVP_PKEY> key(EVP_PKEY_new());
+  RELEASE_ASSERT(EVP_PKEY_set1_EC_KEY(key.get(), ec_key.get()) == 1, "");
+
+  bssl::UniquePtr<X509> cert(X509_new());
+  X509_set_version(cert.get(), 2);
+  ASN1_INTEGER_set(X509_get_serialNumber(cert.get()), 1);
+  X509_gmtime_adj(X509_getm_notBefore(cert.get()), 0);
+  X509_gmtime_adj(X509_getm_notAfter(cert.get()), 3600);
+  X509_set_pubkey(cert.get(), key.get());
+  X509_NAME* name = X509_get_subject_name(cert.get());
+  X509_NAME_add_entry_by_txt(name, "CN", MBSTRING_ASC, reinterpret_cast<const uint8_t*>("test"),
+                             -1, -1, 0);
+  X509_set_issuer_name(cert.get(), name);
+  RELEASE_ASSERT(X509_sign(cert.get(), key.get(), EVP_sha256()) != 0, "");
+
+  RELEASE_ASSERT(SSL_CTX_use_certificate(ctx, cert.get()) == 1, "");
+  RELEASE_ASSERT(SSL_CTX_use_PrivateKey(ctx, key.get()) == 1, "");
+}
+
+/**
+ * Runs the handshake of two connections against each other, alternating between them until both
+ * have completed it. The connections must use non-blocking transports.
+ * @param client supplies the client connection.
+ * @param server supplies the server connection.
+ */
+inline void runHandshake(SSL* client, SSL* server) {
+  bool client_done = false;
+  bool server_done = false;
+  while (!client_done || !server_done) {
+    for (SSL* ssl : {client, server}) {
+      bool& done = ssl == client ? client_done : server_done;
+      if (done) {
+        continue;
+      }
+      const int rc = SSL_do_handshake(ssl);
+      if (rc == 1) {
+        done = true;
+        continue;
+      }
+      const int err = SSL_get_error(ssl, rc);
+      RELEASE_ASSERT(err == SSL_ERROR_WANT_READ || err == SSL_ERROR_WANT_WRITE, "");
+    }
+  }
+}
+
+} // namespace Tls
+} // namespace TransportSockets
+} // namespace Extensions
+} // namespace Envoy
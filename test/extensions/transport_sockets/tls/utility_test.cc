@@ -1,6 +1,8 @@
 #include <string>
 #include <vector>
 
+#include "common/buffer/buffer_impl.h"
+
 #include "extensions/transport_sockets/tls/utility.h"
 
 #include "test/extensions/transport_sockets/tls/ssl_test_utility.h"
@@ -127,6 +129,43 @@ TEST(UtilityTest, GetLastCryptoError) {
   EXPECT_FALSE(Utility::getLastCryptoError().has_value());
 }
 
+TEST(UtilityTest, NextRecordSize) {
+  Buffer::OwnedImpl buffer;
+  EXPECT_EQ(0, Utility::nextRecordSize(buffer, Utility::MaxRecordSize));
+
+  // Records are cut at the maximum size.
+  buffer.appendSliceForTest(std::string(20000, 'a'));
+  EXPECT_EQ(Utility::MaxRecordSize, Utility::nextRecordSize(buffer, Utility::MaxRecordSize));
+  EXPECT_EQ(1400, Utility::nextRecordSize(buffer, 1400));
+
+  // Large front slices are written as records of their own, and small ones are joined with the
+  // following slices.
+  buffer.drain(20000 - Utility::MinSliceRecordSize);
+  buffer.appendSliceForTest(std::string(20000, 'b'));
+  EXPECT_EQ(Utility::MinSliceRecordSize,
+            Utility::nextRecordSize(buffer, Utility::MaxRecordSize));
+  buffer.drain(1);
+  EXPECT_EQ(Utility::MaxRecordSize, Utility::nextRecordSize(buffer, Utility::MaxRecordSize));
+
+  // Short buffers are written whole.
+  buffer.drain(buffer.length() - 100);
+  EXPECT_EQ(100, Utility::nextRecordSize(buffer, Utility::MaxRecordSize));
+}
+
+TEST(UtilityTest, RecordData) {
+  Buffer::OwnedImpl buffer;
+  buffer.appendSliceForTest("hello ");
+  buffer.appendSliceForTest("world");
+
+  // Records within the front slice are not copied.
+  EXPECT_EQ(buffer.getRawSlices(1)[0].mem_, Utility::recordData(buffer, 5));
+
+  // Records spanning slices are copied without modifying the buffer.
+  const void* record = Utility::recordData(buffer, 11);
+  EXPECT_EQ("hello world", std::string(static_cast<const char*>(record), 11));
+  EXPECT_EQ(2, buffer.getRawSlices().size());
+}
+
 } // namespace
 } // namespace Tls
 } // namespace TransportSockets
@@ -23,6 +23,11 @@ MockDispatcher::MockDispatcher(const std::string& name) : name_(name) {
     to_delete_.clear();
   }));
   ON_CALL(*this, createTimer_(_)).WillByDefault(ReturnNew<NiceMock<Event::MockTimer>>());
+  // Coarse timers behave like regular timers in tests, so a MockTimer set up for the dispatcher
+  // also catches the next coarse timer it creates.
+  ON_CALL(*this, createCoarseTimer_(_)).WillByDefault(Invoke([this](TimerCb cb) -> Timer* {
+    return createTimer_(std::move(cb));
+  }));
   ON_CALL(*this, post(_)).WillByDefault(Invoke([](PostCb cb) -> void { cb(); }));
 }
 
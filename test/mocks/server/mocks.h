@@ -234,6 +234,7 @@ public:
   MOCK_METHOD(std::string, version, ());
   MOCK_METHOD(Thread::BasicLockable&, logLock, ());
   MOCK_METHOD(Thread::BasicLockable&, accessLogLock, ());
+  MOCK_METHOD(Ssl::SessionTicketKeyStorage*, sessionTicketKeyStorage, ());
   MOCK_METHOD(Stats::Allocator&, statsAllocator, ());
 
 private:
@@ -83,6 +83,9 @@ public:
   MOCK_METHOD(const CertificateValidationContextConfig*, certificateValidationContext, (), (const));
   MOCK_METHOD(unsigned, minProtocolVersion, (), (const));
   MOCK_METHOD(unsigned, maxProtocolVersion, (), (const));
+  MOCK_METHOD(bool, kernelTlsOffload, (), (const));
+  MOCK_METHOD(uint32_t, initialRecordSize, (), (const));
+  MOCK_METHOD(uint32_t, initialRecordBytes, (), (const));
   MOCK_METHOD(bool, isReady, (), (const));
   MOCK_METHOD(void, setSecretUpdateCallback, (std::function<void()> callback));
 
@@ -105,6 +108,9 @@ public:
   MOCK_METHOD(const CertificateValidationContextConfig*, certificateValidationContext, (), (const));
   MOCK_METHOD(unsigned, minProtocolVersion, (), (const));
   MOCK_METHOD(unsigned, maxProtocolVersion, (), (const));
+  MOCK_METHOD(bool, kernelTlsOffload, (), (const));
+  MOCK_METHOD(uint32_t, initialRecordSize, (), (const));
+  MOCK_METHOD(uint32_t, initialRecordBytes, (), (const));
   MOCK_METHOD(bool, isReady, (), (const));
   MOCK_METHOD(absl::optional<std::chrono::seconds>, sessionTimeout, (), (const));
   MOCK_METHOD(void, setSecretUpdateCallback, (std::function<void()> callback));
@@ -112,6 +118,9 @@ public:
   MOCK_METHOD(bool, requireClientCertificate, (), (const));
   MOCK_METHOD(const std::vector<SessionTicketKey>&, sessionTicketKeys, (), (const));
   MOCK_METHOD(bool, disableStatelessSessionResumption, (), (const));
+  MOCK_METHOD(const absl::optional<SessionTicketKeyRotation>&, sessionTicketKeyRotation, (),
+              (const));
+  MOCK_METHOD(bool, sharedSessionCache, (), (const));
 };
 
 class MockPrivateKeyMethodManager : public PrivateKeyMethodManager {
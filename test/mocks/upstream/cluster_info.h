@@ -87,6 +87,9 @@ public:
   MOCK_METHOD(std::chrono::milliseconds, connectTimeout, (), (const));
   MOCK_METHOD(const absl::optional<std::chrono::milliseconds>, idleTimeout, (), (const));
   MOCK_METHOD(uint32_t, perConnectionBufferLimitBytes, (), (const));
+  MOCK_METHOD(float, perUpstreamPreconnectRatio, (), (const));
+  MOCK_METHOD(uint32_t, sharedHttp2PoolOwnerWorkers, (), (const));
+  MOCK_METHOD(bool, compactHostRepresentation, (), (const));
   MOCK_METHOD(uint64_t, features, (), (const));
   MOCK_METHOD(const Http::Http1Settings&, http1Settings, (), (const));
   MOCK_METHOD(const envoy::config::core::v3::Http2ProtocolOptions&, http2Options, (), (const));
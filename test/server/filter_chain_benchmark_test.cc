@@ -162,6 +162,31 @@ const char YamlSingleDstPortBottom[] = R"EOF(
           session_ticket_keys:
             keys:
             - filename: "{{ test_rundir }}/test/extensions/transport_sockets/tls/test_data/ticket_key_a")EOF";
+// Filter chains which differ by server name but match the same destination and source CIDR ranges.
+const char YamlServerNameCidrTop[] = R"EOF(
+    - filter_chain_match:
+        server_names: "server)EOF";
+const char YamlServerNameCidrBottom[] = R"EOF(.example.com"
+        transport_protocol: "tls"
+        prefix_ranges:
+        - { address_prefix: 10.0.0.0, prefix_len: 8 }
+        - { address_prefix: 127.0.0.0, prefix_len: 8 }
+        - { address_prefix: 172.16.0.0, prefix_len: 12 }
+        - { address_prefix: 192.168.0.0, prefix_len: 16 }
+        source_prefix_ranges:
+        - { address_prefix: 1.1.1.0, prefix_len: 24 }
+        - { address_prefix: 8.8.0.0, prefix_len: 16 }
+      transport_socket:
+        name: tls
+        typed_config:
+          "@type": type.googleapis.com/envoy.api.v2.auth.DownstreamTlsContext
+          common_tls_context:
+            tls_certificates:
+              - certificate_chain: { filename: "{{ test_rundir }}/test/extensions/transport_sockets/tls/test_data/san_multiple_dns_cert.pem" }
+                private_key: { filename: "{{ test_rundir }}/test/extensions/transport_sockets/tls/test_data/san_multiple_dns_key.pem" }
+          session_ticket_keys:
+            keys:
+            - filename: "{{ test_rundir }}/test/extensions/transport_sockets/tls/test_data/ticket_key_a")EOF";
 } // namespace
 
 class FilterChainBenchmarkFixture : public benchmark::Fixture {
@@ -220,6 +245,60 @@ BENCHMARK_DEFINE_F(FilterChainBenchmarkFixture, FilterChainFindTest)
     }
   }
 }
+// Many filter chains with the same CIDR ranges under distinct server names, which exercises the
+// CIDR range matchers of every server name branch.
+class FilterChainCidrBenchmarkFixture : public FilterChainBenchmarkFixture {
+public:
+  using benchmark::Fixture::SetUp;
+
+  void SetUp(::benchmark::State& state) override {
+    int64_t input_size = state.range(0);
+    std::vector<std::string> server_chains;
+    server_chains.reserve(input_size);
+    for (int i = 0; i < input_size; i++) {
+      server_chains.push_back(absl::StrCat(YamlServerNameCidrTop, i, YamlServerNameCidrBottom));
+    }
+    listener_yaml_config_ = TestEnvironment::substitute(
+        absl::StrCat(YamlHeader, absl::StrJoin(server_chains, "")),
+        Network::Address::IpVersion::v4);
+    TestUtility::loadFromYaml(listener_yaml_config_, listener_config_);
+    filter_chains_ = listener_config_.filter_chains();
+  }
+};
+
+// NOLINTNEXTLINE(readability-redundant-member-init)
+BENCHMARK_DEFINE_F(FilterChainCidrBenchmarkFixture, FilterChainManagerBuildTest)
+(::benchmark::State& state) {
+  NiceMock<Server::Configuration::MockFactoryContext> factory_context;
+  for (auto _ : state) {
+    FilterChainManagerImpl filter_chain_manager{
+        std::make_shared<Network::Address::Ipv4Instance>("127.0.0.1", 1234), factory_context,
+        init_manager_};
+    filter_chain_manager.addFilterChain(filter_chains_, dummy_builder_, filter_chain_manager);
+  }
+}
+
+BENCHMARK_DEFINE_F(FilterChainCidrBenchmarkFixture, FilterChainFindTest)
+(::benchmark::State& state) {
+  std::vector<MockConnectionSocket> sockets;
+  sockets.reserve(state.range(0));
+  for (int i = 0; i < state.range(0); i++) {
+    sockets.push_back(std::move(*MockConnectionSocket::createMockConnectionSocket(
+        1234, "127.0.0.1", absl::StrCat("server", i, ".example.com"), "tls", {}, "8.8.8.8", 111)));
+  }
+  NiceMock<Server::Configuration::MockFactoryContext> factory_context;
+  FilterChainManagerImpl filter_chain_manager{
+      std::make_shared<Network::Address::Ipv4Instance>("127.0.0.1", 1234), factory_context,
+      init_manager_};
+
+  filter_chain_manager.addFilterChain(filter_chains_, dummy_builder_, filter_chain_manager);
+  for (auto _ : state) {
+    for (int i = 0; i < state.range(0); i++) {
+      filter_chain_manager.findFilterChain(sockets[i]);
+    }
+  }
+}
+
 BENCHMARK_REGISTER_F(FilterChainBenchmarkFixture, FilterChainManagerBuildTest)
     ->Ranges({
         // scale of the chains
@@ -230,6 +309,16 @@ BENCHMARK_REGISTER_F(FilterChainBenchmarkFixture, FilterChainFindTest)
         // scale of the chains
         {1, 4096},
     });
+BENCHMARK_REGISTER_F(FilterChainCidrBenchmarkFixture, FilterChainManagerBuildTest)
+    ->Ranges({
+        // scale of the chains
+        {1, 4096},
+    });
+BENCHMARK_REGISTER_F(FilterChainCidrBenchmarkFixture, FilterChainFindTest)
+    ->Ranges({
+        // scale of the chains
+        {1, 4096},
+    });
 
 /*
 clang-format off
@@ -255,6 +344,46 @@ FilterChainBenchmarkFixture/FilterChainFindTest/64                16057 ns
 FilterChainBenchmarkFixture/FilterChainFindTest/512              172423 ns       172269 ns         4253
 FilterChainBenchmarkFixture/FilterChainFindTest/4096            2676478 ns      2676167 ns          254
 
+clang-format on
+*/
+
+/*
+Before and after building one trie per distinct set of CIDR ranges and skipping the tries of
+catch-all ranges, with filter chain matching and this benchmark built standalone at -O2:
+
+clang-format off
+
+Run on (1 X 2000 MHz CPU )
+CPU Caches:
+  L1 Data 48 KiB (x1)
+  L1 Instruction 32 KiB (x1)
+  L2 Unified 2048 KiB (x1)
+  L3 Unified 107520 KiB (x1)
+Load Average: 0.80, 0.45, 0.34
+-----------------------------------------------------------------------------------------------------------------------------
+Benchmark                                                                 Before (Time / CPU)              After (Time / CPU)
+-----------------------------------------------------------------------------------------------------------------------------
+FilterChainBenchmarkFixture/FilterChainManagerBuildTest/1            128690 ns /    122493 ns        84495 ns /     81684 ns
+FilterChainBenchmarkFixture/FilterChainManagerBuildTest/8            622371 ns /    586852 ns       336810 ns /    327522 ns
+FilterChainBenchmarkFixture/FilterChainManagerBuildTest/64          5608125 ns /   5396300 ns      2543346 ns /   2493151 ns
+FilterChainBenchmarkFixture/FilterChainManagerBuildTest/512        40856975 ns /  38397747 ns     22513587 ns /  22100689 ns
+FilterChainBenchmarkFixture/FilterChainManagerBuildTest/4096      350148428 ns / 335996303 ns    266741300 ns / 261146108 ns
+FilterChainBenchmarkFixture/FilterChainFindTest/1                       240 ns /       238 ns         88.7 ns /      87.0 ns
+FilterChainBenchmarkFixture/FilterChainFindTest/8                      1774 ns /      1746 ns          700 ns /       675 ns
+FilterChainBenchmarkFixture/FilterChainFindTest/64                    18507 ns /     18195 ns         7104 ns /      7038 ns
+FilterChainBenchmarkFixture/FilterChainFindTest/512                  150495 ns /    148651 ns        42696 ns /     42551 ns
+FilterChainBenchmarkFixture/FilterChainFindTest/4096                9321623 ns /   8346160 ns       754037 ns /    740515 ns
+FilterChainCidrBenchmarkFixture/FilterChainManagerBuildTest/1        221939 ns /    214861 ns       142032 ns /    137592 ns
+FilterChainCidrBenchmarkFixture/FilterChainManagerBuildTest/8       1306103 ns /   1267450 ns       896300 ns /    876796 ns
+FilterChainCidrBenchmarkFixture/FilterChainManagerBuildTest/64      8508062 ns /   8298261 ns      7957049 ns /   7566167 ns
+FilterChainCidrBenchmarkFixture/FilterChainManagerBuildTest/512    74039734 ns /  73122828 ns     58809004 ns /  58334743 ns
+FilterChainCidrBenchmarkFixture/FilterChainManagerBuildTest/4096  732503873 ns / 721848611 ns    639956003 ns / 624207693 ns
+FilterChainCidrBenchmarkFixture/FilterChainFindTest/1                   257 ns /       253 ns          256 ns /       251 ns
+FilterChainCidrBenchmarkFixture/FilterChainFindTest/8                  2576 ns /      2528 ns         2068 ns /      2018 ns
+FilterChainCidrBenchmarkFixture/FilterChainFindTest/64                20836 ns /     20559 ns        15963 ns /     15662 ns
+FilterChainCidrBenchmarkFixture/FilterChainFindTest/512              156446 ns /    150389 ns       132658 ns /    129408 ns
+FilterChainCidrBenchmarkFixture/FilterChainFindTest/4096            7370172 ns /   7212058 ns      3549018 ns /   3515146 ns
+
 clang-format on
 */
 } // namespace Server
@@ -191,6 +191,45 @@ TEST_F(FilterChainManagerImplTest, DuplicateContextsAreNotBuilt) {
       filter_chain_factory_builder_, new_filter_chain_manager);
 }
 
+// Destination ports configured with the same source CIDR ranges share a trie, which must still
+// lead to the filter chains of each port.
+TEST_F(FilterChainManagerImplTest, SharedSourceIPsTries) {
+  std::vector<envoy::config::listener::v3::FilterChain> filter_chain_messages;
+  for (int i = 0; i < 4; i++) {
+    envoy::config::listener::v3::FilterChain new_filter_chain = filter_chain_template_;
+    new_filter_chain.set_name(absl::StrCat("filter_chain_", i));
+    auto* filter_chain_match = new_filter_chain.mutable_filter_chain_match();
+    filter_chain_match->mutable_destination_port()->set_value(10000 + i / 2);
+    if (i % 2 == 1) {
+      auto* source_prefix_range = filter_chain_match->add_source_prefix_ranges();
+      source_prefix_range->set_address_prefix("10.0.0.0");
+      source_prefix_range->mutable_prefix_len()->set_value(8);
+    }
+    filter_chain_messages.push_back(std::move(new_filter_chain));
+  }
+  EXPECT_CALL(filter_chain_factory_builder_, buildFilterChain(_, _))
+      .Times(4)
+      .WillRepeatedly(testing::InvokeWithoutArgs(
+          []() { return std::make_shared<Network::MockFilterChain>(); }));
+  filter_chain_manager_.addFilterChain(
+      std::vector<const envoy::config::listener::v3::FilterChain*>{
+          &filter_chain_messages[0], &filter_chain_messages[1], &filter_chain_messages[2],
+          &filter_chain_messages[3]},
+      filter_chain_factory_builder_, filter_chain_manager_);
+
+  std::vector<const Network::FilterChain*> filter_chains;
+  filter_chains.push_back(findFilterChainHelper(10000, "127.0.0.1", "", "tls", {}, "8.8.8.8", 111));
+  filter_chains.push_back(
+      findFilterChainHelper(10000, "127.0.0.1", "", "tls", {}, "10.1.2.3", 111));
+  filter_chains.push_back(findFilterChainHelper(10001, "127.0.0.1", "", "tls", {}, "8.8.8.8", 111));
+  filter_chains.push_back(
+      findFilterChainHelper(10001, "127.0.0.1", "", "tls", {}, "10.1.2.3", 111));
+  for (int i = 0; i < 4; i++) {
+    EXPECT_EQ(filter_chains[i],
+              filter_chain_manager_.filterChainsByMessage().at(filter_chain_messages[i]).get());
+  }
+}
+
 TEST_F(FilterChainManagerImplTest, CreatedFilterChainFactoryContextHasIndependentDrainClose) {
   std::vector<envoy::config::listener::v3::FilterChain> filter_chain_messages;
   for (int i = 0; i < 3; i++) {
@@ -215,9 +254,14 @@ TEST_F(FilterChainManagerImplTest, CreatedFilterChainFactoryContextHasIndependen
   EXPECT_FALSE(context1->drainDecision().drainClose());
 
   // Drain filter chain 0
+  Network::MockDrainDecision filter_chain_drain_decision;
   auto* context_impl_0 = dynamic_cast<PerFilterChainFactoryContextImpl*>(context0.get());
-  context_impl_0->startDraining();
+  context_impl_0->startDraining(filter_chain_drain_decision);
 
+  // Connections of the draining filter chain are closed as decided by the draining listener.
+  EXPECT_CALL(filter_chain_drain_decision, drainClose()).WillOnce(Return(false));
+  EXPECT_FALSE(context0->drainDecision().drainClose());
+  EXPECT_CALL(filter_chain_drain_decision, drainClose()).WillOnce(Return(true));
   EXPECT_TRUE(context0->drainDecision().drainClose());
   EXPECT_FALSE(context1->drainDecision().drainClose());
 }
@@ -1,8 +1,11 @@
+#include <algorithm>
+#include <cstring>
 #include <memory>
 
 #include "common/api/os_sys_calls_impl.h"
 #include "common/api/os_sys_calls_impl_hot_restart.h"
 #include "common/common/hex.h"
+#include "common/common/lock_guard.h"
 
 #include "server/hot_restart_impl.h"
 
@@ -77,6 +80,42 @@ TEST_F(HotRestartImplTest, VersionString) {
   }
 }
 
+// Rotated session ticket keys are laid into the shared memory segment, so that they are visible to
+// the child process.
+TEST_F(HotRestartImplTest, SessionTicketKeyStorage) {
+  setup();
+  Ssl::SessionTicketKeyStorage* storage = hot_restart_->sessionTicketKeyStorage();
+  ASSERT_NE(nullptr, storage);
+  Thread::LockGuard lock(storage->lock());
+  const uint8_t* keys = reinterpret_cast<const uint8_t*>(&storage->keys());
+  EXPECT_GE(keys, buffer_.data());
+  EXPECT_LE(keys + sizeof(Ssl::RotatedSessionTicketKeys), buffer_.data() + buffer_.size());
+  EXPECT_EQ(0, storage->keys().num_keys_);
+}
+
+// The last process attached to the shared memory segment scrubs the session ticket keys on exit.
+TEST_F(HotRestartImplTest, SessionTicketKeysClearedOnExit) {
+  setup();
+  Ssl::SessionTicketKeyStorage* storage = hot_restart_->sessionTicketKeyStorage();
+  uint64_t generation;
+  {
+    Thread::LockGuard lock(storage->lock());
+    storage->keys().num_keys_ = 1;
+    std::memset(storage->keys().keys_[0].aes_key_, 0xab, sizeof(storage->keys().keys_[0].aes_key_));
+    generation = ++storage->generation();
+  }
+  const SharedMemory& shmem = *reinterpret_cast<const SharedMemory*>(buffer_.data());
+  EXPECT_EQ(1, shmem.attached_processes_);
+
+  hot_restart_.reset();
+  EXPECT_EQ(0, shmem.attached_processes_);
+  EXPECT_EQ(0, shmem.session_ticket_keys_.num_keys_);
+  const uint8_t* keys = reinterpret_cast<const uint8_t*>(&shmem.session_ticket_keys_);
+  EXPECT_TRUE(std::all_of(keys, keys + sizeof(Ssl::RotatedSessionTicketKeys),
+                          [](uint8_t byte) { return byte == 0; }));
+  EXPECT_GT(shmem.session_ticket_keys_generation_, generation);
+}
+
 } // namespace
 } // namespace Server
 } // namespace Envoy
@@ -613,7 +613,7 @@ drain_type: modify_only
 }
 
 // Make sure that a listener creation does not fail on IPv4 only setups when FilterChainMatch is not
-// specified and we try to create default CidrRange. See makeCidrListEntry function for
+// specified and we try to create default CidrRange. See makeCidrRanges function for
 // more details.
 TEST_F(ListenerManagerImplTest, AddListenerOnIpv4OnlySetups) {
   InSequence s;
@@ -645,7 +645,7 @@ drain_type: default
 }
 
 // Make sure that a listener creation does not fail on IPv6 only setups when FilterChainMatch is not
-// specified and we try to create default CidrRange. See makeCidrListEntry function for
+// specified and we try to create default CidrRange. See makeCidrRanges function for
 // more details.
 TEST_F(ListenerManagerImplTest, AddListenerOnIpv6OnlySetups) {
   InSequence s;
@@ -4347,6 +4347,13 @@ filter_chains:
   listener_foo_update1->target_.ready();
   checkStats(__LINE__, 1, 1, 0, 0, 1, 0, 1);
 
+  // The connections of the removed filter chain are closed with a probability growing over the
+  // drain time rather than all at once.
+  ON_CALL(server_.random_, random()).WillByDefault(Return(300000));
+  EXPECT_FALSE(listener_foo->context_->drainDecision().drainClose());
+  time_system_.advanceTimeWait(std::chrono::seconds(301));
+  EXPECT_TRUE(listener_foo->context_->drainDecision().drainClose());
+
   // Timer expires, worker close connections if any.
   EXPECT_CALL(*worker_, removeFilterChains(_, _, _));
   filter_chain_drain_timer->invokeCallback();
@@ -0,0 +1,49 @@
+#include "test/test_common/allocation_counter.h"
+
+#include <atomic>
+
+#include "common/common/assert.h"
+
+#ifdef TCMALLOC
+#include "gperftools/malloc_hook.h"
+#endif
+
+namespace Envoy {
+namespace {
+
+std::atomic<uint64_t> allocations_;
+bool counting_;
+
+#ifdef TCMALLOC
+void onNew(const void*, size_t) { allocations_.fetch_add(1, std::memory_order_relaxed); }
+#endif
+
+} // namespace
+
+AllocationCounter::AllocationCounter() {
+  RELEASE_ASSERT(!counting_, "only one AllocationCounter may be alive at a time");
+  counting_ = true;
+  allocations_ = 0;
+#ifdef TCMALLOC
+  MallocHook::AddNewHook(&onNew);
+#endif
+}
+
+AllocationCounter::~AllocationCounter() {
+#ifdef TCMALLOC
+  MallocHook::RemoveNewHook(&onNew);
+#endif
+  counting_ = false;
+}
+
+bool AllocationCounter::supported() {
+#ifdef TCMALLOC
+  return true;
+#else
+  return false;
+#endif
+}
+
+uint64_t AllocationCounter::allocations() const { return allocations_; }
+
+} // namespace Envoy
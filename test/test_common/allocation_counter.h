@@ -0,0 +1,26 @@
+#pragma once
+
+#include <cstdint>
+
+namespace Envoy {
+
+// Counts the heap allocations made by all threads while it is alive, so that benchmarks can report
+// allocations per operation. Allocations are only counted when the build uses tcmalloc, and only
+// one counter may be alive at a time.
+class AllocationCounter {
+public:
+  AllocationCounter();
+  ~AllocationCounter();
+
+  /**
+   * @return whether allocations are counted in this build.
+   */
+  static bool supported();
+
+  /**
+   * @return the number of allocations made since the counter was created.
+   */
+  uint64_t allocations() const;
+};
+
+} // namespace Envoy
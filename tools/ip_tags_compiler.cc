@@ -0,0 +1,49 @@
+/**
+ * Utility to compile the IP tags of an IP tagging filter configuration, for the
+ * compiled_ip_tags field of the filter.
+ *
+ * Usage:
+ *
+ * ip_tags_compiler <input IPTagging YAML/JSON/proto path> <output compiled IP tags path>
+ */
+#include <cstdlib>
+#include <fstream>
+
+#include "envoy/extensions/filters/http/ip_tagging/v3/ip_tagging.pb.h"
+
+#include "common/api/api_impl.h"
+#include "common/common/assert.h"
+#include "common/event/real_time_system.h"
+#include "common/protobuf/message_validator_impl.h"
+#include "common/protobuf/utility.h"
+#include "common/stats/isolated_store_impl.h"
+
+#include "exe/platform_impl.h"
+
+#include "extensions/filters/http/ip_tagging/ip_tagging_filter.h"
+
+// NOLINT(namespace-envoy)
+int main(int argc, char** argv) {
+  if (argc != 3) {
+    std::cerr << "Usage: " << argv[0]
+              << " <input IPTagging YAML/JSON/proto path> <output compiled IP tags path>"
+              << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  Envoy::PlatformImpl platform_impl_;
+  Envoy::Stats::IsolatedStoreImpl stats_store;
+  Envoy::Event::RealTimeSystem time_system; // NO_CHECK_FORMAT(real_time)
+  Envoy::Api::Impl api(platform_impl_.threadFactory(), stats_store, time_system,
+                       platform_impl_.fileSystem());
+
+  envoy::extensions::filters::http::ip_tagging::v3::IPTagging config;
+  Envoy::MessageUtil::loadFromFile(argv[1], config,
+                                   Envoy::ProtobufMessage::getStrictValidationVisitor(), api);
+  const std::string compiled_ip_tags =
+      Envoy::Extensions::HttpFilters::IpTagging::IpTaggingFilterConfig::buildTrie(config)
+          ->snapshot();
+  std::ofstream compiled_ip_tags_file(argv[2], std::ios::binary);
+  compiled_ip_tags_file << compiled_ip_tags;
+  return compiled_ip_tags_file ? EXIT_SUCCESS : EXIT_FAILURE;
+}